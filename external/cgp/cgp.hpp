@@ -16,5 +16,6 @@
 #include "cgp_debug.hpp"
 #include "core/core.hpp"
 #include "geometry/geometry.hpp"
+#include "physics/physics.hpp"
 #include "graphics/graphics.hpp"
 
@@ -2,3 +2,5 @@
 
 #include "numarray_stack/numarray_stack.hpp"
 #include "numarray/numarray.hpp"
+#include "pack/pack.hpp"
+#include "rand_array/rand_array.hpp"
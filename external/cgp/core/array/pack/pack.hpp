@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+	/** Number of lanes of the packs: 8 floats fill an AVX register (and two SSE/NEON registers) */
+	constexpr int pack_lanes = 8;
+
+	/** Result of a lane-wise comparison between two float_pack */
+	struct mask_pack
+	{
+		bool data[pack_lanes];
+	};
+
+	/** Fixed size pack of floats used to write vectorized kernels
+	*
+	* All operations are applied independently on each lane, without bound checking and without data-dependent branches,
+	*   such that the compiler can map them directly to SIMD instructions.
+	* Kernels can be written once as templates on the scalar type, and instantiated with float (scalar version) or float_pack (8 lanes at once):
+	*   - Comparisons return a bool (float) or a mask_pack (float_pack)
+	*   - Conditional values are expressed using select(condition, value_if_true, value_if_false) instead of branches */
+	struct float_pack
+	{
+		alignas(32) float data[pack_lanes];
+
+		float_pack() = default;
+		// Broadcast the value to all lanes (implicit to allow expressions mixing packs and constants)
+		float_pack(float value);
+
+		static float_pack load(float const* p);
+		void store(float* p) const;
+
+		float const& operator[](int lane) const { return data[lane]; }
+		float& operator[](int lane) { return data[lane]; }
+	};
+
+	float_pack operator-(float_pack const& a);
+	float_pack operator+(float_pack const& a, float_pack const& b);
+	float_pack operator-(float_pack const& a, float_pack const& b);
+	float_pack operator*(float_pack const& a, float_pack const& b);
+	float_pack operator/(float_pack const& a, float_pack const& b);
+	float_pack& operator+=(float_pack& a, float_pack const& b);
+	float_pack& operator-=(float_pack& a, float_pack const& b);
+	float_pack& operator*=(float_pack& a, float_pack const& b);
+	float_pack& operator/=(float_pack& a, float_pack const& b);
+
+	mask_pack operator<(float_pack const& a, float_pack const& b);
+	mask_pack operator<=(float_pack const& a, float_pack const& b);
+	mask_pack operator>(float_pack const& a, float_pack const& b);
+	mask_pack operator>=(float_pack const& a, float_pack const& b);
+	mask_pack operator==(float_pack const& a, float_pack const& b);
+	mask_pack operator&&(mask_pack const& a, mask_pack const& b);
+	mask_pack operator||(mask_pack const& a, mask_pack const& b);
+	mask_pack operator!(mask_pack const& a);
+
+	float_pack sqrt(float_pack const& a);
+	float_pack abs(float_pack const& a);
+	float_pack floor(float_pack const& a);
+	float_pack sin(float_pack const& a);
+	float_pack cos(float_pack const& a);
+	float_pack min(float_pack const& a, float_pack const& b);
+	float_pack max(float_pack const& a, float_pack const& b);
+
+	/** Lane-wise selection: condition ? a : b */
+	float_pack select(mask_pack const& condition, float_pack const& a, float_pack const& b);
+	/** Scalar counterpart of select, allows to instantiate pack kernels with float */
+	constexpr float select(bool condition, float a, float b);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	inline float_pack::float_pack(float value)
+	{
+		for (int k = 0; k < pack_lanes; ++k)
+			data[k] = value;
+	}
+	inline float_pack float_pack::load(float const* p)
+	{
+		float_pack a;
+		for (int k = 0; k < pack_lanes; ++k)
+			a.data[k] = p[k];
+		return a;
+	}
+	inline void float_pack::store(float* p) const
+	{
+		for (int k = 0; k < pack_lanes; ++k)
+			p[k] = data[k];
+	}
+
+	inline float_pack operator-(float_pack const& a)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = -a.data[k];
+		return r;
+	}
+	inline float_pack operator+(float_pack const& a, float_pack const& b)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = a.data[k] + b.data[k];
+		return r;
+	}
+	inline float_pack operator-(float_pack const& a, float_pack const& b)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = a.data[k] - b.data[k];
+		return r;
+	}
+	inline float_pack operator*(float_pack const& a, float_pack const& b)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = a.data[k] * b.data[k];
+		return r;
+	}
+	inline float_pack operator/(float_pack const& a, float_pack const& b)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = a.data[k] / b.data[k];
+		return r;
+	}
+	inline float_pack& operator+=(float_pack& a, float_pack const& b) { a = a + b; return a; }
+	inline float_pack& operator-=(float_pack& a, float_pack const& b) { a = a - b; return a; }
+	inline float_pack& operator*=(float_pack& a, float_pack const& b) { a = a * b; return a; }
+	inline float_pack& operator/=(float_pack& a, float_pack const& b) { a = a / b; return a; }
+
+	inline mask_pack operator<(float_pack const& a, float_pack const& b)
+	{
+		mask_pack m;
+		for (int k = 0; k < pack_lanes; ++k)
+			m.data[k] = a.data[k] < b.data[k];
+		return m;
+	}
+	inline mask_pack operator<=(float_pack const& a, float_pack const& b)
+	{
+		mask_pack m;
+		for (int k = 0; k < pack_lanes; ++k)
+			m.data[k] = a.data[k] <= b.data[k];
+		return m;
+	}
+	inline mask_pack operator>(float_pack const& a, float_pack const& b) { return b < a; }
+	inline mask_pack operator>=(float_pack const& a, float_pack const& b) { return b <= a; }
+	inline mask_pack operator==(float_pack const& a, float_pack const& b)
+	{
+		mask_pack m;
+		for (int k = 0; k < pack_lanes; ++k)
+			m.data[k] = a.data[k] == b.data[k];
+		return m;
+	}
+	inline mask_pack operator&&(mask_pack const& a, mask_pack const& b)
+	{
+		mask_pack m;
+		for (int k = 0; k < pack_lanes; ++k)
+			m.data[k] = a.data[k] & b.data[k];
+		return m;
+	}
+	inline mask_pack operator||(mask_pack const& a, mask_pack const& b)
+	{
+		mask_pack m;
+		for (int k = 0; k < pack_lanes; ++k)
+			m.data[k] = a.data[k] | b.data[k];
+		return m;
+	}
+	inline mask_pack operator!(mask_pack const& a)
+	{
+		mask_pack m;
+		for (int k = 0; k < pack_lanes; ++k)
+			m.data[k] = !a.data[k];
+		return m;
+	}
+
+	inline float_pack sqrt(float_pack const& a)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = std::sqrt(a.data[k]);
+		return r;
+	}
+	inline float_pack abs(float_pack const& a)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = std::abs(a.data[k]);
+		return r;
+	}
+	inline float_pack floor(float_pack const& a)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = std::floor(a.data[k]);
+		return r;
+	}
+	inline float_pack sin(float_pack const& a)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = std::sin(a.data[k]);
+		return r;
+	}
+	inline float_pack cos(float_pack const& a)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = std::cos(a.data[k]);
+		return r;
+	}
+	inline float_pack min(float_pack const& a, float_pack const& b)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = a.data[k] < b.data[k] ? a.data[k] : b.data[k];
+		return r;
+	}
+	inline float_pack max(float_pack const& a, float_pack const& b)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = a.data[k] > b.data[k] ? a.data[k] : b.data[k];
+		return r;
+	}
+
+	inline float_pack select(mask_pack const& condition, float_pack const& a, float_pack const& b)
+	{
+		float_pack r;
+		for (int k = 0; k < pack_lanes; ++k)
+			r.data[k] = condition.data[k] ? a.data[k] : b.data[k];
+		return r;
+	}
+	constexpr float select(bool condition, float a, float b)
+	{
+		return condition ? a : b;
+	}
+}
@@ -0,0 +1,118 @@
+#include "rand_array.hpp"
+
+#include "cgp/core/array/pack/pack.hpp"
+
+#include <cmath>
+
+namespace cgp
+{
+	namespace
+	{
+		// Random words of the generator for pack_lanes consecutive ids, with the same (seed, step, block)
+		//  word[w][lane] = rand_philox4x32({block, step, id}, seed)[w] with id = first_id + lane
+		// The loops along the lanes have no dependencies and are vectorized by the compiler
+		void philox_lanes(uint64_t seed, uint64_t first_id, uint32_t step, uint32_t block, uint32_t word[4][pack_lanes])
+		{
+			uint32_t c0[pack_lanes], c1[pack_lanes], c2[pack_lanes], c3[pack_lanes];
+			for (int lane = 0; lane < pack_lanes; ++lane) {
+				uint64_t const id = first_id + uint64_t(lane);
+				c0[lane] = block;
+				c1[lane] = step;
+				c2[lane] = uint32_t(id);
+				c3[lane] = uint32_t(id >> 32);
+			}
+
+			uint32_t k0 = uint32_t(seed), k1 = uint32_t(seed >> 32);
+			for (int round = 0; round < 10; ++round)
+			{
+				for (int lane = 0; lane < pack_lanes; ++lane) {
+					uint64_t const p0 = uint64_t(0xD2511F53u) * c0[lane];
+					uint64_t const p1 = uint64_t(0xCD9E8D57u) * c2[lane];
+					uint32_t const n0 = uint32_t(p1 >> 32) ^ c1[lane] ^ k0;
+					uint32_t const n2 = uint32_t(p0 >> 32) ^ c3[lane] ^ k1;
+					c0[lane] = n0;
+					c1[lane] = uint32_t(p1);
+					c2[lane] = n2;
+					c3[lane] = uint32_t(p0);
+				}
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+
+			for (int lane = 0; lane < pack_lanes; ++lane) {
+				word[0][lane] = c0[lane];
+				word[1][lane] = c1[lane];
+				word[2][lane] = c2[lane];
+				word[3][lane] = c3[lane];
+			}
+		}
+
+		// Convert the 4 words of each lane to 4 uniform values in [0,1) (same conversion as rand_interval_counter)
+		void uniform_lanes(uint32_t const word[4][pack_lanes], float value[4][pack_lanes])
+		{
+			for (int w = 0; w < 4; ++w)
+				for (int lane = 0; lane < pack_lanes; ++lane)
+					value[w][lane] = float(word[w][lane] >> 8) * (1.0f / 16777216.0f);
+		}
+
+		// Convert the 4 words of each lane to 4 normal values (same Box-Muller transform as rand_normal_counter)
+		void normal_lanes(uint32_t const word[4][pack_lanes], float value[4][pack_lanes])
+		{
+			for (int pair = 0; pair < 2; ++pair) {
+				for (int lane = 0; lane < pack_lanes; ++lane) {
+					float const u1 = float((word[2 * pair][lane] >> 8) + 1) * (1.0f / 16777216.0f);
+					float const u2 = float(word[2 * pair + 1][lane] >> 8) * (1.0f / 16777216.0f);
+					float const radius = std::sqrt(-2.0f * std::log(u1));
+					float const angle = 6.283185307f * u2;
+					value[2 * pair][lane] = radius * std::cos(angle);
+					value[2 * pair + 1][lane] = radius * std::sin(angle);
+				}
+			}
+		}
+
+		float& component(float& value, int) { return value; }
+		float& component(numarray_stack3<float>& value, int c) { return value.at_unsafe(c); }
+
+		// Fill the array, with components values per element (at most 4: a single block of the generator per element)
+		template <bool normal, int components, typename T>
+		void fill_counter(numarray<T>& values, uint64_t seed, uint32_t step, float scale, float offset, uint64_t first_id)
+		{
+			int const N = values.size();
+			int const N_pack = (N + pack_lanes - 1) / pack_lanes;
+
+			#pragma omp parallel for
+			for (int k_pack = 0; k_pack < N_pack; ++k_pack)
+			{
+				int const k0 = k_pack * pack_lanes;
+				uint32_t word[4][pack_lanes];
+				float value[4][pack_lanes];
+				philox_lanes(seed, first_id + uint64_t(k0), step, 0, word);
+				if (normal)
+					normal_lanes(word, value);
+				else
+					uniform_lanes(word, value);
+
+				for (int lane = 0; lane < pack_lanes && k0 + lane < N; ++lane)
+					for (int c = 0; c < components; ++c)
+						component(values.at_unsafe(k0 + lane), c) = scale * value[c][lane] + offset;
+			}
+		}
+	}
+
+	void rand_interval_counter(numarray<float>& values, uint64_t seed, uint32_t step, float value_min, float value_max, uint64_t first_id)
+	{
+		fill_counter<false, 1>(values, seed, step, value_max - value_min, value_min, first_id);
+	}
+	void rand_interval_counter(numarray<numarray_stack3<float> >& values, uint64_t seed, uint32_t step, float value_min, float value_max, uint64_t first_id)
+	{
+		fill_counter<false, 3>(values, seed, step, value_max - value_min, value_min, first_id);
+	}
+	void rand_normal_counter(numarray<float>& values, uint64_t seed, uint32_t step, float average, float stddev, uint64_t first_id)
+	{
+		fill_counter<true, 1>(values, seed, step, stddev, average, first_id);
+	}
+	void rand_normal_counter(numarray<numarray_stack3<float> >& values, uint64_t seed, uint32_t step, float average, float stddev, uint64_t first_id)
+	{
+		fill_counter<true, 3>(values, seed, step, stddev, average, first_id);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "cgp/core/base/rand/rand.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+#include "cgp/core/array/numarray_stack/numarray_stack.hpp"
+
+#include <cstdint>
+
+namespace cgp
+{
+	// Batched counter-based random values (Philox4x32-10, see rand_interval_counter in cgp/core/base/rand)
+	//
+	// The whole array is filled at once: the generator is evaluated on 8 consecutive elements at a time (vectorized along the elements), and the array is processed in parallel with OpenMP.
+	// The element values[k] is drawn with the id (first_id+k), and its components with the index 0, 1, 2:
+	//   values[k] == rand_interval_counter(seed, first_id+k, step, 0, value_min, value_max) (float)
+	//   values[k][c] == rand_interval_counter(seed, first_id+k, step, c, value_min, value_max) (numarray_stack3<float> / vec3)
+	// The results are therefore identical whatever the number of threads and the way the arrays are split (up to the rounding of the vectorized log/sin/cos for normal values).
+	//
+	// The arrays must be allocated to the number of expected values before the call.
+
+	/** Fill the array with uniform values in [value_min, value_max) */
+	void rand_interval_counter(numarray<float>& values, uint64_t seed, uint32_t step, float value_min = 0.0f, float value_max = 1.0f, uint64_t first_id = 0);
+	/** Fill the array with 3 independent uniform values per element in [value_min, value_max) */
+	void rand_interval_counter(numarray<numarray_stack3<float> >& values, uint64_t seed, uint32_t step, float value_min = 0.0f, float value_max = 1.0f, uint64_t first_id = 0);
+
+	/** Fill the array with normal values */
+	void rand_normal_counter(numarray<float>& values, uint64_t seed, uint32_t step, float average = 0.0f, float stddev = 1.0f, uint64_t first_id = 0);
+	/** Fill the array with 3 independent normal values per element (ex. stochastic force per particle) */
+	void rand_normal_counter(numarray<numarray_stack3<float> >& values, uint64_t seed, uint32_t step, float average = 0.0f, float stddev = 1.0f, uint64_t first_id = 0);
+}
@@ -0,0 +1,71 @@
+#include "test_rand_array.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../rand_array.hpp"
+
+#include <cmath>
+
+namespace cgp_test
+{
+	void test_rand_array()
+	{
+		using namespace cgp;
+
+		// Known answers of Philox4x32-10 (Random123 test vectors)
+		{
+			std::array<uint32_t, 4> const r0 = rand_philox4x32({ 0,0,0,0 }, { 0,0 });
+			assert_cgp_no_msg(r0[0] == 0x6627e8d5u && r0[1] == 0xe169c58du && r0[2] == 0xbc57ac4cu && r0[3] == 0x9b00dbd8u);
+
+			std::array<uint32_t, 4> const r1 = rand_philox4x32({ 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u }, { 0xa4093822u, 0x299f31d0u });
+			assert_cgp_no_msg(r1[0] == 0xd16cfe09u && r1[1] == 0x94fdccebu && r1[2] == 0x5001e420u && r1[3] == 0x24126ea1u);
+		}
+
+		// Counter-based values are pure functions of (seed, id, step, index)
+		{
+			assert_cgp_no_msg(rand_interval_counter(7, 12, 3, 1) == rand_interval_counter(7, 12, 3, 1));
+			assert_cgp_no_msg(rand_interval_counter(7, 12, 3, 1) != rand_interval_counter(7, 12, 4, 1));
+			assert_cgp_no_msg(rand_interval_counter(7, 12, 3, 1) != rand_interval_counter(7, 13, 3, 1));
+			assert_cgp_no_msg(rand_interval_counter(7, 12, 3, 1) != rand_interval_counter(8, 12, 3, 1));
+		}
+
+		// Batched versions match the scalar ones, including with an offset on the ids
+		{
+			int const N = 1003; // not a multiple of the number of lanes
+			numarray<float> u(N), n(N);
+			numarray<numarray_stack3<float> > u3(N), n3(N);
+			rand_interval_counter(u, 42, 5, -1.0f, 2.0f);
+			rand_normal_counter(n, 42, 5, 1.0f, 0.5f);
+			rand_interval_counter(u3, 42, 5, 0.0f, 1.0f, 100);
+			rand_normal_counter(n3, 42, 5, 0.0f, 1.0f, 100);
+
+			for (int k = 0; k < N; ++k) {
+				assert_cgp_no_msg(u[k] == rand_interval_counter(42, k, 5, 0, -1.0f, 2.0f));
+				assert_cgp_no_msg(std::abs(n[k] - rand_normal_counter(42, k, 5, 0, 1.0f, 0.5f)) < 1e-5f);
+				for (int c = 0; c < 3; ++c) {
+					assert_cgp_no_msg(u3[k][c] == rand_interval_counter(42, 100 + k, 5, c));
+					assert_cgp_no_msg(std::abs(n3[k][c] - rand_normal_counter(42, 100 + k, 5, c)) < 1e-5f);
+				}
+			}
+		}
+
+		// Statistics of the distributions
+		{
+			int const N = 100000;
+			numarray<float> u(N), n(N);
+			rand_interval_counter(u, 1, 0);
+			rand_normal_counter(n, 1, 0);
+
+			double mean_u = 0, mean_n = 0, var_n = 0;
+			for (int k = 0; k < N; ++k) {
+				assert_cgp_no_msg(u[k] >= 0.0f && u[k] < 1.0f);
+				mean_u += u[k];
+				mean_n += n[k];
+				var_n += double(n[k]) * n[k];
+			}
+			mean_u /= N; mean_n /= N; var_n /= N;
+			assert_cgp_no_msg(std::abs(mean_u - 0.5) < 0.01);
+			assert_cgp_no_msg(std::abs(mean_n) < 0.02);
+			assert_cgp_no_msg(std::abs(var_n - 1.0) < 0.02);
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #include "rand.hpp"
 #include <random>
 #include <chrono>
+#include <cmath>
 
 namespace cgp
 {
@@ -19,4 +20,52 @@ float rand_normal(float const average, float const stddev)
     return stddev * distribution_normal(generator) + average;
 }
 
+
+std::array<uint32_t, 4> rand_philox4x32(std::array<uint32_t, 4> const& counter, std::array<uint32_t, 2> const& key)
+{
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round)
+    {
+        uint64_t const p0 = uint64_t(0xD2511F53u) * c0;
+        uint64_t const p1 = uint64_t(0xCD9E8D57u) * c2;
+        uint32_t const n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+        uint32_t const n1 = uint32_t(p1);
+        uint32_t const n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+        uint32_t const n3 = uint32_t(p0);
+        c0 = n0; c1 = n1; c2 = n2; c3 = n3;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    return { c0, c1, c2, c3 };
+}
+
+// Each block of the generator provides 4 values: the block counter is (index/4, step, id) and the key is the seed
+static std::array<uint32_t, 4> rand_counter_block(uint64_t seed, uint64_t id, uint32_t step, uint32_t index)
+{
+    return rand_philox4x32({ index / 4, step, uint32_t(id), uint32_t(id >> 32) }, { uint32_t(seed), uint32_t(seed >> 32) });
+}
+
+float rand_interval_counter(uint64_t seed, uint64_t id, uint32_t step, uint32_t index, float value_min, float value_max)
+{
+    std::array<uint32_t, 4> const r = rand_counter_block(seed, id, step, index);
+    // 24 most significant bits mapped to [0,1)
+    float const u = float(r[index % 4] >> 8) * (1.0f / 16777216.0f);
+    return u * (value_max - value_min) + value_min;
+}
+
+float rand_normal_counter(uint64_t seed, uint64_t id, uint32_t step, uint32_t index, float average, float stddev)
+{
+    std::array<uint32_t, 4> const r = rand_counter_block(seed, id, step, index);
+
+    // Box-Muller transform: the words (0,1) and (2,3) give two pairs of normal values (cos, sin)
+    int const pair = int(index % 4) / 2;
+    float const u1 = float((r[2 * pair] >> 8) + 1) * (1.0f / 16777216.0f); // in (0,1]
+    float const u2 = float(r[2 * pair + 1] >> 8) * (1.0f / 16777216.0f);
+    float const radius = std::sqrt(-2.0f * std::log(u1));
+    float const angle = 6.283185307f * u2;
+    float const n = (index % 2 == 0) ? radius * std::cos(angle) : radius * std::sin(angle);
+    return stddev * n + average;
+}
+
 }
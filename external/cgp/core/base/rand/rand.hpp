@@ -1,14 +1,32 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 namespace cgp
 {
 
 	/** Uniform random distribution defined on the interval [value_min, value_max]
-	* default call rand_interval() generates uniform in [0,1]	*/
+	* default call rand_interval() generates uniform in [0,1]	
+	* Note: uses a single generator shared by the whole program - not thread safe (see rand_interval_counter for parallel use) */
 	float rand_interval(float const value_min=0.0f, float const value_max=1.0f);
 
 	/** Normal random distribution with specified averaged and stddev
 	* default call rand_normal() is set with average=0, stddev=1*/
 	float rand_normal(float const average = 0.0f, float const stddev = 1.0f);
 
+
+	/** Philox4x32-10 counter-based generator (Salmon et al. 2011)
+	* Returns 4 random 32-bit words that are a pure function of the 128-bit counter and the 64-bit key */
+	std::array<uint32_t, 4> rand_philox4x32(std::array<uint32_t, 4> const& counter, std::array<uint32_t, 2> const& key);
+
+	/** Counter-based versions of rand_interval and rand_normal
+	* The value is a pure function of (seed, id, step, index): the functions are thread safe, and the results are reproducible whatever the evaluation order
+	*  - id: identifier of the element the value is drawn for (ex. particle index)
+	*  - step: simulation step
+	*  - index: allows to draw several independent values for the same (id, step) (ex. the 3 components of a random vector)
+	* Batched versions filling whole arrays can be found in cgp/core/array/rand_array */
+	float rand_interval_counter(uint64_t seed, uint64_t id, uint32_t step, uint32_t index = 0, float value_min = 0.0f, float value_max = 1.0f);
+	float rand_normal_counter(uint64_t seed, uint64_t id, uint32_t step, uint32_t index = 0, float average = 0.0f, float stddev = 1.0f);
+
 }
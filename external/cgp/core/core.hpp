@@ -4,3 +4,4 @@
 #include "array/array.hpp"
 #include "containers/containers.hpp"
 #include "files/files.hpp"
+#include "profiling/profiling.hpp"
@@ -0,0 +1,105 @@
+#include "binary_file.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#endif
+
+namespace cgp
+{
+	static int process_id()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		return int(getpid());
+#elif defined(_WIN32)
+		return int(_getpid());
+#else
+		return 0;
+#endif
+	}
+
+	uint64_t binary_file_align(uint64_t offset)
+	{
+		return (offset + binary_file_alignment - 1) / binary_file_alignment * binary_file_alignment;
+	}
+
+	binary_file_signature binary_file_signature_create(char const* magic, uint32_t version)
+	{
+		binary_file_signature signature;
+		std::memcpy(signature.magic, magic, sizeof(signature.magic));
+		signature.version = version;
+		signature.endian_check = binary_file_endian_check;
+		return signature;
+	}
+
+	std::string binary_file_signature_check(binary_file_signature const& signature, char const* magic, uint32_t version, std::string const& filename, std::string const& format_name)
+	{
+		if (std::memcmp(signature.magic, magic, sizeof(signature.magic)) != 0)
+			return "File " + filename + " is not a " + format_name;
+		if (signature.version != version)
+			return "File " + filename + " has version " + str(signature.version) + " while the supported version is " + str(version);
+		if (signature.endian_check != binary_file_endian_check)
+			return "File " + filename + " has been written on a machine with a different endianness";
+		return "";
+	}
+
+	void binary_file_write_block(std::ostream& stream, uint64_t& position, uint64_t offset, void const* data, uint64_t size)
+	{
+		assert_cgp(offset >= position, "Blocks must be written in increasing order (offset " + str(offset) + " before position " + str(position) + ")");
+		char const padding[binary_file_alignment] = {};
+		while (position < offset) {
+			uint64_t const N = std::min(offset - position, binary_file_alignment);
+			stream.write(padding, N);
+			position += N;
+		}
+		if (size > 0)
+			stream.write(static_cast<char const*>(data), size);
+		position = offset + size;
+	}
+
+	std::string file_write_atomic(std::string const& filename, std::function<void(std::ostream&)> const& write)
+	{
+		// The temporary name is unique to the process and to the call, such that concurrent writers of the same file never share it
+		static std::atomic<unsigned int> counter(0);
+		std::string const tmp_filename = filename + ".tmp" + str(process_id()) + "_" + str(counter++);
+		{
+			std::ofstream stream(tmp_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!stream.is_open())
+				return "Cannot open file " + tmp_filename;
+
+			write(stream);
+			stream.flush();
+			if (!stream.good()) {
+				stream.close();
+				std::remove(tmp_filename.c_str());
+				return "Error while writing file " + tmp_filename;
+			}
+		}
+
+#ifdef _WIN32
+		// rename does not replace an existing file on Windows
+		std::remove(filename.c_str());
+#endif
+		if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+			std::remove(tmp_filename.c_str());
+			return "Cannot rename " + tmp_filename + " to " + filename;
+		}
+		return "";
+	}
+
+	std::string cache_filename(std::string const& directory, std::string const& prefix, uint64_t key, std::string const& extension)
+	{
+		char key_str[17];
+		std::snprintf(key_str, sizeof(key_str), "%016llx", static_cast<unsigned long long>(key));
+		return directory + "/" + prefix + key_str + extension;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+
+namespace cgp
+{
+	// Common parts of the binary formats of the library (tet_mesh, mesh cache, rest state, checkpoint, recording, etc.)
+	//
+	// A binary file starts with a signature: the magic number of the format, its version, and a known value detecting a different endianness.
+	// The arrays are stored in blocks aligned on binary_file_alignment octets, such that they can be used directly from a mapped file.
+
+	/** Signature placed at the beginning of a binary file */
+	struct binary_file_signature
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t endian_check;
+	};
+
+	uint32_t const binary_file_endian_check = 0x01020304u;
+	uint64_t const binary_file_alignment = 64;
+
+	/** Smallest multiple of binary_file_alignment greater or equal to the offset */
+	uint64_t binary_file_align(uint64_t offset);
+
+	/** Signature of the current version of a format (magic is an array of 8 characters) */
+	binary_file_signature binary_file_signature_create(char const* magic, uint32_t version);
+
+	/** Compare the signature read in a file to the expected format
+	* Return an empty string if it matches, otherwise the description of the mismatch (format_name is used in the message, ex. "checkpoint") */
+	std::string binary_file_signature_check(binary_file_signature const& signature, char const* magic, uint32_t version, std::string const& filename, std::string const& format_name);
+
+	/** Write size octets of data at the given offset of the stream, after filling the gap from the current position with zeros
+	* The position is updated to the end of the block */
+	void binary_file_write_block(std::ostream& stream, uint64_t& position, uint64_t offset, void const* data, uint64_t size);
+
+	/** Write a file in a temporary file that is renamed once complete, such that an interrupted write never leaves an incomplete file
+	* On POSIX systems the rename replaces the previous file atomically: a crash leaves either the previous or the new file.
+	* The temporary file name is unique to the process and to the call, such that concurrent writers do not interfere.
+	* Return an empty string on success, otherwise the description of the error (the temporary file is removed) */
+	std::string file_write_atomic(std::string const& filename, std::function<void(std::ostream&)> const& write);
+
+	/** Filename of the cache entry identified by a key: directory/[prefix][16 hexadecimal digits of the key][extension] */
+	std::string cache_filename(std::string const& directory, std::string const& prefix, uint64_t key, std::string const& extension);
+}
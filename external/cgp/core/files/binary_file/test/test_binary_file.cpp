@@ -0,0 +1,81 @@
+#include "test_binary_file.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace cgp_test
+{
+	void test_binary_file()
+	{
+		using namespace cgp;
+		char const magic[8] = { 'C','G','P','T','E','S','T','\0' };
+		std::string const filename = "test_binary_file.bin";
+
+		assert_cgp_no_msg(binary_file_align(0) == 0 && binary_file_align(1) == 64 && binary_file_align(64) == 64 && binary_file_align(65) == 128);
+
+		// Signature and aligned block
+		{
+			binary_file_signature const signature = binary_file_signature_create(magic, 3);
+			int const values[3] = { 1, 2, 3 };
+			std::string const error = file_write_atomic(filename, [&](std::ostream& stream) {
+				uint64_t position = 0;
+				binary_file_write_block(stream, position, 0, &signature, sizeof(signature));
+				binary_file_write_block(stream, position, binary_file_align(sizeof(signature)), values, sizeof(values));
+			});
+			assert_cgp_no_msg(error.empty());
+			assert_cgp_no_msg(file_get_size(filename) == 64 + sizeof(values));
+		}
+		{
+			file_mapping const file(filename);
+			binary_file_signature signature;
+			std::memcpy(&signature, file.data, sizeof(signature));
+			assert_cgp_no_msg(binary_file_signature_check(signature, magic, 3, filename, "test file").empty());
+			assert_cgp_no_msg(!binary_file_signature_check(signature, magic, 4, filename, "test file").empty());
+			char const other_magic[8] = { 'C','G','P','O','T','H','E','R' };
+			assert_cgp_no_msg(!binary_file_signature_check(signature, other_magic, 3, filename, "test file").empty());
+			signature.endian_check = 0x04030201u;
+			assert_cgp_no_msg(!binary_file_signature_check(signature, magic, 3, filename, "test file").empty());
+
+			int values[3];
+			std::memcpy(values, file.data + 64, sizeof(values));
+			assert_cgp_no_msg(values[0] == 1 && values[2] == 3);
+		}
+		std::remove(filename.c_str());
+
+		// Concurrent writers of the same file: the result is always one complete version
+		{
+			std::vector<std::thread> writers;
+			for (int k = 0; k < 4; ++k) {
+				writers.push_back(std::thread([&filename, k]() {
+					std::vector<char> const data(100000, char('a' + k));
+					for (int n = 0; n < 10; ++n) {
+						std::string const error = file_write_atomic(filename, [&](std::ostream& stream) { stream.write(data.data(), data.size()); });
+						assert_cgp_no_msg(error.empty());
+					}
+				}));
+			}
+			for (std::thread& writer : writers)
+				writer.join();
+
+			file_mapping const file(filename);
+			assert_cgp_no_msg(file.size == 100000);
+			assert_cgp_no_msg(std::count(file.data, file.data + file.size, file.data[0]) == 100000);
+		}
+		std::remove(filename.c_str());
+
+		// A failed write reports an error and leaves no file
+		std::string const error = file_write_atomic("missing_directory/" + filename, [](std::ostream&) {});
+		assert_cgp_no_msg(!error.empty());
+
+		// Cache entries and hashes
+		assert_cgp_no_msg(cache_filename("cache", "entry_", 0xabcull, ".bin") == "cache/entry_0000000000000abc.bin");
+		assert_cgp_no_msg(hash_value(true) == hash_value(uint8_t(1)) && hash_value(false) != hash_value(true));
+		assert_cgp_no_msg(hash_value(1.0f, 7) != hash_value(1.0f, 8));
+	}
+}
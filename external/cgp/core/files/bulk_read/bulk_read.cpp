@@ -0,0 +1,146 @@
+#include "bulk_read.hpp"
+
+#include "../parse/parse.hpp"
+
+#include <vector>
+#include <algorithm>
+
+namespace cgp
+{
+	namespace
+	{
+		size_t const bulk_chunk_size = 1 << 20;
+
+		bool is_separator(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',' || c == ';';
+		}
+
+		// Split the buffer in chunks of about bulk_chunk_size octets ending at a new line (such that values and comments are never split)
+		std::vector<char const*> split_chunks(char const* begin, char const* end)
+		{
+			std::vector<char const*> bounds = { begin };
+			char const* p = begin;
+			while (size_t(end - p) > bulk_chunk_size) {
+				p = parse_line_end(p + bulk_chunk_size, end);
+				if (p < end)
+					++p;
+				bounds.push_back(p);
+			}
+			if (bounds.back() != end)
+				bounds.push_back(end);
+			return bounds;
+		}
+
+		size_t count_values_chunk(char const* p, char const* end)
+		{
+			size_t count = 0;
+			while (p < end) {
+				char const c = *p;
+				if (c == '#')
+					p = parse_line_end(p, end);
+				else if (is_separator(c))
+					++p;
+				else {
+					++count;
+					while (p < end && !is_separator(*p) && *p != '#')
+						++p;
+				}
+			}
+			return count;
+		}
+
+		bool parse_value(char const*& p, char const* end, float& value) { return parse_float(p, end, value); }
+		bool parse_value(char const*& p, char const* end, int& value) { return parse_int(p, end, value); }
+
+		// Return the position of the first invalid value, or nullptr if all the values are valid
+		template <typename S>
+		char const* parse_values_chunk(char const* p, char const* end, S* values)
+		{
+			size_t k = 0;
+			while (p < end) {
+				char const c = *p;
+				if (c == '#')
+					p = parse_line_end(p, end);
+				else if (is_separator(c))
+					++p;
+				else {
+					if (!parse_value(p, end, values[k]) || (p < end && !is_separator(*p) && *p != '#'))
+						return p;
+					++k;
+				}
+			}
+			return nullptr;
+		}
+
+		// Parse all chunks in parallel, each one at the position given by the number of values of the previous chunks
+		template <typename S>
+		void parse_values(text_chunks const& chunks, S* values)
+		{
+			int const N_chunk = int(chunks.bounds.size()) - 1;
+			std::vector<char const*> error(N_chunk, nullptr);
+			#pragma omp parallel for schedule(dynamic)
+			for (int k = 0; k < N_chunk; ++k)
+				error[k] = parse_values_chunk(chunks.bounds[k], chunks.bounds[k + 1], values + chunks.offset[k]);
+
+			char const* const begin = chunks.bounds.front();
+			char const* const end = chunks.bounds.back();
+			for (int k = 0; k < N_chunk; ++k)
+				if (error[k] != nullptr) {
+					char const* const line_end = parse_line_end(error[k], end);
+					error_cgp("Invalid value at position " + str(error[k] - begin) + ": \"" + std::string(error[k], std::min(line_end, error[k] + 32)) + "\"");
+				}
+		}
+
+		template <typename S>
+		void parse_values(char const* begin, char const* end, S* values, size_t N)
+		{
+			text_chunks const chunks = text_split_values(begin, end);
+			assert_cgp(chunks.value_count() == N, "The buffer contains " + str(chunks.value_count()) + " values while " + str(N) + " values are expected");
+			parse_values(chunks, values);
+		}
+	}
+
+	size_t text_chunks::value_count() const
+	{
+		return offset.back();
+	}
+
+	text_chunks text_split_values(char const* begin, char const* end)
+	{
+		text_chunks chunks;
+		chunks.bounds = split_chunks(begin, end);
+		int const N_chunk = int(chunks.bounds.size()) - 1;
+
+		chunks.offset.assign(N_chunk + 1, 0);
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < N_chunk; ++k)
+			chunks.offset[k + 1] = count_values_chunk(chunks.bounds[k], chunks.bounds[k + 1]);
+		for (int k = 0; k < N_chunk; ++k)
+			chunks.offset[k + 1] += chunks.offset[k];
+		return chunks;
+	}
+
+	void text_parse_values(text_chunks const& chunks, float* values)
+	{
+		parse_values(chunks, values);
+	}
+	void text_parse_values(text_chunks const& chunks, int* values)
+	{
+		parse_values(chunks, values);
+	}
+
+	size_t text_count_values(char const* begin, char const* end)
+	{
+		return text_split_values(begin, end).value_count();
+	}
+
+	void text_parse_values(char const* begin, char const* end, float* values, size_t N)
+	{
+		parse_values(begin, end, values, N);
+	}
+	void text_parse_values(char const* begin, char const* end, int* values, size_t N)
+	{
+		parse_values(begin, end, values, N);
+	}
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/array/array.hpp"
+#include "cgp/core/containers/grid/grid.hpp"
+#include "cgp/core/containers/matrix_stack/matrix_stack.hpp"
+#include "../file_mapping/file_mapping.hpp"
+
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+// Bulk reading of large arrays of numbers (recorded trajectories, field data, etc.)
+//  - Text files: values separated by spaces, tabulations, new lines, commas or semicolons ('#' starts a comment until the end of the line).
+//    The file is mapped in memory and parsed in parallel chunks directly in the storage of the array (no intermediate stream or buffer).
+//  - Binary files: raw copy of the values, without any parsing (use file_mapping directly to access the values in place without copy).
+// The elements T can be float, int, or fixed size vectors/matrices of them (vec3, int3, mat3, etc), filled coordinate by coordinate.
+// If the array is not empty, the file must contain exactly its number of values, which are written in place. Otherwise the array is resized to the content of the file.
+// grid_3D must always be allocated with their dimension, the values are read in the order of their internal buffer.
+
+namespace cgp
+{
+	template <typename T> void read_from_file_text_bulk(std::string const& filename, numarray<T>& data);
+	template <typename T> void read_from_file_text_bulk(std::string const& filename, grid_3D<T>& data);
+
+	template <typename T> void read_from_file_binary_bulk(std::string const& filename, numarray<T>& data);
+	template <typename T> void read_from_file_binary_bulk(std::string const& filename, grid_3D<T>& data);
+
+	/** Save the raw values of the array (can be read with read_from_file_binary_bulk) */
+	template <typename T> void write_to_file_binary(std::string const& filename, numarray<T> const& data);
+	template <typename T> void write_to_file_binary(std::string const& filename, grid_3D<T> const& data);
+
+	/** Text buffer split in chunks parsed in parallel, with the number of values before each chunk */
+	struct text_chunks
+	{
+		std::vector<char const*> bounds; // chunk k is [bounds[k], bounds[k+1])
+		std::vector<size_t> offset;      // index of the first value of each chunk, offset.back() is the total number of values
+
+		size_t value_count() const;
+	};
+
+	/** Split the buffer [begin, end) in chunks and count their values (in parallel)
+	* The result gives the total number of values, and is reused to parse them without counting them again */
+	text_chunks text_split_values(char const* begin, char const* end);
+	/** Parse the values of the chunks in values[0 ... chunks.value_count()-1] (an error is raised if the buffer contains an invalid value) */
+	void text_parse_values(text_chunks const& chunks, float* values);
+	void text_parse_values(text_chunks const& chunks, int* values);
+
+	/** Number of values stored as text in the buffer [begin, end) */
+	size_t text_count_values(char const* begin, char const* end);
+	/** Parse exactly N values stored as text in the buffer [begin, end) (an error is raised if the buffer contains invalid or a different number of values) */
+	void text_parse_values(char const* begin, char const* end, float* values, size_t N);
+	void text_parse_values(char const* begin, char const* end, int* values, size_t N);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	namespace detail
+	{
+		// Scalar type of the coordinates of an element (float for vec3, mat3, etc)
+		template <typename T> struct bulk_scalar { using type = T; };
+		template <typename T, int N> struct bulk_scalar<numarray_stack<T, N> > { using type = typename bulk_scalar<T>::type; };
+		template <typename T, int N1, int N2> struct bulk_scalar<matrix_stack<T, N1, N2> > { using type = typename bulk_scalar<T>::type; };
+
+		template <typename T>
+		void read_text_bulk(std::string const& filename, T* data, size_t N_element, bool resize_allowed, numarray<T>* resized)
+		{
+			using S = typename bulk_scalar<T>::type;
+			static_assert(sizeof(T) % sizeof(S) == 0, "Elements must be stored as contiguous scalars");
+			size_t const dim = sizeof(T) / sizeof(S);
+
+			file_mapping const file(filename);
+			text_chunks const chunks = text_split_values(file.begin(), file.end());
+			size_t const N_value = chunks.value_count();
+
+			if (resize_allowed && N_element == 0) {
+				assert_cgp(N_value % dim == 0, "File " + filename + " contains " + str(N_value) + " values, which is not a multiple of the " + str(dim) + " coordinates of the elements");
+				N_element = N_value / dim;
+				resized->resize(N_element);
+				data = resized->data.data();
+			}
+			assert_cgp(N_value == N_element * dim, "File " + filename + " contains " + str(N_value) + " values while " + str(N_element * dim) + " values are expected (" + str(N_element) + " elements of " + str(dim) + " coordinates)");
+			text_parse_values(chunks, reinterpret_cast<S*>(data));
+		}
+
+		template <typename T>
+		void read_binary_bulk(std::string const& filename, T* data, size_t N_element, bool resize_allowed, numarray<T>* resized)
+		{
+			file_mapping const file(filename);
+			assert_cgp(file.size % sizeof(T) == 0, "Size of file " + filename + " (" + str(file.size) + " octets) is not a multiple of the size of the elements (" + str(sizeof(T)) + " octets)");
+
+			if (resize_allowed && N_element == 0) {
+				N_element = file.size / sizeof(T);
+				resized->resize(N_element);
+				data = resized->data.data();
+			}
+			assert_cgp(file.size == N_element * sizeof(T), "File " + filename + " contains " + str(file.size / sizeof(T)) + " elements while " + str(N_element) + " elements are expected");
+			if (N_element > 0)
+				std::memcpy(data, file.data, file.size);
+		}
+
+		template <typename T>
+		void write_binary(std::string const& filename, T const* data, size_t N_element)
+		{
+			std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+			assert_cgp(stream.is_open(), "Cannot open file " + filename);
+			stream.write(reinterpret_cast<char const*>(data), N_element * sizeof(T));
+			assert_cgp(stream.good(), "Error while writing file " + filename);
+		}
+	}
+
+	template <typename T> void read_from_file_text_bulk(std::string const& filename, numarray<T>& data)
+	{
+		detail::read_text_bulk(filename, data.data.data(), data.size(), true, &data);
+	}
+	template <typename T> void read_from_file_text_bulk(std::string const& filename, grid_3D<T>& data)
+	{
+		assert_cgp(data.size() > 0, "The grid must be allocated before reading file " + filename);
+		detail::read_text_bulk(filename, data.data.data.data(), data.size(), false, static_cast<numarray<T>*>(nullptr));
+	}
+
+	template <typename T> void read_from_file_binary_bulk(std::string const& filename, numarray<T>& data)
+	{
+		detail::read_binary_bulk(filename, data.data.data(), data.size(), true, &data);
+	}
+	template <typename T> void read_from_file_binary_bulk(std::string const& filename, grid_3D<T>& data)
+	{
+		assert_cgp(data.size() > 0, "The grid must be allocated before reading file " + filename);
+		detail::read_binary_bulk(filename, data.data.data.data(), data.size(), false, static_cast<numarray<T>*>(nullptr));
+	}
+
+	template <typename T> void write_to_file_binary(std::string const& filename, numarray<T> const& data)
+	{
+		detail::write_binary(filename, data.data.data(), data.size());
+	}
+	template <typename T> void write_to_file_binary(std::string const& filename, grid_3D<T> const& data)
+	{
+		detail::write_binary(filename, data.data.data.data(), data.size());
+	}
+}
@@ -0,0 +1,80 @@
+#include "test_bulk_read.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "cgp/geometry/vec/vec.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+namespace cgp_test
+{
+	void test_bulk_read()
+	{
+		using namespace cgp;
+		std::string const filename = "test_bulk_read.txt";
+
+		// Text with different separators, comments, and notations
+		{
+			std::ofstream stream(filename);
+			stream << "# x y z\n1 2 3\r\n-4.5,5e-1;6 # comment 7\n\t7.25 8 -9\n\n";
+		}
+		numarray<float> values;
+		read_from_file_text_bulk(filename, values);
+		float const expected[] = { 1, 2, 3, -4.5f, 0.5f, 6, 7.25f, 8, -9 };
+		assert_cgp_no_msg(values.size() == 9);
+		for (int k = 0; k < 9; ++k)
+			assert_cgp_no_msg(values[k] == expected[k]);
+
+		numarray<vec3> positions;
+		read_from_file_text_bulk(filename, positions);
+		assert_cgp_no_msg(positions.size() == 3 && is_equal(positions[1], vec3(-4.5f, 0.5f, 6.0f)));
+
+		// Preallocated grid
+		grid_3D<float> grid(3, 3, 1);
+		read_from_file_text_bulk(filename, grid);
+		assert_cgp_no_msg(grid.data[8] == -9.0f);
+
+		// Large file parsed in several chunks
+		int const N = 300000;
+		{
+			std::ofstream stream(filename);
+			for (int k = 0; k < N; ++k)
+				stream << k << (k % 3 == 2 ? "\n" : " ");
+		}
+		numarray<int3> indices;
+		read_from_file_text_bulk(filename, indices);
+		assert_cgp_no_msg(indices.size() == N / 3);
+		for (int k = 0; k < N / 3; ++k)
+			assert_cgp_no_msg(indices[k][0] == 3 * k && indices[k][2] == 3 * k + 2);
+
+		// The chunks and their counts are computed once, and reused by the parsing
+		{
+			file_mapping const file(filename);
+			text_chunks const chunks = text_split_values(file.begin(), file.end());
+			assert_cgp_no_msg(chunks.bounds.size() > 2 && chunks.offset.size() == chunks.bounds.size());
+			assert_cgp_no_msg(chunks.value_count() == size_t(N) && text_count_values(file.begin(), file.end()) == size_t(N));
+			numarray<int> values(N);
+			text_parse_values(chunks, values.data.data());
+			for (int k = 0; k < N; ++k)
+				assert_cgp_no_msg(values[k] == k);
+		}
+
+		// Binary round trip
+		numarray<vec3> p(1000);
+		for (int k = 0; k < p.size(); ++k)
+			p[k] = { k * 0.5f, -float(k), 1.0f / (k + 1) };
+		write_to_file_binary(filename, p);
+		numarray<vec3> p_read;
+		read_from_file_binary_bulk(filename, p_read);
+		assert_cgp_no_msg(p_read.size() == p.size());
+		for (int k = 0; k < p.size(); ++k)
+			assert_cgp_no_msg(p_read[k].x == p[k].x && p_read[k].y == p[k].y && p_read[k].z == p[k].z);
+
+		grid_3D<vec3> g(10, 10, 10);
+		read_from_file_binary_bulk(filename, g);
+		assert_cgp_no_msg(g.data[999].z == p[999].z);
+
+		std::remove(filename.c_str());
+	}
+}
@@ -0,0 +1,98 @@
+#include "file_mapping.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../files.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CGP_FILE_MAPPING_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cgp
+{
+	file_mapping::file_mapping(std::string const& filename)
+	{
+		open(filename);
+	}
+
+	file_mapping::~file_mapping()
+	{
+		close();
+	}
+
+	file_mapping::file_mapping(file_mapping&& other) noexcept
+		:data(other.data), size(other.size), is_mapped(other.is_mapped), buffer(std::move(other.buffer))
+	{
+		other.data = nullptr;
+		other.size = 0;
+		other.is_mapped = false;
+	}
+
+	file_mapping& file_mapping::operator=(file_mapping&& other) noexcept
+	{
+		if (this != &other) {
+			close();
+			data = other.data;
+			size = other.size;
+			is_mapped = other.is_mapped;
+			buffer = std::move(other.buffer);
+			other.data = nullptr;
+			other.size = 0;
+			other.is_mapped = false;
+		}
+		return *this;
+	}
+
+	void file_mapping::open(std::string const& filename)
+	{
+		close();
+		assert_file_exist(filename);
+
+#ifdef CGP_FILE_MAPPING_MMAP
+		int const fd = ::open(filename.c_str(), O_RDONLY);
+		assert_cgp(fd >= 0, "Cannot open file " + filename);
+
+		struct stat stat_buf;
+		int const rc = fstat(fd, &stat_buf);
+		assert_cgp(rc == 0, "Cannot stat file " + filename);
+
+		size = size_t(stat_buf.st_size);
+		if (size > 0) {
+			void* const p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			assert_cgp(p != MAP_FAILED, "Cannot map file " + filename + " in memory");
+			madvise(p, size, MADV_SEQUENTIAL);
+			data = static_cast<char const*>(p);
+			is_mapped = true;
+		}
+		::close(fd);
+#else
+		std::ifstream stream(filename, std::ios::in | std::ios::binary | std::ios::ate);
+		assert_cgp(stream.is_open(), "Cannot open file " + filename);
+		size = size_t(stream.tellg());
+		buffer.resize(size);
+		stream.seekg(0);
+		if (size > 0)
+			stream.read(buffer.data(), size);
+		data = buffer.data();
+#endif
+	}
+
+	void file_mapping::close()
+	{
+#ifdef CGP_FILE_MAPPING_MMAP
+		if (is_mapped)
+			munmap(const_cast<char*>(data), size);
+#endif
+		is_mapped = false;
+		buffer.clear();
+		buffer.shrink_to_fit();
+		data = nullptr;
+		size = 0;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cgp
+{
+	/** Read-only view on the content of a file mapped in memory
+	*
+	* The content of the file is accessible as a contiguous buffer of bytes [data, data+size) as long as the structure is alive.
+	* Pages are loaded on demand by the system (mmap), which avoids copying large files in memory before parsing them.
+	* On systems without mmap, the content of the file is read in an internal buffer instead.
+	* Note: the buffer is not null-terminated. */
+	struct file_mapping
+	{
+		char const* data = nullptr;
+		size_t size = 0;
+
+		file_mapping() = default;
+		explicit file_mapping(std::string const& filename);
+		~file_mapping();
+
+		file_mapping(file_mapping const&) = delete;
+		file_mapping& operator=(file_mapping const&) = delete;
+		file_mapping(file_mapping&& other) noexcept;
+		file_mapping& operator=(file_mapping&& other) noexcept;
+
+		/** Map the file (an error is raised if the file cannot be accessed) */
+		void open(std::string const& filename);
+		/** Release the mapping (data becomes invalid) */
+		void close();
+
+		char const* begin() const { return data; }
+		char const* end() const { return data + size; }
+
+	private:
+		bool is_mapped = false;      // true if data is mapped with mmap
+		std::vector<char> buffer;    // storage used when mmap is not available
+	};
+}
@@ -4,6 +4,8 @@
 
 #include <fstream>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 #include <sys/stat.h>
 
 namespace cgp
@@ -65,6 +67,76 @@ namespace cgp
     }
 
     
+    int64_t file_get_modification_time(std::string const& filename)
+    {
+        assert_file_exist(filename);
+        struct stat stat_buf;
+        int rc = stat(filename.c_str(), &stat_buf);
+        assert_cgp(rc==0, "Cannot stat file " + filename);
+
+#if defined(__APPLE__)
+        return int64_t(stat_buf.st_mtimespec.tv_sec) * 1000000000 + int64_t(stat_buf.st_mtimespec.tv_nsec);
+#elif defined(__unix__)
+        return int64_t(stat_buf.st_mtim.tv_sec) * 1000000000 + int64_t(stat_buf.st_mtim.tv_nsec);
+#else
+        return int64_t(stat_buf.st_mtime) * 1000000000;
+#endif
+    }
+
+    static uint64_t hash_rotate(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+    static uint64_t hash_mix(uint64_t h, uint64_t w)
+    {
+        w *= 0x87C37B91114253D5ull;
+        w = hash_rotate(w, 31);
+        w *= 0x4CF5AD432745937Full;
+        h ^= w;
+        return hash_rotate(h, 27) * 5 + 0x52DCE729ull;
+    }
+
+    uint64_t hash_buffer(void const* data, size_t size, uint64_t seed)
+    {
+        unsigned char const* p = static_cast<unsigned char const*>(data);
+
+        // 4 independent accumulators processing blocks of 32 octets
+        uint64_t h[4] = { seed, seed ^ 0x9E3779B97F4A7C15ull, seed ^ 0xC2B2AE3D27D4EB4Full, seed ^ 0x165667B19E3779F9ull };
+        size_t const N_block = size / 32;
+        for (size_t k = 0; k < N_block; ++k, p += 32) {
+            uint64_t w[4];
+            std::memcpy(w, p, 32);
+            for (int i = 0; i < 4; ++i)
+                h[i] = hash_mix(h[i], w[i]);
+        }
+
+        uint64_t result = size;
+        for (int i = 0; i < 4; ++i)
+            result = hash_mix(result, h[i]);
+
+        // Remaining octets
+        size_t const remaining = size - 32 * N_block;
+        for (size_t k = 0; k < remaining; k += 8) {
+            uint64_t w = 0;
+            std::memcpy(&w, p + k, std::min<size_t>(8, remaining - k));
+            result = hash_mix(result, w);
+        }
+
+        // Final avalanche
+        result ^= result >> 33;
+        result *= 0xFF51AFD7ED558CCDull;
+        result ^= result >> 33;
+        result *= 0xC4CEB9FE1A85EC53ull;
+        result ^= result >> 33;
+        return result;
+    }
+
+    uint64_t file_hash(std::string const& filename)
+    {
+        file_mapping const file(filename);
+        return hash_buffer(file.data, file.size);
+    }
+
     std::vector <char> read_from_file_binary(std::string const& filename)
     {
         assert_file_exist(filename);
@@ -2,10 +2,17 @@
 
 
 #include "cgp/core/array/array.hpp"
+#include "file_mapping/file_mapping.hpp"
+#include "parse/parse.hpp"
+#include "bulk_read/bulk_read.hpp"
+#include "indexed_frame_file/indexed_frame_file.hpp"
+#include "binary_file/binary_file.hpp"
 
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <cstdint>
+#include <type_traits>
 
 namespace cgp
 {
@@ -19,6 +26,18 @@ namespace cgp
 	/** Return the size in octets of a file*/
 	size_t file_get_size(std::string const& filename);
 
+	/** Return the last modification time of a file in nanoseconds since epoch
+	* The sub-second part is only available on POSIX systems, and is zero elsewhere */
+	int64_t file_get_modification_time(std::string const& filename);
+
+	/** 64-bit hash of a buffer of octets (non-cryptographic, used to detect changes of data) */
+	uint64_t hash_buffer(void const* data, size_t size, uint64_t seed = 0);
+	/** 64-bit hash of a single value (number, or boolean hashed as one octet)
+	* Structures must be hashed field by field with this function, as the content of their padding is undefined */
+	template <typename T> uint64_t hash_value(T const& value, uint64_t seed = 0);
+	/** 64-bit hash of the content of a file */
+	uint64_t file_hash(std::string const& filename);
+
 	/** Read the entire content of a file as binary vector of octets*/
 	std::vector <char> read_from_file_binary(std::string const& filename);
 
@@ -36,6 +55,17 @@ namespace cgp
 
 namespace cgp
 {
+	template <typename T>
+	uint64_t hash_value(T const& value, uint64_t seed)
+	{
+		static_assert(std::is_arithmetic<T>::value, "hash_value only accepts numbers: hash the structures field by field");
+		if (std::is_same<T, bool>::value) {
+			uint8_t const octet = value ? 1 : 0;
+			return hash_buffer(&octet, sizeof(octet), seed);
+		}
+		return hash_buffer(&value, sizeof(T), seed);
+	}
+
 	template <typename T>
 	std::istream& read_from_stream(std::istream& stream, T& data)
 	{
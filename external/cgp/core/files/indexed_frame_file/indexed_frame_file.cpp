@@ -0,0 +1,155 @@
+#include "indexed_frame_file.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace cgp
+{
+	namespace
+	{
+		struct indexed_frame_footer
+		{
+			uint64_t frame_count;
+			uint64_t index_offset; // position of the N_frame+1 frame offsets
+			char magic[8];
+		};
+	}
+
+	indexed_frame_writer::~indexed_frame_writer()
+	{
+		close();
+	}
+
+	void indexed_frame_writer::open(std::string const& filename_arg, std::vector<char> const& header, char const* index_magic, size_t frame_size, indexed_frame_encoder encoder_arg, int queue_capacity)
+	{
+		close();
+		assert_cgp(queue_capacity > 0, "The queue of frames must have a strictly positive capacity (" + str(queue_capacity) + ")");
+
+		filename = filename_arg;
+		std::memcpy(magic, index_magic, sizeof(magic));
+		encoder = std::move(encoder_arg);
+		frame_recorded = 0;
+		last_error.clear();
+		buffers.assign(queue_capacity, std::vector<uint32_t>(frame_size));
+		first = 0;
+		pending = 0;
+		filling = false;
+		closing = false;
+
+		stream.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		assert_cgp(stream.is_open(), "Cannot open file " + filename);
+		stream.write(header.data(), header.size());
+
+		writer = std::thread(&indexed_frame_writer::write_loop, this);
+	}
+
+	std::vector<uint32_t>& indexed_frame_writer::begin_frame()
+	{
+		assert_cgp(is_open(), "The file must be opened before writing frames");
+		assert_cgp(!filling, "begin_frame() called twice without end_frame()");
+		int const capacity = int(buffers.size());
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this, capacity] { return pending < capacity; });
+		filling = true;
+		return buffers[(first + pending) % capacity];
+	}
+
+	void indexed_frame_writer::end_frame()
+	{
+		assert_cgp(filling, "end_frame() called without begin_frame()");
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending++;
+			filling = false;
+		}
+		condition.notify_all();
+		frame_recorded++;
+	}
+
+	void indexed_frame_writer::write_loop()
+	{
+		std::vector<uint64_t> offset;
+		std::vector<char> encoded;
+		uint64_t position = uint64_t(stream.tellp());
+		int const capacity = int(buffers.size());
+
+		while (true)
+		{
+			int slot = 0;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this] { return pending > 0 || closing; });
+				if (pending == 0)
+					break;
+				slot = first;
+			}
+
+			// The buffer stays in the queue while it is encoded: the producer cannot reuse it
+			encoder(offset.size(), buffers[slot], encoded);
+			offset.push_back(position);
+			stream.write(encoded.data(), encoded.size());
+			position += encoded.size();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				first = (first + 1) % capacity;
+				pending--;
+			}
+			condition.notify_all();
+		}
+
+		// Index of the frames (aligned such that the reader can access it in place)
+		offset.push_back(position);
+		char const padding[sizeof(uint64_t)] = {};
+		size_t const padding_size = (sizeof(uint64_t) - position % sizeof(uint64_t)) % sizeof(uint64_t);
+		stream.write(padding, padding_size);
+
+		indexed_frame_footer footer;
+		std::memset(&footer, 0, sizeof(footer));
+		footer.frame_count = offset.size() - 1;
+		footer.index_offset = position + padding_size;
+		std::memcpy(footer.magic, magic, sizeof(magic));
+		stream.write(reinterpret_cast<char const*>(offset.data()), offset.size() * sizeof(uint64_t));
+		stream.write(reinterpret_cast<char const*>(&footer), sizeof(footer));
+	}
+
+	void indexed_frame_writer::close()
+	{
+		if (!is_open())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closing = true;
+		}
+		condition.notify_all();
+		writer.join();
+
+		stream.close();
+		if (stream.fail())
+			last_error = "Error while writing file " + filename;
+		buffers.clear();
+		encoder = nullptr;
+	}
+
+	indexed_frame_index indexed_frame_read_index(file_mapping const& file, char const* index_magic, size_t header_size, std::string const& filename)
+	{
+		assert_cgp(file.size >= header_size + sizeof(indexed_frame_footer), "File " + filename + " is too small");
+
+		indexed_frame_footer footer;
+		std::memcpy(&footer, file.data + file.size - sizeof(footer), sizeof(footer));
+		assert_cgp(std::memcmp(footer.magic, index_magic, sizeof(footer.magic)) == 0, "File " + filename + " has no index (the file has not been closed)");
+		assert_cgp(footer.frame_count < file.size && footer.index_offset % sizeof(uint64_t) == 0 && footer.index_offset >= header_size
+			&& footer.index_offset + (footer.frame_count + 1) * sizeof(uint64_t) + sizeof(footer) == file.size, "File " + filename + " has a corrupted index");
+
+		indexed_frame_index index;
+		index.frame_count = int(footer.frame_count);
+		index.offset = reinterpret_cast<uint64_t const*>(file.data + footer.index_offset);
+		index.index_offset = footer.index_offset;
+		assert_cgp(index.offset[0] >= header_size, "File " + filename + " has a corrupted index");
+		for (int k = 0; k < index.frame_count; ++k)
+			assert_cgp(index.offset[k] <= index.offset[k + 1] && index.offset[k + 1] <= footer.index_offset, "File " + filename + " has a corrupted index");
+		return index;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "cgp/core/files/file_mapping/file_mapping.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <fstream>
+#include <cstdint>
+
+namespace cgp
+{
+	// Files made of a header, a sequence of encoded frames, and an index of the frames
+	//
+	// The layout is: [header] [frame 0] [frame 1] ... [padding to 8 octets] [N_frame+1 offsets (uint64)] [footer: frame_count, index_offset, magic]
+	//  The offsets are the positions of the frames in the file (the last one is the end of the frames), such that a reader can access any frame directly.
+	//  The index is written when the file is closed: a file without index (interrupted writing) is detected by the magic of its footer.
+	//
+	// Frames are arrays of 32 bits words (ex. the bits of float coordinates, or quantized coordinates) of constant size.
+	//  The writer encodes them in a background thread, in the order of the frames, with the encoder given by the format.
+	//  The number of frames waiting to be encoded is bounded: begin_frame() waits for the background thread when the queue is full,
+	//  such that a producer faster than the disk is slowed down instead of accumulating frames in memory.
+	//
+	// Example:
+	//   writer.open(filename, header, "MYFMTIDX", [](size_t index, std::vector<uint32_t> const& frame, std::vector<char>& encoded) { ... });
+	//   while (...) {
+	//     std::vector<uint32_t>& frame = writer.begin_frame();
+	//     ... fill frame ...
+	//     writer.end_frame();
+	//   }
+	//   writer.close();
+
+	/** Encode a frame: replace the content of encoded by the octets to store (called by the background thread) */
+	using indexed_frame_encoder = std::function<void(size_t index, std::vector<uint32_t> const& frame, std::vector<char>& encoded)>;
+
+	struct indexed_frame_writer
+	{
+		indexed_frame_writer() = default;
+		~indexed_frame_writer();
+
+		indexed_frame_writer(indexed_frame_writer const&) = delete;
+		indexed_frame_writer& operator=(indexed_frame_writer const&) = delete;
+
+		/** Create the file, write the header and start the background thread
+		* index_magic: 8 characters identifying the footer of the format. queue_capacity: number of frames that can wait to be encoded. */
+		void open(std::string const& filename, std::vector<char> const& header, char const* index_magic, size_t frame_size, indexed_frame_encoder encoder, int queue_capacity = 8);
+
+		/** Buffer of frame_size words to fill with the next frame (waits if queue_capacity frames are waiting) */
+		std::vector<uint32_t>& begin_frame();
+		/** Give the frame filled after begin_frame() to the background thread */
+		void end_frame();
+
+		/** Wait for all the frames to be written, and write the index at the end of the file
+		* A write error (ex. full disk) doesn't stop the program (close() is also called by the destructor): it is given by error(). */
+		void close();
+
+		bool is_open() const { return writer.joinable(); }
+		int frame_count() const { return frame_recorded; }
+		/** Description of the write error of the last closed file (empty if the file has been written entirely) */
+		std::string const& error() const { return last_error; }
+
+	private:
+		void write_loop();
+
+		std::ofstream stream;
+		std::string filename;
+		char magic[8] = {};
+		indexed_frame_encoder encoder;
+		int frame_recorded = 0;
+		std::string last_error;
+
+		// Ring of queue_capacity buffers: [first, first+pending[ are waiting for the background thread, the others are free
+		std::thread writer;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::vector<std::vector<uint32_t> > buffers;
+		int first = 0;
+		int pending = 0;
+		bool filling = false;
+		bool closing = false;
+	};
+
+	/** Offsets of the frames of a file written by indexed_frame_writer */
+	struct indexed_frame_index
+	{
+		int frame_count = 0;
+		uint64_t const* offset = nullptr; // frame_count+1 offsets in the mapped file
+		uint64_t index_offset = 0;        // position of the offsets (end of the frames and of the padding)
+
+		/** Size of the encoded frame in octets */
+		size_t frame_size(int index) const { return size_t(offset[index + 1] - offset[index]); }
+	};
+
+	/** Check the footer and the index of a mapped file (the offsets must be increasing and between header_size and the index), and return it */
+	indexed_frame_index indexed_frame_read_index(file_mapping const& file, char const* index_magic, size_t header_size, std::string const& filename);
+}
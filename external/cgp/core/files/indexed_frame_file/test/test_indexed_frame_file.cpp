@@ -0,0 +1,74 @@
+#include "test_indexed_frame_file.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+namespace cgp_test
+{
+	void test_indexed_frame_file()
+	{
+		using namespace cgp;
+		std::string const filename = "test_indexed_frame_file.bin";
+		std::vector<char> const header = { 'H','E','A','D' };
+
+		// Frames of variable encoded size, written by a slow encoder: the producer never gets ahead by more than the capacity of the queue
+		{
+			std::atomic<int> encoded_frames(0);
+			auto encoder = [&encoded_frames](size_t index, std::vector<uint32_t> const& frame, std::vector<char>& encoded) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				encoded.assign(index + 1, char(frame[0]));
+				encoded_frames++;
+			};
+
+			indexed_frame_writer writer;
+			writer.open(filename, header, "TESTIDX0", 2, encoder, 2);
+			int max_ahead = 0;
+			for (int k = 0; k < 10; ++k) {
+				std::vector<uint32_t>& frame = writer.begin_frame();
+				assert_cgp_no_msg(frame.size() == 2);
+				frame[0] = uint32_t('a' + k);
+				writer.end_frame();
+				max_ahead = std::max(max_ahead, writer.frame_count() - encoded_frames);
+			}
+			writer.close();
+			assert_cgp_no_msg(writer.frame_count() == 10 && encoded_frames == 10 && max_ahead <= 3);
+			assert_cgp_no_msg(writer.error().empty());
+		}
+
+		{
+			file_mapping const file(filename);
+			indexed_frame_index const index = indexed_frame_read_index(file, "TESTIDX0", header.size(), filename);
+			assert_cgp_no_msg(index.frame_count == 10 && index.offset[0] == header.size() && std::memcmp(file.data, "HEAD", 4) == 0);
+			for (int k = 0; k < 10; ++k)
+				assert_cgp_no_msg(index.frame_size(k) == size_t(k + 1) && file.data[index.offset[k]] == char('a' + k));
+		}
+
+		std::remove(filename.c_str());
+
+#ifdef __linux__
+		// A write error (full disk) is reported by error() instead of stopping the program, including when the writer is destroyed
+		{
+			auto encoder = [](size_t, std::vector<uint32_t> const& frame, std::vector<char>& encoded) { encoded.assign(4096, char(frame[0])); };
+			indexed_frame_writer writer;
+			writer.open("/dev/full", header, "TESTIDX0", 1, encoder);
+			for (int k = 0; k < 4; ++k) {
+				writer.begin_frame()[0] = uint32_t(k);
+				writer.end_frame();
+			}
+			writer.close();
+			assert_cgp_no_msg(!writer.error().empty());
+
+			indexed_frame_writer destroyed;
+			destroyed.open("/dev/full", header, "TESTIDX0", 1, encoder);
+			destroyed.begin_frame()[0] = 0;
+			destroyed.end_frame();
+		}
+#endif
+	}
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+// Fast parsing of numbers stored as text in a raw buffer of characters [p, end) (ex. memory-mapped file)
+//  - The functions don't allocate, don't depend on the locale, and never read after end (the buffer doesn't need to be null-terminated)
+//  - On success, p is moved after the parsed value and true is returned. On failure, p is unchanged and false is returned.
+
+namespace cgp
+{
+	/** Move p to the first character that is not a space or a tabulation (new lines are not skipped) */
+	char const* parse_skip_spaces(char const* p, char const* end);
+	/** Move p to the first space, tabulation, or new line character */
+	char const* parse_skip_word(char const* p, char const* end);
+	/** Pointer to the next '\n' character, or end */
+	char const* parse_line_end(char const* p, char const* end);
+
+	/** Parse an integer with optional sign (fails if the value doesn't fit in an int) */
+	bool parse_int(char const*& p, char const* end, int& value);
+
+	/** Parse a floating point value (decimal or scientific notation, inf, nan)
+	* Common values (up to 15 significant digits, moderate exponent) are converted exactly in double precision,
+	*  other values are converted with strtod. */
+	bool parse_double(char const*& p, char const* end, double& value);
+	/** Same as parse_double, rounded to float */
+	bool parse_float(char const*& p, char const* end, float& value);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	inline char const* parse_skip_spaces(char const* p, char const* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+			++p;
+		return p;
+	}
+
+	inline char const* parse_skip_word(char const* p, char const* end)
+	{
+		while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+			++p;
+		return p;
+	}
+
+	inline char const* parse_line_end(char const* p, char const* end)
+	{
+		char const* const q = static_cast<char const*>(std::memchr(p, '\n', size_t(end - p)));
+		return q != nullptr ? q : end;
+	}
+
+	inline bool parse_int(char const*& p, char const* end, int& value)
+	{
+		char const* s = p;
+		bool negative = false;
+		if (s < end && (*s == '-' || *s == '+')) {
+			negative = (*s == '-');
+			++s;
+		}
+		if (s == end || *s < '0' || *s > '9')
+			return false;
+
+		// Accumulate in 64 bits, and fail as soon as the magnitude exceeds the range of int
+		int64_t const limit = negative ? -int64_t(INT32_MIN) : int64_t(INT32_MAX);
+		int64_t v = 0;
+		while (s < end && *s >= '0' && *s <= '9') {
+			v = 10 * v + (*s - '0');
+			if (v > limit)
+				return false;
+			++s;
+		}
+		value = int(negative ? -v : v);
+		p = s;
+		return true;
+	}
+
+	inline bool parse_double(char const*& p, char const* end, double& value)
+	{
+		// Exact powers of 10 in double precision
+		static double const power_10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		char const* s = p;
+		bool negative = false;
+		if (s < end && (*s == '-' || *s == '+')) {
+			negative = (*s == '-');
+			++s;
+		}
+
+		uint64_t mantissa = 0;
+		int significant_digits = 0; // digits stored in the mantissa (without leading zeros)
+		int exponent = 0;
+		bool has_digit = false;
+		bool exact = true;
+
+		while (s < end && *s >= '0' && *s <= '9') {
+			has_digit = true;
+			if (significant_digits < 19) {
+				mantissa = 10 * mantissa + uint64_t(*s - '0');
+				if (mantissa > 0) significant_digits++;
+			}
+			else {
+				exponent++;
+				exact = exact && (*s == '0');
+			}
+			++s;
+		}
+		if (s < end && *s == '.') {
+			++s;
+			while (s < end && *s >= '0' && *s <= '9') {
+				has_digit = true;
+				if (significant_digits < 19) {
+					mantissa = 10 * mantissa + uint64_t(*s - '0');
+					exponent--;
+					if (mantissa > 0) significant_digits++;
+				}
+				else
+					exact = exact && (*s == '0');
+				++s;
+			}
+		}
+
+		if (!has_digit) {
+			// Possible inf/nan: use strtod
+			char const* const word_end = parse_skip_word(p, end);
+			char buffer[32];
+			size_t const length = size_t(word_end - p);
+			if (length == 0 || length >= sizeof(buffer))
+				return false;
+			std::memcpy(buffer, p, length);
+			buffer[length] = '\0';
+			char* converted_end = nullptr;
+			double const v = std::strtod(buffer, &converted_end);
+			if (converted_end == buffer)
+				return false;
+			value = v;
+			p += converted_end - buffer;
+			return true;
+		}
+
+		if (s < end && (*s == 'e' || *s == 'E')) {
+			char const* e = s + 1;
+			int exponent_value = 0;
+			if (parse_int(e, end, exponent_value)) {
+				exponent += exponent_value;
+				s = e;
+			}
+		}
+
+		double v = 0.0;
+		if (exact && mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+			v = exponent < 0 ? double(mantissa) / power_10[-exponent] : double(mantissa) * power_10[exponent];
+		else {
+			// Rare cases (very long or large/small values): use strtod
+			char buffer[128];
+			size_t const length = size_t(s - p);
+			if (length >= sizeof(buffer))
+				return false;
+			std::memcpy(buffer, p, length);
+			buffer[length] = '\0';
+			v = std::strtod(buffer, nullptr);
+			negative = false; // the sign is already handled by strtod
+		}
+
+		value = negative ? -v : v;
+		p = s;
+		return true;
+	}
+
+	inline bool parse_float(char const*& p, char const* end, float& value)
+	{
+		double v = 0.0;
+		if (!parse_double(p, end, v))
+			return false;
+		value = float(v);
+		return true;
+	}
+}
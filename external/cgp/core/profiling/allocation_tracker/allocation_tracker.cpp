@@ -0,0 +1,208 @@
+#include "allocation_tracker.hpp"
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define CGP_ALLOCATION_BACKTRACE
+#include <execinfo.h>
+#endif
+
+// Size of an allocated block, to subtract the freed blocks from the live octets
+#if defined(__GLIBC__)
+#define CGP_ALLOCATION_BLOCK_SIZE
+#include <malloc.h>
+#elif defined(__APPLE__)
+#define CGP_ALLOCATION_BLOCK_SIZE
+#include <malloc/malloc.h>
+#elif defined(_WIN32)
+#define CGP_ALLOCATION_BLOCK_SIZE
+#include <malloc.h>
+#endif
+
+namespace cgp
+{
+	namespace
+	{
+		std::atomic<int64_t> process_allocations(0);
+		std::atomic<int64_t> process_deallocations(0);
+		std::atomic<int64_t> process_bytes(0);
+		std::atomic<bool> guard_enabled(false);
+
+		// Plain thread local values: no construction, usable in the operators new/delete of any thread
+		thread_local int64_t thread_allocations = 0;
+		thread_local int64_t thread_deallocations = 0;
+		thread_local int64_t thread_bytes = 0;
+		thread_local int64_t thread_live_bytes = 0;
+		thread_local int64_t thread_peak_bytes = 0;
+		thread_local char const* forbidden_scope = nullptr;
+
+		int64_t block_size(void* p)
+		{
+#if defined(__GLIBC__)
+			return int64_t(malloc_usable_size(p));
+#elif defined(__APPLE__)
+			return int64_t(malloc_size(p));
+#elif defined(_WIN32)
+			return int64_t(_msize(p));
+#else
+			(void)p;
+			return 0;
+#endif
+		}
+
+		[[noreturn]] void forbidden_allocation(std::size_t size)
+		{
+			char const* const scope = forbidden_scope;
+			forbidden_scope = nullptr; // the report itself may allocate
+
+			std::fprintf(stderr, "\n===========================================\n");
+			std::fprintf(stderr, "ERROR detected !\n\n");
+			std::fprintf(stderr, "Allocation of %zu octets in the scope \"%s\" where allocations are forbidden (allocation_forbidden_scope)\n", size, scope);
+#ifdef CGP_ALLOCATION_BACKTRACE
+			std::fprintf(stderr, "Backtrace:\n");
+			void* frames[64];
+			int const N = backtrace(frames, 64);
+			backtrace_symbols_fd(frames, N, 2);
+#else
+			std::fprintf(stderr, "> Run the program in a debugger to get the call stack of the allocation.\n");
+#endif
+			std::fprintf(stderr, "\n");
+			std::abort();
+		}
+
+		void* counted_allocation(std::size_t size)
+		{
+			if (forbidden_scope != nullptr && guard_enabled.load(std::memory_order_relaxed))
+				forbidden_allocation(size);
+
+			thread_allocations++;
+			thread_bytes += int64_t(size);
+			process_allocations.fetch_add(1, std::memory_order_relaxed);
+			process_bytes.fetch_add(int64_t(size), std::memory_order_relaxed);
+			void* const p = std::malloc(size == 0 ? 1 : size);
+			if (p != nullptr) {
+				thread_live_bytes += block_size(p);
+				thread_peak_bytes = std::max(thread_peak_bytes, thread_live_bytes);
+			}
+			return p;
+		}
+
+		void* allocate(std::size_t size)
+		{
+			for (;;) {
+				void* p = counted_allocation(size);
+				if (p != nullptr)
+					return p;
+				std::new_handler handler = std::get_new_handler();
+				if (handler == nullptr)
+					throw std::bad_alloc();
+				handler();
+			}
+		}
+
+		void deallocate(void* p) noexcept
+		{
+			if (p == nullptr)
+				return;
+			thread_deallocations++;
+			thread_live_bytes -= block_size(p);
+			process_deallocations.fetch_add(1, std::memory_order_relaxed);
+			std::free(p);
+		}
+	}
+
+	allocation_counters operator-(allocation_counters const& a, allocation_counters const& b)
+	{
+		allocation_counters d;
+		d.allocations = a.allocations - b.allocations;
+		d.deallocations = a.deallocations - b.deallocations;
+		d.bytes = a.bytes - b.bytes;
+		return d;
+	}
+
+	allocation_counters allocation_count()
+	{
+		allocation_counters c;
+		c.allocations = process_allocations.load(std::memory_order_relaxed);
+		c.deallocations = process_deallocations.load(std::memory_order_relaxed);
+		c.bytes = process_bytes.load(std::memory_order_relaxed);
+		return c;
+	}
+
+	allocation_counters allocation_thread_count()
+	{
+		allocation_counters c;
+		c.allocations = thread_allocations;
+		c.deallocations = thread_deallocations;
+		c.bytes = thread_bytes;
+		return c;
+	}
+
+	int64_t allocation_thread_live_bytes()
+	{
+		return thread_live_bytes;
+	}
+
+	int64_t allocation_thread_peak_bytes()
+	{
+		return thread_peak_bytes;
+	}
+
+	void allocation_thread_reset_peak()
+	{
+		thread_peak_bytes = thread_live_bytes;
+	}
+
+	bool allocation_live_bytes_available()
+	{
+#ifdef CGP_ALLOCATION_BLOCK_SIZE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void allocation_guard_enable(bool enabled)
+	{
+#ifdef CGP_ALLOCATION_BACKTRACE
+		// The first call to backtrace loads the unwinder, which must not happen when the error is reported
+		void* frame[1];
+		backtrace(frame, 1);
+#endif
+		guard_enabled = enabled;
+	}
+
+	bool allocation_guard_enabled()
+	{
+		return guard_enabled;
+	}
+
+	allocation_forbidden_scope::allocation_forbidden_scope(char const* name)
+		:previous(forbidden_scope)
+	{
+		if (name != nullptr)
+			forbidden_scope = name;
+	}
+
+	allocation_forbidden_scope::~allocation_forbidden_scope()
+	{
+		forbidden_scope = previous;
+	}
+}
+
+// Replacement of the global operators (they are used by the whole program as soon as this file is linked)
+void* operator new(std::size_t size) { return cgp::allocate(size); }
+void* operator new[](std::size_t size) { return cgp::allocate(size); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { return cgp::counted_allocation(size); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { return cgp::counted_allocation(size); }
+
+void operator delete(void* p) noexcept { cgp::deallocate(p); }
+void operator delete[](void* p) noexcept { cgp::deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { cgp::deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { cgp::deallocate(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { cgp::deallocate(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { cgp::deallocate(p); }
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cgp
+{
+	// Counting of the heap allocations made by the global operators new and delete
+	//
+	// The global operators new/delete (and their array, sized and nothrow variants) are replaced in allocation_tracker.cpp by versions counting
+	//  the allocations of the process and of each thread before calling malloc/free (two relaxed atomic increments per allocation).
+	// The containers of the library (numarray, std::vector, std::string, etc.) all allocate through operator new. Direct calls to malloc
+	//  (C libraries, OpenGL driver) are not counted.
+	//
+	// Allocations can be forbidden in a scope of a thread, for instance in the steps of a simulation once its buffers are allocated:
+	//   allocation_guard_enable(true);                     // opt-in (the scopes have no effect otherwise)
+	//   {
+	//     allocation_forbidden_scope guard("simulation step");
+	//     simulation_step(sim);                            // an allocation here prints its size, the name of the scope and the backtrace, then aborts
+	//   }
+	// The guard only applies to the thread opening the scope: background threads (such as the checkpoint writer) and the OpenMP workers
+	//  of the parallel loops executed in the scope may allocate without being detected. To check a parallel code, execute it on one thread
+	//  in the scope (batch_measure does so for the simulation steps when allocations are forbidden).
+	// The backtrace is printed on Linux and macOS (link with -rdynamic to get the names of the functions).
+
+	/** Number of allocations, deallocations and allocated octets */
+	struct allocation_counters
+	{
+		int64_t allocations = 0;
+		int64_t deallocations = 0;
+		int64_t bytes = 0;
+	};
+
+	allocation_counters operator-(allocation_counters const& a, allocation_counters const& b);
+
+	/** Allocations of all the threads since the start of the program */
+	allocation_counters allocation_count();
+	/** Allocations of the current thread since its start */
+	allocation_counters allocation_thread_count();
+
+	/** Octets of the blocks allocated and not yet freed by the current thread (usable size of the blocks given by the allocator)
+	* A block freed by another thread than the one allocating it is subtracted from the freeing thread.
+	* Always 0 if the allocator does not give the size of its blocks (see allocation_live_bytes_available()). */
+	int64_t allocation_thread_live_bytes();
+	/** Maximum of allocation_thread_live_bytes() since the start of the thread or the last call to allocation_thread_reset_peak() */
+	int64_t allocation_thread_peak_bytes();
+	void allocation_thread_reset_peak();
+	bool allocation_live_bytes_available();
+
+	/** Enable or disable the abort on the allocations made in an allocation_forbidden_scope (disabled by default) */
+	void allocation_guard_enable(bool enabled);
+	bool allocation_guard_enabled();
+
+	/** Scope of the current thread in which allocations abort the program (if the guard is enabled). Scopes can be nested.
+	* The name must be a string literal (nullptr: the scope does not change the current restriction). */
+	struct allocation_forbidden_scope
+	{
+		explicit allocation_forbidden_scope(char const* name);
+		~allocation_forbidden_scope();
+
+		allocation_forbidden_scope(allocation_forbidden_scope const&) = delete;
+		allocation_forbidden_scope& operator=(allocation_forbidden_scope const&) = delete;
+
+	private:
+		char const* previous;
+	};
+}
@@ -0,0 +1,64 @@
+#include "test_allocation_tracker.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../allocation_tracker.hpp"
+
+#include <vector>
+#include <memory>
+#include <thread>
+
+namespace cgp_test
+{
+	void test_allocation_tracker()
+	{
+		using namespace cgp;
+
+		allocation_counters const process_start = allocation_count();
+		allocation_counters const thread_start = allocation_thread_count();
+		{
+			std::vector<int> v(1000);
+			std::unique_ptr<double[]> p(new double[10]);
+			v[0] = int(p[0] = 1);
+		}
+		allocation_counters const thread_allocated = allocation_thread_count() - thread_start;
+		assert_cgp_no_msg(thread_allocated.allocations == 2 && thread_allocated.deallocations == 2);
+		assert_cgp_no_msg(thread_allocated.bytes == int64_t(1000 * sizeof(int) + 10 * sizeof(double)));
+		assert_cgp_no_msg((allocation_count() - process_start).allocations >= 2);
+
+		// The allocations of another thread are only counted for the process
+		int64_t other_thread_allocations = 0;
+		std::thread t([&other_thread_allocations]() {
+			allocation_counters const start = allocation_thread_count();
+			std::vector<char> v(64);
+			other_thread_allocations = (allocation_thread_count() - start).allocations;
+		});
+		t.join();
+		assert_cgp_no_msg(other_thread_allocations == 1);
+		allocation_counters const process_before = allocation_count();
+		std::thread([]() { std::vector<char> v(64); }).join();
+		assert_cgp_no_msg((allocation_count() - process_before).allocations >= 1);
+
+		// Live octets of the thread: the peak stays after the blocks are freed
+		if (allocation_live_bytes_available()) {
+			allocation_thread_reset_peak();
+			int64_t const live_start = allocation_thread_live_bytes();
+			{
+				std::vector<char> v(1000000);
+				v[0] = 1;
+				assert_cgp_no_msg(allocation_thread_live_bytes() - live_start >= 1000000);
+			}
+			assert_cgp_no_msg(allocation_thread_live_bytes() == live_start);
+			assert_cgp_no_msg(allocation_thread_peak_bytes() - live_start >= 1000000);
+			allocation_thread_reset_peak();
+			assert_cgp_no_msg(allocation_thread_peak_bytes() == live_start);
+		}
+
+		// Without the guard, a forbidden scope only marks the thread
+		assert_cgp_no_msg(!allocation_guard_enabled());
+		{
+			allocation_forbidden_scope guard("test");
+			std::vector<int> v(10);
+			v[0] = 1;
+		}
+	}
+}
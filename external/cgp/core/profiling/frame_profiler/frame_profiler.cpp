@@ -0,0 +1,255 @@
+#include "frame_profiler.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+namespace cgp
+{
+	namespace
+	{
+		double seconds_between(std::chrono::steady_clock::time_point const& t0, std::chrono::steady_clock::time_point const& t1)
+		{
+			return std::chrono::duration<double>(t1 - t0).count();
+		}
+	}
+
+	frame_profiler::frame_profiler(int hitch_capacity)
+		:hitch_ring(std::max(hitch_capacity, 0))
+	{
+		clear();
+	}
+
+	void frame_profiler::clear()
+	{
+		for (int k = 0; k < N_phase; ++k)
+			phases[k].clear();
+		N_phase = 0;
+		frames = 0;
+		last_frame_allocation = allocation_counters();
+		N_hitch = 0;
+	}
+
+	int frame_profiler::phase_index(char const* name)
+	{
+		for (int k = 0; k < N_phase; ++k)
+			if (phase_names[k] == name || std::strcmp(phase_names[k], name) == 0)
+				return k;
+		assert_cgp(N_phase < max_phases, "Too many phases in the frame profiler (at most " + str(int(max_phases)) + "), cannot add " + std::string(name));
+		phases[N_phase].clear();
+		phase_names[N_phase] = name;
+		allocations[N_phase] = 0;
+		allocated_bytes[N_phase] = 0;
+		phase_counter[N_phase] = perf_counter_values();
+		return N_phase++;
+	}
+
+	void frame_profiler::add(int phase, double seconds, allocation_counters const& allocated, perf_counter_values const& counted)
+	{
+		phases[phase].add(seconds);
+		allocations[phase] += allocated.allocations;
+		allocated_bytes[phase] += allocated.bytes;
+		phase_counter[phase] = phase_counter[phase] + counted;
+	}
+
+	perf_counter_values frame_profiler::read_counters() const
+	{
+		return counters != nullptr ? counters->read() : perf_counter_values();
+	}
+
+	bool frame_profiler::enable_hardware_counters(bool enabled)
+	{
+		if (!enabled) {
+			counters.reset();
+			return true;
+		}
+		if (counters == nullptr)
+			counters.reset(new perf_counters());
+
+		// The frame and the zones in progress start now
+		perf_counter_values const now = counters->read();
+		frame_counter_start = now;
+		for (int k = 0; k < depth; ++k)
+			zone_counter_start[k] = now;
+		return counters->available();
+	}
+
+	int frame_profiler::find_phase(std::string const& name) const
+	{
+		for (int k = 0; k < N_phase; ++k)
+			if (name == phase_names[k])
+				return k;
+		return -1;
+	}
+
+	void frame_profiler::begin_frame()
+	{
+		in_frame = true;
+		N_frame_zone = 0;
+		frame_truncated = false;
+		// Zones still open from the previous frame are not part of this one
+		for (int k = 0; k < depth; ++k)
+			zone_entry[k] = -1;
+		frame_allocation_start = allocation_thread_count();
+		frame_counter_start = read_counters();
+		frame_start = clock::now();
+	}
+
+	void frame_profiler::end_frame()
+	{
+		assert_cgp(in_frame, "end_frame() called without begin_frame()");
+		double const duration = seconds_between(frame_start, clock::now());
+		perf_counter_values const counted = read_counters() - frame_counter_start;
+		last_frame_allocation = allocation_thread_count() - frame_allocation_start;
+		add(phase_index(frame_name), duration, last_frame_allocation, counted);
+
+		if (budget > 0 && duration > budget) {
+			if (!hitch_ring.empty()) {
+				frame_hitch& h = hitch_ring[N_hitch % int64_t(hitch_ring.size())];
+				h.frame = frames;
+				h.duration = duration;
+				h.allocations = last_frame_allocation.allocations;
+				h.zone_count = std::min(N_frame_zone, int(frame_hitch::max_zones));
+				std::copy(frame_zones, frame_zones + h.zone_count, h.zones);
+				h.truncated = frame_truncated || N_frame_zone > frame_hitch::max_zones;
+			}
+			N_hitch++;
+		}
+
+		frames++;
+		in_frame = false;
+	}
+
+	void frame_profiler::begin_zone(char const* name)
+	{
+		assert_cgp(depth < max_depth, "Too many nested zones in the frame profiler (at most " + str(int(max_depth)) + ")");
+		zone_name[depth] = name;
+		zone_entry[depth] = -1;
+		if (in_frame) {
+			if (N_frame_zone < max_frame_zones) {
+				frame_zones[N_frame_zone] = { name, depth, -1.0, 0 };
+				zone_entry[depth] = N_frame_zone++;
+			}
+			else
+				frame_truncated = true;
+		}
+		zone_allocation_start[depth] = allocation_thread_count();
+		zone_counter_start[depth] = read_counters();
+		zone_start[depth] = clock::now();
+		depth++;
+	}
+
+	void frame_profiler::end_zone()
+	{
+		clock::time_point const now = clock::now();
+		assert_cgp(depth > 0, "end_zone() called without begin_zone()");
+		depth--;
+		double const duration = seconds_between(zone_start[depth], now);
+		perf_counter_values const counted = read_counters() - zone_counter_start[depth];
+		allocation_counters const allocated = allocation_thread_count() - zone_allocation_start[depth];
+		add(phase_index(zone_name[depth]), duration, allocated, counted);
+		if (zone_entry[depth] >= 0) {
+			frame_zones[zone_entry[depth]].duration = duration;
+			frame_zones[zone_entry[depth]].allocations = allocated.allocations;
+		}
+	}
+
+	void frame_profiler::record(char const* name, double seconds, int zone_depth)
+	{
+		add(phase_index(name), seconds, allocation_counters(), perf_counter_values());
+		if (!in_frame)
+			return;
+		if (N_frame_zone < max_frame_zones)
+			frame_zones[N_frame_zone++] = { name, depth + zone_depth, seconds, 0 };
+		else
+			frame_truncated = true;
+	}
+
+	std::vector<time_distribution> frame_profiler::distributions() const
+	{
+		std::vector<time_distribution> d;
+		int const frame_phase = find_phase(frame_name);
+		for (int k = 0; k < N_phase; ++k) {
+			time_histogram const& h = phases[k];
+			time_distribution t;
+			t.name = phase_names[k];
+			t.count = h.count();
+			t.mean = h.mean();
+			t.p50 = h.percentile(50);
+			t.p95 = h.percentile(95);
+			t.p99 = h.percentile(99);
+			t.max = h.max();
+			t.allocations = h.count() > 0 ? double(allocations[k]) / h.count() : 0.0;
+			t.allocated_bytes = h.count() > 0 ? double(allocated_bytes[k]) / h.count() : 0.0;
+			perf_counter_values const& c = phase_counter[k];
+			if (h.count() > 0) {
+				t.cycles = double(c.cycles) / h.count();
+				t.instructions = double(c.instructions) / h.count();
+				t.cache_misses = double(c.cache_misses) / h.count();
+				t.branch_misses = double(c.branch_misses) / h.count();
+			}
+			t.ipc = c.ipc();
+			if (k == frame_phase)
+				d.insert(d.begin(), t);
+			else
+				d.push_back(t);
+		}
+		return d;
+	}
+
+	std::vector<frame_hitch> frame_profiler::hitches() const
+	{
+		int64_t const capacity = int64_t(hitch_ring.size());
+		int64_t const N = std::min(N_hitch, capacity);
+		std::vector<frame_hitch> h;
+		for (int64_t k = N_hitch - N; k < N_hitch; ++k)
+			h.push_back(hitch_ring[k % capacity]);
+		return h;
+	}
+
+	std::string frame_profiler::report() const
+	{
+		std::string s;
+		char line[256];
+		for (time_distribution const& d : distributions()) {
+			std::snprintf(line, sizeof(line), "%-16s n=%-8lld mean %8.3f  p50 %8.3f  p95 %8.3f  p99 %8.3f  max %8.3f ms  %8.1f allocations\n",
+				d.name.c_str(), (long long)d.count, 1000 * d.mean, 1000 * d.p50, 1000 * d.p95, 1000 * d.p99, 1000 * d.max, d.allocations);
+			s += line;
+			if (counters != nullptr && counters->available()) {
+				std::snprintf(line, sizeof(line), "%-16s ipc %.2f, %.0f cache misses, %.0f branch misses per occurrence\n", "", d.ipc, d.cache_misses, d.branch_misses);
+				s += line;
+			}
+		}
+		if (budget > 0) {
+			std::snprintf(line, sizeof(line), "%lld frames above the budget of %.3f ms\n", (long long)N_hitch, 1000 * budget);
+			s += line;
+			for (frame_hitch const& h : hitches()) {
+				std::snprintf(line, sizeof(line), "  frame %lld: %.3f ms, %lld allocations", (long long)h.frame, 1000 * h.duration, (long long)h.allocations);
+				s += line;
+				for (int k = 0; k < h.zone_count; ++k) {
+					frame_zone_time const& z = h.zones[k];
+					if (z.duration < 0)
+						std::snprintf(line, sizeof(line), " | %s (active)", z.name);
+					else
+						std::snprintf(line, sizeof(line), " | %s %.3f", z.name, 1000 * z.duration);
+					s += line;
+				}
+				s += h.truncated ? " | ...\n" : "\n";
+			}
+		}
+		return s;
+	}
+
+	frame_profiler_zone::frame_profiler_zone(frame_profiler& profiler_arg, char const* name)
+		:profiler(profiler_arg)
+	{
+		profiler.begin_zone(name);
+	}
+
+	frame_profiler_zone::~frame_profiler_zone()
+	{
+		profiler.end_zone();
+	}
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "../time_histogram/time_histogram.hpp"
+#include "../allocation_tracker/allocation_tracker.hpp"
+#include "../perf_counters/perf_counters.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+namespace cgp
+{
+	// Distribution of the duration of the frames (or simulation steps) and of the zones executed in each frame
+	//
+	// The duration of each frame, and of each named zone, is added to a time_histogram of its name (a phase).
+	// A frame lasting more than the budget is a hitch: it is stored with the list of the zones executed during the frame.
+	// The heap allocations made by the thread of the profiler during each frame and each zone are also counted (see allocation_tracker),
+	//  as well as the hardware counters of the thread when they are enabled (see perf_counters).
+	// The memory is fixed after the construction (no allocation in begin/end_frame and begin/end_zone), such that the profiler
+	//  can be used in every frame without disturbing the measures. Names of zones must be string literals (stored by pointer).
+	// A profiler is used by a single thread.
+	//
+	// Example:
+	//   frame_profiler profiler;
+	//   profiler.budget = 1/30.0;
+	//   while(...) {
+	//     profiler.begin_frame();
+	//     { frame_profiler_zone zone(profiler, "physics"); ... }
+	//     { frame_profiler_zone zone(profiler, "display"); ... }
+	//     profiler.end_frame();
+	//   }
+	//   std::cout << profiler.report() << std::endl;
+
+	/** Duration of a zone in a frame */
+	struct frame_zone_time
+	{
+		char const* name = nullptr;
+		int depth = 0;          // 0 for a zone directly in the frame, 1 for a zone inside it, etc.
+		double duration = 0.0;  // seconds (-1 if the zone was not finished at the end of the frame)
+		int64_t allocations = 0; // heap allocations during the zone (0 for durations given to record())
+	};
+
+	/** Frame above the budget */
+	struct frame_hitch
+	{
+		static constexpr int max_zones = 16;
+
+		int64_t frame = 0;
+		double duration = 0.0;
+		int64_t allocations = 0;
+		int zone_count = 0;
+		frame_zone_time zones[max_zones]; // first zones of the frame (in the order they started)
+		bool truncated = false;           // the frame had more than max_zones zones
+	};
+
+	/** Summary of a phase */
+	struct time_distribution
+	{
+		std::string name;
+		int64_t count = 0;
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+		double allocations = 0.0;     // mean number of heap allocations per occurrence
+		double allocated_bytes = 0.0; // mean number of allocated octets per occurrence
+
+		// Mean per occurrence of the hardware counters (0 if they are not enabled or not available)
+		double cycles = 0.0;
+		double instructions = 0.0;
+		double cache_misses = 0.0;
+		double branch_misses = 0.0;
+		double ipc = 0.0;             // instructions per cycle
+	};
+
+	struct frame_profiler
+	{
+		static constexpr int max_phases = 32;
+		static constexpr int max_depth = 16;
+		static constexpr int max_frame_zones = 64;
+
+		double budget = 0.0;                // seconds; frames above are stored as hitches (0: no detection)
+		char const* frame_name = "frame";  // name of the phase of the frames
+
+		explicit frame_profiler(int hitch_capacity = 32);
+
+		void begin_frame();
+		void end_frame();
+
+		/** Zones can be nested, and can be used outside of a frame (they are then only added to their phase) */
+		void begin_zone(char const* name);
+		void end_zone();
+		/** Add a duration measured elsewhere as a zone of the current frame (ex. time of a phase reported by a solver) */
+		void record(char const* name, double seconds, int depth = 0);
+
+		/** Remove the measures. The frame and the zones in progress are kept: they are added to the new measures when they end
+		* (clear() can be called from inside a zone, ex. by a button of the GUI). */
+		void clear();
+
+		/** Measure the hardware counters of the thread calling this function (which must be the thread of the profiler).
+		* Returns false if the counters are not available (see hardware_counters()->error()). */
+		bool enable_hardware_counters(bool enabled);
+		/** Counters of the profiler (nullptr if they are not enabled) */
+		perf_counters const* hardware_counters() const { return counters.get(); }
+
+		int64_t frame_count() const { return frames; }
+		int phase_count() const { return N_phase; }
+		char const* phase_name(int phase) const { return phase_names[phase]; }
+		time_histogram const& phase(int phase) const { return phases[phase]; }
+		/** Index of the phase with the given name, or -1 */
+		int find_phase(std::string const& name) const;
+		/** Total number of heap allocations and of allocated octets of a phase */
+		int64_t phase_allocations(int phase) const { return allocations[phase]; }
+		int64_t phase_allocated_bytes(int phase) const { return allocated_bytes[phase]; }
+		/** Total of the hardware counters of a phase */
+		perf_counter_values const& phase_counters(int phase) const { return phase_counter[phase]; }
+		/** Allocations of the last finished frame */
+		allocation_counters last_frame_allocations() const { return last_frame_allocation; }
+
+		/** p50, p95, p99 and max of each phase (the frames first) */
+		std::vector<time_distribution> distributions() const;
+
+		/** Last hitches (at most hitch_capacity, the oldest first), and total number of hitches */
+		std::vector<frame_hitch> hitches() const;
+		int64_t hitch_count() const { return N_hitch; }
+
+		/** Readable summary (times in milliseconds) */
+		std::string report() const;
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		int phase_index(char const* name);
+		void add(int phase, double seconds, allocation_counters const& allocated, perf_counter_values const& counted);
+		perf_counter_values read_counters() const;
+
+		time_histogram phases[max_phases];
+		char const* phase_names[max_phases];
+		int64_t allocations[max_phases];
+		int64_t allocated_bytes[max_phases];
+		perf_counter_values phase_counter[max_phases];
+		int N_phase = 0;
+
+		// Current frame
+		clock::time_point frame_start;
+		allocation_counters frame_allocation_start;
+		allocation_counters last_frame_allocation;
+		perf_counter_values frame_counter_start;
+		bool in_frame = false;
+		int64_t frames = 0;
+		frame_zone_time frame_zones[max_frame_zones];
+		int N_frame_zone = 0;
+		bool frame_truncated = false;
+
+		// Stack of the open zones: start time and entry in frame_zones (-1 if not stored)
+		clock::time_point zone_start[max_depth];
+		allocation_counters zone_allocation_start[max_depth];
+		perf_counter_values zone_counter_start[max_depth];
+		char const* zone_name[max_depth];
+		int zone_entry[max_depth];
+		int depth = 0;
+
+		std::vector<frame_hitch> hitch_ring;
+		int64_t N_hitch = 0;
+
+		std::unique_ptr<perf_counters> counters;
+	};
+
+	/** Zone of the scope where it is declared */
+	struct frame_profiler_zone
+	{
+		frame_profiler_zone(frame_profiler& profiler, char const* name);
+		~frame_profiler_zone();
+
+		frame_profiler_zone(frame_profiler_zone const&) = delete;
+		frame_profiler_zone& operator=(frame_profiler_zone const&) = delete;
+
+	private:
+		frame_profiler& profiler;
+	};
+}
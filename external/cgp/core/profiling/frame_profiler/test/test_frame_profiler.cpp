@@ -0,0 +1,96 @@
+#include "test_frame_profiler.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../frame_profiler.hpp"
+
+#include <thread>
+#include <chrono>
+
+namespace cgp_test
+{
+	void test_frame_profiler()
+	{
+		using namespace cgp;
+
+		frame_profiler profiler(2);
+		profiler.budget = 0.02;
+
+		// Frame 1 is above the budget, in the zone "slow" (inside "physics")
+		for (int frame = 0; frame < 3; ++frame) {
+			profiler.begin_frame();
+			{
+				frame_profiler_zone physics(profiler, "physics");
+				profiler.record("solve", 0.001);
+				if (frame == 1) {
+					frame_profiler_zone slow(profiler, "slow");
+					std::this_thread::sleep_for(std::chrono::milliseconds(30));
+				}
+			}
+			{
+				frame_profiler_zone display(profiler, "display");
+			}
+			profiler.end_frame();
+		}
+
+		assert_cgp_no_msg(profiler.frame_count() == 3 && profiler.hitch_count() == 1);
+		assert_cgp_no_msg(profiler.phase_count() == 5 && profiler.find_phase("physics") >= 0 && profiler.find_phase("unknown") == -1);
+		assert_cgp_no_msg(profiler.phase(profiler.find_phase("frame")).count() == 3);
+		assert_cgp_no_msg(profiler.phase(profiler.find_phase("slow")).count() == 1);
+		assert_cgp_no_msg(profiler.phase(profiler.find_phase("solve")).max() == 0.001);
+
+		std::vector<frame_hitch> const hitches = profiler.hitches();
+		assert_cgp_no_msg(hitches.size() == 1 && hitches[0].frame == 1 && hitches[0].duration >= 0.03);
+		frame_hitch const& h = hitches[0];
+		assert_cgp_no_msg(h.zone_count == 4 && !h.truncated);
+		assert_cgp_no_msg(std::string(h.zones[0].name) == "physics" && h.zones[0].depth == 0 && h.zones[0].duration >= 0.03);
+		assert_cgp_no_msg(std::string(h.zones[1].name) == "solve" && h.zones[1].depth == 1);
+		assert_cgp_no_msg(std::string(h.zones[2].name) == "slow" && h.zones[2].depth == 1);
+		assert_cgp_no_msg(std::string(h.zones[3].name) == "display");
+
+		// The frame phase is the first distribution
+		std::vector<time_distribution> const d = profiler.distributions();
+		assert_cgp_no_msg(d.size() == 5 && d[0].name == "frame" && d[0].count == 3 && d[0].max >= 0.03 && d[0].p50 < d[0].max);
+		assert_cgp_no_msg(profiler.report().find("1 frames above the budget") != std::string::npos);
+
+		// A zone still open at the end of a hitch is reported as active
+		profiler.begin_frame();
+		profiler.begin_zone("long");
+		std::this_thread::sleep_for(std::chrono::milliseconds(25));
+		profiler.end_frame();
+		profiler.end_zone();
+		assert_cgp_no_msg(profiler.hitch_count() == 2 && profiler.hitches()[1].zones[0].duration < 0);
+
+		// Only the last hitches are kept
+		profiler.begin_frame();
+		std::this_thread::sleep_for(std::chrono::milliseconds(25));
+		profiler.end_frame();
+		assert_cgp_no_msg(profiler.hitch_count() == 3 && profiler.hitches().size() == 2 && profiler.hitches()[0].frame == 3 && profiler.hitches()[1].frame == 4);
+
+		// Heap allocations of the frames and of the zones (the profiler itself does not allocate once its phases are known)
+		for (int frame = 0; frame < 2; ++frame) {
+			profiler.begin_frame();
+			{
+				frame_profiler_zone zone(profiler, "allocate");
+				std::vector<int> v(10, frame);
+				assert_cgp_no_msg(v[9] == frame);
+			}
+			{
+				frame_profiler_zone zone(profiler, "display");
+			}
+			profiler.end_frame();
+		}
+		assert_cgp_no_msg(profiler.last_frame_allocations().allocations == 1 && profiler.last_frame_allocations().bytes == int64_t(10 * sizeof(int)));
+		assert_cgp_no_msg(profiler.phase_allocations(profiler.find_phase("allocate")) == 2 && profiler.phase_allocations(profiler.find_phase("display")) == 0);
+
+		profiler.clear();
+		assert_cgp_no_msg(profiler.frame_count() == 0 && profiler.phase_count() == 0 && profiler.hitches().empty());
+
+		// Clearing inside a zone of a frame keeps the frame and the zone open
+		profiler.begin_frame();
+		profiler.begin_zone("gui");
+		profiler.clear();
+		profiler.end_zone();
+		profiler.end_frame();
+		assert_cgp_no_msg(profiler.frame_count() == 1 && profiler.phase_count() == 2 && profiler.phase(profiler.find_phase("gui")).count() == 1);
+	}
+}
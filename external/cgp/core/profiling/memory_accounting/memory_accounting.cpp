@@ -0,0 +1,175 @@
+#include "memory_accounting.hpp"
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+
+namespace cgp
+{
+	namespace
+	{
+		struct gpu_object_record
+		{
+			memory_account* account = nullptr;
+			int64_t bytes = 0;
+		};
+
+		struct memory_registry
+		{
+			std::mutex mutex;
+			std::map<std::pair<std::string, std::string>, memory_account> accounts; // nodes are stable: the objects point to their account
+			std::map<std::pair<int, unsigned int>, gpu_object_record> objects;
+			memory_account total;
+		};
+
+		memory_registry& registry()
+		{
+			static memory_registry r;
+			return r;
+		}
+
+		thread_local memory_scope* current_scope = nullptr;
+
+		char const* kind_name(gpu_object_kind kind)
+		{
+			switch (kind) {
+			case gpu_object_kind::buffer: return "buffers";
+			case gpu_object_kind::texture: return "textures";
+			default: return "vertex arrays";
+			}
+		}
+
+		memory_account& find_account(memory_registry& r, std::string const& category, std::string const& name)
+		{
+			memory_account& a = r.accounts[{category, name}];
+			if (a.category.empty()) {
+				a.category = category;
+				a.name = name;
+			}
+			return a;
+		}
+
+		void add_cpu(memory_registry& r, memory_account& a, int64_t bytes)
+		{
+			a.cpu_bytes += bytes;
+			a.cpu_peak = std::max(a.cpu_peak, a.cpu_bytes);
+			r.total.cpu_bytes += bytes;
+			r.total.cpu_peak = std::max(r.total.cpu_peak, r.total.cpu_bytes);
+		}
+
+		void add_gpu(memory_registry& r, memory_account& a, int64_t bytes, int objects)
+		{
+			a.gpu_bytes += bytes;
+			a.gpu_objects += objects;
+			a.gpu_peak = std::max(a.gpu_peak, a.gpu_bytes);
+			r.total.gpu_bytes += bytes;
+			r.total.gpu_objects += objects;
+			r.total.gpu_peak = std::max(r.total.gpu_peak, r.total.gpu_bytes);
+		}
+
+		std::string readable_size(int64_t bytes)
+		{
+			char s[32];
+			if (bytes < 1024)
+				std::snprintf(s, sizeof(s), "%lld B", (long long)bytes);
+			else if (bytes < 1024 * 1024)
+				std::snprintf(s, sizeof(s), "%.1f kB", bytes / 1024.0);
+			else
+				std::snprintf(s, sizeof(s), "%.1f MB", bytes / (1024.0 * 1024.0));
+			return s;
+		}
+	}
+
+	void memory_account_set_cpu(std::string const& category, std::string const& name, int64_t bytes)
+	{
+		memory_registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		memory_account& a = find_account(r, category, name);
+		add_cpu(r, a, bytes - a.cpu_bytes);
+	}
+
+	void memory_gpu_create(gpu_object_kind kind, unsigned int id, int64_t bytes)
+	{
+		if (id == 0)
+			return;
+		memory_registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+
+		gpu_object_record& object = r.objects[{int(kind), id}];
+		if (object.account != nullptr)
+			add_gpu(r, *object.account, -object.bytes, -1);
+
+		object.account = current_scope != nullptr ? &find_account(r, current_scope->category, current_scope->name) : &find_account(r, "gpu", kind_name(kind));
+		object.bytes = bytes;
+		add_gpu(r, *object.account, bytes, 1);
+	}
+
+	void memory_gpu_delete(gpu_object_kind kind, unsigned int id)
+	{
+		memory_registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		auto const it = r.objects.find({ int(kind), id });
+		if (it == r.objects.end())
+			return;
+		add_gpu(r, *it->second.account, -it->second.bytes, -1);
+		r.objects.erase(it);
+	}
+
+	std::vector<memory_account> memory_accounts()
+	{
+		memory_registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		std::vector<memory_account> accounts;
+		for (auto const& it : r.accounts)
+			accounts.push_back(it.second);
+		return accounts;
+	}
+
+	memory_account memory_account_total()
+	{
+		memory_registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		memory_account total = r.total;
+		total.category = "total";
+		return total;
+	}
+
+	void memory_accounts_clear()
+	{
+		memory_registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		r.objects.clear();
+		r.accounts.clear();
+		r.total = memory_account();
+	}
+
+	std::string memory_report()
+	{
+		std::vector<memory_account> accounts = memory_accounts();
+		accounts.push_back(memory_account_total());
+
+		std::string s;
+		char line[256];
+		std::snprintf(line, sizeof(line), "%-12s %-20s %12s %12s %12s %12s %8s\n", "category", "name", "CPU", "CPU peak", "GPU", "GPU peak", "objects");
+		s += line;
+		for (memory_account const& a : accounts) {
+			std::snprintf(line, sizeof(line), "%-12s %-20s %12s %12s %12s %12s %8lld\n", a.category.c_str(), a.name.c_str(),
+				readable_size(a.cpu_bytes).c_str(), readable_size(a.cpu_peak).c_str(), readable_size(a.gpu_bytes).c_str(), readable_size(a.gpu_peak).c_str(), (long long)a.gpu_objects);
+			s += line;
+		}
+		return s;
+	}
+
+	memory_scope::memory_scope(std::string const& category_arg, std::string const& name_arg)
+		:category(category_arg), name(name_arg), previous(current_scope)
+	{
+		current_scope = this;
+	}
+
+	memory_scope::~memory_scope()
+	{
+		current_scope = previous;
+	}
+}
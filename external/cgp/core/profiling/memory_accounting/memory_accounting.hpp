@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace cgp
+{
+	// Memory used by the subsystems of the program (CPU arrays and GPU objects), with the high-water mark of each account
+	//
+	// An account is identified by a category (subsystem, ex. "body", "collider", "scene") and a name (element, ex. the name of a body).
+	// - CPU memory is declared by the code owning the arrays, with memory_account_set_cpu (current size of its arrays).
+	// - GPU memory is declared where the OpenGL objects are created and deleted (buffers, textures, vertex arrays). An object is attributed to
+	//   the account of the memory_scope active on the thread creating it, or to the account ("gpu", kind of the object) without scope.
+	//   Objects are identified by their kind and OpenGL id: copies of a structure sharing an object are counted once, and an object that
+	//   is never deleted (a leak) stays in its account, whose number of objects keeps growing.
+	// All the functions are thread safe (they are called at the creation of the data, not in every frame).
+	//
+	// Example:
+	//   {
+	//     memory_scope scope("body", "cloth");
+	//     drawable.initialize_data_on_gpu(shape);          // the buffers and the vertex array are counted in ("body", "cloth")
+	//   }
+	//   memory_account_set_cpu("body", "cloth", shape.memory_size());
+	//   std::cout << memory_report() << std::endl;
+
+	enum class gpu_object_kind { buffer, texture, vertex_array };
+
+	struct memory_account
+	{
+		std::string category;
+		std::string name;
+
+		int64_t cpu_bytes = 0;
+		int64_t cpu_peak = 0;
+		int64_t gpu_bytes = 0;
+		int64_t gpu_peak = 0;
+		int64_t gpu_objects = 0; // number of GPU objects currently allocated
+	};
+
+	/** Set the CPU memory currently used by an account (octets) */
+	void memory_account_set_cpu(std::string const& category, std::string const& name, int64_t bytes);
+
+	/** Creation of a GPU object of the given size (octets), in the account of the current memory_scope.
+	* Creating an object that already exists (same kind and id) replaces its size. */
+	void memory_gpu_create(gpu_object_kind kind, unsigned int id, int64_t bytes);
+	/** Deletion of a GPU object (ignored for unknown objects and id 0) */
+	void memory_gpu_delete(gpu_object_kind kind, unsigned int id);
+
+	/** All the accounts, sorted by category and name */
+	std::vector<memory_account> memory_accounts();
+	/** Sum of all the accounts (the peaks are the high-water marks of the totals) */
+	memory_account memory_account_total();
+	/** Remove all the accounts and objects */
+	void memory_accounts_clear();
+
+	/** Readable table of the accounts */
+	std::string memory_report();
+
+	/** Account of the GPU objects created by the current thread in the scope where it is declared. Scopes can be nested. */
+	struct memory_scope
+	{
+		memory_scope(std::string const& category, std::string const& name);
+		~memory_scope();
+
+		memory_scope(memory_scope const&) = delete;
+		memory_scope& operator=(memory_scope const&) = delete;
+
+	private:
+		std::string category;
+		std::string name;
+		memory_scope* previous;
+
+		friend void memory_gpu_create(gpu_object_kind kind, unsigned int id, int64_t bytes);
+	};
+}
@@ -0,0 +1,56 @@
+#include "test_memory_accounting.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../memory_accounting.hpp"
+
+namespace cgp_test
+{
+	void test_memory_accounting()
+	{
+		using namespace cgp;
+		memory_accounts_clear();
+
+		// CPU memory and its high-water mark
+		memory_account_set_cpu("body", "cloth", 1000);
+		memory_account_set_cpu("body", "cloth", 400);
+		memory_account_set_cpu("body", "ball", 100);
+
+		// GPU objects are attributed to the current scope
+		{
+			memory_scope scope("body", "cloth");
+			memory_gpu_create(gpu_object_kind::buffer, 1, 300);
+			memory_gpu_create(gpu_object_kind::vertex_array, 1, 0);
+			{
+				memory_scope inner("body", "ball");
+				memory_gpu_create(gpu_object_kind::buffer, 2, 50);
+			}
+			memory_gpu_create(gpu_object_kind::texture, 1, 200);
+		}
+		memory_gpu_create(gpu_object_kind::buffer, 3, 10);
+
+		std::vector<memory_account> accounts = memory_accounts();
+		assert_cgp_no_msg(accounts.size() == 3);
+		memory_account const& ball = accounts[0];
+		memory_account const& cloth = accounts[1];
+		assert_cgp_no_msg(ball.name == "ball" && ball.cpu_bytes == 100 && ball.gpu_bytes == 50 && ball.gpu_objects == 1);
+		assert_cgp_no_msg(cloth.name == "cloth" && cloth.cpu_bytes == 400 && cloth.cpu_peak == 1000 && cloth.gpu_bytes == 500 && cloth.gpu_objects == 3);
+		assert_cgp_no_msg(accounts[2].category == "gpu" && accounts[2].name == "buffers" && accounts[2].gpu_bytes == 10);
+
+		// Deletion, once per object (copies sharing an object may delete it twice), and unknown objects are ignored
+		memory_gpu_delete(gpu_object_kind::buffer, 1);
+		memory_gpu_delete(gpu_object_kind::buffer, 1);
+		memory_gpu_delete(gpu_object_kind::buffer, 42);
+		memory_gpu_delete(gpu_object_kind::texture, 0);
+		accounts = memory_accounts();
+		assert_cgp_no_msg(accounts[1].gpu_bytes == 200 && accounts[1].gpu_peak == 500 && accounts[1].gpu_objects == 2);
+
+		// An object created again (same id) replaces its size
+		memory_gpu_create(gpu_object_kind::texture, 1, 800);
+		memory_account const total = memory_account_total();
+		assert_cgp_no_msg(total.cpu_bytes == 500 && total.cpu_peak == 1000 && total.gpu_bytes == 50 + 800 + 10 && total.gpu_objects == 4);
+		assert_cgp_no_msg(memory_report().find("cloth") != std::string::npos);
+
+		memory_accounts_clear();
+		assert_cgp_no_msg(memory_accounts().empty() && memory_account_total().gpu_bytes == 0);
+	}
+}
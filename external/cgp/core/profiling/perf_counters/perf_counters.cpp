@@ -0,0 +1,117 @@
+#include "perf_counters.hpp"
+
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef __linux__
+#define CGP_PERF_EVENT
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace cgp
+{
+	perf_counter_values operator+(perf_counter_values const& a, perf_counter_values const& b)
+	{
+		perf_counter_values s;
+		s.cycles = a.cycles + b.cycles;
+		s.instructions = a.instructions + b.instructions;
+		s.cache_misses = a.cache_misses + b.cache_misses;
+		s.branch_misses = a.branch_misses + b.branch_misses;
+		return s;
+	}
+
+	perf_counter_values operator-(perf_counter_values const& a, perf_counter_values const& b)
+	{
+		perf_counter_values d;
+		d.cycles = a.cycles - b.cycles;
+		d.instructions = a.instructions - b.instructions;
+		d.cache_misses = a.cache_misses - b.cache_misses;
+		d.branch_misses = a.branch_misses - b.branch_misses;
+		return d;
+	}
+
+#ifdef CGP_PERF_EVENT
+	namespace
+	{
+		// Events in the order of the fields of perf_counter_values
+		uint64_t const events[perf_counters::max_counters] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+		char const* const event_names[perf_counters::max_counters] = { "cycles", "instructions", "cache misses", "branch misses" };
+
+		int open_event(uint64_t event, int group)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = event;
+			attr.disabled = group == -1 ? 1 : 0; // the group is enabled once complete
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			return int(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+		}
+	}
+
+	perf_counters::perf_counters()
+	{
+		for (int k = 0; k < max_counters; ++k) {
+			int const group = N_counter > 0 ? fd[0] : -1;
+			int const f = open_event(events[k], group);
+			if (f < 0) {
+				message += (message.empty() ? "" : ", ") + std::string(event_names[k]) + ": " + std::strerror(errno);
+				continue;
+			}
+			fd[N_counter] = f;
+			counter_index[N_counter] = k;
+			N_counter++;
+		}
+		if (N_counter > 0) {
+			ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+		if (!message.empty())
+			message = "perf_event_open failed (" + message + ")";
+	}
+
+	perf_counters::~perf_counters()
+	{
+		for (int k = 0; k < N_counter; ++k)
+			close(fd[k]);
+	}
+
+	perf_counter_values perf_counters::read() const
+	{
+		perf_counter_values v;
+		if (N_counter == 0)
+			return v;
+
+		// Layout of PERF_FORMAT_GROUP: number of events, time enabled, time running, value of each event
+		uint64_t data[3 + max_counters];
+		if (::read(fd[0], data, sizeof(data)) < ssize_t(3 * sizeof(uint64_t)))
+			return v;
+		int const N = std::min(int(data[0]), N_counter);
+		double const scale = (data[2] > 0 && data[2] < data[1]) ? double(data[1]) / double(data[2]) : 1.0;
+
+		int64_t* const fields[max_counters] = { &v.cycles, &v.instructions, &v.cache_misses, &v.branch_misses };
+		for (int k = 0; k < N; ++k)
+			*fields[counter_index[k]] = int64_t(double(data[3 + k]) * scale);
+		return v;
+	}
+#else
+	perf_counters::perf_counters()
+		:message("Hardware counters are only available on Linux (perf_event_open)")
+	{}
+
+	perf_counters::~perf_counters()
+	{}
+
+	perf_counter_values perf_counters::read() const
+	{
+		return perf_counter_values();
+	}
+#endif
+}
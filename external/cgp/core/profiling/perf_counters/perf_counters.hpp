@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace cgp
+{
+	// Hardware performance counters of a thread (Linux perf_event_open)
+	//
+	// The counters (cycles, instructions, last level cache misses, branch misses) are opened as a group counting the user space
+	//  of the calling thread, and read together in a single system call. Threads created by the thread (ex. OpenMP workers) are not counted.
+	// The counters are not available on other systems, in most virtual machines, or when /proc/sys/kernel/perf_event_paranoid forbids them:
+	//  available() is then false, error() gives the reason, and read() returns zeros. Counters that the processor does not provide are left to 0.
+	// When more counters are used than the processor has registers, the kernel multiplexes them: the values are extrapolated to the total running time.
+	//
+	// The memory traffic is estimated from the cache misses (one cache line per miss); the exact bandwidth requires the uncore counters of the memory controller, which are system-wide.
+	//
+	// Example:
+	//   perf_counters counters;
+	//   perf_counter_values const start = counters.read();
+	//   ... 
+	//   perf_counter_values const d = counters.read() - start;
+	//   std::cout << d.ipc() << " instructions per cycle" << std::endl;
+
+	struct perf_counter_values
+	{
+		static constexpr int cache_line = 64; // octets loaded per cache miss
+
+		int64_t cycles = 0;
+		int64_t instructions = 0;
+		int64_t cache_misses = 0;
+		int64_t branch_misses = 0;
+
+		/** Instructions per cycle (0 without cycles) */
+		double ipc() const { return cycles > 0 ? double(instructions) / double(cycles) : 0.0; }
+		/** Estimate of the octets read from the memory */
+		int64_t memory_bytes() const { return cache_misses * cache_line; }
+	};
+
+	perf_counter_values operator+(perf_counter_values const& a, perf_counter_values const& b);
+	perf_counter_values operator-(perf_counter_values const& a, perf_counter_values const& b);
+
+	struct perf_counters
+	{
+		static constexpr int max_counters = 4;
+
+		/** Open the counters of the calling thread (they count from the construction) */
+		perf_counters();
+		~perf_counters();
+
+		perf_counters(perf_counters const&) = delete;
+		perf_counters& operator=(perf_counters const&) = delete;
+
+		bool available() const { return N_counter > 0; }
+		/** Reason why the counters (or some of them) are not available, empty otherwise */
+		std::string const& error() const { return message; }
+
+		/** Values since the construction (no allocation, a single system call) */
+		perf_counter_values read() const;
+
+	private:
+		int fd[max_counters];
+		int counter_index[max_counters]; // counter (order of perf_counter_values) of each opened event
+		int N_counter = 0;
+		std::string message;
+	};
+}
@@ -0,0 +1,57 @@
+#include "test_perf_counters.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../perf_counters.hpp"
+#include "../../frame_profiler/frame_profiler.hpp"
+
+namespace cgp_test
+{
+	void test_perf_counters()
+	{
+		using namespace cgp;
+
+		perf_counter_values a;
+		a.cycles = 200; a.instructions = 300; a.cache_misses = 2;
+		perf_counter_values const b = (a + a) - a;
+		assert_cgp_no_msg(b.cycles == 200 && b.instructions == 300 && b.ipc() == 1.5 && b.memory_bytes() == 2 * perf_counter_values::cache_line);
+		assert_cgp_no_msg(perf_counter_values().ipc() == 0.0);
+
+		// The counters are either measured, or unavailable with a reason and zero values
+		perf_counters counters;
+		perf_counter_values const start = counters.read();
+		volatile double x = 0.0;
+		for (int k = 0; k < 1000000; ++k)
+			x = x + 1.0;
+		perf_counter_values const d = counters.read() - start;
+		if (counters.available()) {
+			assert_cgp_no_msg(d.cycles >= 0 && d.instructions >= 0 && (d.instructions == 0 || d.instructions > 1000000));
+		}
+		else {
+			assert_cgp_no_msg(!counters.error().empty() && d.cycles == 0 && d.instructions == 0 && d.cache_misses == 0 && d.branch_misses == 0);
+		}
+
+		// Counters of the zones of a profiler
+		frame_profiler profiler;
+		bool const available = profiler.enable_hardware_counters(true);
+		assert_cgp_no_msg(available == counters.available() && profiler.hardware_counters() != nullptr);
+		for (int frame = 0; frame < 3; ++frame) {
+			profiler.begin_frame();
+			{
+				frame_profiler_zone zone(profiler, "compute");
+				for (int k = 0; k < 100000; ++k)
+					x = x + 1.0;
+			}
+			profiler.end_frame();
+		}
+		time_distribution const& compute = profiler.distributions()[1];
+		assert_cgp_no_msg(compute.name == "compute" && compute.count == 3);
+		if (available) {
+			assert_cgp_no_msg(compute.cycles >= 0 && compute.ipc >= 0 && profiler.phase_counters(profiler.find_phase("frame")).cycles >= profiler.phase_counters(profiler.find_phase("compute")).cycles);
+		}
+		else {
+			assert_cgp_no_msg(compute.cycles == 0 && compute.ipc == 0 && compute.cache_misses == 0);
+		}
+		profiler.enable_hardware_counters(false);
+		assert_cgp_no_msg(profiler.hardware_counters() == nullptr);
+	}
+}
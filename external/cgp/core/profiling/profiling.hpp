@@ -0,0 +1,7 @@
+#pragma once
+
+#include "time_histogram/time_histogram.hpp"
+#include "frame_profiler/frame_profiler.hpp"
+#include "allocation_tracker/allocation_tracker.hpp"
+#include "perf_counters/perf_counters.hpp"
+#include "memory_accounting/memory_accounting.hpp"
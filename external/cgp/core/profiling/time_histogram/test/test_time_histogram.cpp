@@ -0,0 +1,50 @@
+#include "test_time_histogram.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../time_histogram.hpp"
+
+#include <cmath>
+
+namespace cgp_test
+{
+	void test_time_histogram()
+	{
+		using namespace cgp;
+
+		// Buckets: the upper bound of the bucket of a value is above the value, within the relative precision
+		for (double v : { 1.5e-7, 1e-6, 3.3e-5, 1e-3, 0.016, 0.25, 1.0, 100.0 }) {
+			int const k = time_histogram::bucket_index(v);
+			double const upper = time_histogram::bucket_upper_bound(k);
+			assert_cgp_no_msg(upper > v && upper < v * (1 + 1.0 / time_histogram::sub_buckets) * 1.0001);
+			assert_cgp_no_msg(time_histogram::bucket_upper_bound(k - 1) <= v);
+		}
+		assert_cgp_no_msg(time_histogram::bucket_index(1e-9) == 0 && time_histogram::bucket_index(-1.0) == 0);
+		assert_cgp_no_msg(time_histogram::bucket_index(1e6) == time_histogram::bucket_count - 1);
+
+		time_histogram h;
+		assert_cgp_no_msg(h.count() == 0 && h.percentile(50) == 0 && h.max() == 0 && h.mean() == 0);
+
+		// 1000 values of 1ms to 1s: percentiles within the precision of the buckets
+		for (int k = 1; k <= 1000; ++k)
+			h.add(k * 1e-3);
+		assert_cgp_no_msg(h.count() == 1000 && std::abs(h.mean() - 0.5005) < 1e-9);
+		assert_cgp_no_msg(h.min() == 1e-3 && h.max() == 1.0);
+		for (double p : { 50.0, 95.0, 99.0 }) {
+			double const exact = p * 1e-2;
+			assert_cgp_no_msg(h.percentile(p) >= exact && h.percentile(p) <= exact * 1.07);
+		}
+		assert_cgp_no_msg(h.percentile(100) == 1.0 && h.percentile(0) == 1e-3);
+
+		// A single hitch is visible in the maximum and not in the median
+		time_histogram frames;
+		for (int k = 0; k < 999; ++k)
+			frames.add(0.016);
+		frames.add(0.2);
+		assert_cgp_no_msg(frames.percentile(50) < 0.0171 && frames.percentile(99) < 0.0171 && frames.max() == 0.2 && frames.percentile(100) == 0.2);
+
+		frames.merge(h);
+		assert_cgp_no_msg(frames.count() == 2000 && frames.max() == 1.0 && frames.min() == 1e-3);
+		frames.clear();
+		assert_cgp_no_msg(frames.count() == 0 && frames.percentile(99) == 0);
+	}
+}
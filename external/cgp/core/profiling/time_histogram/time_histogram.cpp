@@ -0,0 +1,100 @@
+#include "time_histogram.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace cgp
+{
+	time_histogram::time_histogram()
+	{
+		clear();
+	}
+
+	void time_histogram::clear()
+	{
+		std::fill(bucket, bucket + bucket_count, int64_t(0));
+		N = 0;
+		sum = 0.0;
+		value_min = std::numeric_limits<double>::max();
+		value_max = 0.0;
+	}
+
+	int time_histogram::bucket_index(double seconds)
+	{
+		if (!(seconds >= min_value))
+			return 0;
+
+		// seconds = min_value * m * 2^e with m in [0.5,1[
+		int e = 0;
+		double const m = std::frexp(seconds / min_value, &e);
+		int const sub = std::min(int((2 * m - 1) * sub_buckets), sub_buckets - 1);
+		return std::min(1 + (e - 1) * sub_buckets + sub, bucket_count - 1);
+	}
+
+	double time_histogram::bucket_upper_bound(int index)
+	{
+		if (index <= 0)
+			return min_value;
+		int const e = (index - 1) / sub_buckets;
+		int const sub = (index - 1) % sub_buckets;
+		return std::ldexp(min_value, e) * (1.0 + double(sub + 1) / sub_buckets);
+	}
+
+	void time_histogram::add(double seconds)
+	{
+		bucket[bucket_index(seconds)]++;
+		N++;
+		sum += seconds;
+		value_min = std::min(value_min, seconds);
+		value_max = std::max(value_max, seconds);
+	}
+
+	void time_histogram::merge(time_histogram const& other)
+	{
+		for (int k = 0; k < bucket_count; ++k)
+			bucket[k] += other.bucket[k];
+		N += other.N;
+		sum += other.sum;
+		value_min = std::min(value_min, other.value_min);
+		value_max = std::max(value_max, other.value_max);
+	}
+
+	double time_histogram::mean() const
+	{
+		return N > 0 ? sum / N : 0.0;
+	}
+
+	double time_histogram::min() const
+	{
+		return N > 0 ? value_min : 0.0;
+	}
+
+	double time_histogram::max() const
+	{
+		return value_max;
+	}
+
+	double time_histogram::percentile(double p) const
+	{
+		assert_cgp(p >= 0 && p <= 100, "Percentile must be in [0,100] (p=" + str(p) + ")");
+		if (N == 0)
+			return 0.0;
+		if (p == 0)
+			return value_min;
+
+		// Rank of the value (nearest rank), and first bucket reaching it
+		int64_t const rank = std::max(int64_t(1), int64_t(std::ceil(p / 100.0 * N)));
+		if (rank >= N)
+			return value_max;
+		int64_t cumulated = 0;
+		for (int k = 0; k < bucket_count; ++k) {
+			cumulated += bucket[k];
+			if (cumulated >= rank)
+				return std::min(std::max(bucket_upper_bound(k), value_min), value_max);
+		}
+		return value_max;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cgp
+{
+	/** Distribution of durations stored in a fixed memory (no allocation when values are added)
+	* The durations are counted in logarithmic buckets: 16 buckets per power of 2 from 100ns to about 400s (relative precision of the percentiles below 4.5%).
+	* Durations below 100ns are counted in a first bucket, and durations above the last bucket are counted in the last one (the exact maximum is kept). */
+	struct time_histogram
+	{
+		static constexpr int sub_buckets = 16;
+		static constexpr int octaves = 32;
+		static constexpr int bucket_count = octaves * sub_buckets + 1;
+		static constexpr double min_value = 1e-7;
+
+		time_histogram();
+
+		/** Add a duration (seconds) */
+		void add(double seconds);
+		void clear();
+		/** Add the values of another histogram */
+		void merge(time_histogram const& other);
+
+		int64_t count() const { return N; }
+		double total() const { return sum; }
+		double mean() const;
+		double min() const;
+		double max() const;
+		/** Duration below which p percent of the values are (p in [0,100]), 0 if the histogram is empty */
+		double percentile(double p) const;
+
+		/** Bucket of a duration, and upper bound of the durations of a bucket */
+		static int bucket_index(double seconds);
+		static double bucket_upper_bound(int index);
+
+	private:
+		int64_t bucket[bucket_count];
+		int64_t N;
+		double sum;
+		double value_min;
+		double value_max;
+	};
+}
@@ -0,0 +1,443 @@
+#include "cgp/core/base/base.hpp"
+#include "decomposition.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+// Implementation of the 3x3 SVD following
+//   "Computing the Singular Value Decomposition of 3x3 matrices with minimal branching and elementary floating point operations", McAdams et al. 2011
+// and of the warm-started rotation extraction from
+//   "A Robust Method to Extract the Rotational Part of Deformations", Muller et al. 2016
+//
+// The kernels are templates on the scalar type T: T=float for the single matrix version, T=float_pack to process 8 matrices at once.
+//  They don't contain data-dependent branches (only select()), such that the float_pack version maps directly to SIMD instructions.
+
+namespace cgp
+{
+	namespace
+	{
+		constexpr float givens_gamma = 5.828427124f;  // 3+2*sqrt(2)
+		constexpr float givens_cstar = 0.923879532f;  // cos(pi/8)
+		constexpr float givens_sstar = 0.3826834323f; // sin(pi/8)
+		constexpr float qr_epsilon = 1e-6f;
+		constexpr int jacobi_sweeps = 6; // 4 in the original paper, 6 keeps the reconstruction error of float matrices below 1e-4
+
+		// Exchange x and y if c is true, the former x being negated (preserves the orientation when applied to matrix columns)
+		template <typename T, typename B>
+		inline void conditional_negative_swap(B const& c, T& x, T& y)
+		{
+			T const z = -x;
+			x = select(c, y, x);
+			y = select(c, z, y);
+		}
+
+		// Apply the rotation Q (identity except Q_pp=c, Q_pq=-s, Q_qp=s, Q_qq=c) on the columns of M: M <- M Q
+		template <int p, int q, typename T>
+		inline void rotate_columns(T M[3][3], T const& c, T const& s)
+		{
+			for (int k = 0; k < 3; ++k) {
+				T const mp = M[k][p];
+				T const mq = M[k][q];
+				M[k][p] = c * mp + s * mq;
+				M[k][q] = c * mq - s * mp;
+			}
+		}
+
+		// Apply the rotation Q^T on the rows of M: M <- Q^T M
+		template <int p, int q, typename T>
+		inline void rotate_rows(T M[3][3], T const& c, T const& s)
+		{
+			for (int k = 0; k < 3; ++k) {
+				T const mp = M[p][k];
+				T const mq = M[q][k];
+				M[p][k] = c * mp + s * mq;
+				M[q][k] = c * mq - s * mp;
+			}
+		}
+
+		// One approximate Jacobi rotation cancelling (approximately) the coefficient (p,q) of the symmetric matrix S
+		//  S <- Q^T S Q,  V <- V Q
+		template <int p, int q, typename T>
+		inline void jacobi_conjugation(T S[3][3], T V[3][3])
+		{
+			using std::sqrt;
+			T ch = 2.0f * (S[p][p] - S[q][q]);
+			T sh = S[p][q];
+			auto const use_givens = givens_gamma * sh * sh < ch * ch;
+			T const w = 1.0f / sqrt(ch * ch + sh * sh);
+			ch = select(use_givens, w * ch, T(givens_cstar));
+			sh = select(use_givens, w * sh, T(givens_sstar));
+
+			// (ch,sh) is the half-angle representation of the rotation
+			T const c = ch * ch - sh * sh;
+			T const s = 2.0f * ch * sh;
+
+			rotate_columns<p, q>(S, c, s);
+			rotate_rows<p, q>(S, c, s);
+			rotate_columns<p, q>(V, c, s);
+		}
+
+		// Givens rotation cancelling the coefficient B(q,p) of the QR decomposition
+		//  B <- Q^T B,  U <- U Q
+		template <int p, int q, typename T>
+		inline void qr_givens(T B[3][3], T U[3][3])
+		{
+			using std::sqrt;
+			using std::abs;
+			using std::max;
+			T const a1 = B[p][p];
+			T const a2 = B[q][p];
+			T const rho = sqrt(a1 * a1 + a2 * a2);
+			T sh = select(rho > qr_epsilon, a2, T(0.0f));
+			T ch = abs(a1) + max(rho, T(qr_epsilon));
+			auto const negative = a1 < 0.0f;
+			T const tmp = sh;
+			sh = select(negative, ch, sh);
+			ch = select(negative, tmp, ch);
+			T const w = 1.0f / sqrt(ch * ch + sh * sh);
+			ch *= w;
+			sh *= w;
+
+			T const c = ch * ch - sh * sh;
+			T const s = 2.0f * ch * sh;
+
+			rotate_rows<p, q>(B, c, s);
+			rotate_columns<p, q>(U, c, s);
+		}
+
+		template <typename T>
+		inline void product(T const A[3][3], T const B[3][3], T AB[3][3])
+		{
+			for (int i = 0; i < 3; ++i)
+				for (int j = 0; j < 3; ++j)
+					AB[i][j] = A[i][0] * B[0][j] + A[i][1] * B[1][j] + A[i][2] * B[2][j];
+		}
+
+		template <typename T>
+		inline void set_identity(T M[3][3])
+		{
+			for (int i = 0; i < 3; ++i)
+				for (int j = 0; j < 3; ++j)
+					M[i][j] = (i == j) ? 1.0f : 0.0f;
+		}
+
+		template <typename T>
+		inline void svd_kernel(T const A[3][3], T U[3][3], T S[3], T V[3][3])
+		{
+			// Eigen decomposition of the symmetric matrix A^T A using Jacobi iterations
+			T ATA[3][3];
+			for (int i = 0; i < 3; ++i)
+				for (int j = 0; j < 3; ++j)
+					ATA[i][j] = A[0][i] * A[0][j] + A[1][i] * A[1][j] + A[2][i] * A[2][j];
+
+			set_identity(V);
+			for (int k = 0; k < jacobi_sweeps; ++k) {
+				jacobi_conjugation<0, 1>(ATA, V);
+				jacobi_conjugation<1, 2>(ATA, V);
+				jacobi_conjugation<0, 2>(ATA, V);
+			}
+
+			// B = A V has orthogonal columns - sort them by decreasing norm
+			T B[3][3];
+			product(A, V, B);
+
+			T rho0 = B[0][0] * B[0][0] + B[1][0] * B[1][0] + B[2][0] * B[2][0];
+			T rho1 = B[0][1] * B[0][1] + B[1][1] * B[1][1] + B[2][1] * B[2][1];
+			T rho2 = B[0][2] * B[0][2] + B[1][2] * B[1][2] + B[2][2] * B[2][2];
+
+			auto c = rho0 < rho1;
+			for (int k = 0; k < 3; ++k) {
+				conditional_negative_swap(c, B[k][0], B[k][1]);
+				conditional_negative_swap(c, V[k][0], V[k][1]);
+			}
+			T tmp = rho0; rho0 = select(c, rho1, rho0); rho1 = select(c, tmp, rho1);
+
+			c = rho0 < rho2;
+			for (int k = 0; k < 3; ++k) {
+				conditional_negative_swap(c, B[k][0], B[k][2]);
+				conditional_negative_swap(c, V[k][0], V[k][2]);
+			}
+			tmp = rho0; rho0 = select(c, rho2, rho0); rho2 = select(c, tmp, rho2);
+
+			c = rho1 < rho2;
+			for (int k = 0; k < 3; ++k) {
+				conditional_negative_swap(c, B[k][1], B[k][2]);
+				conditional_negative_swap(c, V[k][1], V[k][2]);
+			}
+
+			// QR decomposition of B using Givens rotations: B = U R, R being diagonal
+			set_identity(U);
+			qr_givens<0, 1>(B, U);
+			qr_givens<0, 2>(B, U);
+			qr_givens<1, 2>(B, U);
+
+			S[0] = B[0][0];
+			S[1] = B[1][1];
+			S[2] = B[2][2];
+		}
+
+		// R <- Rot(omega) R for the rotation vector omega (Rodrigues formula), valid for omega=0
+		template <typename T>
+		inline void rotate_from_vector(T R[3][3], T const& wx, T const& wy, T const& wz)
+		{
+			using std::sqrt;
+			using std::max;
+			using std::sin;
+			using std::cos;
+			T const theta = sqrt(wx * wx + wy * wy + wz * wz);
+			T const inv_theta = 1.0f / max(theta, T(1e-20f));
+			T const kx = wx * inv_theta, ky = wy * inv_theta, kz = wz * inv_theta;
+			T const s = sin(theta);
+			T const c1 = 1.0f - cos(theta);
+
+			// Rot = I + s K + (1-cos) K^2
+			T const Rot[3][3] = {
+				{1.0f + c1 * (kx * kx - 1.0f), c1 * kx * ky - s * kz,         s * ky + c1 * kx * kz},
+				{s * kz + c1 * kx * ky,         1.0f + c1 * (ky * ky - 1.0f), c1 * ky * kz - s * kx},
+				{c1 * kx * kz - s * ky,         s * kx + c1 * ky * kz,         1.0f + c1 * (kz * kz - 1.0f)} };
+
+			T const R0[3][3] = { {R[0][0],R[0][1],R[0][2]}, {R[1][0],R[1][1],R[1][2]}, {R[2][0],R[2][1],R[2][2]} };
+			product(Rot, R0, R);
+		}
+
+		// Gram-Schmidt on the columns of R, avoids the drift of the rotation reused over many time steps
+		template <typename T>
+		inline void orthonormalize_columns(T R[3][3])
+		{
+			using std::sqrt;
+			T n = 1.0f / sqrt(R[0][0] * R[0][0] + R[1][0] * R[1][0] + R[2][0] * R[2][0]);
+			R[0][0] *= n; R[1][0] *= n; R[2][0] *= n;
+
+			T const d = R[0][0] * R[0][1] + R[1][0] * R[1][1] + R[2][0] * R[2][1];
+			R[0][1] -= d * R[0][0]; R[1][1] -= d * R[1][0]; R[2][1] -= d * R[2][0];
+			n = 1.0f / sqrt(R[0][1] * R[0][1] + R[1][1] * R[1][1] + R[2][1] * R[2][1]);
+			R[0][1] *= n; R[1][1] *= n; R[2][1] *= n;
+
+			R[0][2] = R[1][0] * R[2][1] - R[2][0] * R[1][1];
+			R[1][2] = R[2][0] * R[0][1] - R[0][0] * R[2][1];
+			R[2][2] = R[0][0] * R[1][1] - R[1][0] * R[0][1];
+		}
+
+		template <typename T>
+		inline void polar_rotation_warm_start_kernel(T const A[3][3], T R[3][3], int iterations)
+		{
+			using std::abs;
+			for (int it = 0; it < iterations; ++it)
+			{
+				// omega = sum_i r_i x a_i / (|sum_i r_i.a_i| + eps) with r_i, a_i the columns of R and A
+				T wx = 0.0f, wy = 0.0f, wz = 0.0f, d = 0.0f;
+				for (int i = 0; i < 3; ++i) {
+					wx += R[1][i] * A[2][i] - R[2][i] * A[1][i];
+					wy += R[2][i] * A[0][i] - R[0][i] * A[2][i];
+					wz += R[0][i] * A[1][i] - R[1][i] * A[0][i];
+					d += R[0][i] * A[0][i] + R[1][i] * A[1][i] + R[2][i] * A[2][i];
+				}
+				T const inv = 1.0f / (abs(d) + 1e-9f);
+				rotate_from_vector(R, wx * inv, wy * inv, wz * inv);
+			}
+			orthonormalize_columns(R);
+		}
+
+		template <typename T>
+		inline void polar_rotation_kernel(T const A[3][3], T R[3][3])
+		{
+			T U[3][3], S[3], V[3][3];
+			svd_kernel(A, U, S, V);
+			for (int i = 0; i < 3; ++i)
+				for (int j = 0; j < 3; ++j)
+					R[i][j] = U[i][0] * V[j][0] + U[i][1] * V[j][1] + U[i][2] * V[j][2];
+		}
+
+		inline void load(mat3 const& M, float A[3][3])
+		{
+			for (int k = 0; k < 9; ++k)
+				A[k / 3][k % 3] = M.at_offset(k);
+		}
+		inline mat3 store(float const A[3][3])
+		{
+			return mat3{ A[0][0],A[0][1],A[0][2], A[1][0],A[1][1],A[1][2], A[2][0],A[2][1],A[2][2] };
+		}
+		inline void load(mat3_pack const& M, float_pack A[3][3])
+		{
+			for (int k = 0; k < 9; ++k)
+				A[k / 3][k % 3] = M.data[k];
+		}
+		inline void store(float_pack const A[3][3], mat3_pack& M)
+		{
+			for (int k = 0; k < 9; ++k)
+				M.data[k] = A[k / 3][k % 3];
+		}
+
+		// Fill the lanes of a pack from the array M starting at offset, lanes after the end of the array are set to identity
+		void load_pack(numarray<mat3> const& M, int offset, mat3_pack& pack)
+		{
+			int const N = std::min(mat3_pack::lanes, int(M.size()) - offset);
+			for (int lane = 0; lane < mat3_pack::lanes; ++lane)
+				pack.set(lane, lane < N ? M.at(offset + lane) : mat3::build_identity());
+		}
+	}
+
+
+	void svd(mat3 const& M, mat3& U, vec3& S, mat3& V)
+	{
+		float A[3][3], u[3][3], s[3], v[3][3];
+		load(M, A);
+		svd_kernel(A, u, s, v);
+		U = store(u);
+		V = store(v);
+		S = { s[0], s[1], s[2] };
+	}
+
+	void polar_decomposition(mat3 const& M, mat3& R, mat3& S)
+	{
+		mat3 U, V;
+		vec3 sigma;
+		svd(M, U, sigma, V);
+		R = U * transpose(V);
+		S = V * mat3::build_diagonal(sigma.x, sigma.y, sigma.z) * transpose(V);
+	}
+
+	mat3 polar_rotation(mat3 const& M)
+	{
+		float A[3][3], R[3][3];
+		load(M, A);
+		polar_rotation_kernel(A, R);
+		return store(R);
+	}
+
+	mat3 polar_rotation_warm_start(mat3 const& M, mat3 const& R_init, int iterations)
+	{
+		float A[3][3], R[3][3];
+		load(M, A);
+		load(R_init, R);
+		polar_rotation_warm_start_kernel(A, R, iterations);
+		return store(R);
+	}
+
+
+
+	void mat3_pack::set(int lane, mat3 const& M)
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < lanes);
+		for (int k = 0; k < 9; ++k)
+			data[k][lane] = M.at_offset(k);
+	}
+	mat3 mat3_pack::get(int lane) const
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < lanes);
+		mat3 M;
+		for (int k = 0; k < 9; ++k)
+			M.at_offset(k) = data[k][lane];
+		return M;
+	}
+
+	void vec3_pack::set(int lane, vec3 const& v)
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < lanes);
+		data[0][lane] = v.x;
+		data[1][lane] = v.y;
+		data[2][lane] = v.z;
+	}
+	vec3 vec3_pack::get(int lane) const
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < lanes);
+		return { data[0][lane], data[1][lane], data[2][lane] };
+	}
+
+
+	void svd(mat3_pack const& M, mat3_pack& U, vec3_pack& S, mat3_pack& V)
+	{
+		float_pack A[3][3], u[3][3], v[3][3];
+		load(M, A);
+		svd_kernel(A, u, S.data, v);
+		store(u, U);
+		store(v, V);
+	}
+
+	void polar_rotation(mat3_pack const& M, mat3_pack& R)
+	{
+		float_pack A[3][3], r[3][3];
+		load(M, A);
+		polar_rotation_kernel(A, r);
+		store(r, R);
+	}
+
+	void polar_rotation_warm_start(mat3_pack const& M, mat3_pack& R, int iterations)
+	{
+		float_pack A[3][3], r[3][3];
+		load(M, A);
+		load(R, r);
+		polar_rotation_warm_start_kernel(A, r, iterations);
+		store(r, R);
+	}
+
+
+
+	void svd(numarray<mat3> const& M, numarray<mat3>& U, numarray<vec3>& S, numarray<mat3>& V)
+	{
+		int const N = M.size();
+		U.resize(N);
+		S.resize(N);
+		V.resize(N);
+
+		int const N_pack = (N + mat3_pack::lanes - 1) / mat3_pack::lanes;
+		#pragma omp parallel for
+		for (int k_pack = 0; k_pack < N_pack; ++k_pack)
+		{
+			int const offset = k_pack * mat3_pack::lanes;
+			mat3_pack M_pack, U_pack, V_pack;
+			vec3_pack S_pack;
+			load_pack(M, offset, M_pack);
+
+			svd(M_pack, U_pack, S_pack, V_pack);
+
+			for (int lane = 0; lane < mat3_pack::lanes && offset + lane < N; ++lane) {
+				U.at(offset + lane) = U_pack.get(lane);
+				S.at(offset + lane) = S_pack.get(lane);
+				V.at(offset + lane) = V_pack.get(lane);
+			}
+		}
+	}
+
+	void polar_rotation(numarray<mat3> const& M, numarray<mat3>& R)
+	{
+		int const N = M.size();
+		R.resize(N);
+
+		int const N_pack = (N + mat3_pack::lanes - 1) / mat3_pack::lanes;
+		#pragma omp parallel for
+		for (int k_pack = 0; k_pack < N_pack; ++k_pack)
+		{
+			int const offset = k_pack * mat3_pack::lanes;
+			mat3_pack M_pack, R_pack;
+			load_pack(M, offset, M_pack);
+
+			polar_rotation(M_pack, R_pack);
+
+			for (int lane = 0; lane < mat3_pack::lanes && offset + lane < N; ++lane)
+				R.at(offset + lane) = R_pack.get(lane);
+		}
+	}
+
+	void polar_rotation_warm_start(numarray<mat3> const& M, numarray<mat3>& R, int iterations)
+	{
+		int const N = M.size();
+		assert_cgp(R.size() == N, "Initial rotations must have the same size than the matrices (size(R)=" + str(R.size()) + ", size(M)=" + str(N) + ")");
+
+		int const N_pack = (N + mat3_pack::lanes - 1) / mat3_pack::lanes;
+		#pragma omp parallel for
+		for (int k_pack = 0; k_pack < N_pack; ++k_pack)
+		{
+			int const offset = k_pack * mat3_pack::lanes;
+			mat3_pack M_pack, R_pack;
+			load_pack(M, offset, M_pack);
+			load_pack(R, offset, R_pack);
+
+			polar_rotation_warm_start(M_pack, R_pack, iterations);
+
+			for (int lane = 0; lane < mat3_pack::lanes && offset + lane < N; ++lane)
+				R.at(offset + lane) = R_pack.get(lane);
+		}
+	}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../mat3/mat3.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+#include "cgp/core/array/pack/pack.hpp"
+
+namespace cgp
+{
+
+	/** Singular Value Decomposition of a 3x3 matrix: M = U diag(S) V^T
+	* Jacobi-based, branch-free implementation (McAdams et al. 2011)
+	*  - U and V are rotations (det=+1)
+	*  - S is sorted by decreasing absolute value. The last singular value is negative if det(M)<0 (signed SVD, as required for inverted elements) */
+	void svd(mat3 const& M, mat3& U, vec3& S, mat3& V);
+
+	/** Polar decomposition M = R S where R is a rotation and S is symmetric */
+	void polar_decomposition(mat3 const& M, mat3& R, mat3& S);
+
+	/** Rotational part of M (R of the polar decomposition) */
+	mat3 polar_rotation(mat3 const& M);
+
+	/** Rotational part of M refined iteratively from an initial guess R_init (typically the rotation of the previous time step)
+	* Uses the fixed point iterations of Muller et al. 2016 - few iterations are needed when the deformation changes smoothly */
+	mat3 polar_rotation_warm_start(mat3 const& M, mat3 const& R_init, int iterations = 4);
+
+
+
+	/** Structure of Array storage of 8 mat3 used by the batched kernels
+	* data[k][lane] stores the coefficient at_offset(k) of the matrix in the given lane
+	* Each kernel process all the lanes at once (vectorized along the lanes) */
+	struct mat3_pack
+	{
+		static constexpr int lanes = pack_lanes;
+		float_pack data[9];
+
+		void set(int lane, mat3 const& M);
+		mat3 get(int lane) const;
+	};
+
+	/** Structure of Array storage of 8 vec3 */
+	struct vec3_pack
+	{
+		static constexpr int lanes = pack_lanes;
+		float_pack data[3];
+
+		void set(int lane, vec3 const& v);
+		vec3 get(int lane) const;
+	};
+
+	// Batched versions of the decompositions on a pack of 8 matrices
+	void svd(mat3_pack const& M, mat3_pack& U, vec3_pack& S, mat3_pack& V);
+	void polar_rotation(mat3_pack const& M, mat3_pack& R);
+	// R is used as initial guess and is updated with the new rotation
+	void polar_rotation_warm_start(mat3_pack const& M, mat3_pack& R, int iterations = 4);
+
+	// Batched versions on arrays of arbitrary size (packed by 8 internally)
+	void svd(numarray<mat3> const& M, numarray<mat3>& U, numarray<vec3>& S, numarray<mat3>& V);
+	void polar_rotation(numarray<mat3> const& M, numarray<mat3>& R);
+	// R must have the same size than M and contains the initial guess (ex. rotations of the previous step)
+	void polar_rotation_warm_start(numarray<mat3> const& M, numarray<mat3>& R, int iterations = 4);
+}
@@ -0,0 +1,158 @@
+#include "test_decomposition.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/geometry/mat/mat.hpp"
+#include "../decomposition.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace cgp_test
+{
+	// Double precision reference: singular values of M computed as the square roots of the eigenvalues of M^T M (cyclic Jacobi with exact rotations)
+	static void reference_singular_values(cgp::mat3 const& M, double sigma[3])
+	{
+		double S[3][3];
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j < 3; ++j)
+				S[i][j] = double(M(0, i)) * M(0, j) + double(M(1, i)) * M(1, j) + double(M(2, i)) * M(2, j);
+
+		for (int sweep = 0; sweep < 50; ++sweep) {
+			for (int p = 0; p < 2; ++p) {
+				for (int q = p + 1; q < 3; ++q) {
+					if (std::abs(S[p][q]) < 1e-300) continue;
+					double const theta = 0.5 * std::atan2(2 * S[p][q], S[p][p] - S[q][q]);
+					double const c = std::cos(theta), s = std::sin(theta);
+					for (int k = 0; k < 3; ++k) {
+						double const a = S[k][p], b = S[k][q];
+						S[k][p] = c * a + s * b; S[k][q] = -s * a + c * b;
+					}
+					for (int k = 0; k < 3; ++k) {
+						double const a = S[p][k], b = S[q][k];
+						S[p][k] = c * a + s * b; S[q][k] = -s * a + c * b;
+					}
+				}
+			}
+		}
+		for (int k = 0; k < 3; ++k)
+			sigma[k] = std::sqrt(std::max(S[k][k], 0.0));
+		std::sort(sigma, sigma + 3, [](double a, double b) {return a > b; });
+	}
+
+	static double max_difference(cgp::mat3 const& A, cgp::mat3 const& B)
+	{
+		double d = 0.0;
+		for (int k = 0; k < 9; ++k)
+			d = std::max(d, std::abs(double(A.at_offset(k)) - double(B.at_offset(k))));
+		return d;
+	}
+
+	static cgp::mat3 random_matrix()
+	{
+		cgp::mat3 M;
+		for (int k = 0; k < 9; ++k)
+			M.at_offset(k) = cgp::rand_interval(-2.0f, 2.0f);
+		return M;
+	}
+
+	void test_decomposition()
+	{
+		using namespace cgp;
+		mat3 const Id = mat3::build_identity();
+
+		// Scalar SVD compared to the double precision reference
+		{
+			for (int k = 0; k < 1000; ++k)
+			{
+				mat3 const M = random_matrix();
+				mat3 U, V;
+				vec3 S;
+				svd(M, U, S, V);
+
+				double sigma[3];
+				reference_singular_values(M, sigma);
+				double const scale = std::max(sigma[0], 1.0);
+
+				assert_cgp_no_msg(std::abs(std::abs(S.x) - sigma[0]) < 1e-4 * scale);
+				assert_cgp_no_msg(std::abs(std::abs(S.y) - sigma[1]) < 1e-4 * scale);
+				assert_cgp_no_msg(std::abs(std::abs(S.z) - sigma[2]) < 1e-4 * scale);
+				assert_cgp_no_msg(S.x >= 0 && S.y >= 0);
+				assert_cgp_no_msg((S.z < 0) == (det(M) < 0) || std::abs(S.z) < 1e-4f);
+
+				assert_cgp_no_msg(max_difference(U * transpose(U), Id) < 1e-5);
+				assert_cgp_no_msg(max_difference(V * transpose(V), Id) < 1e-5);
+				assert_cgp_no_msg(std::abs(det(U) - 1.0f) < 1e-5f);
+				assert_cgp_no_msg(std::abs(det(V) - 1.0f) < 1e-5f);
+				assert_cgp_no_msg(max_difference(U * mat3::build_diagonal(S.x, S.y, S.z) * transpose(V), M) < 1e-4 * scale);
+			}
+		}
+
+		// Degenerated cases
+		{
+			mat3 const cases[] = { mat3::build_identity(), mat3::build_constant(0.0f), mat3{1,0,0, 0,1,0, 0,0,-1}, mat3{1,1,1, 1,1,1, 1,1,1}, mat3{2,0,0, 0,2,0, 0,0,0} };
+			for (mat3 const& M : cases) {
+				mat3 U, V;
+				vec3 S;
+				svd(M, U, S, V);
+				assert_cgp_no_msg(max_difference(U * mat3::build_diagonal(S.x, S.y, S.z) * transpose(V), M) < 1e-5);
+				assert_cgp_no_msg(std::abs(det(U) - 1.0f) < 1e-5f && std::abs(det(V) - 1.0f) < 1e-5f);
+			}
+		}
+
+		// Polar decomposition
+		{
+			for (int k = 0; k < 200; ++k)
+			{
+				mat3 const M = random_matrix();
+				mat3 R, S;
+				polar_decomposition(M, R, S);
+				assert_cgp_no_msg(max_difference(R * S, M) < 1e-4);
+				assert_cgp_no_msg(max_difference(S, transpose(S)) < 1e-4);
+				assert_cgp_no_msg(max_difference(R * transpose(R), Id) < 1e-5);
+				assert_cgp_no_msg(max_difference(polar_rotation(M), R) < 1e-5);
+			}
+		}
+
+		// Warm-started rotation extraction: small rotation perturbation of a stretched matrix
+		{
+			for (int k = 0; k < 200; ++k)
+			{
+				vec3 const axis = normalize(vec3{ rand_interval(-1,1), rand_interval(-1,1), rand_interval(-1,1) } + vec3{ 0.01f,0,0 });
+				mat3 const R_prev = mat3::build_rotation_from_axis_angle(axis, rand_interval(0.0f, 3.0f));
+				mat3 const R_next = mat3::build_rotation_from_axis_angle(normalize(axis + vec3{ 0.1f,0.2f,0.0f }), 0.1f) * R_prev;
+				mat3 const M = R_next * mat3{ 1.2f,0.1f,0.0f, 0.1f,0.9f,0.05f, 0.0f,0.05f,1.1f };
+
+				mat3 const R = polar_rotation_warm_start(M, R_prev, 6);
+				assert_cgp_no_msg(max_difference(R, polar_rotation(M)) < 1e-3);
+				assert_cgp_no_msg(max_difference(R * transpose(R), Id) < 1e-5);
+			}
+		}
+
+		// Batched versions match the scalar ones
+		{
+			int const N = 37; // not a multiple of the number of lanes
+			numarray<mat3> M(N), U, V, R, R_warm(N);
+			numarray<vec3> S;
+			for (int k = 0; k < N; ++k) {
+				M[k] = random_matrix();
+				R_warm[k] = Id;
+			}
+
+			svd(M, U, S, V);
+			polar_rotation(M, R);
+			for (int k = 0; k < N; ++k) {
+				mat3 Uk, Vk;
+				vec3 Sk;
+				svd(M[k], Uk, Sk, Vk);
+				assert_cgp_no_msg(max_difference(U[k], Uk) < 1e-5);
+				assert_cgp_no_msg(max_difference(V[k], Vk) < 1e-5);
+				assert_cgp_no_msg(norm(S[k] - Sk) < 1e-5f);
+				assert_cgp_no_msg(max_difference(R[k], polar_rotation(M[k])) < 1e-5);
+			}
+
+			polar_rotation_warm_start(M, R_warm, 3);
+			for (int k = 0; k < N; ++k)
+				assert_cgp_no_msg(max_difference(R_warm[k], polar_rotation_warm_start(M[k], Id, 3)) < 1e-5);
+		}
+	}
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "cgp/core/array/pack/pack.hpp"
+#include "cgp/core/containers/matrix_stack/matrix_stack.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+// Dense factorizations of small matrices with size N known at compile time (typically 3x3 to 12x12 element-local systems)
+//
+// The factorizations work in place on arrays T[N][N] where T is either
+//  - float: a single system
+//  - float_pack: 8 independent systems solved at once, one per lane (see cgp/core/array/pack)
+// All loops have compile-time bounds and the kernels have no data-dependent branches, including the pivoting of the LU factorization.
+// The LDL^T and LU versions are constexpr (with T=float) and can be evaluated at compile time.
+//
+// The factorization functions return a status (bool for float, mask_pack for float_pack) that is false if a pivot is null (or negative for Cholesky).
+// The values of a failed factorization are finite but meaningless.
+
+namespace cgp
+{
+	/** Type of the status returned by the factorizations: bool for float, mask_pack for float_pack */
+	template <typename T> using factorization_status = decltype(std::declval<T>() < std::declval<T>());
+
+	/** Pivots with an absolute value lower than this threshold are considered as null */
+	constexpr float factorization_pivot_epsilon = 1e-20f;
+
+
+	/** Cholesky factorization A = L L^T of a symmetric positive definite matrix
+	* Only the lower triangular part of A is read. L is stored in the lower triangular part (diagonal included), the strict upper part is left unchanged. */
+	template <typename T, int N> factorization_status<T> cholesky_factorize(T (&A)[N][N]);
+	/** Solve L L^T x = b, with L computed by cholesky_factorize. b is overwritten by x. */
+	template <typename T, int N> void cholesky_solve(T const (&L)[N][N], T (&b)[N]);
+
+	/** LDL^T factorization of a symmetric matrix (no square root, can be used on indefinite matrices with non-null pivots)
+	* Only the lower triangular part of A is read. D is stored on the diagonal, and the unit lower triangular L in the strict lower part. */
+	template <typename T, int N> constexpr factorization_status<T> ldlt_factorize(T (&A)[N][N]);
+	/** Solve L D L^T x = b, with L and D computed by ldlt_factorize. b is overwritten by x. */
+	template <typename T, int N> constexpr void ldlt_solve(T const (&LD)[N][N], T (&b)[N]);
+
+	/** LU factorization with partial pivoting P A = L U of a general matrix
+	* L (unit diagonal) is stored in the strict lower part, U in the upper part (diagonal included).
+	* permutation[k] stores the index of the row of A placed in row k. */
+	template <typename T, int N> constexpr factorization_status<T> lu_factorize(T (&A)[N][N], T (&permutation)[N]);
+	/** Solve A x = b, with the factors computed by lu_factorize. b is overwritten by x. */
+	template <typename T, int N> constexpr void lu_solve(T const (&LU)[N][N], T const (&permutation)[N], T (&b)[N]);
+
+
+	/** Convenience versions solving A x = b for a single matrix_stack
+	* Errors are raised (if CGP_NO_DEBUG is not defined) when the factorization fails */
+	template <int N> numarray_stack<float, N> solve_cholesky(matrix_stack<float, N, N> const& A, numarray_stack<float, N> const& b);
+	template <int N> numarray_stack<float, N> solve_ldlt(matrix_stack<float, N, N> const& A, numarray_stack<float, N> const& b);
+	template <int N> numarray_stack<float, N> solve_lu(matrix_stack<float, N, N> const& A, numarray_stack<float, N> const& b);
+
+	/** Copy a matrix_stack (resp. numarray_stack) in/from one lane of the batched storage */
+	template <int N> void set_lane(float_pack (&A)[N][N], int lane, matrix_stack<float, N, N> const& M);
+	template <int N> void set_lane(float_pack (&b)[N], int lane, numarray_stack<float, N> const& v);
+	template <int N> matrix_stack<float, N, N> get_lane(float_pack const (&A)[N][N], int lane);
+	template <int N> numarray_stack<float, N> get_lane(float_pack const (&b)[N], int lane);
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	template <typename T, int N> factorization_status<T> cholesky_factorize(T (&A)[N][N])
+	{
+		using std::sqrt;
+		using std::max;
+
+		factorization_status<T> valid = T(1.0f) > T(0.0f);
+		for (int j = 0; j < N; ++j)
+		{
+			T d = A[j][j];
+			for (int k = 0; k < j; ++k)
+				d -= A[j][k] * A[j][k];
+			valid = valid && (d > factorization_pivot_epsilon);
+
+			T const Ljj = sqrt(max(d, T(factorization_pivot_epsilon)));
+			T const inv = 1.0f / Ljj;
+			A[j][j] = Ljj;
+
+			for (int i = j + 1; i < N; ++i)
+			{
+				T s = A[i][j];
+				for (int k = 0; k < j; ++k)
+					s -= A[i][k] * A[j][k];
+				A[i][j] = s * inv;
+			}
+		}
+		return valid;
+	}
+
+	template <typename T, int N> void cholesky_solve(T const (&L)[N][N], T (&b)[N])
+	{
+		// L y = b
+		for (int i = 0; i < N; ++i) {
+			T s = b[i];
+			for (int k = 0; k < i; ++k)
+				s -= L[i][k] * b[k];
+			b[i] = s / L[i][i];
+		}
+		// L^T x = y
+		for (int i = N - 1; i >= 0; --i) {
+			T s = b[i];
+			for (int k = i + 1; k < N; ++k)
+				s -= L[k][i] * b[k];
+			b[i] = s / L[i][i];
+		}
+	}
+
+
+	template <typename T, int N> constexpr factorization_status<T> ldlt_factorize(T (&A)[N][N])
+	{
+		factorization_status<T> valid = T(1.0f) > T(0.0f);
+		for (int j = 0; j < N; ++j)
+		{
+			// v_k = L_jk D_k
+			T v[N] = {};
+			for (int k = 0; k < j; ++k)
+				v[k] = A[j][k] * A[k][k];
+
+			T d = A[j][j];
+			for (int k = 0; k < j; ++k)
+				d -= A[j][k] * v[k];
+			T const abs_d = select(d < 0.0f, -d, d);
+			valid = valid && (abs_d > factorization_pivot_epsilon);
+
+			// Null pivots are replaced by epsilon to keep finite values
+			d = select(abs_d > factorization_pivot_epsilon, d, T(factorization_pivot_epsilon));
+			A[j][j] = d;
+			T const inv = 1.0f / d;
+
+			for (int i = j + 1; i < N; ++i)
+			{
+				T s = A[i][j];
+				for (int k = 0; k < j; ++k)
+					s -= A[i][k] * v[k];
+				A[i][j] = s * inv;
+			}
+		}
+		return valid;
+	}
+
+	template <typename T, int N> constexpr void ldlt_solve(T const (&LD)[N][N], T (&b)[N])
+	{
+		// L z = b
+		for (int i = 0; i < N; ++i)
+			for (int k = 0; k < i; ++k)
+				b[i] -= LD[i][k] * b[k];
+		// D y = z
+		for (int i = 0; i < N; ++i)
+			b[i] = b[i] / LD[i][i];
+		// L^T x = y
+		for (int i = N - 1; i >= 0; --i)
+			for (int k = i + 1; k < N; ++k)
+				b[i] -= LD[k][i] * b[k];
+	}
+
+
+	template <typename T, int N> constexpr factorization_status<T> lu_factorize(T (&A)[N][N], T (&permutation)[N])
+	{
+		for (int i = 0; i < N; ++i)
+			permutation[i] = T(float(i));
+
+		factorization_status<T> valid = T(1.0f) > T(0.0f);
+		for (int k = 0; k < N; ++k)
+		{
+			// Partial pivoting: row k is successively exchanged with any row having a larger pivot
+			//  (conditional swaps instead of an argmax, such that each lane can select a different row)
+			for (int i = k + 1; i < N; ++i)
+			{
+				T const a_ik = A[i][k];
+				T const a_kk = A[k][k];
+				auto const swap = select(a_ik < 0.0f, -a_ik, a_ik) > select(a_kk < 0.0f, -a_kk, a_kk);
+				for (int j = 0; j < N; ++j) {
+					T const tmp = A[k][j];
+					A[k][j] = select(swap, A[i][j], tmp);
+					A[i][j] = select(swap, tmp, A[i][j]);
+				}
+				T const tmp = permutation[k];
+				permutation[k] = select(swap, permutation[i], tmp);
+				permutation[i] = select(swap, tmp, permutation[i]);
+			}
+
+			T pivot = A[k][k];
+			T const abs_pivot = select(pivot < 0.0f, -pivot, pivot);
+			valid = valid && (abs_pivot > factorization_pivot_epsilon);
+			pivot = select(abs_pivot > factorization_pivot_epsilon, pivot, T(factorization_pivot_epsilon));
+			A[k][k] = pivot;
+			T const inv = 1.0f / pivot;
+
+			for (int i = k + 1; i < N; ++i)
+			{
+				A[i][k] = A[i][k] * inv;
+				for (int j = k + 1; j < N; ++j)
+					A[i][j] -= A[i][k] * A[k][j];
+			}
+		}
+		return valid;
+	}
+
+	template <typename T, int N> constexpr void lu_solve(T const (&LU)[N][N], T const (&permutation)[N], T (&b)[N])
+	{
+		// y = P b (gather written as selections to allow a different permutation per lane)
+		T y[N] = {};
+		for (int i = 0; i < N; ++i)
+			for (int k = 0; k < N; ++k)
+				y[i] = select(permutation[i] == T(float(k)), b[k], y[i]);
+
+		// L z = y
+		for (int i = 0; i < N; ++i)
+			for (int k = 0; k < i; ++k)
+				y[i] -= LU[i][k] * y[k];
+		// U x = z
+		for (int i = N - 1; i >= 0; --i) {
+			for (int k = i + 1; k < N; ++k)
+				y[i] -= LU[i][k] * y[k];
+			y[i] = y[i] / LU[i][i];
+		}
+
+		for (int i = 0; i < N; ++i)
+			b[i] = y[i];
+	}
+
+
+	template <int N> numarray_stack<float, N> solve_cholesky(matrix_stack<float, N, N> const& A, numarray_stack<float, N> const& b)
+	{
+		float L[N][N] = {};
+		float x[N] = {};
+		for (int i = 0; i < N; ++i) {
+			for (int j = 0; j < N; ++j)
+				L[i][j] = A.at_unsafe(i, j);
+			x[i] = b.at_unsafe(i);
+		}
+
+		bool const valid = cholesky_factorize(L);
+		assert_cgp(valid, "Cholesky factorization failed: the matrix is not symmetric positive definite");
+		cholesky_solve(L, x);
+
+		numarray_stack<float, N> res;
+		for (int i = 0; i < N; ++i)
+			res.at_unsafe(i) = x[i];
+		return res;
+	}
+
+	template <int N> numarray_stack<float, N> solve_ldlt(matrix_stack<float, N, N> const& A, numarray_stack<float, N> const& b)
+	{
+		float LD[N][N] = {};
+		float x[N] = {};
+		for (int i = 0; i < N; ++i) {
+			for (int j = 0; j < N; ++j)
+				LD[i][j] = A.at_unsafe(i, j);
+			x[i] = b.at_unsafe(i);
+		}
+
+		bool const valid = ldlt_factorize(LD);
+		assert_cgp(valid, "LDLt factorization failed: null pivot");
+		ldlt_solve(LD, x);
+
+		numarray_stack<float, N> res;
+		for (int i = 0; i < N; ++i)
+			res.at_unsafe(i) = x[i];
+		return res;
+	}
+
+	template <int N> numarray_stack<float, N> solve_lu(matrix_stack<float, N, N> const& A, numarray_stack<float, N> const& b)
+	{
+		float LU[N][N] = {};
+		float permutation[N] = {};
+		float x[N] = {};
+		for (int i = 0; i < N; ++i) {
+			for (int j = 0; j < N; ++j)
+				LU[i][j] = A.at_unsafe(i, j);
+			x[i] = b.at_unsafe(i);
+		}
+
+		bool const valid = lu_factorize(LU, permutation);
+		assert_cgp(valid, "LU factorization failed: the matrix is singular");
+		lu_solve(LU, permutation, x);
+
+		numarray_stack<float, N> res;
+		for (int i = 0; i < N; ++i)
+			res.at_unsafe(i) = x[i];
+		return res;
+	}
+
+
+	template <int N> void set_lane(float_pack (&A)[N][N], int lane, matrix_stack<float, N, N> const& M)
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < pack_lanes);
+		for (int i = 0; i < N; ++i)
+			for (int j = 0; j < N; ++j)
+				A[i][j][lane] = M.at_unsafe(i, j);
+	}
+	template <int N> void set_lane(float_pack (&b)[N], int lane, numarray_stack<float, N> const& v)
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < pack_lanes);
+		for (int i = 0; i < N; ++i)
+			b[i][lane] = v.at_unsafe(i);
+	}
+	template <int N> matrix_stack<float, N, N> get_lane(float_pack const (&A)[N][N], int lane)
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < pack_lanes);
+		matrix_stack<float, N, N> M;
+		for (int i = 0; i < N; ++i)
+			for (int j = 0; j < N; ++j)
+				M.at_unsafe(i, j) = A[i][j][lane];
+		return M;
+	}
+	template <int N> numarray_stack<float, N> get_lane(float_pack const (&b)[N], int lane)
+	{
+		assert_cgp_no_msg(lane >= 0 && lane < pack_lanes);
+		numarray_stack<float, N> v;
+		for (int i = 0; i < N; ++i)
+			v.at_unsafe(i) = b[i][lane];
+		return v;
+	}
+}
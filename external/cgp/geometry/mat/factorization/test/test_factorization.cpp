@@ -0,0 +1,158 @@
+#include "test_factorization.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../factorization.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace cgp_test
+{
+	// Compile-time evaluation of the LDL^T and LU solvers on a 3x3 symmetric system
+	//  A = [4 2 0; 2 5 1; 0 1 3], b = A (1,2,3)^T = (8,15,11)
+	struct constexpr_solution { float x[3]; };
+	constexpr constexpr_solution constexpr_ldlt_solve()
+	{
+		float A[3][3] = { {4,2,0}, {2,5,1}, {0,1,3} };
+		float b[3] = { 8,15,11 };
+		cgp::ldlt_factorize(A);
+		cgp::ldlt_solve(A, b);
+		return { {b[0], b[1], b[2]} };
+	}
+	constexpr constexpr_solution constexpr_lu_solve()
+	{
+		float A[3][3] = { {0,2,1}, {4,2,0}, {2,5,1} }; // requires pivoting
+		float p[3] = {};
+		float b[3] = { 7,8,15 };
+		cgp::lu_factorize(A, p);
+		cgp::lu_solve(A, p, b);
+		return { {b[0], b[1], b[2]} };
+	}
+	constexpr bool near(float a, float b) { return (a - b) < 1e-5f && (b - a) < 1e-5f; }
+	constexpr constexpr_solution ldlt_x = constexpr_ldlt_solve();
+	constexpr constexpr_solution lu_x = constexpr_lu_solve();
+	static_assert(near(ldlt_x.x[0], 1) && near(ldlt_x.x[1], 2) && near(ldlt_x.x[2], 3), "constexpr LDLt solve");
+	static_assert(near(lu_x.x[0], 1) && near(lu_x.x[1], 2) && near(lu_x.x[2], 3), "constexpr LU solve");
+
+
+	// Random symmetric positive definite matrix A = B B^T + N Id
+	template <int N> static cgp::matrix_stack<float, N, N> random_spd()
+	{
+		cgp::matrix_stack<float, N, N> B;
+		for (int i = 0; i < N; ++i)
+			for (int j = 0; j < N; ++j)
+				B(i, j) = cgp::rand_interval(-1.0f, 1.0f);
+
+		cgp::matrix_stack<float, N, N> A;
+		for (int i = 0; i < N; ++i) {
+			for (int j = 0; j < N; ++j) {
+				float s = 0.0f;
+				for (int k = 0; k < N; ++k)
+					s += B(i, k) * B(j, k);
+				A(i, j) = s + (i == j ? float(N) : 0.0f);
+			}
+		}
+		return A;
+	}
+
+	template <int N> static cgp::matrix_stack<float, N, N> random_general()
+	{
+		cgp::matrix_stack<float, N, N> A;
+		for (int i = 0; i < N; ++i)
+			for (int j = 0; j < N; ++j)
+				A(i, j) = cgp::rand_interval(-1.0f, 1.0f) + (i == j ? 2.0f : 0.0f);
+		return A;
+	}
+
+	template <int N> static cgp::numarray_stack<float, N> random_vector()
+	{
+		cgp::numarray_stack<float, N> v;
+		for (int i = 0; i < N; ++i)
+			v[i] = cgp::rand_interval(-1.0f, 1.0f);
+		return v;
+	}
+
+	template <int N> static float residual(cgp::matrix_stack<float, N, N> const& A, cgp::numarray_stack<float, N> const& x, cgp::numarray_stack<float, N> const& b)
+	{
+		float r = 0.0f;
+		for (int i = 0; i < N; ++i) {
+			float s = -b[i];
+			for (int j = 0; j < N; ++j)
+				s += A(i, j) * x[j];
+			r = std::max(r, std::abs(s));
+		}
+		return r;
+	}
+
+	template <int N> static void test_factorization_size()
+	{
+		using namespace cgp;
+
+		// Scalar solvers
+		for (int k = 0; k < 100; ++k)
+		{
+			matrix_stack<float, N, N> const A = random_spd<N>();
+			matrix_stack<float, N, N> const G = random_general<N>();
+			numarray_stack<float, N> const b = random_vector<N>();
+
+			assert_cgp_no_msg(residual(A, solve_cholesky(A, b), b) < 1e-4f);
+			assert_cgp_no_msg(residual(A, solve_ldlt(A, b), b) < 1e-4f);
+			assert_cgp_no_msg(residual(G, solve_lu(G, b), b) < 1e-4f);
+		}
+
+		// Batched solvers: each lane solves its own system (and uses its own pivoting for LU)
+		{
+			matrix_stack<float, N, N> A[pack_lanes], G[pack_lanes];
+			numarray_stack<float, N> b[pack_lanes];
+			float_pack A_pack[N][N], G_pack[N][N], P_pack[N], xA[N], xG[N], xL[N];
+			for (int lane = 0; lane < pack_lanes; ++lane) {
+				A[lane] = random_spd<N>();
+				G[lane] = random_general<N>();
+				b[lane] = random_vector<N>();
+				set_lane(A_pack, lane, A[lane]);
+				set_lane(G_pack, lane, G[lane]);
+				set_lane(xA, lane, b[lane]);
+				set_lane(xG, lane, b[lane]);
+				set_lane(xL, lane, b[lane]);
+			}
+
+			float_pack LD_pack[N][N];
+			for (int i = 0; i < N; ++i)
+				for (int j = 0; j < N; ++j)
+					LD_pack[i][j] = A_pack[i][j];
+
+			mask_pack const valid_cholesky = cholesky_factorize(A_pack);
+			mask_pack const valid_ldlt = ldlt_factorize(LD_pack);
+			mask_pack const valid_lu = lu_factorize(G_pack, P_pack);
+			cholesky_solve(A_pack, xA);
+			ldlt_solve(LD_pack, xL);
+			lu_solve(G_pack, P_pack, xG);
+
+			for (int lane = 0; lane < pack_lanes; ++lane) {
+				assert_cgp_no_msg(valid_cholesky.data[lane] && valid_ldlt.data[lane] && valid_lu.data[lane]);
+				assert_cgp_no_msg(residual(A[lane], get_lane(xA, lane), b[lane]) < 1e-4f);
+				assert_cgp_no_msg(residual(A[lane], get_lane(xL, lane), b[lane]) < 1e-4f);
+				assert_cgp_no_msg(residual(G[lane], get_lane(xG, lane), b[lane]) < 1e-4f);
+			}
+		}
+	}
+
+	void test_factorization()
+	{
+		using namespace cgp;
+
+		test_factorization_size<3>();
+		test_factorization_size<6>();
+		test_factorization_size<12>();
+
+		// Failures are reported
+		{
+			float S[2][2] = { {1,2}, {2,1} }; // symmetric indefinite
+			assert_cgp_no_msg(cholesky_factorize(S) == false);
+
+			float Z[2][2] = { {1,2}, {2,4} }; // singular
+			float p[2] = {};
+			assert_cgp_no_msg(lu_factorize(Z, p) == false);
+		}
+	}
+}
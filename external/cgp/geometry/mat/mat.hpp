@@ -5,3 +5,5 @@
 #include "mat3/mat3.hpp"
 #include "mat4/mat4.hpp"
 #include "functions/mat_functions.hpp"
+#include "decomposition/decomposition.hpp"
+#include "factorization/factorization.hpp"
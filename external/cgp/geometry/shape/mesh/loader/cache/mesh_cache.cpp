@@ -0,0 +1,257 @@
+#include "mesh_cache.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "../obj/obj.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace cgp
+{
+	static_assert(sizeof(vec2) == 2 * sizeof(float) && sizeof(vec3) == 3 * sizeof(float) && sizeof(uint3) == 3 * sizeof(unsigned int), "The cache stores vectors as packed values");
+
+	namespace
+	{
+		char const cache_magic[8] = { 'C','G','P','M','E','S','H','\0' };
+		uint32_t const cache_version = 2;
+
+		enum cache_block { block_position, block_normal, block_color, block_uv, block_connectivity, block_one_ring_offset, block_one_ring_index, block_count };
+
+		struct cache_header
+		{
+			binary_file_signature signature;
+
+			// Description of the source file
+			uint64_t source_size;
+			int64_t source_time; // nanoseconds since epoch, or untrusted_time
+			uint64_t source_hash;
+
+			uint64_t N_vertex;
+			uint64_t N_triangle;
+			uint64_t N_one_ring; // total number of one-ring indices (0 if the topology is not stored)
+
+			// Position and size in octets of each block (size 0 if not stored)
+			uint64_t offset[block_count];
+			uint64_t size[block_count];
+		};
+
+		// One-ring neighborhood of the vertices in compressed format (offset + concatenated sorted indices)
+		void compute_one_ring(int N_vertex, numarray<uint3> const& connectivity, std::vector<int>& offset, std::vector<int>& index)
+		{
+			offset.assign(N_vertex + 1, 0);
+			for (uint3 const& tri : connectivity)
+				for (int k = 0; k < 3; ++k)
+					offset[tri[k] + 1] += 2;
+			for (int k = 0; k < N_vertex; ++k)
+				offset[k + 1] += offset[k];
+
+			std::vector<int> fill(offset.begin(), offset.end() - 1);
+			index.resize(offset[N_vertex]);
+			for (uint3 const& tri : connectivity)
+				for (int k = 0; k < 3; ++k) {
+					index[fill[tri[k]]++] = int(tri[(k + 1) % 3]);
+					index[fill[tri[k]]++] = int(tri[(k + 2) % 3]);
+				}
+
+			// Remove duplicates, and compact the indices
+			int current = 0;
+			for (int k = 0; k < N_vertex; ++k) {
+				auto const first = index.begin() + offset[k];
+				auto const last = index.begin() + offset[k + 1];
+				std::sort(first, last);
+				int const N_unique = int(std::unique(first, last) - first);
+				std::copy(first, first + N_unique, index.begin() + current);
+				offset[k] = current;
+				current += N_unique;
+			}
+			offset[N_vertex] = current;
+			index.resize(current);
+		}
+
+		// Modification times are stamped with a coarse clock (up to 2 seconds on some file systems), so a source modified shortly before the
+		//  cache is written may be modified again with the same time. Its time is then not trusted, and the next load compares the content.
+		int64_t const untrusted_time = std::numeric_limits<int64_t>::min();
+		int64_t const time_granularity = int64_t(2000000000);
+
+		int64_t trusted_modification_time(std::string const& source_filename)
+		{
+			int64_t const time = file_get_modification_time(source_filename);
+			int64_t const now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			return now - time < time_granularity ? untrusted_time : time;
+		}
+
+		// touched: same content as when the cache was created, but another modification time
+		enum class source_state { unchanged, touched, modified };
+
+		source_state source_compare(cache_header const& header, std::string const& source_filename)
+		{
+			if (source_filename.empty() || !check_file_exist(source_filename))
+				return source_state::unchanged;
+			if (file_get_size(source_filename) != header.source_size)
+				return source_state::modified;
+			if (file_get_modification_time(source_filename) == header.source_time)
+				return source_state::unchanged;
+			return file_hash(source_filename) == header.source_hash ? source_state::touched : source_state::modified;
+		}
+
+		// Store the new modification time of a touched source, such that the next loads don't hash it again
+		//  A failure is ignored: the cache stays valid, and the source is hashed again at the next load
+		void update_source_time(std::string const& cache_filename, int64_t source_time)
+		{
+			std::fstream stream(cache_filename, std::ios::in | std::ios::out | std::ios::binary);
+			if (!stream.is_open())
+				return;
+			stream.seekp(offsetof(cache_header, source_time));
+			stream.write(reinterpret_cast<char const*>(&source_time), sizeof(source_time));
+		}
+	}
+
+	// Return an empty string on success, otherwise the description of the error
+	static std::string mesh_write_file_cache(std::string const& cache_filename, mesh const& m, std::string const& source_filename, bool with_topology)
+	{
+		int const N_vertex = m.position.size();
+		int const N_triangle = m.connectivity.size();
+		assert_cgp(m.normal.size() == N_vertex && m.color.size() == N_vertex && m.uv.size() == N_vertex, "All per-vertex attributes must be filled before saving the mesh in cache (call fill_empty_field()): " + str(m));
+
+		std::vector<int> one_ring_offset, one_ring_index;
+		if (with_topology)
+			compute_one_ring(N_vertex, m.connectivity, one_ring_offset, one_ring_index);
+
+		cache_header header;
+		std::memset(&header, 0, sizeof(header));
+		header.signature = binary_file_signature_create(cache_magic, cache_version);
+		if (!source_filename.empty()) {
+			header.source_size = file_get_size(source_filename);
+			header.source_time = trusted_modification_time(source_filename);
+			header.source_hash = file_hash(source_filename);
+		}
+		header.N_vertex = N_vertex;
+		header.N_triangle = N_triangle;
+		header.N_one_ring = one_ring_index.size();
+
+		void const* block_data[block_count] = { m.position.data.data(), m.normal.data.data(), m.color.data.data(), m.uv.data.data(), m.connectivity.data.data(), one_ring_offset.data(), one_ring_index.data() };
+		header.size[block_position] = N_vertex * sizeof(vec3);
+		header.size[block_normal] = N_vertex * sizeof(vec3);
+		header.size[block_color] = N_vertex * sizeof(vec3);
+		header.size[block_uv] = N_vertex * sizeof(vec2);
+		header.size[block_connectivity] = N_triangle * sizeof(uint3);
+		header.size[block_one_ring_offset] = one_ring_offset.size() * sizeof(int);
+		header.size[block_one_ring_index] = one_ring_index.size() * sizeof(int);
+
+		uint64_t offset = binary_file_align(sizeof(cache_header));
+		for (int k = 0; k < block_count; ++k) {
+			header.offset[k] = offset;
+			offset = binary_file_align(offset + header.size[k]);
+		}
+
+		return file_write_atomic(cache_filename, [&](std::ostream& stream) {
+			uint64_t position = 0;
+			binary_file_write_block(stream, position, 0, &header, sizeof(header));
+			for (int k = 0; k < block_count; ++k)
+				binary_file_write_block(stream, position, header.offset[k], block_data[k], header.size[k]);
+		});
+	}
+
+	void mesh_save_file_cache(std::string const& cache_filename, mesh const& m, std::string const& source_filename, bool with_topology)
+	{
+		std::string const error = mesh_write_file_cache(cache_filename, m, source_filename, with_topology);
+		assert_cgp(error.empty(), error);
+	}
+
+
+	bool mesh_cache_view::open(std::string const& cache_filename, std::string const& source_filename)
+	{
+		*this = mesh_cache_view();
+		if (!check_file_exist(cache_filename) || file_get_size(cache_filename) < sizeof(cache_header))
+			return false;
+
+		file.open(cache_filename);
+		cache_header header;
+		std::memcpy(&header, file.data, sizeof(header));
+
+		bool valid = binary_file_signature_check(header.signature, cache_magic, cache_version, cache_filename, "mesh cache").empty();
+		valid = valid && header.size[block_position] == header.N_vertex * sizeof(vec3) && header.size[block_normal] == header.N_vertex * sizeof(vec3) && header.size[block_color] == header.N_vertex * sizeof(vec3) && header.size[block_uv] == header.N_vertex * sizeof(vec2);
+		valid = valid && header.size[block_connectivity] == header.N_triangle * sizeof(uint3);
+		valid = valid && (header.N_one_ring == 0 || header.size[block_one_ring_offset] == (header.N_vertex + 1) * sizeof(int));
+		valid = valid && header.size[block_one_ring_index] == header.N_one_ring * sizeof(int);
+		for (int k = 0; valid && k < block_count; ++k)
+			valid = header.offset[k] % binary_file_alignment == 0 && header.offset[k] + header.size[k] <= file.size;
+		source_state const source = valid ? source_compare(header, source_filename) : source_state::modified;
+		valid = valid && source != source_state::modified;
+
+		if (valid && source == source_state::touched) {
+			// The file is modified while it is not mapped (a mapped file cannot be written on Windows)
+			size_t const size = file.size;
+			file.close();
+			update_source_time(cache_filename, trusted_modification_time(source_filename));
+			file.open(cache_filename);
+			valid = file.size == size;
+		}
+
+		if (!valid) {
+			file.close();
+			return false;
+		}
+
+		N_vertex = int(header.N_vertex);
+		N_triangle = int(header.N_triangle);
+		position = reinterpret_cast<vec3 const*>(file.data + header.offset[block_position]);
+		normal = reinterpret_cast<vec3 const*>(file.data + header.offset[block_normal]);
+		color = reinterpret_cast<vec3 const*>(file.data + header.offset[block_color]);
+		uv = reinterpret_cast<vec2 const*>(file.data + header.offset[block_uv]);
+		connectivity = reinterpret_cast<uint3 const*>(file.data + header.offset[block_connectivity]);
+		if (header.size[block_one_ring_offset] > 0) {
+			one_ring_offset = reinterpret_cast<int const*>(file.data + header.offset[block_one_ring_offset]);
+			one_ring_index = reinterpret_cast<int const*>(file.data + header.offset[block_one_ring_index]);
+		}
+		return true;
+	}
+
+	bool mesh_cache_view::has_topology() const
+	{
+		return one_ring_offset != nullptr;
+	}
+
+	mesh mesh_cache_view::to_mesh() const
+	{
+		mesh m;
+		m.position.data.assign(position, position + N_vertex);
+		m.normal.data.assign(normal, normal + N_vertex);
+		m.color.data.assign(color, color + N_vertex);
+		m.uv.data.assign(uv, uv + N_vertex);
+		m.connectivity.data.assign(connectivity, connectivity + N_triangle);
+		return m;
+	}
+
+	numarray<numarray<int> > mesh_cache_view::one_ring() const
+	{
+		assert_cgp(has_topology(), "The cache doesn't store the one-ring topology");
+		numarray<numarray<int> > result(N_vertex);
+		for (int k = 0; k < N_vertex; ++k)
+			result[k].data.assign(one_ring_index + one_ring_offset[k], one_ring_index + one_ring_offset[k + 1]);
+		return result;
+	}
+
+
+	mesh mesh_load_file_obj_cached(std::string const& filename, std::string const& cache_filename_arg)
+	{
+		std::string const cache_filename = cache_filename_arg.empty() ? filename + ".cgpmesh" : cache_filename_arg;
+
+		mesh_cache_view view;
+		if (view.open(cache_filename, filename))
+			return view.to_mesh();
+
+		mesh const m = mesh_load_file_obj(filename);
+
+		// The mesh is loaded even if the cache cannot be written (read-only directory, full disk)
+		std::string const error = mesh_write_file_cache(cache_filename, m, filename, false);
+		if (!error.empty())
+			warning_cgp("Cannot write the mesh cache", error);
+		return m;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../../structure/mesh.hpp"
+#include "cgp/core/files/files.hpp"
+
+namespace cgp
+{
+	// Binary cache of mesh data, used to load large assets without parsing them
+	//
+	// File layout: a versioned header followed by data blocks aligned on 64 octets
+	//   position, normal, color, uv, connectivity, and optionally the one-ring topology of the vertices
+	// The header stores the size, modification time and content hash of the source file the cache was created from, such that outdated caches are detected.
+	// The cache stores raw values in the native representation of the machine (it is not meant to be shared between different architectures).
+
+	/** Save the mesh in a binary cache file
+	* - source_filename: file the mesh was loaded from (used to detect outdated caches), can be empty
+	* - with_topology: also store the one-ring neighborhood of each vertex */
+	void mesh_save_file_cache(std::string const& cache_filename, mesh const& m, std::string const& source_filename = "", bool with_topology = false);
+
+	/** Read-only view on a cache file mapped in memory
+	* The arrays point directly to the mapped file (no copy, no parsing), and remain valid as long as the view is alive */
+	struct mesh_cache_view
+	{
+		file_mapping file;
+		int N_vertex = 0;
+		int N_triangle = 0;
+
+		vec3 const* position = nullptr;
+		vec3 const* normal = nullptr;
+		vec3 const* color = nullptr;
+		vec2 const* uv = nullptr;
+		uint3 const* connectivity = nullptr;
+
+		// One-ring topology (nullptr if not stored): the neighbors of vertex k are one_ring_index[one_ring_offset[k] ... one_ring_offset[k+1]-1]
+		int const* one_ring_offset = nullptr;
+		int const* one_ring_index = nullptr;
+
+		/** Map the cache file
+		* Return false if the file doesn't exist, is not a valid cache of the current version, or is outdated with respect to the source file (if source_filename is not empty).
+		* The source is considered unchanged if its size and modification time are the same, or if its content has the same hash.
+		* The modification time of a source modified less than 2 seconds before the cache is written is not trusted (its content is compared at the next load).
+		* In the latter case, the new modification time is stored in the cache such that the source is not hashed again at the next load. */
+		bool open(std::string const& cache_filename, std::string const& source_filename = "");
+
+		bool has_topology() const;
+
+		/** Copy the data in a mesh structure */
+		mesh to_mesh() const;
+		/** Copy the one-ring topology (same format as connectivity_one_ring) */
+		numarray<numarray<int> > one_ring() const;
+	};
+
+	/** Load a mesh stored as .obj in the filename using a binary cache stored next to it (filename.cgpmesh by default)
+	* The cache is created at the first load, and rebuilt when the source file changes. 
+	* A cache that cannot be written only displays a warning.
+	* The result is the same as mesh_load_file_obj(filename). */
+	mesh mesh_load_file_obj_cached(std::string const& filename, std::string const& cache_filename = "");
+}
@@ -0,0 +1,126 @@
+#include "test_mesh_cache.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../mesh_cache.hpp"
+#include "../../obj/obj.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <utime.h>
+#endif
+
+namespace cgp_test
+{
+	void test_mesh_cache()
+	{
+		using namespace cgp;
+
+		std::string const obj_filename = "test_mesh_cache.obj";
+		std::string const cache_filename = "test_mesh_cache.obj.cgpmesh";
+		{
+			std::ofstream stream(obj_filename);
+			stream << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nf 1/1 2/2 3/3 4/4\n";
+		}
+		std::remove(cache_filename.c_str());
+
+		// First load creates the cache, second load reads it
+		mesh const reference = mesh_load_file_obj(obj_filename);
+		mesh const m0 = mesh_load_file_obj_cached(obj_filename);
+		assert_cgp_no_msg(check_file_exist(cache_filename));
+		mesh const m1 = mesh_load_file_obj_cached(obj_filename);
+		for (mesh const* m : { &m0, &m1 }) {
+			assert_cgp_no_msg(m->position.size() == 4 && m->connectivity.size() == 2);
+			for (int k = 0; k < 4; ++k) {
+				assert_cgp_no_msg(is_equal(m->position[k], reference.position[k]));
+				assert_cgp_no_msg(is_equal(m->uv[k], reference.uv[k]));
+				assert_cgp_no_msg(is_equal(m->normal[k], reference.normal[k]));
+			}
+			for (int k = 0; k < 2; ++k)
+				assert_cgp_no_msg(is_equal(m->connectivity[k], reference.connectivity[k]));
+		}
+
+		// Zero-copy view with topology
+		mesh_save_file_cache(cache_filename, reference, obj_filename, true);
+		{
+			mesh_cache_view view;
+			assert_cgp_no_msg(view.open(cache_filename, obj_filename));
+			assert_cgp_no_msg(view.N_vertex == 4 && view.N_triangle == 2 && view.has_topology());
+			assert_cgp_no_msg(reinterpret_cast<size_t>(view.position) % 64 == 0);
+			assert_cgp_no_msg(is_equal(view.position[2], reference.position[2]));
+
+			numarray<numarray<int> > const one_ring = view.one_ring();
+			for (int k = 0; k < 4; ++k) {
+				int const N_neighbor = (k == 0 || k == 2) ? 3 : 2; // vertices 0 and 2 are shared by both triangles
+				assert_cgp_no_msg(one_ring[k].size() == N_neighbor);
+				for (int j : one_ring[k])
+					assert_cgp_no_msg(j != k && j >= 0 && j < 4);
+			}
+		}
+
+#if defined(__unix__) || defined(__APPLE__)
+		// Touching the source keeps the cache valid, and stores the new modification time in the cache
+		{
+			utimbuf const times = { 1000000, 1000000 };
+			assert_cgp_no_msg(utime(obj_filename.c_str(), &times) == 0);
+			size_t const cache_size = file_get_size(cache_filename);
+			{
+				mesh_cache_view view;
+				assert_cgp_no_msg(view.open(cache_filename, obj_filename));
+				assert_cgp_no_msg(view.N_vertex == 4 && is_equal(view.position[2], reference.position[2]));
+			}
+			int64_t source_time = 0;
+			std::ifstream stream(cache_filename, std::ios::binary);
+			stream.seekg(24); // after the signature and the size of the source
+			stream.read(reinterpret_cast<char*>(&source_time), sizeof(source_time));
+			assert_cgp_no_msg(source_time == int64_t(1000000) * 1000000000 && file_get_size(cache_filename) == cache_size);
+		}
+#endif
+
+		// Modifying the source invalidates the cache
+		{
+			std::ofstream stream(obj_filename, std::ios::app);
+			stream << "v 2 2 2\n";
+		}
+		{
+			mesh_cache_view view;
+			assert_cgp_no_msg(!view.open(cache_filename, obj_filename));
+			assert_cgp_no_msg(view.open(cache_filename));
+		}
+		mesh const m2 = mesh_load_file_obj_cached(obj_filename);
+		{
+			mesh_cache_view view;
+			assert_cgp_no_msg(view.open(cache_filename, obj_filename));
+			assert_cgp_no_msg(view.N_vertex == m2.position.size());
+		}
+
+		// A cache that cannot be written doesn't prevent the load
+		{
+			mesh const m3 = mesh_load_file_obj_cached(obj_filename, "missing_directory/test_mesh_cache.cgpmesh");
+			assert_cgp_no_msg(m3.position.size() == m2.position.size() && m3.connectivity.size() == m2.connectivity.size());
+		}
+
+		// A source rewritten with the same size right after the cache was created (same modification time on a coarse clock) is detected
+		{
+			std::ofstream(obj_filename) << "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\n";
+			mesh const before = mesh_load_file_obj_cached(obj_filename);
+			std::ofstream(obj_filename) << "v 0 0 0\nv 2 0 0\nv 1 1 0\nf 1 2 3\n";
+			mesh const after = mesh_load_file_obj_cached(obj_filename);
+			assert_cgp_no_msg(is_equal(before.position[1], vec3(1, 0, 0)) && is_equal(after.position[1], vec3(2, 0, 0)));
+		}
+
+		// Corrupted file is rejected
+		{
+			std::ofstream stream(cache_filename, std::ios::binary | std::ios::trunc);
+			stream << "not a cache";
+		}
+		{
+			mesh_cache_view view;
+			assert_cgp_no_msg(!view.open(cache_filename));
+		}
+
+		std::remove(obj_filename.c_str());
+		std::remove(cache_filename.c_str());
+	}
+}
@@ -10,7 +10,9 @@
 #include "cgp/core/base/base.hpp"
 #include "cgp/core/files/files.hpp"
 
-#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
 
 #include <fstream>
 #include <sstream>
@@ -69,31 +71,45 @@ namespace cgp
     }
 
 
-// Comparator of triplet of integer for std::map
-struct comparator_int3 {
-    long int N; // number of vertices
+namespace loader {
 
-    comparator_int3(int N_arg=0) :N(N_arg) {}
+    // Content of an OBJ file parsed in a single pass
+    struct obj_content {
+        numarray<vec3> position;
+        numarray<vec2> texture_uv;
+        numarray<vec3> normal;
+        numarray<int3> face_vertex;  // (position, texture, normal) index of all the vertices of all the faces (0-based, -1 if undefined)
+        numarray<int> face_offset;   // face k is made of the vertices [face_offset[k], face_offset[k+1])
+    };
 
-    // compute a<b
-    bool operator()(int3 const& a, int3 const& b) const
+    static obj_content obj_read_content(std::string const& filename);
+}
+
+
+// Hash of a triplet (position, texture, normal) of indices
+struct hash_int3 {
+    size_t operator()(int3 const& a) const
     {
-        long int const offset_a = long(a[0]) + N*(long(a[1]) + N*long(a[2]));
-        long int const offset_b = long(b[0]) + N*(long(b[1]) + N*long(b[2]));
-        return offset_a < offset_b;
+        uint64_t h = uint64_t(uint32_t(a[0]));
+        h = h * 0x9E3779B97F4A7C15ull + uint64_t(uint32_t(a[1]));
+        h = h * 0x9E3779B97F4A7C15ull + uint64_t(uint32_t(a[2]));
+        return size_t(h ^ (h >> 29));
     }
 };
+struct equal_int3 {
+    bool operator()(int3 const& a, int3 const& b) const { return a[0] == b[0] && a[1] == b[1] && a[2] == b[2]; }
+};
 
 
-static numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces);
+static numarray<numarray_stack<int3,3>> triangulate_faces(numarray<int3> const& face_vertex, numarray<int> const& face_offset);
 
 
-static std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
+static mesh make_unique_parameter_per_value(numarray<vec3> const& positions,
                                     numarray<vec2> const& texture_uv,
                                     numarray<vec3> const& normals,
                                     numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type);
+                                    loader::obj_type const type,
+                                    numarray<numarray<int> >& vertex_correspondance);
 
 
 mesh mesh_load_file_obj(const std::string& filename)
@@ -105,87 +121,81 @@ mesh mesh_load_file_obj(const std::string& filename)
 }
 mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >& vertex_correspondance)
 {
-    assert_file_exist(filename);
-
-    // Load parameters
-    numarray<vec3> positions = loader::obj_read_positions(filename);
-    numarray<vec2> texture_uv = loader::obj_read_texture_uv(filename);
-    numarray<vec3> normals = loader::obj_read_normals(filename);
+    // Load all the data of the file in a single pass
+    loader::obj_content const content = loader::obj_read_content(filename);
 
-    assert_cgp(positions.size()>0, str("File ")+filename+" has 0 vertices");
+    assert_cgp(content.position.size()>0, str("File ")+filename+" has 0 vertices");
 
     // set obj type
     loader::obj_type type = loader::obj_type::vertex;
-    if(texture_uv.size()>0 && normals.size()>0)
+    if(content.texture_uv.size()>0 && content.normal.size()>0)
         type = loader::obj_type::vertex_texture_normal;
-    else if( texture_uv.size()>0 )
+    else if( content.texture_uv.size()>0 )
         type = loader::obj_type::vertex_texture;
-    else if( normals.size()>0 )
+    else if( content.normal.size()>0 )
         type = loader::obj_type::vertex_normal;
 
-    // Load connectivity and triangulate
-    numarray<numarray_stack<int3,3>> faces = triangulate_faces( loader::obj_read_faces(filename, type) );
+    // Triangulate
+    numarray<numarray_stack<int3,3>> const faces = triangulate_faces(content.face_vertex, content.face_offset);
 
     // Set unique per-vertex value for texture and normals (duplicate vertices if necessary)
-    mesh m;
-    std::map<int3, int, comparator_int3> connectivity_map;
-    std::tie(m,connectivity_map) = make_unique_parameter_per_value(positions, texture_uv, normals, faces, type);
-
-    // Retrieve correspondance between initial vertices in files and new ones
-    vertex_correspondance.resize(positions.size());
-    for(auto const& it : connectivity_map)
-    {
-        int const vertex_in = it.first[0];
-        int const vertex_out = it.second;
-
-        vertex_correspondance[vertex_in].push_back(vertex_out);
-    }
-
-    return m;
+    //  and retrieve correspondance between initial vertices in files and new ones
+    return make_unique_parameter_per_value(content.position, content.texture_uv, content.normal, faces, type, vertex_correspondance);
 }
 
 
-numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces)
+numarray<numarray_stack<int3,3>> triangulate_faces(numarray<int3> const& face_vertex, numarray<int> const& face_offset)
 {
-    numarray<numarray_stack<int3,3>> faces_triangulation;
-    size_t const N_face = faces.size();
-    for(size_t k_face=0; k_face<N_face; ++k_face)
-    {
-        numarray<int3> const& current_polygon = faces[k_face];
-        int const N_polygon = int(current_polygon.size());
+    int const N_face = face_offset.size()-1;
 
-        for(int k=0; k<N_polygon-2; ++k) {
-            // triangulation
-            int3 const& f0 = current_polygon[0];
-            int3 const& f1 = current_polygon[k+1];
-            int3 const& f2 = current_polygon[k+2];
+    // Offset of the first triangle of each face
+    numarray<int> triangle_offset(N_face+1);
+    triangle_offset[0] = 0;
+    for(int k_face=0; k_face<N_face; ++k_face)
+        triangle_offset[k_face+1] = triangle_offset[k_face] + std::max(face_offset[k_face+1]-face_offset[k_face]-2, 0);
 
-            faces_triangulation.push_back({f0,f1,f2});
-        }
+    numarray<numarray_stack<int3,3>> faces_triangulation(triangle_offset[N_face]);
+    #pragma omp parallel for
+    for(int k_face=0; k_face<N_face; ++k_face)
+    {
+        int const first = face_offset.at_unsafe(k_face);
+        int const N_polygon = face_offset.at_unsafe(k_face+1) - first;
+        for(int k=0; k<N_polygon-2; ++k)
+            faces_triangulation.at_unsafe(triangle_offset.at_unsafe(k_face)+k) = { face_vertex.at_unsafe(first), face_vertex.at_unsafe(first+k+1), face_vertex.at_unsafe(first+k+2) };
     }
     return faces_triangulation;
 }
 
-std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
+mesh make_unique_parameter_per_value(numarray<vec3> const& positions,
                                     numarray<vec2> const& texture_uv,
                                     numarray<vec3> const& normals,
                                     numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type)
+                                    loader::obj_type const type,
+                                    numarray<numarray<int> >& vertex_correspondance)
 {
+    bool const use_texture = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture;
+    bool const use_normal = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal;
+
     mesh m;
-    comparator_int3 comparator(int(positions.size()));
-    std::map<int3, int, comparator_int3> connectivity_map(comparator); // stores map between original face index and final offset
+    size_t const N_triangle = faces.size();
+    std::unordered_map<int3, int, hash_int3, equal_int3> connectivity_map; // stores map between original face index and final offset
+    connectivity_map.reserve(positions.size());
+    m.connectivity.resize(N_triangle);
 
+    vertex_correspondance.clear();
+    vertex_correspondance.resize(positions.size());
 
-    size_t const N_triangle = faces.size();
     for(size_t k_triangle=0; k_triangle<N_triangle; ++k_triangle)
     {
         numarray_stack<int3,3> const& tri = faces[k_triangle];
         uint3 new_triangle_index;
         for(int k=0; k<3; ++k)
         {
-            int3 const& index = tri[k];
+            // Only the indices used by the type of the file identify a vertex
+            int3 index = tri[k];
+            if(!use_texture) index[1] = -1;
+            if(!use_normal) index[2] = -1;
+
             auto const it = connectivity_map.find( index );
             if( it==connectivity_map.end() ) {
 
@@ -195,17 +205,18 @@ std::pair<mesh, std::map<int3, int, comparator_int3>>
 
                 int const idx_position = index[0];
 
-                assert_cgp_no_msg( idx_position<int(positions.size()));
+                assert_cgp_no_msg( idx_position>=0 && idx_position<int(positions.size()));
                 m.position.push_back( positions[idx_position] );
+                vertex_correspondance[idx_position].push_back(int(offset));
 
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture) {
+                if(use_texture) {
                     int const idx_uv = index[1];
-                    assert_cgp_no_msg( idx_uv<int(texture_uv.size()) );
+                    assert_cgp_no_msg( idx_uv>=0 && idx_uv<int(texture_uv.size()) );
                     m.uv.push_back( texture_uv[ idx_uv ] );
                 }
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal) {
+                if(use_normal) {
                     int const idx_normal = index[2];
-                    assert_cgp_no_msg( idx_normal<int(normals.size()) );
+                    assert_cgp_no_msg( idx_normal>=0 && idx_normal<int(normals.size()) );
                     m.normal.push_back( normals[idx_normal] );
                 }
 
@@ -213,207 +224,246 @@ std::pair<mesh, std::map<int3, int, comparator_int3>>
             else
                 new_triangle_index[k] = it->second;
         }
-        m.connectivity.push_back(new_triangle_index);
+        m.connectivity[k_triangle] = new_triangle_index;
     }
 
-    return {m, connectivity_map};
+    return m;
 }
 
 
 namespace loader{
-std::vector<vec3> obj_read_positions(const std::string& filename)
+
+// Data parsed from a contiguous set of lines of the file
+struct obj_chunk {
+    std::vector<vec3> position;
+    std::vector<vec2> texture_uv;
+    std::vector<vec3> normal;
+    std::vector<int3> face_vertex;
+    std::vector<int> face_size;
+    // Relative (negative) indices refer to the elements read before the line: they can only be resolved once the chunks are merged
+    //  (corner index in face_vertex, component)
+    std::vector<std::pair<int,int>> relative_index;
+    // First face index that is a number out of the range of int (nullptr if none), reported once the chunks are parsed
+    char const* invalid_index = nullptr;
+};
+
+// True if the text starts with an integer (optional sign followed by a digit)
+static bool obj_starts_with_integer(char const* p, char const* end)
 {
-    assert_file_exist(filename);
-    std::vector<vec3> positions;
-
-    std::ifstream stream(filename);
-    assert_cgp(stream.is_open(), "Cannot open file "+str(filename));
-    while(stream.good()) {
-        std::string buffer;
-        std::getline(stream,buffer);
-        if( buffer.size()>0 )
-        {
-            std::stringstream tokens_buffer(buffer);
-            std::string first_word;
-            tokens_buffer >> first_word;
-            if( first_word.size()>0 && first_word[0]!='#' ) {
-                if( first_word=="v" ) {
-                    vec3 p;
-                    tokens_buffer >> p.x >> p.y >> p.z;
-                    positions.push_back(p);
-                }
-            }
-        }
-    }
-    stream.close();
-    assert_cgp(!stream.is_open(), "Cannot close file "+str(filename));
-    return positions;
+    if(p<end && (*p=='-' || *p=='+'))
+        ++p;
+    return p<end && *p>='0' && *p<='9';
 }
 
-std::vector<vec3> obj_read_normals(const std::string& filename)
+// Parse a face vertex "v", "v/t", "v//n" or "v/t/n"
+//  Absolute indices are converted to 0-based indices, relative indices are converted to an index relative to the start of the chunk
+static bool obj_parse_face_vertex(char const*& p, char const* end, obj_chunk& chunk)
 {
-    assert_file_exist(filename);
-    std::vector<vec3> normals;
-
-    std::ifstream stream(filename);
-    assert_cgp(stream.is_open(), "Cannot open file "+str(filename));
-    while(stream.good()) {
-        std::string buffer;
-        std::getline(stream,buffer);
-        if( buffer.size()>0 )
-        {
-            std::stringstream tokens_buffer(buffer);
-            std::string first_word;
-            tokens_buffer >> first_word;
-            if( first_word.size()>0 && first_word[0]!='#' ) {
-                if( first_word=="vn" ) {
-                    vec3 n;
-                    tokens_buffer >> n.x >> n.y >> n.z;
-                    normals.push_back(n);
-                }
-            }
+    int3 index = {-1,-1,-1};
+    bool is_relative[3] = {false,false,false};
+    int const count[3] = { int(chunk.position.size()), int(chunk.texture_uv.size()), int(chunk.normal.size()) };
+
+    for(int k=0; k<3; ++k) {
+        if(k>0) {
+            if(p==end || *p!='/')
+                break;
+            ++p;
+        }
+        int value = 0;
+        if(parse_int(p, end, value)) {
+            is_relative[k] = value<0;
+            index[k] = value<0 ? count[k]+value : value-1;
         }
+        else if(obj_starts_with_integer(p, end)) {
+            if(chunk.invalid_index==nullptr)
+                chunk.invalid_index = p;
+            return false;
+        }
+        else if(k==0)
+            return false;
     }
-    stream.close();
-    assert_cgp(!stream.is_open(), "Cannot close file "+str(filename));
-    return normals;
+    p = parse_skip_word(p, end);
+
+    int const corner = int(chunk.face_vertex.size());
+    chunk.face_vertex.push_back(index);
+    for(int k=0; k<3; ++k)
+        if(is_relative[k])
+            chunk.relative_index.push_back({corner, k});
+    return true;
 }
 
-std::vector<vec2> obj_read_texture_uv(const std::string& filename)
+static void obj_parse_chunk(char const* p, char const* end, obj_chunk& chunk)
 {
-    assert_file_exist(filename);
-    std::vector<vec2> texture_uv;
+    while(p<end)
+    {
+        char const* const line_end = parse_line_end(p, end);
+        char const* s = parse_skip_spaces(p, line_end);
 
-    std::ifstream stream(filename);
-    assert_cgp(stream.is_open(), "Cannot open file "+str(filename));
-    while(stream.good()) {
-        std::string buffer;
-        std::getline(stream,buffer);
-        if( buffer.size()>0 )
+        if(s+1<line_end && s[0]=='v')
         {
-            std::stringstream tokens_buffer(buffer);
-            std::string first_word;
-            tokens_buffer >> first_word;
-            if( first_word.size()>0 && first_word[0]!='#' ) {
-                if( first_word=="vt" ) {
-                    vec2 uv;
-                    tokens_buffer >> uv.x >> uv.y;
-                    texture_uv.push_back( {uv.x, uv.y} );
-                }
+            if(s[1]==' ' || s[1]=='\t') {
+                s += 1;
+                vec3 v = {0,0,0};
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, v.x);
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, v.y);
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, v.z);
+                chunk.position.push_back(v);
+            }
+            else if(s[1]=='t' && s+2<line_end && (s[2]==' ' || s[2]=='\t')) {
+                s += 2;
+                vec2 uv = {0,0};
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, uv.x);
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, uv.y);
+                chunk.texture_uv.push_back(uv);
+            }
+            else if(s[1]=='n' && s+2<line_end && (s[2]==' ' || s[2]=='\t')) {
+                s += 2;
+                vec3 n = {0,0,0};
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, n.x);
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, n.y);
+                parse_float(s=parse_skip_spaces(s,line_end), line_end, n.z);
+                chunk.normal.push_back(n);
             }
         }
+        else if(s+1<line_end && s[0]=='f' && (s[1]==' ' || s[1]=='\t'))
+        {
+            s += 1;
+            int N_vertex = 0;
+            while(true) {
+                s = parse_skip_spaces(s, line_end);
+                if(s==line_end || *s=='#' || !obj_parse_face_vertex(s, line_end, chunk))
+                    break;
+                N_vertex++;
+            }
+            chunk.face_size.push_back(N_vertex);
+        }
+
+        p = line_end<end ? line_end+1 : end;
     }
-    stream.close();
-    assert_cgp(!stream.is_open(), "Cannot close file "+str(filename));
-    return texture_uv;
 }
 
-
-std::vector<uint3> obj_read_connectivity(const std::string& filename)
+obj_content obj_read_content(std::string const& filename)
 {
-    assert_file_exist(filename);
+    file_mapping const file(filename);
+    char const* const begin = file.begin();
+    char const* const end = file.end();
+
+    // Split the file in chunks starting at the beginning of a line, and parse them in parallel
+    size_t const chunk_size = size_t(1) << 20;
+    int const N_chunk = int(std::min<size_t>(file.size/chunk_size + 1, 4096));
+    std::vector<char const*> chunk_begin(N_chunk+1);
+    chunk_begin[0] = begin;
+    chunk_begin[N_chunk] = end;
+    for(int k=1; k<N_chunk; ++k) {
+        char const* p = begin + file.size/N_chunk*k;
+        p = std::max(p, chunk_begin[k-1]);
+        char const* const line_end = parse_line_end(p, end);
+        chunk_begin[k] = line_end<end ? line_end+1 : end;
+    }
 
-    std::vector<uint3> connectivity;
+    std::vector<obj_chunk> chunks(N_chunk);
+    #pragma omp parallel for schedule(dynamic)
+    for(int k=0; k<N_chunk; ++k)
+        obj_parse_chunk(chunk_begin[k], chunk_begin[k+1], chunks[k]);
 
-    // Open file
-    std::ifstream stream(filename);
-    assert_cgp(stream.is_open(), "Cannot open file "+str(filename));
+    for(obj_chunk const& chunk : chunks) {
+        if(chunk.invalid_index!=nullptr) {
+            int const line = 1 + int(std::count(begin, chunk.invalid_index, '\n'));
+            error_cgp("File " + filename + " line " + str(line) + ": face index " + std::string(chunk.invalid_index, parse_skip_word(chunk.invalid_index, end)) + " is out of the range of int");
+        }
+    }
 
+    // Merge the chunks
+    std::vector<int3> offset(N_chunk+1, int3{0,0,0});
+    std::vector<int> offset_face(N_chunk+1, 0), offset_face_vertex(N_chunk+1, 0);
+    for(int k=0; k<N_chunk; ++k) {
+        offset[k+1] = offset[k] + int3{int(chunks[k].position.size()), int(chunks[k].texture_uv.size()), int(chunks[k].normal.size())};
+        offset_face[k+1] = offset_face[k] + int(chunks[k].face_size.size());
+        offset_face_vertex[k+1] = offset_face_vertex[k] + int(chunks[k].face_vertex.size());
+    }
 
-    while(stream.good())
-    {
-        std::string buffer;
-        std::getline(stream,buffer);
+    obj_content content;
+    content.position.resize(offset[N_chunk][0]);
+    content.texture_uv.resize(offset[N_chunk][1]);
+    content.normal.resize(offset[N_chunk][2]);
+    content.face_vertex.resize(offset_face_vertex[N_chunk]);
+    content.face_offset.resize(offset_face[N_chunk]+1);
+    content.face_offset[offset_face[N_chunk]] = offset_face_vertex[N_chunk];
 
-        if( buffer.size()>0 )
-        {
-            std::stringstream tokens_buffer(buffer);
-            std::string first_word;
-            tokens_buffer >> first_word;
-
-            if( first_word.size()>0 && first_word[0]!='#' )
-            {
-                if(first_word=="f")
-                {
-                    std::array<std::string,3> s;
-                    tokens_buffer >> s[0] >> s[1] >> s[2];
-
-                    uint3 f;
-                    for(int k=0; k<3; ++k)
-                        f[k] = std::stoi(s[k])-1;
-
-                    connectivity.push_back(f);
-                }
-            }
+    #pragma omp parallel for schedule(dynamic)
+    for(int k=0; k<N_chunk; ++k)
+    {
+        obj_chunk& chunk = chunks[k];
+        std::copy(chunk.position.begin(), chunk.position.end(), content.position.data.begin()+offset[k][0]);
+        std::copy(chunk.texture_uv.begin(), chunk.texture_uv.end(), content.texture_uv.data.begin()+offset[k][1]);
+        std::copy(chunk.normal.begin(), chunk.normal.end(), content.normal.data.begin()+offset[k][2]);
+
+        for(auto const& r : chunk.relative_index)
+            chunk.face_vertex[r.first][r.second] += offset[k][r.second];
+        std::copy(chunk.face_vertex.begin(), chunk.face_vertex.end(), content.face_vertex.data.begin()+offset_face_vertex[k]);
+
+        int current = offset_face_vertex[k];
+        for(size_t k_face=0; k_face<chunk.face_size.size(); ++k_face) {
+            content.face_offset.at_unsafe(offset_face[k]+int(k_face)) = current;
+            current += chunk.face_size[k_face];
         }
-    }
-
 
+        chunk = obj_chunk(); // release memory
+    }
 
-    stream.close();
-    assert_cgp(!stream.is_open(), "Cannot close file "+str(filename));
+    return content;
+}
 
-    return connectivity;
+std::vector<vec3> obj_read_positions(const std::string& filename)
+{
+    return obj_read_content(filename).position.data;
 }
 
-int3 extract_face_index(std::string const& word, obj_type const type)
+std::vector<vec3> obj_read_normals(const std::string& filename)
 {
-    int3 indices = {0,0,0};
+    return obj_read_content(filename).normal.data;
+}
 
+std::vector<vec2> obj_read_texture_uv(const std::string& filename)
+{
+    return obj_read_content(filename).texture_uv.data;
+}
 
-    if(type == obj_type::vertex)
-        sscanf(word.c_str(), "%d", &indices[0]);
-    else if( type==obj_type::vertex_texture )
-        sscanf(word.c_str(), "%d/%d", &indices[0], &indices[1]);
-    else if( type==obj_type::vertex_normal )
-        sscanf(word.c_str(), "%d//%d", &indices[0], &indices[2]);
-    else if( type==obj_type::vertex_texture_normal )
-        sscanf(word.c_str(), "%d/%d/%d", &indices[0], &indices[1], &indices[2]);
 
-    for(int k=0; k<3; ++k)
-        indices[k]--;    // obj indices starts at 1
+std::vector<uint3> obj_read_connectivity(const std::string& filename)
+{
+    obj_content const content = obj_read_content(filename);
 
-    return indices;
+    // Position index of the first three vertices of each face
+    std::vector<uint3> connectivity;
+    int const N_face = content.face_offset.size()-1;
+    for(int k_face=0; k_face<N_face; ++k_face) {
+        int const first = content.face_offset[k_face];
+        if(content.face_offset[k_face+1]-first >= 3)
+            connectivity.push_back({ (unsigned int)content.face_vertex[first][0], (unsigned int)content.face_vertex[first+1][0], (unsigned int)content.face_vertex[first+2][0] });
+    }
 
+    return connectivity;
 }
 
 
 numarray<numarray<int3>> obj_read_faces(const std::string& filename, obj_type const type)
 {
-    assert_file_exist(filename);
-    numarray<numarray<int3>> faces;
-
-    std::ifstream stream(filename);
-    assert_cgp(stream.is_open(), "Cannot open file "+str(filename));
-    while(stream.good()) {
-        std::string buffer;
-        std::getline(stream,buffer);
-        if( buffer.size()>0 )
-        {
-            std::stringstream tokens_buffer(buffer);
-            std::string first_word;
-            tokens_buffer >> first_word;
-            if( first_word.size()>0 && first_word[0]!='#' ) {
-                if( first_word=="f" ) {
-
-                    std::string word;
-                    cgp::numarray<int3> current_face;
-                    while(tokens_buffer) {
-                        tokens_buffer >> word;
-
-                        if(tokens_buffer){
-                            int3 face_index = extract_face_index(word, type);
-                            current_face.push_back(face_index);
-                        }
-                    }
-                    faces.push_back(current_face);
-
-                }
-            }
+    obj_content const content = obj_read_content(filename);
+
+    bool const use_texture = type==obj_type::vertex_texture_normal || type==obj_type::vertex_texture;
+    bool const use_normal = type==obj_type::vertex_texture_normal || type==obj_type::vertex_normal;
+
+    int const N_face = content.face_offset.size()-1;
+    numarray<numarray<int3>> faces(N_face);
+    for(int k_face=0; k_face<N_face; ++k_face) {
+        for(int k=content.face_offset[k_face]; k<content.face_offset[k_face+1]; ++k) {
+            int3 index = content.face_vertex[k];
+            if(!use_texture) index[1] = -1;
+            if(!use_normal) index[2] = -1;
+            faces[k_face].push_back(index);
         }
     }
-    stream.close();
-    assert_cgp(!stream.is_open(), "Cannot close file "+str(filename));
 
     return faces;
 }
@@ -0,0 +1,138 @@
+#include "test_obj.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "../obj.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+
+namespace cgp_test
+{
+	static bool parse_float_match(std::string const& text)
+	{
+		float value = 0.0f;
+		char const* p = text.data();
+		bool const ok = cgp::parse_float(p, text.data() + text.size(), value);
+		float const expected = std::strtof(text.c_str(), nullptr);
+		if (std::isnan(expected))
+			return ok && std::isnan(value);
+		return ok && p == text.data() + text.size() && (value == expected || std::abs(value - expected) <= 1e-7f * std::abs(expected));
+	}
+
+	void test_obj()
+	{
+		using namespace cgp;
+
+		// Number parsing
+		{
+			char const* const values[] = { "0", "-0", "1", "-2.5", "+3.25", "0.1", "123456.789", "1e-3", "-4.5E+6", "3.4028234e38", "1.17549435e-38", "0.000000000000000000000000001234", "12345678901234567890123", "inf", "-inf", "nan" };
+			for (char const* v : values)
+				assert_cgp_no_msg(parse_float_match(v));
+
+			std::string const text = "12 -7/3 x";
+			char const* p = text.data();
+			char const* const end = text.data() + text.size();
+			int a = 0, b = 0, c = 0;
+			float f = 0;
+			assert_cgp_no_msg(parse_int(p, end, a) && a == 12);
+			p = parse_skip_spaces(p, end);
+			assert_cgp_no_msg(parse_int(p, end, b) && b == -7 && *p == '/');
+			++p;
+			assert_cgp_no_msg(parse_int(p, end, c) && c == 3);
+			p = parse_skip_spaces(p, end);
+			assert_cgp_no_msg(!parse_float(p, end, f) && *p == 'x');
+
+			// Limits of int, and overflow reported as a failure
+			std::string const limits = "2147483647 -2147483648 2147483648 -2147483649 99999999999999999999";
+			p = limits.data();
+			char const* const limits_end = limits.data() + limits.size();
+			assert_cgp_no_msg(parse_int(p, limits_end, a) && a == 2147483647);
+			p = parse_skip_spaces(p, limits_end);
+			assert_cgp_no_msg(parse_int(p, limits_end, a) && a == -2147483647 - 1);
+			for (int k = 0; k < 3; ++k) {
+				p = parse_skip_spaces(p, limits_end);
+				char const* const start = p;
+				assert_cgp_no_msg(!parse_int(p, limits_end, a) && p == start);
+				p = parse_skip_word(p, limits_end);
+			}
+		}
+
+		// OBJ file with polygons, comments, relative indices and CRLF line endings
+		std::string const filename = "cgp_test_obj.obj";
+		{
+			std::ofstream stream(filename, std::ios::binary);
+			stream << "# test file\r\n"
+				<< "o square\r\n"
+				<< "v 0 0 0\r\nv 1 0 0\r\nv 1 1 0\r\nv 0 1 0 # comment\r\n"
+				<< "vt 0 0\r\nvt 1 0\r\nvt 1 1\r\nvt 0 1\r\n"
+				<< "vn 0 0 1\r\n"
+				<< "s off\r\n"
+				<< "f 1/1/1 2/2/1 3/3/1 4/4/1\r\n"
+				<< "v 2 0 0\r\n"
+				<< "vt 0.5 0.5\r\n"
+				<< "f -4/-4/-1 -1/-1/-1 -3/3/1\r\n"
+				<< "f 2/2/1 5/5/1 3/2/1"; // no final new line
+		}
+
+		{
+			numarray<numarray<int>> correspondance;
+			mesh const m = mesh_load_file_obj(filename, correspondance);
+
+			assert_cgp_no_msg(m.connectivity.size() == 4);
+			// vertex 3 is used with two different uv: duplicated
+			assert_cgp_no_msg(m.position.size() == 6);
+			assert_cgp_no_msg(m.uv.size() == 6 && m.normal.size() == 6);
+			assert_cgp_no_msg(correspondance.size() == 5);
+			assert_cgp_no_msg(correspondance[2].size() == 2);
+
+			for (int k_tri = 0; k_tri < m.connectivity.size(); ++k_tri)
+				for (int k = 0; k < 3; ++k)
+					assert_cgp_no_msg(norm(m.normal[m.connectivity[k_tri][k]] - vec3{ 0,0,1 }) < 1e-6f);
+
+			// triangle (2,5,3) with relative indices (-4,-1,-3) = (2,5,3)
+			uint3 const t1 = m.connectivity[2];
+			assert_cgp_no_msg(norm(m.position[t1[0]] - vec3{ 1,0,0 }) < 1e-6f);
+			assert_cgp_no_msg(norm(m.position[t1[1]] - vec3{ 2,0,0 }) < 1e-6f);
+			assert_cgp_no_msg(norm(m.position[t1[2]] - vec3{ 1,1,0 }) < 1e-6f);
+			assert_cgp_no_msg(norm(m.uv[t1[1]] - vec2{ 0.5f,0.5f }) < 1e-6f);
+
+			assert_cgp_no_msg(loader::obj_read_positions(filename).size() == 5);
+			assert_cgp_no_msg(loader::obj_read_texture_uv(filename).size() == 5);
+			assert_cgp_no_msg(loader::obj_read_normals(filename).size() == 1);
+			assert_cgp_no_msg(loader::obj_read_faces(filename, loader::obj_type::vertex_texture_normal).size() == 3);
+			assert_cgp_no_msg(loader::obj_read_connectivity(filename).size() == 3);
+		}
+
+		// Large file split in several chunks parsed in parallel
+		{
+			int const N = 300;
+			{
+				std::ofstream stream(filename, std::ios::binary);
+				for (int i = 0; i < N; ++i)
+					for (int j = 0; j < N; ++j)
+						stream << "v " << i / float(N) << " " << j / float(N) << " " << 0.001f * (i * j % 7) << "\n";
+				for (int i = 0; i < N - 1; ++i)
+					for (int j = 0; j < N - 1; ++j)
+						stream << "f " << i * N + j + 1 << " " << (i + 1) * N + j + 1 << " " << (i + 1) * N + j + 2 << " " << i * N + j + 2 << "\n";
+			}
+			assert_cgp_no_msg(file_get_size(filename) > (size_t(1) << 20));
+
+			numarray<numarray<int>> correspondance;
+			mesh const m = mesh_load_file_obj(filename, correspondance);
+			assert_cgp_no_msg(m.position.size() == N * N);
+			assert_cgp_no_msg(m.connectivity.size() == 2 * (N - 1) * (N - 1));
+			for (int i = 0; i < N; i += 37) {
+				for (int j = 0; j < N; j += 41) {
+					int const k = correspondance[i * N + j][0];
+					assert_cgp_no_msg(norm(m.position[k] - vec3{ i / float(N), j / float(N), 0.001f * (i * j % 7) }) < 1e-5f);
+				}
+			}
+			uint3 const last = m.connectivity[m.connectivity.size() - 1];
+			assert_cgp_no_msg(last[0] == correspondance[(N - 2) * N + N - 2][0] && last[1] == correspondance[(N - 1) * N + N - 1][0] && last[2] == correspondance[(N - 2) * N + N - 1][0]);
+		}
+
+		std::remove(filename.c_str());
+	}
+}
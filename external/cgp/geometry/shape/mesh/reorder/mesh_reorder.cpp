@@ -0,0 +1,237 @@
+#include "mesh_reorder.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace cgp
+{
+	namespace
+	{
+		// Parameters of the vertex score (values proposed by T. Forsyth)
+		float const forsyth_cache_decay_power = 1.5f;
+		float const forsyth_last_triangle_score = 0.75f;
+		float const forsyth_valence_boost_scale = 2.0f;
+		float const forsyth_valence_boost_power = 0.5f;
+
+		// Score of a vertex from its position in the cache and its number of remaining triangles, with precomputed tables
+		struct forsyth_score_table
+		{
+			int const max_valence = 64;
+			std::vector<float> cache_score;
+			std::vector<float> valence_score;
+
+			explicit forsyth_score_table(int cache_size)
+				:cache_score(cache_size), valence_score(max_valence)
+			{
+				for (int k = 0; k < cache_size; ++k) {
+					if (k < 3) // vertices of the last triangle: fixed score to avoid favoring a strip-like order
+						cache_score[k] = forsyth_last_triangle_score;
+					else
+						cache_score[k] = std::pow(1.0f - float(k - 3) / float(cache_size - 3), forsyth_cache_decay_power);
+				}
+				// Boost vertices with few remaining triangles, such that isolated triangles are not left behind
+				for (int k = 1; k < max_valence; ++k)
+					valence_score[k] = forsyth_valence_boost_scale * std::pow(float(k), -forsyth_valence_boost_power);
+			}
+
+			float operator()(int cache_position, int remaining_triangles) const
+			{
+				if (remaining_triangles == 0)
+					return -1.0f; // the vertex is not used anymore
+				float const score = cache_position >= 0 ? cache_score[cache_position] : 0.0f;
+				if (remaining_triangles < max_valence)
+					return score + valence_score[remaining_triangles];
+				return score + forsyth_valence_boost_scale * std::pow(float(remaining_triangles), -forsyth_valence_boost_power);
+			}
+		};
+	}
+
+	numarray<int> reorder_triangles_vertex_cache(numarray<uint3> const& connectivity, int N_vertex, int cache_size)
+	{
+		assert_cgp(cache_size > 3, "Cache size must be larger than 3 (cache_size=" + str(cache_size) + ")");
+		int const N_tri = connectivity.size();
+
+		// Triangles adjacent to each vertex
+		std::vector<int> adjacent_offset(N_vertex + 1, 0);
+		for (int k = 0; k < N_tri; ++k)
+			for (unsigned int idx : connectivity[k]) {
+				assert_cgp(int(idx) < N_vertex, "Triangle " + str(k) + " has vertex index " + str(idx) + " while the number of vertices is " + str(N_vertex));
+				adjacent_offset[idx + 1]++;
+			}
+		for (int k = 0; k < N_vertex; ++k)
+			adjacent_offset[k + 1] += adjacent_offset[k];
+		std::vector<int> adjacent(adjacent_offset[N_vertex]);
+		std::vector<int> fill(adjacent_offset.begin(), adjacent_offset.end() - 1);
+		for (int k = 0; k < N_tri; ++k)
+			for (unsigned int idx : connectivity[k])
+				adjacent[fill[idx]++] = k;
+
+		forsyth_score_table const vertex_score_table(cache_size);
+
+		// remaining[v]: number of triangles of the vertex not emitted yet, the first remaining[v] entries of the adjacency are the triangles still to emit
+		std::vector<int> remaining(N_vertex);
+		std::vector<int> cache_position(N_vertex, -1);
+		std::vector<float> vertex_score(N_vertex);
+		for (int v = 0; v < N_vertex; ++v) {
+			remaining[v] = adjacent_offset[v + 1] - adjacent_offset[v];
+			vertex_score[v] = vertex_score_table(-1, remaining[v]);
+		}
+
+		std::vector<float> triangle_score(N_tri);
+		std::vector<char> emitted(N_tri, 0);
+		for (int k = 0; k < N_tri; ++k)
+			triangle_score[k] = vertex_score[connectivity[k][0]] + vertex_score[connectivity[k][1]] + vertex_score[connectivity[k][2]];
+
+		// Simulated LRU cache, with 3 extra entries to hold the vertices pushed out by the new triangle
+		std::vector<int> cache, next_cache;
+		cache.reserve(cache_size + 3);
+		next_cache.reserve(cache_size + 3);
+
+		numarray<int> order(N_tri);
+		int best_triangle = -1;
+		int scan = 0; // triangles before scan are all emitted (used when the cache doesn't provide any candidate)
+		for (int k_order = 0; k_order < N_tri; ++k_order)
+		{
+			if (best_triangle < 0) {
+				// Restart from the first triangles not emitted (a search among all the triangles at each restart would be quadratic)
+				float best_score = -1.0f;
+				int const scan_end = std::min(N_tri, scan + 64);
+				for (int k = scan; k < scan_end; ++k) {
+					if (emitted[k] == 0 && triangle_score[k] > best_score) {
+						best_score = triangle_score[k];
+						best_triangle = k;
+					}
+				}
+			}
+
+			int const t = best_triangle;
+			order[k_order] = t;
+			emitted[t] = 1;
+			while (scan < N_tri && emitted[scan] != 0)
+				++scan;
+
+			// Remove the triangle from the remaining triangles of its vertices, and move them at the front of the cache
+			next_cache.clear();
+			for (unsigned int v : connectivity[t]) {
+				int* const first = adjacent.data() + adjacent_offset[v];
+				int* const last = first + remaining[v];
+				for (int* it = first; it < last; ++it)
+					if (*it == t) {
+						std::swap(*it, *(last - 1));
+						break;
+					}
+				remaining[v]--;
+				next_cache.push_back(v);
+			}
+			for (int v : cache)
+				if (v != int(connectivity[t][0]) && v != int(connectivity[t][1]) && v != int(connectivity[t][2]))
+					next_cache.push_back(v);
+			std::swap(cache, next_cache);
+
+			// Update the score of the vertices in the cache (and of the vertices leaving the cache)
+			for (int k = 0; k < int(cache.size()); ++k) {
+				int const v = cache[k];
+				cache_position[v] = k < cache_size ? k : -1;
+				vertex_score[v] = vertex_score_table(cache_position[v], remaining[v]);
+			}
+
+			// Update the score of the remaining triangles of these vertices, and select the best candidate
+			best_triangle = -1;
+			float best_score = -1.0f;
+			for (int v : cache)
+				for (int j = adjacent_offset[v]; j < adjacent_offset[v] + remaining[v]; ++j) {
+					int const tri = adjacent[j];
+					uint3 const& f = connectivity[tri];
+					float const score = vertex_score[f[0]] + vertex_score[f[1]] + vertex_score[f[2]];
+					triangle_score[tri] = score;
+					if (score > best_score) {
+						best_score = score;
+						best_triangle = tri;
+					}
+				}
+
+			if (int(cache.size()) > cache_size)
+				cache.resize(cache_size);
+		}
+
+		return order;
+	}
+
+	numarray<int> reorder_vertices_first_use(numarray<uint3> const& connectivity, int N_vertex)
+	{
+		std::vector<int> old_to_new(N_vertex, -1);
+		numarray<int> new_to_old;
+		new_to_old.data.reserve(N_vertex);
+		for (int k = 0; k < connectivity.size(); ++k)
+			for (unsigned int idx : connectivity[k])
+				if (old_to_new[idx] == -1) {
+					old_to_new[idx] = new_to_old.size();
+					new_to_old.push_back(idx);
+				}
+		for (int v = 0; v < N_vertex; ++v)
+			if (old_to_new[v] == -1)
+				new_to_old.push_back(v);
+		return new_to_old;
+	}
+
+	mesh& mesh_reorder_for_locality(mesh& m, int cache_size)
+	{
+		numarray<int> new_to_old;
+		return mesh_reorder_for_locality(m, new_to_old, cache_size);
+	}
+
+	mesh& mesh_reorder_for_locality(mesh& m, numarray<int>& new_to_old, int cache_size)
+	{
+		int const N_vertex = m.position.size();
+		numarray<int> const triangle_order = reorder_triangles_vertex_cache(m.connectivity, N_vertex, cache_size);
+		numarray<uint3> const connectivity = permute_values(m.connectivity, triangle_order);
+
+		new_to_old = reorder_vertices_first_use(connectivity, N_vertex);
+		numarray<int> const old_to_new = permutation_inverse(new_to_old);
+
+		m.connectivity.resize(connectivity.size());
+		for (int k = 0; k < connectivity.size(); ++k)
+			for (int j = 0; j < 3; ++j)
+				m.connectivity[k][j] = old_to_new[connectivity[k][j]];
+
+		m.position = permute_values(m.position, new_to_old);
+		if (m.normal.size() == N_vertex)
+			m.normal = permute_values(m.normal, new_to_old);
+		if (m.color.size() == N_vertex)
+			m.color = permute_values(m.color, new_to_old);
+		if (m.uv.size() == N_vertex)
+			m.uv = permute_values(m.uv, new_to_old);
+
+		return m;
+	}
+
+	float vertex_cache_miss_ratio(numarray<uint3> const& connectivity, int N_vertex, int cache_size)
+	{
+		int const N_tri = connectivity.size();
+		if (N_tri == 0)
+			return 0.0f;
+
+		// FIFO cache: a vertex is in the cache if it was inserted less than cache_size misses ago
+		std::vector<long long> insertion(N_vertex, -1);
+		long long misses = 0;
+		for (int k = 0; k < N_tri; ++k)
+			for (unsigned int idx : connectivity[k])
+				if (insertion[idx] < 0 || misses - insertion[idx] >= cache_size) {
+					insertion[idx] = misses;
+					misses++;
+				}
+		return float(misses) / float(N_tri);
+	}
+
+	numarray<int> permutation_inverse(numarray<int> const& new_to_old)
+	{
+		int const N = new_to_old.size();
+		numarray<int> old_to_new(N);
+		for (int k = 0; k < N; ++k)
+			old_to_new.at(new_to_old.at_unsafe(k)) = k;
+		return old_to_new;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../structure/mesh.hpp"
+
+namespace cgp
+{
+	/** Reorder the triangles to improve the hit rate of the post-transform vertex cache of the GPU
+	* Uses the linear-speed vertex cache optimisation of T. Forsyth: triangles using vertices recently added in a simulated LRU cache of size cache_size, 
+	*  or vertices with few remaining triangles, are emitted first.
+	* Return the new order of the triangles: triangle k of the result is the triangle triangle_order[k] of the input */
+	numarray<int> reorder_triangles_vertex_cache(numarray<uint3> const& connectivity, int N_vertex, int cache_size = 32);
+
+	/** Order of the vertices by first use in the connectivity (vertices not referenced are placed at the end)
+	* Return new_to_old, such that vertex k of the reordered mesh is vertex new_to_old[k] of the input */
+	numarray<int> reorder_vertices_first_use(numarray<uint3> const& connectivity, int N_vertex);
+
+	/** Reorder the triangles for the vertex cache, then renumber the vertices in order of first use (improves the memory locality of the per-vertex loops)
+	* All the per-vertex buffers that are filled are permuted. new_to_old[k] is the index in the initial mesh of the vertex k, and can be used to reorder associated data (see permute_values). */
+	mesh& mesh_reorder_for_locality(mesh& m, int cache_size = 32);
+	mesh& mesh_reorder_for_locality(mesh& m, numarray<int>& new_to_old, int cache_size = 32);
+
+	/** Average number of vertices transformed per triangle (ACMR) when the triangles are drawn through a simulated FIFO cache of cache_size vertices
+	* Between 0.5 (ideal for regular meshes) and 3 (no reuse) */
+	float vertex_cache_miss_ratio(numarray<uint3> const& connectivity, int N_vertex, int cache_size = 32);
+
+	/** Reorder values according to a permutation: result[k] = values[new_to_old[k]] */
+	template <typename T>
+	numarray<T> permute_values(numarray<T> const& values, numarray<int> const& new_to_old);
+	/** Inverse permutation: old_to_new[new_to_old[k]] = k */
+	numarray<int> permutation_inverse(numarray<int> const& new_to_old);
+}
+
+
+namespace cgp
+{
+	template <typename T>
+	numarray<T> permute_values(numarray<T> const& values, numarray<int> const& new_to_old)
+	{
+		int const N = new_to_old.size();
+		numarray<T> result(N);
+		for (int k = 0; k < N; ++k)
+			result.at_unsafe(k) = values.at(new_to_old.at_unsafe(k));
+		return result;
+	}
+}
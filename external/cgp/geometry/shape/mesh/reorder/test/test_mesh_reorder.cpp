@@ -0,0 +1,60 @@
+#include "test_mesh_reorder.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../mesh_reorder.hpp"
+#include "../../primitive/mesh_primitive.hpp"
+
+#include <algorithm>
+
+namespace cgp_test
+{
+	void test_mesh_reorder()
+	{
+		using namespace cgp;
+
+		// Grid with shuffled triangles: the reordering recovers a good vertex reuse
+		mesh const grid = mesh_primitive_grid({ 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, 40, 40);
+		int const N_vertex = grid.position.size();
+		int const N_tri = grid.connectivity.size();
+
+		mesh shuffled = grid;
+		for (int k = N_tri - 1; k > 0; --k)
+			std::swap(shuffled.connectivity[k], shuffled.connectivity[(k * 7919) % (k + 1)]);
+
+		float const acmr_shuffled = vertex_cache_miss_ratio(shuffled.connectivity, N_vertex);
+		numarray<int> const triangle_order = reorder_triangles_vertex_cache(shuffled.connectivity, N_vertex);
+		float const acmr_reordered = vertex_cache_miss_ratio(permute_values(shuffled.connectivity, triangle_order), N_vertex);
+		assert_cgp_no_msg(acmr_reordered < 0.8f && acmr_reordered < 0.5f * acmr_shuffled);
+
+		// The triangle order is a permutation
+		numarray<int> sorted = triangle_order;
+		std::sort(sorted.begin(), sorted.end());
+		for (int k = 0; k < N_tri; ++k)
+			assert_cgp_no_msg(sorted[k] == k);
+
+		// Full reordering of the mesh: same triangles, vertices in order of first use
+		mesh reordered = shuffled;
+		numarray<int> new_to_old;
+		mesh_reorder_for_locality(reordered, new_to_old);
+		assert_cgp_no_msg(reordered.position.size() == N_vertex && reordered.connectivity.size() == N_tri);
+		numarray<int> const old_to_new = permutation_inverse(new_to_old);
+		for (int k = 0; k < N_vertex; ++k) {
+			assert_cgp_no_msg(old_to_new[new_to_old[k]] == k);
+			assert_cgp_no_msg(is_equal(reordered.position[k], shuffled.position[new_to_old[k]]));
+			assert_cgp_no_msg(is_equal(reordered.uv[k], shuffled.uv[new_to_old[k]]));
+		}
+
+		int next_new_vertex = 0;
+		for (int k = 0; k < N_tri; ++k) {
+			uint3 const& f = reordered.connectivity[k];
+			uint3 const& f0 = shuffled.connectivity[triangle_order[k]];
+			for (int j = 0; j < 3; ++j) {
+				assert_cgp_no_msg(int(f[j]) <= next_new_vertex);
+				if (int(f[j]) == next_new_vertex)
+					next_new_vertex++;
+				assert_cgp_no_msg(int(f0[j]) == new_to_old[f[j]]);
+			}
+		}
+		assert_cgp_no_msg(is_equal(vertex_cache_miss_ratio(reordered.connectivity, N_vertex), acmr_reordered));
+	}
+}
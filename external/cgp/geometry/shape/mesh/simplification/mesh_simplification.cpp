@@ -0,0 +1,551 @@
+#include "mesh_simplification.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+namespace cgp
+{
+	namespace
+	{
+		// Symmetric 4x4 quadric stored by its upper triangular coefficients
+		//  [a b c d]
+		//  [  e f g]
+		//  [    h i]
+		//  [      j]
+		struct quadric
+		{
+			double q[10] = { 0,0,0,0,0,0,0,0,0,0 };
+
+			// Squared distance to the plane dot(n,p)+d=0 (n unit), multiplied by the weight
+			static quadric plane(vec3 const& n, double d, double weight)
+			{
+				quadric Q;
+				double const a = n.x, b = n.y, c = n.z;
+				double const v[10] = { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d };
+				for (int k = 0; k < 10; ++k)
+					Q.q[k] = weight * v[k];
+				return Q;
+			}
+
+			quadric& operator+=(quadric const& other)
+			{
+				for (int k = 0; k < 10; ++k)
+					q[k] += other.q[k];
+				return *this;
+			}
+
+			double error(vec3 const& p) const
+			{
+				double const x = p.x, y = p.y, z = p.z;
+				return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+					+ q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+					+ q[7] * z * z + 2 * q[8] * z
+					+ q[9];
+			}
+
+			// Position minimizing the error (return false if the system is ill-conditioned)
+			bool minimum(vec3& p) const
+			{
+				double const a = q[0], b = q[1], c = q[2], e = q[4], f = q[5], h = q[7];
+				double const det = a * (e * h - f * f) - b * (b * h - f * c) + c * (b * f - e * c);
+				double const scale = std::abs(a) + std::abs(e) + std::abs(h);
+				if (std::abs(det) <= 1e-9 * scale * scale * scale || scale == 0)
+					return false;
+
+				// Cramer rule on A p = -(d,g,i)
+				double const r0 = -q[3], r1 = -q[6], r2 = -q[8];
+				double const x = (r0 * (e * h - f * f) - b * (r1 * h - f * r2) + c * (r1 * f - e * r2)) / det;
+				double const y = (a * (r1 * h - f * r2) - r0 * (b * h - f * c) + c * (b * r2 - r1 * c)) / det;
+				double const z = (a * (e * r2 - r1 * f) - b * (b * r2 - r1 * c) + r0 * (b * f - e * c)) / det;
+				p = vec3(float(x), float(y), float(z));
+				return true;
+			}
+		};
+
+		quadric operator+(quadric a, quadric const& b)
+		{
+			a += b;
+			return a;
+		}
+
+		struct collapse_candidate
+		{
+			float cost;
+			int a, b;              // b is merged into a
+			int version_a, version_b;
+			vec3 position;
+			float t;               // parameter of the new vertex along the edge (used to interpolate the attributes)
+
+			bool operator<(collapse_candidate const& other) const { return cost > other.cost; } // smallest cost on top of the priority_queue
+		};
+
+		struct simplifier
+		{
+			mesh_simplification_parameters parameters;
+			numarray<vec3> position;
+			numarray<vec2> uv;
+			numarray<vec3> color;
+			std::vector<uint3> triangle;
+			std::vector<char> triangle_removed;
+			std::vector<std::vector<int> > vertex_triangle;
+			std::vector<quadric> Q;
+			std::vector<char> locked;
+			std::vector<char> on_boundary;
+			std::vector<int> version;
+			std::vector<int> parent; // vertex a removed vertex has been merged into (-1 if the vertex is still present)
+			std::priority_queue<collapse_candidate> queue;
+			int N_triangle = 0;
+
+			void initialize(mesh const& m)
+			{
+				int const N_vertex = m.position.size();
+				N_triangle = m.connectivity.size();
+				position = m.position;
+				if (m.uv.size() == N_vertex) uv = m.uv;
+				if (m.color.size() == N_vertex) color = m.color;
+				triangle.assign(m.connectivity.begin(), m.connectivity.end());
+				triangle_removed.assign(N_triangle, 0);
+				vertex_triangle.assign(N_vertex, std::vector<int>());
+				Q.assign(N_vertex, quadric());
+				locked.assign(N_vertex, 0);
+				on_boundary.assign(N_vertex, 0);
+				version.assign(N_vertex, 0);
+				parent.assign(N_vertex, -1);
+				weld_split_vertices();
+
+				// Plane quadric of the triangles weighted by their area
+				for (int k = 0; k < int(triangle.size()); ++k) {
+					uint3 const& f = triangle[k];
+					if (f[0] == f[1] || f[1] == f[2] || f[2] == f[0]) { // corners welded together
+						triangle_removed[k] = 1;
+						N_triangle--;
+						continue;
+					}
+					vec3 const n = cross(position[f[1]] - position[f[0]], position[f[2]] - position[f[0]]);
+					float const L = norm(n);
+					for (int j = 0; j < 3; ++j)
+						vertex_triangle[f[j]].push_back(k);
+					if (L < 1e-20f)
+						continue;
+					vec3 const u = n / L;
+					quadric const Qf = quadric::plane(u, -dot(u, position[f[0]]), 0.5 * L);
+					for (int j = 0; j < 3; ++j)
+						Q[f[j]] += Qf;
+				}
+
+				// Boundary edges (edges of a single triangle): either locked, or constrained by a plane orthogonal to the surface
+				for (int k = 0; k < int(triangle.size()); ++k) {
+					if (triangle_removed[k])
+						continue;
+					uint3 const& f = triangle[k];
+					for (int j = 0; j < 3; ++j) {
+						int const a = f[j], b = f[(j + 1) % 3];
+						if (count_triangles_with_edge(a, b) != 1)
+							continue;
+						on_boundary[a] = on_boundary[b] = 1;
+						if (parameters.preserve_boundary) {
+							locked[a] = locked[b] = 1;
+							continue;
+						}
+						vec3 const e = position[b] - position[a];
+						vec3 const side = cross(e, cross(position[f[1]] - position[f[0]], position[f[2]] - position[f[0]]));
+						float const L = norm(side);
+						if (L < 1e-20f)
+							continue;
+						vec3 const u = side / L;
+						quadric const Qe = quadric::plane(u, -dot(u, position[a]), dot(e, e));
+						Q[a] += Qe;
+						Q[b] += Qe;
+					}
+				}
+
+				for (int k = 0; k < int(triangle.size()); ++k)
+					for (int j = 0; j < 3 && triangle_removed[k] == 0; ++j) {
+						int const a = triangle[k][j], b = triangle[k][(j + 1) % 3];
+						if (a < b || count_triangles_with_edge(a, b) == 1) // each interior edge is pushed once
+							push_candidate(a, b);
+					}
+			}
+
+			// Split vertices are copies of a vertex at the same position (ex. split normals of a flat shading, uv seams)
+			//  The copies with the same uv and color are welded: the triangles use the first one, and the others are merged into it (parent).
+			//  The copies left at a position have different attributes (seam of the uv or colors): they are locked, such that they are not
+			//  collapsed independently and the seam stays closed.
+			void weld_split_vertices()
+			{
+				int const N_vertex = position.size();
+				auto const attributes = [this](int v) {
+					vec2 const t = uv.size() > 0 ? uv[v] : vec2();
+					vec3 const c = color.size() > 0 ? color[v] : vec3();
+					return std::make_tuple(position[v].x, position[v].y, position[v].z, t.x, t.y, c.x, c.y, c.z);
+				};
+				std::vector<int> order(N_vertex);
+				for (int k = 0; k < N_vertex; ++k)
+					order[k] = k;
+				std::stable_sort(order.begin(), order.end(), [&attributes](int i, int j) { return attributes(i) < attributes(j); });
+
+				// Vertices sorted by position then attributes: the copies are consecutive, the first one of each set of identical copies is kept
+				std::vector<int> weld(N_vertex);
+				for (int start = 0; start < N_vertex;) {
+					vec3 const& p = position[order[start]];
+					int end = start + 1;
+					while (end < N_vertex && position[order[end]].x == p.x && position[order[end]].y == p.y && position[order[end]].z == p.z)
+						++end;
+					int copies = 0;
+					int kept = -1;
+					for (int k = start; k < end; ++k) {
+						if (k == start || attributes(order[k]) != attributes(order[k - 1])) {
+							kept = order[k];
+							copies++;
+						}
+						weld[order[k]] = kept;
+					}
+					if (copies > 1)
+						for (int k = start; k < end; ++k)
+							locked[weld[order[k]]] = 1;
+					start = end;
+				}
+
+				for (int v = 0; v < N_vertex; ++v)
+					if (weld[v] != v)
+						parent[v] = weld[v];
+				for (uint3& f : triangle)
+					for (int j = 0; j < 3; ++j)
+						f[j] = weld[f[j]];
+			}
+
+			int count_triangles_with_edge(int a, int b) const
+			{
+				int count = 0;
+				for (int t : vertex_triangle[a])
+					if (triangle_removed[t] == 0 && has_vertex(triangle[t], b))
+						count++;
+				return count;
+			}
+
+			static bool has_vertex(uint3 const& f, int v)
+			{
+				return int(f[0]) == v || int(f[1]) == v || int(f[2]) == v;
+			}
+
+			void push_candidate(int a, int b)
+			{
+				if (locked[a] && locked[b])
+					return;
+				if (locked[b])
+					std::swap(a, b); // the locked vertex is kept
+
+				quadric const Qab = Q[a] + Q[b];
+				vec3 const& pa = position[a];
+				vec3 const& pb = position[b];
+				vec3 p;
+				float t = 0.0f;
+				if (locked[a]) {
+					p = pa;
+				}
+				else if (!parameters.preserve_uv && Qab.minimum(p)) {
+					// Parameter of the projection on the edge, used to interpolate the attributes
+					vec3 const e = pb - pa;
+					float const L2 = dot(e, e);
+					t = L2 > 0 ? std::min(std::max(dot(p - pa, e) / L2, 0.0f), 1.0f) : 0.0f;
+				}
+				else {
+					// Minimum along the edge: error(pa + t (pb-pa)) = alpha t^2 + 2 beta t + gamma
+					double const e0 = Qab.error(pa), e1 = Qab.error(pb), em = Qab.error(0.5f * (pa + pb));
+					double const alpha = 2 * (e0 + e1) - 4 * em;
+					double const beta = (e1 - e0 - alpha) / 2;
+					t = alpha > 0 ? float(std::min(std::max(-beta / alpha, 0.0), 1.0)) : (e0 <= e1 ? 0.0f : 1.0f);
+					p = (1 - t) * pa + t * pb;
+				}
+
+				float const cost = float(std::max(Qab.error(p), 0.0));
+				queue.push({ cost, a, b, version[a], version[b], p, t });
+			}
+
+			// Neighbors of a vertex in the current mesh
+			void neighbors(int v, std::vector<int>& result) const
+			{
+				result.clear();
+				for (int t : vertex_triangle[v])
+					if (triangle_removed[t] == 0)
+						for (unsigned int w : triangle[t])
+							if (int(w) != v)
+								result.push_back(w);
+				std::sort(result.begin(), result.end());
+				result.erase(std::unique(result.begin(), result.end()), result.end());
+			}
+
+			bool is_valid_collapse(collapse_candidate const& c, std::vector<int>& na, std::vector<int>& nb) const
+			{
+				int const a = c.a, b = c.b;
+
+				// Link condition: the common neighbors of a and b are exactly the opposite vertices of the triangles sharing the edge
+				neighbors(a, na);
+				neighbors(b, nb);
+				int common = 0;
+				for (size_t i = 0, j = 0; i < na.size() && j < nb.size();) {
+					if (na[i] < nb[j]) ++i;
+					else if (nb[j] < na[i]) ++j;
+					else { ++common; ++i; ++j; }
+				}
+				int const N_edge_triangle = count_triangles_with_edge(a, b);
+				if (common != N_edge_triangle)
+					return false;
+				// An interior edge joining two boundary vertices would pinch the surface
+				if (N_edge_triangle == 2 && on_boundary[a] && on_boundary[b])
+					return false;
+
+				// The remaining triangles around a and b must not be folded
+				for (int v : { a, b })
+					for (int t : vertex_triangle[v]) {
+						uint3 const& f = triangle[t];
+						if (triangle_removed[t] || (has_vertex(f, a) && has_vertex(f, b)))
+							continue;
+						vec3 p[3];
+						for (int j = 0; j < 3; ++j)
+							p[j] = (int(f[j]) == a || int(f[j]) == b) ? c.position : position[f[j]];
+						vec3 const n0 = cross(position[f[1]] - position[f[0]], position[f[2]] - position[f[0]]);
+						vec3 const n1 = cross(p[1] - p[0], p[2] - p[0]);
+						if (dot(n0, n1) <= 0)
+							return false;
+					}
+				return true;
+			}
+
+			void collapse(collapse_candidate const& c)
+			{
+				int const a = c.a, b = c.b;
+				position[a] = c.position;
+				if (uv.size() > 0) uv[a] = (1 - c.t) * uv[a] + c.t * uv[b];
+				if (color.size() > 0) color[a] = (1 - c.t) * color[a] + c.t * color[b];
+				Q[a] += Q[b];
+				on_boundary[a] = on_boundary[a] || on_boundary[b];
+				parent[b] = a;
+				version[a]++;
+				version[b]++;
+
+				for (int t : vertex_triangle[b]) {
+					if (triangle_removed[t])
+						continue;
+					uint3& f = triangle[t];
+					if (has_vertex(f, a)) {
+						triangle_removed[t] = 1;
+						N_triangle--;
+						continue;
+					}
+					for (int j = 0; j < 3; ++j)
+						if (int(f[j]) == b)
+							f[j] = a;
+					vertex_triangle[a].push_back(t);
+				}
+				vertex_triangle[b].clear();
+
+				std::vector<int>& ta = vertex_triangle[a];
+				ta.erase(std::remove_if(ta.begin(), ta.end(), [this](int t) { return triangle_removed[t] != 0; }), ta.end());
+			}
+
+			void run()
+			{
+				std::vector<int> na, nb;
+				while (N_triangle > parameters.target_triangle && !queue.empty())
+				{
+					collapse_candidate const c = queue.top();
+					queue.pop();
+					if (c.version_a != version[c.a] || c.version_b != version[c.b] || parent[c.a] != -1 || parent[c.b] != -1)
+						continue; // outdated candidate
+					if (parameters.max_error >= 0 && c.cost > parameters.max_error)
+						break;
+					if (!is_valid_collapse(c, na, nb))
+						continue;
+
+					collapse(c);
+					neighbors(c.a, na);
+					for (int v : na)
+						push_candidate(c.a, v);
+				}
+			}
+
+			mesh result(numarray<int>& vertex_to_proxy)
+			{
+				int const N_vertex = position.size();
+				numarray<int> compact(N_vertex);
+				compact.fill(-1);
+				mesh proxy;
+				for (int v = 0; v < N_vertex; ++v) {
+					if (parent[v] != -1 || vertex_triangle[v].empty())
+						continue;
+					compact[v] = proxy.position.size();
+					proxy.position.push_back(position[v]);
+					if (uv.size() > 0) proxy.uv.push_back(uv[v]);
+					if (color.size() > 0) proxy.color.push_back(color[v]);
+				}
+				for (size_t t = 0; t < triangle.size(); ++t)
+					if (triangle_removed[t] == 0)
+						proxy.connectivity.push_back({ compact[triangle[t][0]], compact[triangle[t][1]], compact[triangle[t][2]] });
+
+				// Follow the chain of collapses of each initial vertex (with path compression)
+				vertex_to_proxy.resize(N_vertex);
+				for (int v = 0; v < N_vertex; ++v) {
+					int r = v;
+					while (parent[r] != -1)
+						r = parent[r];
+					for (int w = v; parent[w] != -1;) {
+						int const next = parent[w];
+						parent[w] = r;
+						w = next;
+					}
+					vertex_to_proxy[v] = compact[r];
+				}
+
+				if (proxy.connectivity.size() > 0)
+					proxy.fill_empty_field();
+				return proxy;
+			}
+		};
+	}
+
+	mesh mesh_simplify(mesh const& m, mesh_simplification_parameters const& parameters)
+	{
+		numarray<int> vertex_to_proxy;
+		return mesh_simplify(m, parameters, vertex_to_proxy);
+	}
+
+	mesh mesh_simplify(mesh const& m, mesh_simplification_parameters const& parameters, numarray<int>& vertex_to_proxy)
+	{
+		simplifier s;
+		s.parameters = parameters;
+		s.initialize(m);
+		s.run();
+		return s.result(vertex_to_proxy);
+	}
+
+	namespace
+	{
+		char const proxy_magic[8] = { 'C','G','P','P','R','O','X','Y' };
+		uint32_t const proxy_version = 3; // 3: split vertices are welded (part of the key: proxies of the previous versions are rebuilt)
+
+		enum proxy_block { block_position, block_uv, block_color, block_connectivity, block_vertex_to_proxy, block_count };
+
+		struct proxy_header
+		{
+			binary_file_signature signature;
+			uint64_t key;
+
+			// Position in octets and number of elements of each block
+			uint64_t offset[block_count];
+			uint64_t count[block_count];
+		};
+
+		// Return an empty string on success, otherwise the description of the error
+		std::string proxy_save_file(std::string const& filename, uint64_t key, mesh const& proxy, numarray<int> const& vertex_to_proxy)
+		{
+			proxy_header header;
+			std::memset(&header, 0, sizeof(header));
+			header.signature = binary_file_signature_create(proxy_magic, proxy_version);
+			header.key = key;
+
+			void const* const data[block_count] = { proxy.position.data.data(), proxy.uv.data.data(), proxy.color.data.data(), proxy.connectivity.data.data(), vertex_to_proxy.data.data() };
+			size_t const element_size[block_count] = { sizeof(vec3), sizeof(vec2), sizeof(vec3), sizeof(uint3), sizeof(int) };
+			header.count[block_position] = proxy.position.size();
+			header.count[block_uv] = proxy.uv.size();
+			header.count[block_color] = proxy.color.size();
+			header.count[block_connectivity] = proxy.connectivity.size();
+			header.count[block_vertex_to_proxy] = vertex_to_proxy.size();
+			uint64_t offset = sizeof(header);
+			for (int k = 0; k < block_count; ++k) {
+				header.offset[k] = binary_file_align(offset);
+				offset = header.offset[k] + header.count[k] * element_size[k];
+			}
+
+			return file_write_atomic(filename, [&](std::ostream& stream) {
+				uint64_t position = 0;
+				binary_file_write_block(stream, position, 0, &header, sizeof(header));
+				for (int k = 0; k < block_count; ++k)
+					binary_file_write_block(stream, position, header.offset[k], data[k], header.count[k] * element_size[k]);
+			});
+		}
+
+		template <typename T>
+		void proxy_read_block(file_mapping const& file, proxy_header const& header, int block, numarray<T>& values)
+		{
+			values.resize(header.count[block]);
+			if (header.count[block] > 0)
+				std::memcpy(values.data.data(), file.data + header.offset[block], header.count[block] * sizeof(T));
+		}
+
+		bool proxy_load_file(std::string const& filename, uint64_t key, mesh& proxy, numarray<int>& vertex_to_proxy)
+		{
+			if (!check_file_exist(filename) || file_get_size(filename) < sizeof(proxy_header))
+				return false;
+
+			file_mapping const file(filename);
+			proxy_header header;
+			std::memcpy(&header, file.data, sizeof(header));
+			bool valid = binary_file_signature_check(header.signature, proxy_magic, proxy_version, filename, "simplified mesh").empty() && header.key == key;
+			size_t const element_size[block_count] = { sizeof(vec3), sizeof(vec2), sizeof(vec3), sizeof(uint3), sizeof(int) };
+			for (int k = 0; valid && k < block_count; ++k)
+				valid = header.offset[k] % binary_file_alignment == 0 && header.offset[k] >= sizeof(header) && header.count[k] <= file.size / element_size[k] && header.offset[k] + header.count[k] * element_size[k] <= file.size;
+			uint64_t const N_vertex = header.count[block_position];
+			valid = valid && (header.count[block_uv] == 0 || header.count[block_uv] == N_vertex) && (header.count[block_color] == 0 || header.count[block_color] == N_vertex);
+			if (!valid)
+				return false;
+
+			proxy = mesh();
+			proxy_read_block(file, header, block_position, proxy.position);
+			proxy_read_block(file, header, block_uv, proxy.uv);
+			proxy_read_block(file, header, block_color, proxy.color);
+			proxy_read_block(file, header, block_connectivity, proxy.connectivity);
+			proxy_read_block(file, header, block_vertex_to_proxy, vertex_to_proxy);
+
+			// Indices out of the proxy (corrupted file)
+			for (uint3 const& f : proxy.connectivity)
+				if (f[0] >= N_vertex || f[1] >= N_vertex || f[2] >= N_vertex)
+					return false;
+			for (int v : vertex_to_proxy)
+				if (v < -1 || v >= int64_t(N_vertex))
+					return false;
+
+			if (proxy.connectivity.size() > 0)
+				proxy.fill_empty_field();
+			return true;
+		}
+	}
+
+	uint64_t mesh_simplify_key(mesh const& m, mesh_simplification_parameters const& parameters)
+	{
+		uint64_t key = hash_buffer(&proxy_version, sizeof(proxy_version));
+		key = hash_buffer(m.position.data.data(), m.position.size() * sizeof(vec3), key);
+		key = hash_buffer(m.connectivity.data.data(), m.connectivity.size() * sizeof(uint3), key);
+		key = hash_buffer(m.uv.data.data(), m.uv.size() * sizeof(vec2), key);
+		key = hash_buffer(m.color.data.data(), m.color.size() * sizeof(vec3), key);
+		key = hash_value(int32_t(parameters.target_triangle), key);
+		key = hash_value(parameters.max_error, key);
+		key = hash_value(uint8_t((parameters.preserve_boundary ? 1 : 0) | (parameters.preserve_uv ? 2 : 0)), key);
+		return key;
+	}
+
+	mesh mesh_simplify_cached(mesh const& m, mesh_simplification_parameters const& parameters, std::string const& cache_directory, numarray<int>& vertex_to_proxy)
+	{
+		uint64_t const key = mesh_simplify_key(m, parameters);
+		std::string const filename = cache_filename(cache_directory, "mesh_simplify_", key, ".cgpproxy");
+
+		mesh proxy;
+		if (proxy_load_file(filename, key, proxy, vertex_to_proxy))
+			return proxy;
+
+		proxy = mesh_simplify(m, parameters, vertex_to_proxy);
+
+		// The cache is only an optimization: the proxy is still used if it cannot be written
+		std::string const error = proxy_save_file(filename, key, proxy, vertex_to_proxy);
+		if (!error.empty())
+			warning_cgp("Cannot write the simplified mesh cache", error);
+		return proxy;
+	}
+}
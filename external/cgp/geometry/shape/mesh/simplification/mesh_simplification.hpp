@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../structure/mesh.hpp"
+
+#include <cstdint>
+
+namespace cgp
+{
+	/** Stopping criteria and constraints of the mesh simplification */
+	struct mesh_simplification_parameters
+	{
+		int target_triangle = 0;  // stop when the number of triangles is less or equal to this value
+		float max_error = -1.0f;  // stop when the next collapse has a larger quadric error (squared distance to the initial surface), ignored if negative
+		bool preserve_boundary = true; // vertices on the boundary are not moved (split vertices with the same uv and color are welded first; those on seams of the uv or colors are never moved, such that the seams stay closed)
+		bool preserve_uv = false;      // the new vertices are placed on the collapsed edges, such that uv and colors remain linearly interpolated
+	};
+
+	/** Simplify a triangle mesh with quadric error edge collapses (Garland and Heckbert 1997)
+	* The edges are collapsed by increasing error using a priority queue. Collapses that would fold a triangle or create a non-manifold configuration are rejected.
+	* vertex_to_proxy[k] is the index in the simplified mesh of the vertex the initial vertex k has been merged into (mapping from the initial mesh to the proxy).
+	* The normals of the result are recomputed, the uv and colors are interpolated if they are filled in the input. */
+	mesh mesh_simplify(mesh const& m, mesh_simplification_parameters const& parameters);
+	mesh mesh_simplify(mesh const& m, mesh_simplification_parameters const& parameters, numarray<int>& vertex_to_proxy);
+
+	/** Key identifying the simplification of a mesh: hash of the mesh (positions, connectivity, uv, colors) and of the parameters */
+	uint64_t mesh_simplify_key(mesh const& m, mesh_simplification_parameters const& parameters);
+
+	/** Same as mesh_simplify, but the result is stored in cache_directory and reloaded if the same mesh is simplified again with the same parameters
+	* The cache file is named cache_directory/mesh_simplify_[key].cgpproxy, where the key is a hash of the mesh and the parameters. The directory must exist (otherwise a warning is displayed and the proxy is not cached). */
+	mesh mesh_simplify_cached(mesh const& m, mesh_simplification_parameters const& parameters, std::string const& cache_directory, numarray<int>& vertex_to_proxy);
+}
@@ -0,0 +1,126 @@
+#include "test_mesh_simplification.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "../mesh_simplification.hpp"
+#include "../../primitive/mesh_primitive.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace cgp_test
+{
+	void test_mesh_simplification()
+	{
+		using namespace cgp;
+
+		// A flat grid is simplified without error, and its boundary is preserved
+		{
+			mesh const grid = mesh_primitive_grid({ 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, 20, 20);
+			mesh_simplification_parameters parameters;
+			parameters.target_triangle = 0;
+			numarray<int> vertex_to_proxy;
+			mesh const proxy = mesh_simplify(grid, parameters, vertex_to_proxy);
+
+			assert_cgp_no_msg(proxy.connectivity.size() < grid.connectivity.size() / 2);
+			assert_cgp_no_msg(vertex_to_proxy.size() == grid.position.size());
+			float area = 0.0f;
+			for (uint3 const& f : proxy.connectivity) {
+				vec3 const n = cross(proxy.position[f[1]] - proxy.position[f[0]], proxy.position[f[2]] - proxy.position[f[0]]);
+				assert_cgp_no_msg(n.z > 0); // no folded triangle
+				area += 0.5f * norm(n);
+			}
+			assert_cgp_no_msg(std::abs(area - 1.0f) < 1e-4f);
+			for (int k = 0; k < grid.position.size(); ++k) {
+				vec3 const& p = grid.position[k];
+				assert_cgp_no_msg(vertex_to_proxy[k] >= 0 && vertex_to_proxy[k] < proxy.position.size());
+				assert_cgp_no_msg(std::abs(proxy.position[vertex_to_proxy[k]].z) < 1e-5f);
+				bool const on_boundary = p.x == 0 || p.x == 1 || p.y == 0 || p.y == 1;
+				if (on_boundary)
+					assert_cgp_no_msg(is_equal(proxy.position[vertex_to_proxy[k]], p));
+			}
+		}
+
+		// Sphere reduced to a triangle budget: closed surface stays close to the sphere
+		mesh const sphere = mesh_primitive_sphere(1.0f, { 0,0,0 }, 60, 30);
+		mesh_simplification_parameters parameters;
+		parameters.target_triangle = 600;
+		numarray<int> vertex_to_proxy;
+		mesh const proxy = mesh_simplify(sphere, parameters, vertex_to_proxy);
+		assert_cgp_no_msg(proxy.connectivity.size() <= 600 && proxy.connectivity.size() > 500);
+		assert_cgp_no_msg(mesh_check(proxy));
+		for (vec3 const& p : proxy.position)
+			assert_cgp_no_msg(std::abs(norm(p) - 1.0f) < 0.05f);
+		for (int k = 0; k < sphere.position.size(); ++k)
+			assert_cgp_no_msg(norm(proxy.position[vertex_to_proxy[k]] - sphere.position[k]) < 0.5f);
+
+		// Without boundary preservation, the split vertices on the seam of the sphere stay joined
+		{
+			mesh_simplification_parameters free_boundary = parameters;
+			free_boundary.preserve_boundary = false;
+			numarray<int> free_vertex_to_proxy;
+			mesh const free_proxy = mesh_simplify(sphere, free_boundary, free_vertex_to_proxy);
+			assert_cgp_no_msg(free_proxy.connectivity.size() <= 600);
+			int N_split = 0;
+			for (int i = 0; i < sphere.position.size(); ++i)
+				for (int j = i + 1; j < sphere.position.size(); ++j)
+					if (norm(sphere.position[i] - sphere.position[j]) == 0.0f) {
+						assert_cgp_no_msg(norm(free_proxy.position[free_vertex_to_proxy[i]] - free_proxy.position[free_vertex_to_proxy[j]]) == 0.0f);
+						N_split++;
+					}
+			assert_cgp_no_msg(N_split > 0);
+		}
+
+		// Flat shading: every triangle has its own copies of its vertices, the copies with the same uv are welded and simplified together
+		{
+			mesh flat;
+			for (uint3 const& f : sphere.connectivity) {
+				int const N = flat.position.size();
+				for (int j = 0; j < 3; ++j) {
+					flat.position.push_back(sphere.position[f[j]]);
+					flat.uv.push_back(sphere.uv[f[j]]);
+				}
+				flat.connectivity.push_back({ N, N + 1, N + 2 });
+			}
+			flat.fill_empty_field();
+			numarray<int> flat_vertex_to_proxy;
+			mesh const flat_proxy = mesh_simplify(flat, parameters, flat_vertex_to_proxy);
+			assert_cgp_no_msg(flat_proxy.connectivity.size() <= 600 && mesh_check(flat_proxy));
+			for (int k = 0; k < flat.position.size(); ++k)
+				assert_cgp_no_msg(norm(flat_proxy.position[flat_vertex_to_proxy[k]] - flat.position[k]) < 0.5f);
+			numarray<int> first_copy(sphere.position.size()); // the copies of a vertex of the sphere are merged in the same vertex of the proxy
+			first_copy.fill(-1);
+			for (int t = 0; t < sphere.connectivity.size(); ++t)
+				for (int j = 0; j < 3; ++j) {
+					int& first = first_copy[sphere.connectivity[t][j]];
+					if (first == -1)
+						first = 3 * t + j;
+					assert_cgp_no_msg(flat_vertex_to_proxy[3 * t + j] == flat_vertex_to_proxy[first]);
+				}
+		}
+
+		// Error bound: few collapses are possible with a small error
+		mesh_simplification_parameters bounded;
+		bounded.max_error = 1e-10f;
+		assert_cgp_no_msg(mesh_simplify(sphere, bounded).connectivity.size() > proxy.connectivity.size());
+
+		// Cached proxy
+		numarray<int> cached_vertex_to_proxy;
+		mesh const cached = mesh_simplify_cached(sphere, parameters, ".", cached_vertex_to_proxy);
+		mesh const reloaded = mesh_simplify_cached(sphere, parameters, ".", cached_vertex_to_proxy);
+		assert_cgp_no_msg(cached.position.size() == proxy.position.size() && reloaded.connectivity.size() == proxy.connectivity.size());
+		for (int k = 0; k < proxy.position.size(); ++k)
+			assert_cgp_no_msg(is_equal(reloaded.position[k], proxy.position[k]));
+		for (int k = 0; k < vertex_to_proxy.size(); ++k)
+			assert_cgp_no_msg(cached_vertex_to_proxy[k] == vertex_to_proxy[k]);
+
+		std::string const cached_filename = cache_filename(".", "mesh_simplify_", mesh_simplify_key(sphere, parameters), ".cgpproxy");
+		assert_cgp_no_msg(check_file_exist(cached_filename));
+		std::remove(cached_filename.c_str());
+
+		// A cache that cannot be written doesn't prevent the simplification
+		numarray<int> uncached_vertex_to_proxy;
+		mesh const uncached = mesh_simplify_cached(sphere, parameters, "missing_directory", uncached_vertex_to_proxy);
+		assert_cgp_no_msg(uncached.connectivity.size() == proxy.connectivity.size() && uncached_vertex_to_proxy.size() == vertex_to_proxy.size());
+	}
+}
@@ -4,6 +4,11 @@
 
 namespace cgp
 {
+	size_t mesh::memory_size() const
+	{
+		return (position.size() + normal.size() + color.size()) * sizeof(vec3) + uv.size() * sizeof(vec2) + connectivity.size() * sizeof(uint3);
+	}
+
 	mesh& mesh::fill_empty_field()
 	{
 		size_t const N = position.size();
@@ -43,28 +48,11 @@ namespace cgp
 	}
 
 
-	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals, bool invert)
+	namespace
 	{
-		size_t const N = position.size();
-		if(normals.size()!=N)
-			normals.resize(N);
-		else
-			normals.fill(vec3{0,0,0});
-
-		size_t const N_tri = connectivity.size();
-		for (size_t k_tri = 0; k_tri < N_tri; ++k_tri)
+		// Unit normal and area of a triangle (both null for a degenerated triangle)
+		void triangle_normal_area(vec3 const& p0, vec3 const& p1, vec3 const& p2, vec3& normal, float& area)
 		{
-			uint3 const& face = connectivity.at(k_tri);
-
-			//sanity check
-			assert_cgp_no_msg(get<0>(face)<N);
-			assert_cgp_no_msg(get<1>(face)<N);
-			assert_cgp_no_msg(get<2>(face)<N);
-
-			vec3 const& p0 = position.at(get<0>(face));
-			vec3 const& p1 = position.at(get<1>(face));
-			vec3 const& p2 = position.at(get<2>(face));
-
 			// compute normal of the triangle
 			vec3 const p10 = p1-p0;
 			vec3 const p20 = p2-p0;
@@ -72,8 +60,10 @@ namespace cgp
 			float const L10 = norm(p10);
 			float const L20 = norm(p20);
 
-			// Add the normal direction to all vertices of this triangle
-			//  (only if the triangle is not degenerated: norm of edges>0, edges not aligned)
+			normal = vec3{0,0,0};
+			area = 0.0f;
+
+			// Only consider non degenerated triangles: norm of edges>0, edges not aligned
 			if (L10 > 1e-6f && L20 > 1e-6f)
 			{
 				vec3 const n = cross(p10/L10, p20/L20);
@@ -81,28 +71,89 @@ namespace cgp
 
 				if (Ln > 1e-6f)
 				{
-					vec3 const n_unit = n/Ln;
-					for(unsigned int idx : face)
-						normals.at(idx) += n_unit;
+					normal = n/Ln;
+					area = 0.5f * L10 * L20 * Ln;
 				}
+			}
+		}
 
-
+		void normalize_vertex_normals(numarray<vec3>& normals, bool invert)
+		{
+			for (vec3& n : normals)
+			{
+				float const L = norm(n);
+				if(L>1e-6f)
+					n /= L;
+				if(invert)
+					n = -n;
 			}
 		}
+	}
 
-		// Normalize all normals
-		for (size_t k = 0; k < N; ++k)
+	void normal_per_triangle(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& triangle_normal, numarray<float>& triangle_area)
+	{
+		size_t const N = position.size();
+		int const N_tri = connectivity.size();
+		triangle_normal.resize(N_tri);
+		triangle_area.resize(N_tri);
+
+		#pragma omp parallel for
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
 		{
-			vec3& n = normals.at(k);
-			float const L = norm(n);
-			if(L>1e-6f)
-				n /= L;
+			uint3 const& face = connectivity.at(k_tri);
+
+			//sanity check
+			assert_cgp_no_msg(get<0>(face)<N);
+			assert_cgp_no_msg(get<1>(face)<N);
+			assert_cgp_no_msg(get<2>(face)<N);
+
+			triangle_normal_area(position.at(get<0>(face)), position.at(get<1>(face)), position.at(get<2>(face)), triangle_normal.at(k_tri), triangle_area.at(k_tri));
+		}
+	}
+
+	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals, bool invert)
+	{
+		size_t const N = position.size();
+		if(normals.size()!=N)
+			normals.resize(N);
+		normals.fill(vec3{0,0,0});
+
+		// Same sum of the unit normals of the triangles as the version from per-triangle normals, without storing them
+		size_t const N_tri = connectivity.size();
+		for (size_t k_tri = 0; k_tri < N_tri; ++k_tri)
+		{
+			uint3 const& face = connectivity.at(k_tri);
+			assert_cgp_no_msg(get<0>(face)<N && get<1>(face)<N && get<2>(face)<N);
+
+			vec3 n_unit;
+			float area;
+			triangle_normal_area(position.at(get<0>(face)), position.at(get<1>(face)), position.at(get<2>(face)), n_unit, area);
+			for(unsigned int idx : face)
+				normals.at(idx) += n_unit;
 		}
 
-		// Invert normals if asked
-		if(invert) for(auto& n : normals) n = -n;
+		normalize_vertex_normals(normals, invert);
+	}
+
+	void normal_per_vertex(numarray<vec3> const& triangle_normal, numarray<uint3> const& connectivity, int N_vertex, numarray<vec3>& normals, bool invert)
+	{
+		assert_cgp(triangle_normal.size()==connectivity.size(), "Incoherent number of triangle normals (size(triangle_normal)="+str(triangle_normal.size())+", size(connectivity)="+str(connectivity.size())+")");
+
+		size_t const N = N_vertex;
+		if(normals.size()!=N)
+			normals.resize(N);
+		normals.fill(vec3{0,0,0});
+
+		// Add the normal direction to all vertices of each triangle (degenerated triangles have a null normal)
+		size_t const N_tri = connectivity.size();
+		for (size_t k_tri = 0; k_tri < N_tri; ++k_tri)
+		{
+			vec3 const& n_unit = triangle_normal.at(k_tri);
+			for(unsigned int idx : connectivity.at(k_tri))
+				normals.at(idx) += n_unit;
+		}
 
-			
+		normalize_vertex_normals(normals, invert);
 	}
 	numarray<vec3> normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, bool invert)
 	{
@@ -25,6 +25,9 @@ namespace cgp
 		mesh& push_back(mesh const& to_add);
 		mesh& flip_connectivity();
 		mesh& normal_update();
+
+		/** Octets used by the arrays of the mesh */
+		size_t memory_size() const;
 	};
 
 	/** Compute automaticaly a per-vertex normal given a set of positions and their connectivity 
@@ -33,6 +36,12 @@ namespace cgp
 	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals_to_fill, bool invert=false);
 	/** Compute automaticaly a per-vertex normal given a set of positions and their connectivity */
 	numarray<vec3> normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, bool invert=false);
+	/** Compute the per-vertex normal from per-triangle normals already computed with normal_per_triangle */
+	void normal_per_vertex(numarray<vec3> const& triangle_normal, numarray<uint3> const& connectivity, int N_vertex, numarray<vec3>& normals_to_fill, bool invert=false);
+
+	/** Compute the unit normal and the area of each triangle (both are set to 0 for degenerate triangles)
+	* The triangles are processed in parallel. The results can be reused by per-triangle computations (ex. aerodynamic forces) and by normal_per_vertex. */
+	void normal_per_triangle(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& triangle_normal, numarray<float>& triangle_area);
 
 	/** Check if the mesh looks coherent (correct indexing and size of buffer, no degenerate triangle, etc) */
 	bool mesh_check(mesh const& m);
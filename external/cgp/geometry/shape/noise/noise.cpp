@@ -2,6 +2,12 @@
 
 #include "third_party/src/simplexnoise/simplexnoise1234.hpp"
 #include "cgp/core/base/base.hpp"
+#include "cgp/core/array/pack/pack.hpp"
+
+#include <cmath>
+
+// Permutation table of simplexnoise1234.cpp (shared such that the batched noise matches snoise3)
+extern unsigned char perm[512];
 
 namespace cgp
 {
@@ -50,4 +56,257 @@ namespace cgp
         return value;
     }
 
-}
\ No newline at end of file
+
+
+    namespace
+    {
+        // Gradient directions of grad3: grad3(h,x,y,z) = dot(simplex_gradient[h&15], (x,y,z))
+        float const simplex_gradient[16][3] = {
+            { 1, 1, 0}, {-1, 1, 0}, { 1,-1, 0}, {-1,-1, 0},
+            { 1, 0, 1}, {-1, 0, 1}, { 1, 0,-1}, {-1, 0,-1},
+            { 0, 1, 1}, { 0,-1, 1}, { 0, 1,-1}, { 0,-1,-1},
+            { 1, 1, 0}, { 0,-1, 1}, {-1, 1, 0}, { 0,-1,-1} };
+
+        // Hash of the 4 corners of the simplex cell containing the point (same hash as snoise3)
+        //  (i,j,k): integer coordinates of the cell, (i1,j1,k1) and (i2,j2,k2): offsets of the second and third corners
+        void simplex_corner_hash(float i, float j, float k, float i1, float j1, float k1, float i2, float j2, float k2, int hash[4])
+        {
+            int const ii = int(i) & 0xff;
+            int const jj = int(j) & 0xff;
+            int const kk = int(k) & 0xff;
+            hash[0] = perm[ii + perm[jj + perm[kk]]] & 15;
+            hash[1] = perm[ii + int(i1) + perm[jj + int(j1) + perm[kk + int(k1)]]] & 15;
+            hash[2] = perm[ii + int(i2) + perm[jj + int(j2) + perm[kk + int(k2)]]] & 15;
+            hash[3] = perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]] & 15;
+        }
+
+        // Gradients of the 4 corners
+        void simplex_corner_gradients(float i, float j, float k, float i1, float j1, float k1, float i2, float j2, float k2, float g[4][3])
+        {
+            int hash[4];
+            simplex_corner_hash(i, j, k, i1, j1, k1, i2, j2, k2, hash);
+            for (int c = 0; c < 4; ++c)
+                for (int d = 0; d < 3; ++d)
+                    g[c][d] = simplex_gradient[hash[c]][d];
+        }
+        void simplex_corner_gradients(float_pack const& i, float_pack const& j, float_pack const& k, float_pack const& i1, float_pack const& j1, float_pack const& k1, float_pack const& i2, float_pack const& j2, float_pack const& k2, float_pack g[4][3])
+        {
+            // Table lookups cannot be vectorized: gather lane by lane
+            for (int lane = 0; lane < pack_lanes; ++lane) {
+                int hash[4];
+                simplex_corner_hash(i[lane], j[lane], k[lane], i1[lane], j1[lane], k1[lane], i2[lane], j2[lane], k2[lane], hash);
+                for (int c = 0; c < 4; ++c)
+                    for (int d = 0; d < 3; ++d)
+                        g[c][d][lane] = simplex_gradient[hash[c]][d];
+            }
+        }
+
+        // 3D simplex noise in [-1,1] (same as snoise3) and its gradient (dx,dy,dz) if with_gradient is true
+        //  Branch-free version: T is either float or float_pack
+        template <bool with_gradient, typename T>
+        T simplex_noise_3d(T const& x, T const& y, T const& z, T& dx, T& dy, T& dz)
+        {
+            using std::floor;
+            using std::max;
+
+            float const F3 = 0.333333333f;
+            float const G3 = 0.166666667f;
+
+            T const s = (x + y + z) * F3;
+            T const i = floor(x + s);
+            T const j = floor(y + s);
+            T const k = floor(z + s);
+            T const t = (i + j + k) * G3;
+
+            T p[4][3];
+            p[0][0] = x - (i - t);
+            p[0][1] = y - (j - t);
+            p[0][2] = z - (k - t);
+
+            // Simplex containing the point (same choice as the nested conditions of snoise3)
+            auto const xy = p[0][0] >= p[0][1];
+            auto const yz = p[0][1] >= p[0][2];
+            auto const xz = p[0][0] >= p[0][2];
+            T const one = 1.0f, zero = 0.0f;
+            T const i1 = select(xy && (yz || xz), one, zero);
+            T const j1 = select(!xy && yz, one, zero);
+            T const k1 = select(xy, select(!yz && !xz, one, zero), select(!yz, one, zero));
+            T const i2 = select(xy || (yz && xz), one, zero);
+            T const j2 = select(!xy || yz, one, zero);
+            T const k2 = select(xy, select(!yz, one, zero), select(!yz || !xz, one, zero));
+
+            T const offset[3][3] = { {i1, j1, k1}, {i2, j2, k2}, {one, one, one} };
+            for (int c = 1; c < 4; ++c)
+                for (int d = 0; d < 3; ++d)
+                    p[c][d] = p[0][d] - offset[c - 1][d] + float(c) * G3;
+
+            T g[4][3];
+            simplex_corner_gradients(i, j, k, i1, j1, k1, i2, j2, k2, g);
+
+            // Sum of the contributions n_c = t_c^4 (g_c.p_c), with t_c = max(0.6-|p_c|^2, 0)
+            //  and their gradients t_c^4 g_c - 8 t_c^3 (g_c.p_c) p_c
+            T value = zero;
+            dx = zero; dy = zero; dz = zero;
+            for (int c = 0; c < 4; ++c)
+            {
+                T const tc = max(0.6f - p[c][0] * p[c][0] - p[c][1] * p[c][1] - p[c][2] * p[c][2], zero);
+                T const tc2 = tc * tc;
+                T const tc4 = tc2 * tc2;
+                T const tc3 = tc2 * tc;
+                T const gp = g[c][0] * p[c][0] + g[c][1] * p[c][1] + g[c][2] * p[c][2];
+
+                value += tc4 * gp;
+                if (with_gradient) {
+                    T const w = -8.0f * tc3 * gp;
+                    dx += tc4 * g[c][0] + w * p[c][0];
+                    dy += tc4 * g[c][1] + w * p[c][1];
+                    dz += tc4 * g[c][2] + w * p[c][2];
+                }
+            }
+
+            if (with_gradient) {
+                dx *= 32.0f; dy *= 32.0f; dz *= 32.0f;
+            }
+            return 32.0f * value;
+        }
+
+        // Multi-octave noise (same sum as noise_perlin) and its gradient (gx,gy,gz) if with_gradient is true
+        template <bool with_gradient, typename T>
+        T noise_perlin_kernel(T const& x, T const& y, T const& z, int octave, float persistency, float frequency_gain, T& gx, T& gy, T& gz)
+        {
+            T value = 0.0f;
+            gx = 0.0f; gy = 0.0f; gz = 0.0f;
+            float a = 1.0f; // current magnitude
+            float f = 1.0f; // current frequency
+            for (int k = 0; k < octave; k++)
+            {
+                T dx, dy, dz;
+                T const n = simplex_noise_3d<with_gradient>(x * f, y * f, z * f, dx, dy, dz);
+                value += a * (0.5f + 0.5f * n);
+                if (with_gradient) {
+                    gx += (0.5f * a * f) * dx;
+                    gy += (0.5f * a * f) * dy;
+                    gz += (0.5f * a * f) * dz;
+                }
+                f *= frequency_gain;
+                a *= persistency;
+            }
+            return value;
+        }
+
+        // Offsets decorrelating the three components of the vector potential of the curl noise
+        float const curl_offset[3][3] = { {0.0f, 0.0f, 0.0f}, {31.416f, -47.853f, 12.793f}, {-233.145f, -113.408f, -185.31f} };
+
+        template <typename T>
+        void noise_curl_kernel(T const& x, T const& y, T const& z, int octave, float persistency, float frequency_gain, T& vx, T& vy, T& vz)
+        {
+            // Gradients of the three components of the potential psi
+            T g[3][3];
+            for (int c = 0; c < 3; ++c)
+                noise_perlin_kernel<true>(x + curl_offset[c][0], y + curl_offset[c][1], z + curl_offset[c][2], octave, persistency, frequency_gain, g[c][0], g[c][1], g[c][2]);
+
+            // curl(psi) = (dpsi_z/dy - dpsi_y/dz, dpsi_x/dz - dpsi_z/dx, dpsi_y/dx - dpsi_x/dy)
+            vx = g[2][1] - g[1][2];
+            vy = g[0][2] - g[2][0];
+            vz = g[1][0] - g[0][1];
+        }
+
+        // Positions of the pack starting at offset (the last incomplete pack is padded with the last position)
+        void load_pack(numarray<vec3> const& p, int offset, float_pack& x, float_pack& y, float_pack& z)
+        {
+            int const N = p.size();
+            for (int lane = 0; lane < pack_lanes; ++lane) {
+                vec3 const& q = p.at_unsafe(std::min(offset + lane, N - 1));
+                x[lane] = q.x;
+                y[lane] = q.y;
+                z[lane] = q.z;
+            }
+        }
+    }
+
+    float noise_perlin_gradient(vec3 const& p, vec3& gradient, int octave, float persistency, float frequency_gain)
+    {
+        return noise_perlin_kernel<true>(p.x, p.y, p.z, octave, persistency, frequency_gain, gradient.x, gradient.y, gradient.z);
+    }
+
+    vec3 noise_curl(vec3 const& p, int octave, float persistency, float frequency_gain)
+    {
+        vec3 v;
+        noise_curl_kernel(p.x, p.y, p.z, octave, persistency, frequency_gain, v.x, v.y, v.z);
+        return v;
+    }
+
+    numarray<float> noise_perlin(numarray<vec3> const& p, int octave, float persistency, float frequency_gain)
+    {
+        int const N = p.size();
+        numarray<float> value(N);
+
+        int const N_pack = (N + pack_lanes - 1) / pack_lanes;
+        #pragma omp parallel for
+        for (int k_pack = 0; k_pack < N_pack; ++k_pack)
+        {
+            int const offset = k_pack * pack_lanes;
+            float_pack x, y, z, gx, gy, gz;
+            load_pack(p, offset, x, y, z);
+
+            float_pack const v = noise_perlin_kernel<false>(x, y, z, octave, persistency, frequency_gain, gx, gy, gz);
+
+            for (int lane = 0; lane < pack_lanes && offset + lane < N; ++lane)
+                value.at_unsafe(offset + lane) = v[lane];
+        }
+        return value;
+    }
+
+    void noise_perlin_gradient(numarray<vec3> const& p, numarray<float>& value, numarray<vec3>& gradient, int octave, float persistency, float frequency_gain)
+    {
+        int const N = p.size();
+        value.resize(N);
+        gradient.resize(N);
+
+        int const N_pack = (N + pack_lanes - 1) / pack_lanes;
+        #pragma omp parallel for
+        for (int k_pack = 0; k_pack < N_pack; ++k_pack)
+        {
+            int const offset = k_pack * pack_lanes;
+            float_pack x, y, z, gx, gy, gz;
+            load_pack(p, offset, x, y, z);
+
+            float_pack const v = noise_perlin_kernel<true>(x, y, z, octave, persistency, frequency_gain, gx, gy, gz);
+
+            for (int lane = 0; lane < pack_lanes && offset + lane < N; ++lane) {
+                value.at_unsafe(offset + lane) = v[lane];
+                gradient.at_unsafe(offset + lane) = { gx[lane], gy[lane], gz[lane] };
+            }
+        }
+    }
+
+    numarray<vec3> noise_curl(numarray<vec3> const& p, int octave, float persistency, float frequency_gain)
+    {
+        numarray<vec3> velocity;
+        noise_curl(p, velocity, octave, persistency, frequency_gain);
+        return velocity;
+    }
+
+    void noise_curl(numarray<vec3> const& p, numarray<vec3>& velocity, int octave, float persistency, float frequency_gain)
+    {
+        // Each pack reads its positions before writing its values, such that p and velocity can be the same array
+        int const N = p.size();
+        if (velocity.size() != N)
+            velocity.resize(N);
+
+        int const N_pack = (N + pack_lanes - 1) / pack_lanes;
+        #pragma omp parallel for
+        for (int k_pack = 0; k_pack < N_pack; ++k_pack)
+        {
+            int const offset = k_pack * pack_lanes;
+            float_pack x, y, z, vx, vy, vz;
+            load_pack(p, offset, x, y, z);
+
+            noise_curl_kernel(x, y, z, octave, persistency, frequency_gain, vx, vy, vz);
+
+            for (int lane = 0; lane < pack_lanes && offset + lane < N; ++lane)
+                velocity.at_unsafe(offset + lane) = { vx[lane], vy[lane], vz[lane] };
+        }
+    }
+
+}
@@ -1,10 +1,28 @@
 #pragma once
 
 #include "cgp/geometry/vec/vec.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
 
 namespace cgp
 {
 	float noise_perlin(float x,       int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
 	float noise_perlin(vec2 const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
 	float noise_perlin(vec3 const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
-}
\ No newline at end of file
+
+	/** Noise value and its analytic gradient at position p (same value as noise_perlin(p)) */
+	float noise_perlin_gradient(vec3 const& p, vec3& gradient, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+
+	/** Curl noise: divergence-free vector field, computed as the curl of a vector potential made of three decorrelated noise_perlin fields
+	* Typically used as a turbulent wind or fluid velocity field (the velocity is computed from the analytic gradients of the potential) */
+	vec3 noise_curl(vec3 const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+
+
+	// Batched versions evaluated on all the positions of an array
+	//  The evaluation is vectorized along the positions (8 positions at once) and parallelized with OpenMP.
+	//  The results match the scalar versions up to floating point precision.
+	numarray<float> noise_perlin(numarray<vec3> const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	void noise_perlin_gradient(numarray<vec3> const& p, numarray<float>& value, numarray<vec3>& gradient, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	numarray<vec3> noise_curl(numarray<vec3> const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	/** Version filling velocity (no allocation if it already has the size of p). velocity can be the same array as p. */
+	void noise_curl(numarray<vec3> const& p, numarray<vec3>& velocity, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+}
@@ -0,0 +1,67 @@
+#include "test_noise.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../noise.hpp"
+
+#include <cmath>
+
+namespace cgp_test
+{
+	void test_noise()
+	{
+		using namespace cgp;
+
+		int const N = 1001; // not a multiple of the number of lanes
+		numarray<vec3> p(N);
+		for (int k = 0; k < N; ++k)
+			p[k] = { rand_interval(-20.0f, 20.0f), rand_interval(-20.0f, 20.0f), rand_interval(-20.0f, 20.0f) };
+		p[0] = { 0,0,0 };
+		p[1] = { 1.5f,1.5f,1.5f }; // diagonal of the simplex grid
+		p[2] = { -3.0f,2.0f,-7.0f };
+
+		// Batched evaluation matches the scalar noise
+		numarray<float> value;
+		numarray<vec3> gradient;
+		noise_perlin_gradient(p, value, gradient, 4, 0.4f, 2.0f);
+		numarray<float> const value_only = noise_perlin(p, 4, 0.4f, 2.0f);
+		for (int k = 0; k < N; ++k) {
+			float const reference = noise_perlin(p[k], 4, 0.4f, 2.0f);
+			assert_cgp_no_msg(std::abs(value[k] - reference) < 1e-3f);
+			assert_cgp_no_msg(value_only[k] == value[k]);
+
+			vec3 g;
+			assert_cgp_no_msg(std::abs(noise_perlin_gradient(p[k], g, 4, 0.4f, 2.0f) - reference) < 1e-3f);
+			assert_cgp_no_msg(norm(g - gradient[k]) < 1e-3f * (1.0f + norm(g)));
+		}
+
+		// Analytic gradient compared to finite differences
+		//  (checked on most of the points: finite differences are not valid across the small discontinuities of snoise3)
+		float const h = 1e-3f;
+		int gradient_match = 0;
+		for (int k = 0; k < 100; ++k) {
+			vec3 const& q = p[k];
+			vec3 const fd = {
+				(noise_perlin(q + vec3{h,0,0}, 4, 0.4f, 2.0f) - noise_perlin(q - vec3{h,0,0}, 4, 0.4f, 2.0f)) / (2 * h),
+				(noise_perlin(q + vec3{0,h,0}, 4, 0.4f, 2.0f) - noise_perlin(q - vec3{0,h,0}, 4, 0.4f, 2.0f)) / (2 * h),
+				(noise_perlin(q + vec3{0,0,h}, 4, 0.4f, 2.0f) - noise_perlin(q - vec3{0,0,h}, 4, 0.4f, 2.0f)) / (2 * h) };
+			if (norm(fd - gradient[k]) < 2e-2f * (1.0f + norm(fd)))
+				gradient_match++;
+		}
+		assert_cgp_no_msg(gradient_match > 90);
+
+		// Curl noise: batched matches scalar, and the field is divergence-free (on most of the points)
+		numarray<vec3> const v = noise_curl(p, 3);
+		int divergence_free = 0;
+		for (int k = 0; k < 100; ++k) {
+			vec3 const& q = p[k];
+			assert_cgp_no_msg(norm(v[k] - noise_curl(q, 3)) < 1e-3f * (1.0f + norm(v[k])));
+
+			float const dvx = (noise_curl(q + vec3{h,0,0}, 3).x - noise_curl(q - vec3{h,0,0}, 3).x) / (2 * h);
+			float const dvy = (noise_curl(q + vec3{0,h,0}, 3).y - noise_curl(q - vec3{0,h,0}, 3).y) / (2 * h);
+			float const dvz = (noise_curl(q + vec3{0,0,h}, 3).z - noise_curl(q - vec3{0,0,h}, 3).z) / (2 * h);
+			if (std::abs(dvx + dvy + dvz) < 0.05f * (1.0f + std::abs(dvx) + std::abs(dvy) + std::abs(dvz)))
+				divergence_free++;
+		}
+		assert_cgp_no_msg(divergence_free > 90);
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "mesh/mesh.hpp"
+#include "tet_mesh/tet_mesh.hpp"
 #include "curve/curve.hpp"
 #include "noise/noise.hpp"
 #include "intersection/intersection.hpp"
@@ -0,0 +1,92 @@
+#include "tet_binary.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+
+#include <cstring>
+
+namespace cgp
+{
+	static_assert(sizeof(vec3) == 3 * sizeof(float) && sizeof(uint3) == 3 * sizeof(unsigned int) && sizeof(uint4) == 4 * sizeof(unsigned int), "The binary format stores vectors as packed values");
+
+	namespace
+	{
+		char const tet_binary_magic[8] = { 'C','G','P','T','E','T','\0','\0' };
+		uint32_t const tet_binary_version = 1;
+
+		struct tet_binary_header
+		{
+			binary_file_signature signature;
+
+			uint64_t N_vertex;
+			uint64_t N_tetrahedron;
+			uint64_t N_face;
+
+			uint64_t offset_position;
+			uint64_t offset_connectivity;
+			uint64_t offset_face;
+		};
+	}
+
+	void save_file_tet_binary(std::string const& filename, tet_mesh const& m)
+	{
+		tet_binary_header header;
+		std::memset(&header, 0, sizeof(header));
+		header.signature = binary_file_signature_create(tet_binary_magic, tet_binary_version);
+		header.N_vertex = m.position.size();
+		header.N_tetrahedron = m.connectivity.size();
+		header.N_face = m.face.size();
+		header.offset_position = binary_file_align(sizeof(header));
+		header.offset_connectivity = binary_file_align(header.offset_position + header.N_vertex * sizeof(vec3));
+		header.offset_face = binary_file_align(header.offset_connectivity + header.N_tetrahedron * sizeof(uint4));
+
+		std::string const error = file_write_atomic(filename, [&](std::ostream& stream) {
+			uint64_t position = 0;
+			binary_file_write_block(stream, position, 0, &header, sizeof(header));
+			binary_file_write_block(stream, position, header.offset_position, m.position.data.data(), header.N_vertex * sizeof(vec3));
+			binary_file_write_block(stream, position, header.offset_connectivity, m.connectivity.data.data(), header.N_tetrahedron * sizeof(uint4));
+			binary_file_write_block(stream, position, header.offset_face, m.face.data.data(), header.N_face * sizeof(uint3));
+		});
+		assert_cgp(error.empty(), error);
+	}
+
+	tet_mesh tet_mesh_load_file_tet_binary(std::string const& filename)
+	{
+		assert_file_exist(filename);
+		file_mapping const file(filename);
+		assert_cgp(file.size >= sizeof(tet_binary_header), "File " + filename + " is not a binary tet_mesh file (too small)");
+
+		tet_binary_header header;
+		std::memcpy(&header, file.data, sizeof(header));
+		std::string const error = binary_file_signature_check(header.signature, tet_binary_magic, tet_binary_version, filename, "binary tet_mesh file");
+		assert_cgp(error.empty(), error);
+
+		bool const valid_size = header.N_vertex <= file.size && header.N_tetrahedron <= file.size && header.N_face <= file.size
+			&& header.offset_position + header.N_vertex * sizeof(vec3) <= file.size
+			&& header.offset_connectivity + header.N_tetrahedron * sizeof(uint4) <= file.size
+			&& header.offset_face + header.N_face * sizeof(uint3) <= file.size;
+		assert_cgp(valid_size, "File " + filename + " is truncated or corrupted");
+
+		tet_mesh m;
+		m.position.resize(header.N_vertex);
+		m.connectivity.resize(header.N_tetrahedron);
+		m.face.resize(header.N_face);
+		if (header.N_vertex > 0)
+			std::memcpy(m.position.data.data(), file.data + header.offset_position, header.N_vertex * sizeof(vec3));
+		if (header.N_tetrahedron > 0)
+			std::memcpy(m.connectivity.data.data(), file.data + header.offset_connectivity, header.N_tetrahedron * sizeof(uint4));
+		if (header.N_face > 0)
+			std::memcpy(m.face.data.data(), file.data + header.offset_face, header.N_face * sizeof(uint3));
+
+		// Indices are used without checks by the rest of the code: a corrupted file must not lead to out of bounds accesses
+		uint64_t const N_vertex = header.N_vertex;
+		for (int k = 0; k < m.connectivity.size(); ++k)
+			for (int j = 0; j < 4; ++j)
+				assert_cgp(m.connectivity[k][j] < N_vertex, "Incorrect vertex index " + str(m.connectivity[k][j]) + " of tetrahedron " + str(k) + " in file " + filename + " (number of vertices: " + str(N_vertex) + ")");
+		for (int k = 0; k < m.face.size(); ++k)
+			for (int j = 0; j < 3; ++j)
+				assert_cgp(m.face[k][j] < N_vertex, "Incorrect vertex index " + str(m.face[k][j]) + " of face " + str(k) + " in file " + filename + " (number of vertices: " + str(N_vertex) + ")");
+
+		return m;
+	}
+}
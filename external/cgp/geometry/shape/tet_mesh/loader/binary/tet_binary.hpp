@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../../structure/tet_mesh.hpp"
+
+namespace cgp
+{
+	// Binary format of tetrahedral meshes, fast to load compared to text formats (no parsing)
+	//  A versioned header followed by the position, connectivity and face blocks aligned on 64 octets
+	//  The values are stored in the native representation of the machine (the format is not meant to be exchanged between different architectures)
+
+	/** Save a tetrahedral mesh in binary format (extension .cgptet by convention) */
+	void save_file_tet_binary(std::string const& filename, tet_mesh const& m);
+
+	/** Load a tetrahedral mesh saved with save_file_tet_binary (the file is read through a memory mapping)
+	* A truncated file, or a file with vertex indices out of range, is reported as an error */
+	tet_mesh tet_mesh_load_file_tet_binary(std::string const& filename);
+}
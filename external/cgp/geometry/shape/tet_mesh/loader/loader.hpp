@@ -0,0 +1,4 @@
+#pragma once
+
+#include "tetgen/tetgen.hpp"
+#include "binary/tet_binary.hpp"
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "tetgen.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+namespace cgp
+{
+	namespace
+	{
+		// Sequential reader of the values of a TetGen file: values are separated by spaces or new lines, and '#' starts a comment until the end of the line
+		struct tetgen_reader
+		{
+			file_mapping file;
+			std::string filename;
+			char const* p = nullptr;
+
+			explicit tetgen_reader(std::string const& filename_arg)
+				:file(filename_arg), filename(filename_arg), p(file.begin())
+			{}
+
+			void skip_separators()
+			{
+				char const* const end = file.end();
+				while (p < end) {
+					p = parse_skip_spaces(p, end);
+					if (p < end && *p == '\n')
+						++p;
+					else if (p < end && *p == '#')
+						p = parse_line_end(p, end);
+					else
+						break;
+				}
+			}
+
+			int read_int()
+			{
+				skip_separators();
+				int value = 0;
+				bool const ok = parse_int(p, file.end(), value);
+				assert_cgp(ok, "Cannot read integer value in file " + filename + " at position " + str(p - file.begin()));
+				return value;
+			}
+
+			float read_float()
+			{
+				skip_separators();
+				float value = 0.0f;
+				bool const ok = parse_float(p, file.end(), value);
+				assert_cgp(ok, "Cannot read floating point value in file " + filename + " at position " + str(p - file.begin()));
+				return value;
+			}
+
+			// Skip the optional values remaining on the current line (attributes, markers)
+			void skip_line()
+			{
+				p = parse_line_end(p, file.end());
+			}
+		};
+
+		std::string tetgen_basename(std::string const& filename)
+		{
+			for (std::string const extension : { ".node", ".ele", ".face" })
+				if (filename.size() > extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0)
+					return filename.substr(0, filename.size() - extension.size());
+			return filename;
+		}
+
+		unsigned int read_index(tetgen_reader& reader, int first_index, int N_vertex)
+		{
+			int const idx = reader.read_int() - first_index;
+			assert_cgp(idx >= 0 && idx < N_vertex, "Incorrect vertex index " + str(idx + first_index) + " in file " + reader.filename + " (number of vertices: " + str(N_vertex) + ", first index: " + str(first_index) + ")");
+			return static_cast<unsigned int>(idx);
+		}
+	}
+
+	tet_mesh tet_mesh_load_file_tetgen(std::string const& filename)
+	{
+		std::string const basename = tetgen_basename(filename);
+		tet_mesh m;
+		int first_index = 0;
+
+		// Vertices: <N> <dimension=3> <N attributes> <boundary marker 0/1>, then <index> <x> <y> <z> [attributes] [marker]
+		{
+			assert_file_exist(basename + ".node");
+			tetgen_reader reader(basename + ".node");
+			int const N = reader.read_int();
+			int const dimension = reader.read_int();
+			assert_cgp(dimension == 3, "TetGen file " + reader.filename + " must store 3D vertices (dimension=" + str(dimension) + ")");
+			reader.skip_line();
+
+			m.position.resize(N);
+			for (int k = 0; k < N; ++k) {
+				int const idx = reader.read_int();
+				if (k == 0)
+					first_index = idx;
+				assert_cgp(idx == k + first_index, "Vertices of TetGen file " + reader.filename + " must be numbered consecutively (vertex " + str(idx) + " at line " + str(k + 1) + ")");
+				vec3& p = m.position[k];
+				p.x = reader.read_float();
+				p.y = reader.read_float();
+				p.z = reader.read_float();
+				reader.skip_line();
+			}
+		}
+
+		int const N_vertex = m.position.size();
+
+		// Tetrahedra: <N> <nodes per tetrahedron 4/10> <N attributes>, then <index> <n1> ... <nk> [attributes]
+		{
+			assert_file_exist(basename + ".ele");
+			tetgen_reader reader(basename + ".ele");
+			int const N = reader.read_int();
+			int const nodes = reader.read_int();
+			assert_cgp(nodes == 4 || nodes == 10, "TetGen file " + reader.filename + " must store tetrahedra with 4 or 10 nodes (nodes=" + str(nodes) + ")");
+			reader.skip_line();
+
+			m.connectivity.resize(N);
+			for (int k = 0; k < N; ++k) {
+				reader.read_int();
+				for (int j = 0; j < 4; ++j)
+					m.connectivity[k][j] = read_index(reader, first_index, N_vertex);
+				reader.skip_line();
+			}
+		}
+
+		// Boundary faces (optional): <N> <boundary marker 0/1>, then <index> <a> <b> <c> [marker]
+		if (check_file_exist(basename + ".face"))
+		{
+			tetgen_reader reader(basename + ".face");
+			int const N = reader.read_int();
+			reader.skip_line();
+
+			m.face.resize(N);
+			for (int k = 0; k < N; ++k) {
+				reader.read_int();
+				for (int j = 0; j < 3; ++j)
+					m.face[k][j] = read_index(reader, first_index, N_vertex);
+				reader.skip_line();
+			}
+		}
+
+		return m;
+	}
+
+	void save_file_tetgen(std::string const& filename, tet_mesh const& m)
+	{
+		std::string const basename = tetgen_basename(filename);
+		char buffer[128];
+		auto const write_line = [&buffer](std::ofstream& stream, int n) { stream.write(buffer, n); };
+
+		{
+			std::ofstream stream(basename + ".node");
+			assert_cgp(stream.is_open(), "Cannot open file " + basename + ".node");
+			stream << m.position.size() << " 3 0 0\n";
+			for (int k = 0; k < m.position.size(); ++k) {
+				vec3 const& p = m.position[k];
+				write_line(stream, std::snprintf(buffer, sizeof(buffer), "%d %.9g %.9g %.9g\n", k, p.x, p.y, p.z));
+			}
+		}
+
+		{
+			std::ofstream stream(basename + ".ele");
+			assert_cgp(stream.is_open(), "Cannot open file " + basename + ".ele");
+			stream << m.connectivity.size() << " 4 0\n";
+			for (int k = 0; k < m.connectivity.size(); ++k) {
+				uint4 const& tet = m.connectivity[k];
+				write_line(stream, std::snprintf(buffer, sizeof(buffer), "%d %u %u %u %u\n", k, tet[0], tet[1], tet[2], tet[3]));
+			}
+		}
+
+		if (m.face.size() > 0)
+		{
+			std::ofstream stream(basename + ".face");
+			assert_cgp(stream.is_open(), "Cannot open file " + basename + ".face");
+			stream << m.face.size() << " 0\n";
+			for (int k = 0; k < m.face.size(); ++k) {
+				uint3 const& f = m.face[k];
+				write_line(stream, std::snprintf(buffer, sizeof(buffer), "%d %u %u %u\n", k, f[0], f[1], f[2]));
+			}
+		}
+	}
+}
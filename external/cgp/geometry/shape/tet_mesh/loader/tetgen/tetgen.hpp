@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../../structure/tet_mesh.hpp"
+
+namespace cgp
+{
+	/** Load a tetrahedral mesh stored in the TetGen format
+	* - filename: path without extension (or with the extension .node/.ele/.face), the files [basename].node and [basename].ele are read, as well as [basename].face if it exists
+	* - Indices can start at 0 or 1 (deduced from the first vertex of the .node file)
+	* - Only the corner vertices of quadratic (10 nodes) tetrahedra are kept. Attributes and boundary markers are ignored. */
+	tet_mesh tet_mesh_load_file_tetgen(std::string const& filename);
+
+	/** Save a tetrahedral mesh in the TetGen format ([basename].node, [basename].ele, and [basename].face if the mesh has faces)
+	* Indices start at 0 */
+	void save_file_tetgen(std::string const& filename, tet_mesh const& m);
+}
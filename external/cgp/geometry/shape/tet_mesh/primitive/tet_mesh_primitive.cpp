@@ -0,0 +1,37 @@
+#include "tet_mesh_primitive.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+namespace cgp
+{
+	tet_mesh tet_mesh_primitive_cube(vec3 const& center, float edge_length, int N)
+	{
+		assert_cgp(N >= 2, "The cube requires at least 2 vertices per edge (N=" + str(N) + ")");
+
+		tet_mesh m;
+		m.position.resize(size_t(N) * N * N);
+		float const h = edge_length / (N - 1);
+		vec3 const p0 = center - vec3(edge_length, edge_length, edge_length) / 2.0f;
+		for (int kz = 0; kz < N; ++kz)
+			for (int ky = 0; ky < N; ++ky)
+				for (int kx = 0; kx < N; ++kx)
+					m.position[kx + N * (ky + N * kz)] = p0 + h * vec3(float(kx), float(ky), float(kz));
+
+		// Corner c of a cell has the index x + 2y + 4z: 6 tetrahedra around the diagonal 0-7
+		int const tetrahedra[6][4] = { {0,1,3,7}, {0,1,7,5}, {0,2,7,3}, {0,2,6,7}, {0,4,5,7}, {0,4,7,6} };
+		m.connectivity.resize(size_t(N - 1) * (N - 1) * (N - 1) * 6);
+		size_t t = 0;
+		for (int kz = 0; kz < N - 1; ++kz) {
+			for (int ky = 0; ky < N - 1; ++ky) {
+				for (int kx = 0; kx < N - 1; ++kx) {
+					unsigned int corner[8];
+					for (int c = 0; c < 8; ++c)
+						corner[c] = (kx + (c & 1)) + N * ((ky + ((c >> 1) & 1)) + N * (kz + ((c >> 2) & 1)));
+					for (auto const& tet : tetrahedra)
+						m.connectivity[t++] = { corner[tet[0]], corner[tet[1]], corner[tet[2]], corner[tet[3]] };
+				}
+			}
+		}
+		return m;
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../structure/tet_mesh.hpp"
+
+namespace cgp
+{
+	/** Generate a cube filled with tetrahedra
+	* @center: center of the cube
+	* @edge_length: length of the edges of the cube
+	* @N: number of vertices along each edge (N>=2), each of the (N-1)^3 cells is split in 6 tetrahedra of positive volume
+	*/
+	tet_mesh tet_mesh_primitive_cube(vec3 const& center={0,0,0}, float edge_length=1.0f, int N=2);
+}
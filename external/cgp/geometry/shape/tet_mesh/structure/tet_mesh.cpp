@@ -0,0 +1,155 @@
+#include "tet_mesh.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <algorithm>
+
+namespace cgp
+{
+	size_t tet_mesh::memory_size() const
+	{
+		return position.size() * sizeof(vec3) + connectivity.size() * sizeof(uint4) + face.size() * sizeof(uint3);
+	}
+
+	numarray<float> tet_volume(numarray<vec3> const& position, numarray<uint4> const& connectivity)
+	{
+		int const N_tet = connectivity.size();
+		numarray<float> volume(N_tet);
+		#pragma omp parallel for
+		for (int k = 0; k < N_tet; ++k)
+		{
+			uint4 const& tet = connectivity.at_unsafe(k);
+			vec3 const& a = position.at(tet[0]);
+			volume.at_unsafe(k) = dot(cross(position.at(tet[1]) - a, position.at(tet[2]) - a), position.at(tet[3]) - a) / 6.0f;
+		}
+		return volume;
+	}
+
+	numarray<uint3> tet_mesh_boundary(numarray<vec3> const& position, numarray<uint4> const& connectivity)
+	{
+		// Each face is identified by its sorted vertices, faces are grouped by their smallest vertex (counting sort)
+		//  such that a face shared by two tetrahedra is found by comparing only the few faces of its group
+		struct tet_face { unsigned int sorted[3]; uint3 face; unsigned int opposite; };
+		int const N_tet = connectivity.size();
+		int const N_vertex = position.size();
+
+		std::vector<int> group_offset(N_vertex + 1, 0);
+		for (int k = 0; k < N_tet; ++k)
+			for (int j = 0; j < 4; ++j)
+				group_offset[std::min({ connectivity[k][(j + 1) % 4], connectivity[k][(j + 2) % 4], connectivity[k][(j + 3) % 4] }) + 1]++;
+		for (int k = 0; k < N_vertex; ++k)
+			group_offset[k + 1] += group_offset[k];
+
+		std::vector<tet_face> faces(4 * size_t(N_tet));
+		std::vector<int> fill(group_offset.begin(), group_offset.end() - 1);
+		for (int k = 0; k < N_tet; ++k)
+		{
+			uint4 const& tet = connectivity.at_unsafe(k);
+			for (int j = 0; j < 4; ++j)
+			{
+				tet_face f;
+				f.face = { tet[(j + 1) % 4], tet[(j + 2) % 4], tet[(j + 3) % 4] };
+				f.opposite = tet[j];
+				f.sorted[0] = f.face[0]; f.sorted[1] = f.face[1]; f.sorted[2] = f.face[2];
+				std::sort(f.sorted, f.sorted + 3);
+				faces[fill[f.sorted[0]]++] = f;
+			}
+		}
+
+		// Faces without twin in their group are on the boundary
+		std::vector<char> is_boundary(faces.size(), 1);
+		#pragma omp parallel for schedule(dynamic, 1024)
+		for (int v = 0; v < N_vertex; ++v)
+			for (int i = group_offset[v]; i < group_offset[v + 1]; ++i)
+				for (int j = i + 1; j < group_offset[v + 1]; ++j)
+					if (faces[i].sorted[1] == faces[j].sorted[1] && faces[i].sorted[2] == faces[j].sorted[2])
+						is_boundary[i] = is_boundary[j] = 0;
+
+		numarray<uint3> boundary;
+		for (size_t k = 0; k < faces.size(); ++k)
+		{
+			if (is_boundary[k] == 0)
+				continue;
+
+			// Orient the face such that the opposite vertex is behind it
+			uint3 f = faces[k].face;
+			vec3 const& p0 = position.at(f[0]);
+			if (dot(cross(position.at(f[1]) - p0, position.at(f[2]) - p0), position.at(faces[k].opposite) - p0) > 0)
+				std::swap(f[1], f[2]);
+			boundary.push_back(f);
+		}
+		return boundary;
+	}
+
+	mesh tet_mesh_surface(tet_mesh const& m)
+	{
+		numarray<int> surface_to_volume_index;
+		return tet_mesh_surface(m, surface_to_volume_index);
+	}
+
+	mesh tet_mesh_surface(tet_mesh const& m, numarray<int>& surface_to_volume_index)
+	{
+		numarray<uint3> const boundary = tet_mesh_boundary(m.position, m.connectivity);
+
+		// Compact the indices to the vertices of the boundary
+		int const N_vertex = m.position.size();
+		std::vector<int> volume_to_surface(N_vertex, -1);
+		surface_to_volume_index.clear();
+		mesh surface;
+		surface.connectivity.resize(boundary.size());
+		for (int k = 0; k < boundary.size(); ++k)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				unsigned int const idx = boundary[k][j];
+				if (volume_to_surface[idx] == -1) {
+					volume_to_surface[idx] = surface_to_volume_index.size();
+					surface_to_volume_index.push_back(idx);
+					surface.position.push_back(m.position[idx]);
+				}
+				surface.connectivity[k][j] = volume_to_surface[idx];
+			}
+		}
+
+		if (surface.position.size() > 0)
+			surface.fill_empty_field();
+		return surface;
+	}
+
+	bool tet_mesh_check(tet_mesh const& m)
+	{
+		unsigned int const N_vertex = m.position.size();
+		for (int k = 0; k < m.connectivity.size(); ++k)
+		{
+			uint4 const& tet = m.connectivity[k];
+			for (int j = 0; j < 4; ++j)
+			{
+				if (tet[j] >= N_vertex) {
+					warning_cgp("Incorrect tetrahedron index", "Tetrahedron " + str(k) + " has vertex index " + str(tet[j]) + " while the number of vertices is " + str(N_vertex));
+					return false;
+				}
+				for (int i = 0; i < j; ++i)
+					if (tet[i] == tet[j]) {
+						warning_cgp("Degenerate tetrahedron", "Tetrahedron " + str(k) + " has a repeated vertex index: " + str(tet));
+						return false;
+					}
+			}
+		}
+		for (int k = 0; k < m.face.size(); ++k)
+			for (unsigned int idx : m.face[k])
+				if (idx >= N_vertex) {
+					warning_cgp("Incorrect face index", "Face " + str(k) + " has vertex index " + str(idx) + " while the number of vertices is " + str(N_vertex));
+					return false;
+				}
+		return true;
+	}
+
+	std::string str(tet_mesh const& m)
+	{
+		return "tet_mesh[N_vertex=" + str(m.position.size()) + "][N_tetrahedron=" + str(m.connectivity.size()) + "][N_face=" + str(m.face.size()) + "]";
+	}
+	std::string type_str(tet_mesh const&)
+	{
+		return "tet_mesh";
+	}
+}
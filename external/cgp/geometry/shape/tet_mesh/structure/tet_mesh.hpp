@@ -0,0 +1,40 @@
+#pragma once
+
+#include "cgp/core/containers/containers.hpp"
+#include "cgp/geometry/vec/vec.hpp"
+#include "../../mesh/structure/mesh.hpp"
+
+namespace cgp
+{
+	/** Tetrahedral (volumetric) mesh storing per-vertex positions and tetrahedra connectivity
+	* The surface to be displayed is extracted with tet_mesh_surface */
+	struct tet_mesh
+	{
+		numarray<vec3> position;
+		numarray<uint4> connectivity;
+
+		/** Optional boundary faces given by the file the mesh was loaded from (ex. TetGen .face), can be empty */
+		numarray<uint3> face;
+
+		/** Octets used by the arrays of the mesh */
+		size_t memory_size() const;
+	};
+
+	/** Signed volume of each tetrahedron (a,b,c,d): dot(cross(b-a,c-a),d-a)/6 */
+	numarray<float> tet_volume(numarray<vec3> const& position, numarray<uint4> const& connectivity);
+
+	/** Faces belonging to a single tetrahedron, oriented with their normal pointing outside of the volume */
+	numarray<uint3> tet_mesh_boundary(numarray<vec3> const& position, numarray<uint4> const& connectivity);
+
+	/** Triangle mesh of the boundary of the volume (used for rendering)
+	* Only the vertices on the boundary are kept. surface_to_volume_index[k] is the index in the tet_mesh of the vertex k of the surface. 
+	* The per-vertex attributes of the mesh are filled (fill_empty_field). */
+	mesh tet_mesh_surface(tet_mesh const& m);
+	mesh tet_mesh_surface(tet_mesh const& m, numarray<int>& surface_to_volume_index);
+
+	/** Check if the tet_mesh looks coherent (correct indexing, no degenerate tetrahedron) */
+	bool tet_mesh_check(tet_mesh const& m);
+
+	std::string str(tet_mesh const& m);
+	std::string type_str(tet_mesh const&);
+}
@@ -0,0 +1,109 @@
+#include "test_tet_mesh.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../tet_mesh.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+
+namespace cgp_test
+{
+	static cgp::tet_mesh unit_cube_tet_mesh()
+	{
+		using namespace cgp;
+		tet_mesh m;
+		// Vertex index = x + 2y + 4z, split in 6 tetrahedra around the diagonal 0-7
+		for (int k = 0; k < 8; ++k)
+			m.position.push_back(vec3(float(k & 1), float((k >> 1) & 1), float((k >> 2) & 1)));
+		m.connectivity = { {0,1,3,7}, {0,1,7,5}, {0,2,7,3}, {0,2,6,7}, {0,4,5,7}, {0,4,7,6} };
+		return m;
+	}
+
+	void test_tet_mesh()
+	{
+		using namespace cgp;
+
+		tet_mesh const cube = unit_cube_tet_mesh();
+		assert_cgp_no_msg(tet_mesh_check(cube));
+
+		float total_volume = 0.0f;
+		for (float v : tet_volume(cube.position, cube.connectivity))
+			total_volume += std::abs(v);
+		assert_cgp_no_msg(is_equal(total_volume, 1.0f));
+
+		// Boundary: 2 triangles per side of the cube, with outward normals
+		numarray<uint3> const boundary = tet_mesh_boundary(cube.position, cube.connectivity);
+		assert_cgp_no_msg(boundary.size() == 12);
+		vec3 const center = { 0.5f,0.5f,0.5f };
+		for (uint3 const& f : boundary) {
+			vec3 const& p0 = cube.position[f[0]];
+			vec3 const n = cross(cube.position[f[1]] - p0, cube.position[f[2]] - p0);
+			assert_cgp_no_msg(dot(n, p0 - center) > 0);
+		}
+
+		numarray<int> surface_to_volume;
+		mesh const surface = tet_mesh_surface(cube, surface_to_volume);
+		assert_cgp_no_msg(surface.position.size() == 8 && surface.connectivity.size() == 12 && surface.normal.size() == 8);
+		for (int k = 0; k < 8; ++k)
+			assert_cgp_no_msg(is_equal(surface.position[k], cube.position[surface_to_volume[k]]));
+
+		// Generated cube: (N-1)^3 cells of 6 tetrahedra of positive volume, 6 (N-1)^2 squares on the boundary
+		{
+			tet_mesh const block = tet_mesh_primitive_cube({ 1,2,3 }, 2.0f, 4);
+			assert_cgp_no_msg(tet_mesh_check(block) && block.position.size() == 64 && block.connectivity.size() == 162);
+			float volume = 0.0f;
+			for (float v : tet_volume(block.position, block.connectivity)) {
+				assert_cgp_no_msg(v > 0);
+				volume += v;
+			}
+			assert_cgp_no_msg(std::abs(volume - 8.0f) < 1e-4f);
+			assert_cgp_no_msg(is_equal(block.position[0], vec3(0, 1, 2)) && is_equal(block.position[63], vec3(2, 3, 4)));
+			assert_cgp_no_msg(tet_mesh_boundary(block.position, block.connectivity).size() == 6 * 9 * 2);
+		}
+
+		// TetGen files with indices starting at 1, comments, attributes, markers, and quadratic tetrahedra
+		{
+			std::ofstream node("test_tet_mesh.node");
+			node << "# cube\n8 3 1 1\n";
+			for (int k = 0; k < 8; ++k)
+				node << k + 1 << "  " << cube.position[k].x << " " << cube.position[k].y << " " << cube.position[k].z << " 0.5 1 # vertex\n";
+			std::ofstream ele("test_tet_mesh.ele");
+			ele << "6 10 1\n\n";
+			for (int k = 0; k < 6; ++k) {
+				ele << k + 1;
+				for (unsigned int idx : cube.connectivity[k])
+					ele << " " << idx + 1;
+				ele << " 1 1 1 1 1 1 2\r\n";
+			}
+			std::ofstream face("test_tet_mesh.face");
+			face << "12 1\n";
+			for (int k = 0; k < 12; ++k)
+				face << k + 1 << " " << boundary[k][0] + 1 << " " << boundary[k][1] + 1 << " " << boundary[k][2] + 1 << " -1\n";
+		}
+		tet_mesh const loaded = tet_mesh_load_file_tetgen("test_tet_mesh.node");
+		assert_cgp_no_msg(loaded.position.size() == 8 && loaded.connectivity.size() == 6 && loaded.face.size() == 12);
+		for (int k = 0; k < 8; ++k)
+			assert_cgp_no_msg(is_equal(loaded.position[k], cube.position[k]));
+		for (int k = 0; k < 6; ++k)
+			assert_cgp_no_msg(is_equal(loaded.connectivity[k], cube.connectivity[k]));
+		for (int k = 0; k < 12; ++k)
+			assert_cgp_no_msg(is_equal(loaded.face[k], boundary[k]));
+
+		// Round trip in TetGen and binary formats
+		save_file_tetgen("test_tet_mesh_saved", loaded);
+		save_file_tet_binary("test_tet_mesh.cgptet", loaded);
+		for (tet_mesh const& m : { tet_mesh_load_file_tetgen("test_tet_mesh_saved"), tet_mesh_load_file_tet_binary("test_tet_mesh.cgptet") }) {
+			assert_cgp_no_msg(m.position.size() == 8 && m.connectivity.size() == 6 && m.face.size() == 12);
+			for (int k = 0; k < 8; ++k)
+				assert_cgp_no_msg(is_equal(m.position[k], cube.position[k]));
+			for (int k = 0; k < 6; ++k)
+				assert_cgp_no_msg(is_equal(m.connectivity[k], cube.connectivity[k]));
+			for (int k = 0; k < 12; ++k)
+				assert_cgp_no_msg(is_equal(m.face[k], boundary[k]));
+		}
+
+		for (char const* filename : { "test_tet_mesh.node", "test_tet_mesh.ele", "test_tet_mesh.face", "test_tet_mesh_saved.node", "test_tet_mesh_saved.ele", "test_tet_mesh_saved.face", "test_tet_mesh.cgptet" })
+			std::remove(filename);
+	}
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "structure/tet_mesh.hpp"
+#include "loader/loader.hpp"
+#include "primitive/tet_mesh_primitive.hpp"
\ No newline at end of file
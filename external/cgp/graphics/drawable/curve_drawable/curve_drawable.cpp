@@ -45,6 +45,7 @@ namespace cgp
 		glBindVertexArray(vao); opengl_check;
 		opengl_set_vao_location(vbo_position, 0);
 		glBindVertexArray(0);
+		memory_gpu_create(gpu_object_kind::vertex_array, vao, 0);
 
 	}
 
@@ -53,6 +54,7 @@ namespace cgp
 	{
 		vbo_position.clear(); opengl_check;
 
+		memory_gpu_delete(gpu_object_kind::vertex_array, vao);
 		glDeleteVertexArrays(1, &vao); opengl_check;
 		vao = 0;
 		shader.id = 0;
@@ -1,6 +1,7 @@
 #include "mesh_drawable.hpp"
 
 #include "cgp/core/base/base.hpp"
+#include "cgp/core/profiling/memory_accounting/memory_accounting.hpp"
 
 namespace cgp
 {
@@ -57,6 +58,7 @@ namespace cgp
 		opengl_set_vao_location(vbo_color, 2);
 		opengl_set_vao_location(vbo_uv, 3);
 		glBindVertexArray(0); opengl_check;
+		memory_gpu_create(gpu_object_kind::vertex_array, vao, 0);
 	}
 
 	void mesh_drawable::clear()
@@ -67,8 +69,10 @@ namespace cgp
 		vbo_uv.clear();
 		ebo_connectivity.clear();
 		
-		if(vao!=0)
+		if(vao!=0) {
+			memory_gpu_delete(gpu_object_kind::vertex_array, vao);
 			glDeleteVertexArrays(1, &vao);
+		}
 		vao = 0;
 
 		shader = opengl_shader_structure();
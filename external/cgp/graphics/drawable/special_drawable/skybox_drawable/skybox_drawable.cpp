@@ -1,6 +1,7 @@
 #include "skybox_drawable.hpp"
 
 #include "cgp/geometry/shape/mesh/mesh.hpp"
+#include "cgp/core/profiling/memory_accounting/memory_accounting.hpp"
 
 namespace cgp {
 
@@ -234,7 +235,7 @@ namespace cgp {
 		glBindVertexArray(vao); opengl_check;
 		opengl_set_vao_location(vbo_position, 0);
 		glBindVertexArray(0); opengl_check;
-		
+		memory_gpu_create(gpu_object_kind::vertex_array, vao, 0);
 	}
 
 	
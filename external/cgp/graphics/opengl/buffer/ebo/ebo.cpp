@@ -1,5 +1,6 @@
 #include "ebo.hpp"
 #include "../../debug/debug.hpp"
+#include "cgp/core/profiling/memory_accounting/memory_accounting.hpp"
 
 namespace cgp
 {
@@ -11,6 +12,7 @@ namespace cgp
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id); opengl_check;
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(size_in_memory(data)), ptr(data), GL_DYNAMIC_DRAW); opengl_check;
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); opengl_check;
+		memory_gpu_create(gpu_object_kind::buffer, id, int64_t(size_in_memory(data)));
 
 		size = data.size();
 		type = GL_ELEMENT_ARRAY_BUFFER;
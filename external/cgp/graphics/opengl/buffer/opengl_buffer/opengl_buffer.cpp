@@ -1,5 +1,6 @@
 #include "opengl_buffer.hpp"
 #include "../../debug/debug.hpp"
+#include "cgp/core/profiling/memory_accounting/memory_accounting.hpp"
 
 
 namespace cgp
@@ -27,6 +28,7 @@ namespace cgp
 	}
 	void opengl_gpu_buffer::clear()
 	{
+		memory_gpu_delete(gpu_object_kind::buffer, id);
 		glDeleteBuffers(1, &id);  opengl_check;
 
 		id = 0;
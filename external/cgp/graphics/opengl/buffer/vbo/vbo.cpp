@@ -12,6 +12,7 @@ namespace cgp
 		glBindBuffer(buffer_type, vbo_index);                                              opengl_check;
 		glBufferData(buffer_type, GLsizeiptr(size_in_memory(data)), ptr(data), draw_type); opengl_check;
 		glBindBuffer(buffer_type, 0);                                                      opengl_check;
+		memory_gpu_create(gpu_object_kind::buffer, vbo_index, int64_t(size_in_memory(data)));
 
 		return vbo_index;
 	}
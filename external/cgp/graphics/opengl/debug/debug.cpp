@@ -42,13 +42,13 @@ namespace cgp
             return "UNKNOWN";
         }
     }
-	void check_opengl_error(std::string const& file, std::string const& function, int line)
+	void check_opengl_error(char const* file, char const* function, int line)
 	{
         GLenum error = glGetError();
         if( error !=GL_NO_ERROR )
         {
             std::string msg = "OpenGL ERROR detected\n"
-                    "\tFile "+file+"\n"
+                    "\tFile "+std::string(file)+"\n"
                     "\tFunction "+function+"\n"
                     "\tLine "+str(line)+"\n"
                     "\tOpenGL Error: "+opengl_error_to_string(error);
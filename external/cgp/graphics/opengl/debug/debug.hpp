@@ -12,6 +12,7 @@
 namespace cgp
 {
 	std::string opengl_info_display();
-	void check_opengl_error(const std::string& file, const std::string& function, int line);
+	// Called after each OpenGL call in debug mode: the names are only converted to std::string in the error message (no allocation without error)
+	void check_opengl_error(char const* file, char const* function, int line);
 }
 
@@ -8,20 +8,15 @@
 
 namespace cgp
 {
-    GLint cache_uniform_location_structure::query(GLuint shaderID, std::string const& uniformName)
+    GLint cache_uniform_location_structure::query(GLuint shaderID, char const* uniformName)
     {
         // Sanity check
-        assert_cgp(shaderID != 0, "Try to query uniform " + uniformName + " on unspecified shader (shader index = 0).");
-
-        // Check if shaderID is already recorded
-        auto shaderID_it = cache_data.find(shaderID);
+        assert_cgp(shaderID != 0, "Try to query uniform " + std::string(uniformName) + " on unspecified shader (shader index = 0).");
 
-        // If new shader, then create an empty map
-        if (shaderID_it == cache_data.end())
-            cache_data[shaderID] = std::map<std::string, GLint>();
+        // Uniforms recorded for this shader (an empty map is created for a new shader)
+        std::map<std::string, GLint, std::less<> >& cacheShaderQuery = cache_data[shaderID];
 
         // Check if uniformName is already recorded
-        std::map<std::string, GLint>& cacheShaderQuery = cache_data[shaderID];
         auto uniformLoc_it = cacheShaderQuery.find(uniformName);
 
         // If found, return the cached value
@@ -30,15 +25,20 @@ namespace cgp
 
         // Else: the name is not found
         // Then we query the location using glGetUniformLocation in the shader
-        GLint const location = glGetUniformLocation(shaderID, uniformName.c_str()); opengl_check;
+        GLint const location = glGetUniformLocation(shaderID, uniformName); opengl_check;
 
         // Add the location in the cache system
         //  Note: location == -1 if glGetUniformLocation cannot find the variable
-        cacheShaderQuery[uniformName] = location;
+        cacheShaderQuery.emplace(uniformName, location);
 
         return location;
     }
 
+    GLint cache_uniform_location_structure::query(GLuint shaderID, std::string const& uniformName)
+    {
+        return query(shaderID, uniformName.c_str());
+    }
+
     std::string str(cache_uniform_location_structure const& cache)
     {
         std::string s;
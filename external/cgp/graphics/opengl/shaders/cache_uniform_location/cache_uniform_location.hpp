@@ -11,12 +11,14 @@ namespace cgp
 	// Usage: location = cache_uniform_location.query(shaderID, uniformName)
 	struct cache_uniform_location_structure
 	{
-		std::map<GLuint, std::map<std::string, GLint> > cache_data;
+		//  The names are compared with std::less<>: a query by char const* does not construct a std::string (no allocation once the location is cached)
+		std::map<GLuint, std::map<std::string, GLint, std::less<> > > cache_data;
 
 		// Return the location of the uniform in the shader designated by shaderID and update the caching system
 		//  Query glGetUniformLocation the first time the variable is queried and save it.
 		//  The following times, the variable is read from the cache without requiring access to glGetUniformLocation (that can slow down rendering pipeline)
 		//  If uniformName is not found return (and cache) the value -1.
+		GLint query(GLuint shaderID, char const* uniformName);
 		GLint query(GLuint shaderID, std::string const& uniformName);
 
 	};
@@ -42,11 +42,16 @@ namespace cgp
     }
 
 
-    GLint opengl_shader_structure::query_uniform_location(std::string const& uniform_name) const
+    GLint opengl_shader_structure::query_uniform_location(char const* uniform_name) const
     {
         return cache_uniform_location.query(id, uniform_name);
     }
 
+    GLint opengl_shader_structure::query_uniform_location(std::string const& uniform_name) const
+    {
+        return cache_uniform_location.query(id, uniform_name.c_str());
+    }
+
     void opengl_shader_structure::clear_cache_uniform_location()
     {
         cache_uniform_location.cache_data.clear();
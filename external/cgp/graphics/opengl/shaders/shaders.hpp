@@ -22,6 +22,7 @@ namespace cgp
 		void load_from_inline_text(std::string const& vertex_shader_text, std::string const& fragment_shader_text);
 
 		// Query the location of a uniform variable using the cache system
+		GLint query_uniform_location(char const* uniform_name) const;
 		GLint query_uniform_location(std::string const& uniform_name) const;
 
 		// Clear the cache system
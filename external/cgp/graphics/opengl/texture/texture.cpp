@@ -1,6 +1,7 @@
 #include "texture.hpp"
 
 #include "cgp/core/base/base.hpp"
+#include "cgp/core/profiling/memory_accounting/memory_accounting.hpp"
 
 namespace cgp
 {
@@ -33,6 +34,14 @@ namespace cgp
         error_cgp("Unreachable");
     }
 
+    // Octets of a texture on the GPU (the mipmaps add a third of the image)
+    static int64_t texture_memory_size(int width, int height, GLint format, bool is_mipmap)
+    {
+        int64_t const texel = format == GL_RGB32F ? 3 * sizeof(float) : (format == GL_RGBA8 ? 4 : 3);
+        int64_t const s = int64_t(width) * int64_t(height) * texel;
+        return is_mipmap ? s + s / 3 : s;
+    }
+
     template <typename TYPE>
     static GLuint opengl_initialize_texture_2d_on_gpu(int width, int height, TYPE const* data,
         GLint wrap_s, GLint wrap_t,
@@ -57,6 +66,7 @@ namespace cgp
         }
 
         glBindTexture(texture_type, 0); opengl_check;
+        memory_gpu_create(gpu_object_kind::texture, id, texture_memory_size(width, height, format, is_mipmap));
 
         assert_cgp(glIsTexture(id), "Incorrect texture id");
         return id;
@@ -74,6 +84,7 @@ namespace cgp
     void opengl_texture_image_structure::clear()
     {
         assert_cgp(id != 0, "Cannot clear texture, ID=0");
+        memory_gpu_delete(gpu_object_kind::texture, id);
         glDeleteTextures(1, &id);
         *this = opengl_texture_image_structure();
     }
@@ -166,6 +177,7 @@ namespace cgp
 
 
         glBindTexture(texture_type, 0);
+        memory_gpu_create(gpu_object_kind::texture, id, 6 * texture_memory_size(h, h, format, false));
     }
 
 
@@ -232,6 +244,7 @@ namespace cgp
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); opengl_check;
 
         glBindTexture(GL_TEXTURE_2D,0); opengl_check;
+        memory_gpu_create(gpu_object_kind::texture, id, texture_memory_size(im.width, im.height, im.color_type == image_color_type::rgba ? GL_RGBA8 : GL_RGB8, true));
 
         return id;
     }
@@ -253,6 +266,7 @@ namespace cgp
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
         glBindTexture(GL_TEXTURE_2D,0);
+        memory_gpu_create(gpu_object_kind::texture, id, texture_memory_size(int(im.dimension.x), int(im.dimension.y), GL_RGB32F, true));
 
         return id;
     }
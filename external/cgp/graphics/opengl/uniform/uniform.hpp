@@ -29,6 +29,24 @@ namespace cgp
 	//void opengl_uniform(opengl_shader_structure const& shader, uniform_generic_structure const& uniforms, bool expected = true);
 
 
+	// Send a uniform value to the shader (its location is read from the cache of the shader)
+	//  The names given as char const* (ex. string literals) are looked up without constructing a std::string: no allocation once the location is cached.
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, int value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, GLuint value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, float value, bool expected = true);
+
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, vec2 const& value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, vec3 const& value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, vec4 const& value, bool expected = true);
+
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, float x, float y, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, float x, float y, float z, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, float x, float y, float z, float w, bool expected = true);
+
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, mat4 const& m, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, mat3 const& m, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, char const* name, mat2 const& m, bool expected = true);
+
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, int value, bool expected = true);
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, GLuint value, bool expected = true);
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, float value, bool expected = true);
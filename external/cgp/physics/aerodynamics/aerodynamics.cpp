@@ -0,0 +1,94 @@
+#include "aerodynamics.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/geometry/shape/noise/noise.hpp"
+
+namespace cgp
+{
+	numarray<vec3> wind_velocity(numarray<vec3> const& position, wind_parameters const& wind, float time)
+	{
+		numarray<vec3> velocity;
+		wind_velocity(position, wind, time, velocity);
+		return velocity;
+	}
+
+	void wind_velocity(numarray<vec3> const& position, wind_parameters const& wind, float time, numarray<vec3>& velocity)
+	{
+		int const N = position.size();
+		if (velocity.size() != N)
+			velocity.resize(N);
+		if (wind.turbulence_magnitude == 0.0f) {
+			velocity.fill(wind.velocity);
+			return;
+		}
+
+		// The noise pattern is advected by the mean wind and evolves along the direction (1,1,1) of the noise domain
+		//  The positions in the noise domain are stored in velocity, and replaced in place by the turbulence
+		float const s = 1.0f / wind.turbulence_scale;
+		vec3 const shift = time * (wind.turbulence_speed * vec3{ 1,1,1 } - wind.velocity);
+		for (int k = 0; k < N; ++k)
+			velocity.at_unsafe(k) = s * (position.at_unsafe(k) + shift);
+
+		noise_curl(velocity, velocity, wind.turbulence_octave);
+		for (int k = 0; k < N; ++k)
+			velocity.at_unsafe(k) = wind.velocity + wind.turbulence_magnitude * velocity.at_unsafe(k);
+	}
+
+	vec3 aerodynamic_force(vec3 const& n, float area, vec3 const& relative_velocity, aerodynamic_parameters const& parameters)
+	{
+		float const v2 = dot(relative_velocity, relative_velocity);
+		if (v2 < 1e-12f || area <= 0.0f)
+			return { 0,0,0 };
+
+		vec3 const u = relative_velocity / std::sqrt(v2);
+		float const c = dot(n, u);
+		vec3 const n_front = c >= 0 ? n : -n; // side of the surface facing the relative velocity
+		float const cos_theta = c >= 0 ? c : -c;
+
+		float const pressure = 0.5f * parameters.air_density * v2 * area * cos_theta;
+		vec3 const drag = -pressure * parameters.drag_coefficient * u;
+		vec3 const lift = -pressure * parameters.lift_coefficient * (n_front - cos_theta * u);
+		return drag + lift;
+	}
+
+	void aerodynamic_forces(numarray<vec3> const& velocity, numarray<uint3> const& connectivity, numarray<vec3> const& triangle_normal, numarray<float> const& triangle_area, numarray<vec3> const& wind, aerodynamic_parameters const& parameters, numarray<vec3>& forces, aerodynamic_buffers& buffers)
+	{
+		int const N_tri = connectivity.size();
+		assert_cgp(triangle_normal.size() == N_tri && triangle_area.size() == N_tri, "Per-triangle normals and areas must be computed for all triangles (size(triangle_normal)=" + str(triangle_normal.size()) + ", size(triangle_area)=" + str(triangle_area.size()) + ", size(connectivity)=" + str(N_tri) + ")");
+		assert_cgp(wind.size() == N_tri, "The wind must be given per triangle (size(wind)=" + str(wind.size()) + ", size(connectivity)=" + str(N_tri) + ")");
+		assert_cgp(forces.size() == velocity.size(), "Forces must be allocated for all vertices (size(forces)=" + str(forces.size()) + ", size(velocity)=" + str(velocity.size()) + ")");
+
+		// Force applied on each vertex of the triangles
+		numarray<vec3>& triangle_force = buffers.triangle_force;
+		if (triangle_force.size() != N_tri)
+			triangle_force.resize(N_tri);
+		#pragma omp parallel for
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+		{
+			uint3 const& tri = connectivity.at_unsafe(k_tri);
+			vec3 const v = (velocity.at(tri[0]) + velocity.at(tri[1]) + velocity.at(tri[2])) / 3.0f;
+			triangle_force.at_unsafe(k_tri) = aerodynamic_force(triangle_normal.at_unsafe(k_tri), triangle_area.at_unsafe(k_tri), v - wind.at_unsafe(k_tri), parameters) / 3.0f;
+		}
+
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+			for (unsigned int idx : connectivity.at_unsafe(k_tri))
+				forces.at(idx) += triangle_force.at_unsafe(k_tri);
+	}
+
+	void aerodynamic_forces(numarray<vec3> const& position, numarray<vec3> const& velocity, numarray<uint3> const& connectivity, numarray<vec3> const& triangle_normal, numarray<float> const& triangle_area, wind_parameters const& wind, float time, aerodynamic_parameters const& parameters, numarray<vec3>& forces, aerodynamic_buffers& buffers)
+	{
+		int const N_tri = connectivity.size();
+		numarray<vec3>& center = buffers.center;
+		if (center.size() != N_tri)
+			center.resize(N_tri);
+		#pragma omp parallel for
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+		{
+			uint3 const& tri = connectivity.at_unsafe(k_tri);
+			center.at_unsafe(k_tri) = (position.at(tri[0]) + position.at(tri[1]) + position.at(tri[2])) / 3.0f;
+		}
+
+		wind_velocity(center, wind, time, buffers.wind);
+		aerodynamic_forces(velocity, connectivity, triangle_normal, triangle_area, buffers.wind, parameters, forces, buffers);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cgp/geometry/vec/vec.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+
+namespace cgp
+{
+	/** Coefficients of the aerodynamic model of thin surfaces (cloth, membranes) */
+	struct aerodynamic_parameters
+	{
+		float air_density = 1.2f;      // kg/m^3
+		float drag_coefficient = 1.0f; // force opposed to the relative velocity
+		float lift_coefficient = 0.5f; // force orthogonal to the relative velocity
+	};
+
+	/** Wind velocity field: uniform velocity with optional turbulence given by curl noise (divergence-free) */
+	struct wind_parameters
+	{
+		vec3 velocity = { 0,0,0 };         // mean wind velocity
+		float turbulence_magnitude = 0.0f; // magnitude of the turbulent velocity (0: no turbulence)
+		float turbulence_scale = 1.0f;     // spatial size of the turbulent structures
+		float turbulence_speed = 1.0f;     // speed at which the turbulent pattern evolves with time
+		int turbulence_octave = 3;
+	};
+
+	/** Evaluate the wind velocity at the given positions and time */
+	numarray<vec3> wind_velocity(numarray<vec3> const& position, wind_parameters const& wind, float time);
+	/** Version filling velocity (no allocation if it already has the size of position) */
+	void wind_velocity(numarray<vec3> const& position, wind_parameters const& wind, float time, numarray<vec3>& velocity);
+
+	/** Temporary arrays of aerodynamic_forces, kept by the caller between the steps such that the forces are computed without allocation */
+	struct aerodynamic_buffers
+	{
+		numarray<vec3> center;         // barycenter of each triangle
+		numarray<vec3> wind;           // wind velocity at the barycenter of each triangle
+		numarray<vec3> triangle_force; // force applied on each vertex of a triangle
+	};
+
+	/** Aerodynamic force applied on a flat triangle with unit normal n and given area, moving with relative_velocity with respect to the air
+	*  u: direction of the relative velocity, n oriented such that dot(n,u)>=0 (the model is symmetric for both sides of the surface)
+	*  drag = -1/2 rho C_d A dot(n,u) |v|^2 u
+	*  lift = -1/2 rho C_l A dot(n,u) |v|^2 (n - dot(n,u) u)
+	* Both forces vanish for a relative velocity tangent to the surface. */
+	vec3 aerodynamic_force(vec3 const& n, float area, vec3 const& relative_velocity, aerodynamic_parameters const& parameters);
+
+	/** Add the aerodynamic forces of all triangles to the per-vertex forces
+	*  - triangle_normal, triangle_area: per-triangle unit normal and area (as computed by normal_per_triangle, typically shared with the normal update)
+	*  - wind: wind velocity per triangle
+	* The relative velocity of a triangle is the average velocity of its vertices minus the wind. 
+	* The force of each triangle (proportional to its area) is distributed equally to its three vertices. 
+	* The forces of the triangles are computed in parallel, and accumulated on the vertices in a deterministic order. */
+	void aerodynamic_forces(numarray<vec3> const& velocity, numarray<uint3> const& connectivity, numarray<vec3> const& triangle_normal, numarray<float> const& triangle_area, numarray<vec3> const& wind, aerodynamic_parameters const& parameters, numarray<vec3>& forces, aerodynamic_buffers& buffers);
+
+	/** Same with the wind velocity evaluated at the barycenter of the triangles */
+	void aerodynamic_forces(numarray<vec3> const& position, numarray<vec3> const& velocity, numarray<uint3> const& connectivity, numarray<vec3> const& triangle_normal, numarray<float> const& triangle_area, wind_parameters const& wind, float time, aerodynamic_parameters const& parameters, numarray<vec3>& forces, aerodynamic_buffers& buffers);
+}
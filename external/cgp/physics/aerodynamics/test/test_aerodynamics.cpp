@@ -0,0 +1,106 @@
+#include "test_aerodynamics.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/geometry/shape/mesh/mesh.hpp"
+#include "cgp/core/profiling/allocation_tracker/allocation_tracker.hpp"
+#include "../aerodynamics.hpp"
+
+#include <cmath>
+
+namespace cgp_test
+{
+	void test_aerodynamics()
+	{
+		using namespace cgp;
+		aerodynamic_parameters parameters;
+
+		// Force on a single triangle
+		{
+			vec3 const n = { 0,0,1 };
+			float const area = 2.0f;
+
+			// Relative velocity orthogonal to the surface: pure drag
+			vec3 const f_normal = aerodynamic_force(n, area, { 0,0,3 }, parameters);
+			assert_cgp_no_msg(norm(f_normal - vec3{ 0,0,-0.5f * parameters.air_density * parameters.drag_coefficient * area * 9.0f }) < 1e-5f);
+			// Same force on both sides of the surface
+			assert_cgp_no_msg(norm(aerodynamic_force(-n, area, { 0,0,3 }, parameters) - f_normal) < 1e-6f);
+			// Tangent relative velocity: no force
+			assert_cgp_no_msg(norm(aerodynamic_force(n, area, { 3,0,0 }, parameters)) < 1e-6f);
+
+			// Oblique velocity: the drag opposes the velocity and the lift is orthogonal to it
+			vec3 const v = { 1,0,-1 };
+			aerodynamic_parameters no_lift = parameters;
+			no_lift.lift_coefficient = 0.0f;
+			vec3 const f = aerodynamic_force(n, area, v, parameters);
+			vec3 const drag = aerodynamic_force(n, area, v, no_lift);
+			assert_cgp_no_msg(norm(cross(drag, v)) < 1e-6f && dot(drag, v) < 0);
+			assert_cgp_no_msg(std::abs(dot(f - drag, v)) < 1e-6f);
+		}
+
+		// Forces on a grid of triangles
+		{
+			int const N = 10;
+			mesh grid = mesh_primitive_grid({ 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, N, N);
+			int const N_vertex = grid.position.size();
+			int const N_tri = grid.connectivity.size();
+
+			numarray<vec3> triangle_normal;
+			numarray<float> triangle_area;
+			normal_per_triangle(grid.position, grid.connectivity, triangle_normal, triangle_area);
+			float total_area = 0.0f;
+			for (int k = 0; k < N_tri; ++k)
+				total_area += triangle_area[k];
+			assert_cgp_no_msg(std::abs(total_area - 1.0f) < 1e-4f);
+
+			// Per-vertex normals computed from the triangle normals are the same as the direct computation
+			numarray<vec3> normal_from_triangles;
+			normal_per_vertex(triangle_normal, grid.connectivity, N_vertex, normal_from_triangles);
+			numarray<vec3> const normal_direct = normal_per_vertex(grid.position, grid.connectivity);
+			for (int k = 0; k < N_vertex; ++k)
+				assert_cgp_no_msg(norm(normal_from_triangles[k] - normal_direct[k]) < 1e-6f);
+
+			// Surface falling in still air: the total force is the drag of the whole surface
+			numarray<vec3> velocity(N_vertex);
+			velocity.fill({ 0,0,-2 });
+			numarray<vec3> forces(N_vertex);
+			forces.fill({ 0,0,0 });
+			wind_parameters still_air;
+			aerodynamic_buffers buffers;
+			aerodynamic_forces(grid.position, velocity, grid.connectivity, triangle_normal, triangle_area, still_air, 0.0f, parameters, forces, buffers);
+			vec3 total = { 0,0,0 };
+			for (int k = 0; k < N_vertex; ++k)
+				total += forces[k];
+			assert_cgp_no_msg(norm(total - vec3{ 0,0,0.5f * parameters.air_density * parameters.drag_coefficient * total_area * 4.0f }) < 1e-4f);
+
+			// Surface moving with the wind: no force
+			wind_parameters wind;
+			wind.velocity = { 0,0,-2 };
+			forces.fill({ 0,0,0 });
+			aerodynamic_forces(grid.position, velocity, grid.connectivity, triangle_normal, triangle_area, wind, 1.0f, parameters, forces, buffers);
+			for (int k = 0; k < N_vertex; ++k)
+				assert_cgp_no_msg(norm(forces[k]) < 1e-6f);
+
+			// Turbulent wind: deviation around the mean velocity
+			wind.turbulence_magnitude = 0.5f;
+			numarray<vec3> const w = wind_velocity(grid.position, wind, 1.0f);
+			bool turbulent = false;
+			for (int k = 0; k < N_vertex; ++k)
+				turbulent = turbulent || norm(w[k] - wind.velocity) > 1e-3f;
+			assert_cgp_no_msg(turbulent);
+			numarray<vec3> w_filled;
+			wind_velocity(grid.position, wind, 1.0f, w_filled);
+			for (int k = 0; k < N_vertex; ++k)
+				assert_cgp_no_msg(norm(w_filled[k] - w[k]) < 1e-6f);
+
+			// Once the buffers have the size of the mesh, the normals, the wind and the forces are updated without allocation
+			numarray<vec3> normals;
+			normal_per_vertex(grid.position, grid.connectivity, normals);
+			allocation_counters const before = allocation_count();
+			normal_per_vertex(grid.position, grid.connectivity, normals);
+			normal_per_triangle(grid.position, grid.connectivity, triangle_normal, triangle_area);
+			wind_velocity(grid.position, wind, 2.0f, w_filled);
+			aerodynamic_forces(grid.position, velocity, grid.connectivity, triangle_normal, triangle_area, wind, 2.0f, parameters, forces, buffers);
+			assert_cgp_no_msg((allocation_count() - before).allocations == 0);
+		}
+	}
+}
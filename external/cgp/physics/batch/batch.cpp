@@ -0,0 +1,316 @@
+#include "batch.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <fstream>
+
+namespace cgp
+{
+	namespace
+	{
+		bool set_material(scene_material& m, std::string const& field, float value)
+		{
+			if (field == "mass") m.mass = value;
+			else if (field == "stiffness") m.stiffness = value;
+			else if (field == "damping") m.damping = value;
+			else if (field == "density") m.density = value;
+			else if (field == "bending") m.bending = value;
+			else return false;
+			return true;
+		}
+
+		bool set_body(scene_body& b, std::string const& field, float value)
+		{
+			if (field == "size") b.size = value;
+			else if (field == "resolution") b.resolution = { int(value), int(value) };
+			else return false;
+			return true;
+		}
+
+		bool set_collider(scene_collider& c, std::string const& field, float value)
+		{
+			if (field == "size") c.size = value;
+			else if (field == "friction") c.friction = value;
+			else return false;
+			return true;
+		}
+
+		// Split "category.name.field" in the name and the field after the given prefix
+		bool split_key(std::string const& key, std::string const& prefix, std::string& name, std::string& field)
+		{
+			if (key.compare(0, prefix.size(), prefix) != 0)
+				return false;
+			size_t const dot = key.rfind('.');
+			if (dot == std::string::npos || dot < prefix.size())
+				return false;
+			name = key.substr(prefix.size(), dot - prefix.size());
+			field = key.substr(dot + 1);
+			return true;
+		}
+
+		bool has_assets(scene_description const& scene)
+		{
+			for (scene_body const& b : scene.bodies)
+				if (b.shape.position.size() == 0)
+					return false;
+			return true;
+		}
+
+		std::string json_string(std::string const& s)
+		{
+			std::string r = "\"";
+			for (char c : s) {
+				if (c == '"' || c == '\\') r += '\\';
+				if (static_cast<unsigned char>(c) < 0x20) { r += ' '; continue; }
+				r += c;
+			}
+			return r + "\"";
+		}
+
+		// Non finite values (diverging runs) are exported as null
+		std::string json_number(double x)
+		{
+			if (!std::isfinite(x))
+				return "null";
+			std::ostringstream s;
+			s.precision(9);
+			s << x;
+			return s.str();
+		}
+	}
+
+	bool scene_set_parameter(scene_description& scene, std::string const& key, float value)
+	{
+		std::string name, field;
+		if (key == "solver.time_step") scene.solver.time_step = value;
+		else if (key == "solver.iterations") scene.solver.iterations = int(value);
+		else if (key == "solver.substeps") scene.solver.substeps = int(value);
+		else if (key == "solver.gravity") scene.solver.gravity.z = value;
+		else if (split_key(key, "material.", name, field)) {
+			int const k = scene.find_material(name);
+			return k >= 0 && set_material(scene.materials[k], field, value);
+		}
+		else if (split_key(key, "body.", name, field)) {
+			int const k = scene.find_body(name);
+			return k >= 0 && set_body(scene.bodies[k], field, value);
+		}
+		else if (split_key(key, "collider.", name, field)) {
+			int const k = scene.find_collider(name);
+			return k >= 0 && set_collider(scene.colliders[k], field, value);
+		}
+		else
+			return false;
+		return true;
+	}
+
+	batch_run batch_measure(simulation& sim, int steps, batch_settings const& settings)
+	{
+		batch_run run;
+		run.particles = sim.position.size();
+		run.constraints = sim.edge.size();
+		run.initial_energy = simulation_energy(sim);
+
+		frame_profiler profiler;
+		profiler.frame_name = "step";
+		profiler.budget = settings.step_budget;
+		if (settings.hardware_counters)
+			run.counters_available = profiler.enable_hardware_counters(true);
+
+		run.telemetry = solver_telemetry(settings.telemetry_capacity);
+
+		// The guard only checks the thread opening its scope: the parallel loops of the guarded steps are executed by this thread alone
+		if (settings.allocation_warmup >= 0)
+			sim.threads = 1;
+
+		double residual_sum = 0.0;
+		auto const t0 = std::chrono::steady_clock::now();
+		for (int k = 0; k < steps; ++k) {
+			profiler.begin_frame();
+			simulation_step_statistics stats;
+			{
+				allocation_forbidden_scope guard(settings.allocation_warmup >= 0 && k >= settings.allocation_warmup ? "simulation step" : nullptr);
+				stats = simulation_step(sim);
+			}
+			profiler.record("integrate", stats.time_integrate);
+			profiler.record("solve", stats.time_solve);
+			profiler.record("collide", stats.time_collide);
+			profiler.record("velocity", stats.time_velocity);
+			profiler.end_frame();
+			run.telemetry.add(sim, stats);
+
+			run.iterations += stats.iterations;
+			residual_sum += stats.final_residual;
+			run.max_violation = std::max(run.max_violation, stats.max_violation);
+			run.max_penetration = std::max(run.max_penetration, stats.max_penetration);
+			run.time_integrate += stats.time_integrate;
+			run.time_solve += stats.time_solve;
+			run.time_collide += stats.time_collide;
+			run.time_velocity += stats.time_velocity;
+		}
+		run.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+		run.steps = steps;
+		run.steps_per_second = run.wall_time > 0 ? steps / run.wall_time : 0.0;
+		run.mean_residual = steps > 0 ? float(residual_sum / steps) : 0.0f;
+		run.final_energy = simulation_energy(sim);
+		double const difference = run.final_energy - run.initial_energy;
+		run.energy_drift = std::abs(run.initial_energy) > 1e-12 ? difference / std::abs(run.initial_energy) : difference;
+		run.simulation_memory = sim.memory_size();
+		run.step_time = profiler.distributions();
+		int const step_phase = profiler.find_phase("step");
+		run.step_allocations = step_phase >= 0 ? profiler.phase_allocations(step_phase) : 0;
+		run.step_allocated_bytes = step_phase >= 0 ? profiler.phase_allocated_bytes(step_phase) : 0;
+		if (run.counters_available && step_phase >= 0)
+			run.step_counters = profiler.phase_counters(step_phase);
+		run.hitch_count = profiler.hitch_count();
+		run.hitches = profiler.hitches();
+		return run;
+	}
+
+	std::vector<batch_run> batch_execute(scene_description const& scene, std::vector<batch_parameter> const& sweep, batch_settings const& settings)
+	{
+		assert_cgp(settings.steps > 0 || settings.duration > 0, "A batch requires a number of steps or a duration (steps=" + str(settings.steps) + ", duration=" + str(settings.duration) + ")");
+
+		// Check the keys once, before starting the runs
+		int N_run = 1;
+		bool rebuild_assets = false;
+		for (batch_parameter const& p : sweep) {
+			assert_cgp(p.values.size() > 0, "No value for the parameter " + p.key);
+			scene_description check = scene;
+			assert_cgp(scene_set_parameter(check, p.key, p.values[0]), "Unknown parameter " + p.key + " (or unknown element in the scene " + scene.filename + ")");
+			N_run *= int(p.values.size());
+			rebuild_assets = rebuild_assets || p.key.compare(0, 5, "body.") == 0;
+		}
+
+		// Assets shared by all the runs are built once
+		scene_description base = scene;
+		if (!rebuild_assets && !has_assets(base))
+			scene_load_assets(base);
+
+		int const N_thread = std::max(1, std::min(settings.threads, N_run));
+		int const simulation_threads = settings.simulation_threads > 0 ? settings.simulation_threads : (N_thread > 1 ? 1 : 0);
+
+		std::vector<batch_run> runs(N_run);
+		std::atomic<int> next(0);
+		auto worker = [&]() {
+			for (int index = next++; index < N_run; index = next++)
+			{
+				// Heap memory of the run: the blocks allocated by this thread from here
+				allocation_thread_reset_peak();
+				int64_t const live_start = allocation_thread_live_bytes();
+
+				// Values of the parameters of the run (the last parameter varies first)
+				scene_description run_scene = base;
+				std::vector<std::pair<std::string, float>> parameters(sweep.size());
+				int remainder = index;
+				for (int k = int(sweep.size()) - 1; k >= 0; --k) {
+					int const N_value = int(sweep[k].values.size());
+					parameters[k] = { sweep[k].key, sweep[k].values[remainder % N_value] };
+					remainder /= N_value;
+					scene_set_parameter(run_scene, parameters[k].first, parameters[k].second);
+				}
+				if (rebuild_assets)
+					scene_load_assets(run_scene);
+
+				simulation sim = simulation_build(run_scene);
+				sim.threads = simulation_threads;
+				int const steps = settings.steps > 0 ? settings.steps : int(std::ceil(settings.duration / sim.solver.time_step));
+
+				runs[index] = batch_measure(sim, steps, settings);
+				runs[index].parameters = parameters;
+				runs[index].peak_memory = size_t(std::max(int64_t(0), allocation_thread_peak_bytes() - live_start));
+			}
+		};
+
+		std::vector<std::thread> pool;
+		for (int k = 1; k < N_thread; ++k)
+			pool.emplace_back(worker);
+		worker();
+		for (std::thread& t : pool)
+			t.join();
+
+		return runs;
+	}
+
+	std::string batch_json(std::string const& scene_filename, batch_settings const& settings, std::vector<batch_run> const& runs)
+	{
+		std::ostringstream s;
+		s << "{\n";
+		s << "  \"scene\": " << json_string(scene_filename) << ",\n";
+		s << "  \"steps\": " << settings.steps << ",\n";
+		s << "  \"duration\": " << json_number(settings.duration) << ",\n";
+		s << "  \"threads\": " << settings.threads << ",\n";
+		s << "  \"step_budget\": " << json_number(settings.step_budget) << ",\n";
+		s << "  \"runs\": [";
+		for (size_t k = 0; k < runs.size(); ++k) {
+			batch_run const& r = runs[k];
+			s << (k == 0 ? "\n" : ",\n") << "    {\n";
+			s << "      \"parameters\": {";
+			for (size_t i = 0; i < r.parameters.size(); ++i)
+				s << (i == 0 ? " " : ", ") << json_string(r.parameters[i].first) << ": " << json_number(r.parameters[i].second);
+			s << (r.parameters.empty() ? "},\n" : " },\n");
+			s << "      \"particles\": " << r.particles << ",\n";
+			s << "      \"constraints\": " << r.constraints << ",\n";
+			s << "      \"steps\": " << r.steps << ",\n";
+			s << "      \"wall_time\": " << json_number(r.wall_time) << ",\n";
+			s << "      \"steps_per_second\": " << json_number(r.steps_per_second) << ",\n";
+			s << "      \"iterations\": " << r.iterations << ",\n";
+			s << "      \"initial_energy\": " << json_number(r.initial_energy) << ",\n";
+			s << "      \"final_energy\": " << json_number(r.final_energy) << ",\n";
+			s << "      \"energy_drift\": " << json_number(r.energy_drift) << ",\n";
+			s << "      \"mean_residual\": " << json_number(r.mean_residual) << ",\n";
+			s << "      \"max_violation\": " << json_number(r.max_violation) << ",\n";
+			s << "      \"max_penetration\": " << json_number(r.max_penetration) << ",\n";
+			s << "      \"time\": { \"integrate\": " << json_number(r.time_integrate) << ", \"solve\": " << json_number(r.time_solve)
+				<< ", \"collide\": " << json_number(r.time_collide) << ", \"velocity\": " << json_number(r.time_velocity) << " },\n";
+			s << "      \"simulation_memory\": " << r.simulation_memory << ",\n";
+			s << "      \"peak_memory\": " << r.peak_memory << ",\n";
+			s << "      \"step_allocations\": " << r.step_allocations << ",\n";
+			s << "      \"step_allocated_bytes\": " << r.step_allocated_bytes << ",\n";
+			if (r.counters_available) {
+				perf_counter_values const& c = r.step_counters;
+				double const elements = double(r.steps) * double(std::max(r.particles, 1)); // misses per particle and per step
+				s << "      \"counters\": { \"cycles\": " << c.cycles << ", \"instructions\": " << c.instructions << ", \"ipc\": " << json_number(c.ipc())
+					<< ", \"cache_misses\": " << c.cache_misses << ", \"branch_misses\": " << c.branch_misses
+					<< ", \"cache_misses_per_particle\": " << json_number(c.cache_misses / elements) << ", \"branch_misses_per_particle\": " << json_number(c.branch_misses / elements)
+					<< ", \"memory_bytes_estimate\": " << c.memory_bytes() << " },\n";
+			}
+			else
+				s << "      \"counters\": null,\n";
+			s << "      \"step_time\": {";
+			for (size_t i = 0; i < r.step_time.size(); ++i) {
+				time_distribution const& d = r.step_time[i];
+				s << (i == 0 ? "\n" : ",\n") << "        " << json_string(d.name) << ": { \"count\": " << d.count << ", \"mean\": " << json_number(d.mean)
+					<< ", \"p50\": " << json_number(d.p50) << ", \"p95\": " << json_number(d.p95) << ", \"p99\": " << json_number(d.p99) << ", \"max\": " << json_number(d.max) << ", \"allocations\": " << json_number(d.allocations) << " }";
+			}
+			s << (r.step_time.empty() ? "},\n" : "\n      },\n");
+			s << "      \"hitch_count\": " << r.hitch_count << ",\n";
+			s << "      \"hitches\": [";
+			for (size_t i = 0; i < r.hitches.size(); ++i) {
+				frame_hitch const& h = r.hitches[i];
+				s << (i == 0 ? "" : ", ") << "{ \"step\": " << h.frame << ", \"duration\": " << json_number(h.duration) << ", \"zones\": {";
+				for (int z = 0; z < h.zone_count; ++z)
+					s << (z == 0 ? " " : ", ") << json_string(h.zones[z].name) << ": " << json_number(h.zones[z].duration);
+				s << (h.zone_count == 0 ? "} }" : " } }");
+			}
+			s << "]\n";
+			s << "    }";
+		}
+		s << (runs.empty() ? "]\n" : "\n  ]\n");
+		s << "}\n";
+		return s.str();
+	}
+
+	void batch_save_json(std::string const& filename, std::string const& scene_filename, batch_settings const& settings, std::vector<batch_run> const& runs)
+	{
+		std::ofstream stream(filename);
+		assert_cgp(stream.is_open(), "Cannot write the batch results in the file " + filename);
+		stream << batch_json(scene_filename, settings, runs);
+	}
+}
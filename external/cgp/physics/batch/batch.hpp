@@ -0,0 +1,95 @@
+#pragma once
+
+#include "cgp/physics/scene_file/scene_file.hpp"
+#include "cgp/physics/simulation/simulation.hpp"
+#include "cgp/physics/solver_telemetry/solver_telemetry.hpp"
+#include "cgp/core/profiling/profiling.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace cgp
+{
+	// Headless execution of simulations, without window, as fast as possible (performance measures and regression tests)
+	//
+	// The runs use the XPBD engine of cgp/physics/simulation on the scene description. The interactive application (src/) integrates its spring
+	//  with the GSL ODE solver instead: the measures characterize the engine, not the solver of the application. The settings of the GSL solver
+	//  (method, initial_step, epsabs, epsrel) are ignored: scene_solver::ode_settings tells if the scene gives them.
+	// A batch runs the same scene for every combination of values of a set of parameters (cartesian grid of the sweep).
+	// The runs are distributed on a pool of threads of the process; each run measures its speed, the convergence of the solver and the drift of its energy.
+	// Parameters are designated by keys:
+	//   solver.<field>             time_step, iterations, substeps, gravity (vertical component)
+	//   material.<name>.<field>    mass, stiffness, damping, density, bending
+	//   body.<name>.<field>        size, resolution (both directions) - the assets of the body are rebuilt for each run
+	//   collider.<name>.<field>    size, friction
+
+	/** Values taken by a parameter of the sweep */
+	struct batch_parameter
+	{
+		std::string key;
+		std::vector<float> values;
+	};
+
+	struct batch_settings
+	{
+		int steps = 0;              // number of steps of each run (if > 0)
+		float duration = 0.0f;      // simulated duration of each run (used when steps == 0)
+		int threads = 1;            // number of runs executed in parallel
+		int simulation_threads = 0; // OpenMP threads of each run (0: OpenMP default if a single run is executed at a time, 1 otherwise)
+		double step_budget = 0.0;   // seconds; longer steps are reported as hitches with the time of their phases (0: no detection)
+		int allocation_warmup = -1; // steps after which a heap allocation in a step aborts the program with its backtrace, if allocation_guard_enable(true) was called (-1: allocations allowed). The steps of the run then use a single OpenMP thread, such that the guard checks all their loops.
+		bool hardware_counters = false; // measure the hardware counters of the steps (see perf_counters)
+		int telemetry_capacity = 0;     // number of last steps of each run whose solver convergence is kept in batch_run::telemetry (0: none)
+	};
+
+	/** Measures of a run */
+	struct batch_run
+	{
+		std::vector<std::pair<std::string, float>> parameters; // value of each parameter of the sweep
+
+		int particles = 0;
+		int constraints = 0;
+		int steps = 0;
+		double wall_time = 0.0;         // seconds, without the construction of the simulation
+		double steps_per_second = 0.0;
+		long long iterations = 0;       // total number of solver iterations
+		double initial_energy = 0.0;
+		double final_energy = 0.0;
+		double energy_drift = 0.0;      // (final-initial)/|initial| (absolute difference if the initial energy is 0)
+		float mean_residual = 0.0f;     // mean over the steps of the final residual of the solver
+		float max_violation = 0.0f;     // maximal relative violation of the constraints over all steps
+		float max_penetration = 0.0f;   // maximal penetration in the colliders over all steps
+		double time_integrate = 0.0;    // total time of each phase of the steps (seconds)
+		double time_solve = 0.0;
+		double time_collide = 0.0;
+		double time_velocity = 0.0;
+		size_t simulation_memory = 0;   // octets used by the arrays of the simulation
+		size_t peak_memory = 0;         // peak of the heap memory allocated by the thread of the run, from the copy of its scene to its results (octets, batch_execute only). The blocks allocated by the OpenMP workers are not counted; 0 if allocation_live_bytes_available() is false
+		int64_t step_allocations = 0;      // heap allocations made by the steps (thread of the run, OpenMP threads excluded)
+		int64_t step_allocated_bytes = 0;
+		bool counters_available = false;   // hardware counters were requested and available
+		perf_counter_values step_counters; // total over the steps (thread of the run, OpenMP threads excluded)
+
+		std::vector<time_distribution> step_time; // distribution of the time of the steps ("step") and of their phases
+		int64_t hitch_count = 0;                  // number of steps above the budget
+		std::vector<frame_hitch> hitches;         // last steps above the budget
+		solver_telemetry telemetry = solver_telemetry(0); // convergence of the solver in the last steps (see batch_settings::telemetry_capacity)
+	};
+
+	/** Set a parameter of a scene from its key. Returns false if the key is unknown. */
+	bool scene_set_parameter(scene_description& scene, std::string const& key, float value);
+
+	/** Execute all the combinations of the sweep (a single run if the sweep is empty)
+	* The scene may be given with or without its assets. Runs are returned in the order of the cartesian grid (the last parameter varies first). */
+	std::vector<batch_run> batch_execute(scene_description const& scene, std::vector<batch_parameter> const& sweep, batch_settings const& settings);
+
+	/** Run a single simulation for the given number of steps and measure it (settings.steps, duration and threads are not used)
+	* If settings.allocation_warmup >= 0, sim.threads is set to 1. */
+	batch_run batch_measure(simulation& sim, int steps, batch_settings const& settings = batch_settings());
+
+	/** Export the runs as a JSON document */
+	std::string batch_json(std::string const& scene_filename, batch_settings const& settings, std::vector<batch_run> const& runs);
+	void batch_save_json(std::string const& filename, std::string const& scene_filename, batch_settings const& settings, std::vector<batch_run> const& runs);
+}
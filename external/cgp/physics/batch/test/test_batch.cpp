@@ -0,0 +1,104 @@
+#include "test_batch.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../batch.hpp"
+
+#include <cmath>
+
+namespace cgp_test
+{
+	void test_batch()
+	{
+		using namespace cgp;
+
+		std::string const text =
+			"solver time_step 0.01 substeps 2 iterations 4\n"
+			"material spring mass 2 stiffness 50 damping 0.1\n"
+			"material cloth mass 1\n"
+			"body p1 point position 0 0 1 fixed\n"
+			"body p2 point position 0 0 0 material spring anchor p1 velocity 1 0 0\n"
+			"body cloth grid position 0 0 -1 size 1 resolution 5 5 material cloth\n"
+			"collider ground plane position 0 0 -1.5\n";
+		scene_description const scene = scene_parse(text.data(), text.data() + text.size(), "test_batch.scene");
+
+		// Parameters
+		{
+			scene_description s = scene;
+			assert_cgp_no_msg(scene_set_parameter(s, "solver.iterations", 7) && s.solver.iterations == 7);
+			assert_cgp_no_msg(scene_set_parameter(s, "material.spring.stiffness", 3) && s.materials[0].stiffness == 3.0f);
+			assert_cgp_no_msg(scene_set_parameter(s, "body.cloth.resolution", 8) && s.bodies[2].resolution.y == 8);
+			assert_cgp_no_msg(scene_set_parameter(s, "collider.ground.friction", 0.5f) && s.colliders[0].friction == 0.5f);
+			assert_cgp_no_msg(!scene_set_parameter(s, "material.unknown.mass", 1));
+			assert_cgp_no_msg(!scene_set_parameter(s, "material.spring.unknown", 1));
+			assert_cgp_no_msg(!scene_set_parameter(s, "unknown", 1));
+		}
+
+		// Cartesian grid of the sweep, identical results with one or several threads
+		std::vector<batch_parameter> const sweep = { {"material.spring.stiffness", {10, 100}}, {"solver.substeps", {1, 2, 4}} };
+		batch_settings settings;
+		settings.duration = 0.5f;
+		std::vector<batch_run> const sequential = batch_execute(scene, sweep, settings);
+		settings.threads = 3;
+		std::vector<batch_run> const parallel = batch_execute(scene, sweep, settings);
+
+		assert_cgp_no_msg(sequential.size() == 6 && parallel.size() == 6);
+		assert_cgp_no_msg(sequential[1].parameters[0].second == 10.0f && sequential[1].parameters[1].second == 2.0f);
+		assert_cgp_no_msg(sequential[5].parameters[0].second == 100.0f && sequential[5].parameters[1].second == 4.0f);
+		for (int k = 0; k < 6; ++k) {
+			batch_run const& r = sequential[k];
+			assert_cgp_no_msg(r.steps == 50 && r.particles == 27 && r.iterations == 50 * 4 * r.parameters[1].second);
+			assert_cgp_no_msg(r.final_energy == parallel[k].final_energy && r.energy_drift < 0);
+			assert_cgp_no_msg(r.simulation_memory > 0 && r.steps_per_second > 0);
+			if (allocation_live_bytes_available())
+				assert_cgp_no_msg(r.peak_memory >= r.simulation_memory && parallel[k].peak_memory >= parallel[k].simulation_memory);
+		}
+
+		// Distribution of the time of the steps and of their phases
+		assert_cgp_no_msg(sequential[0].step_time.size() == 5 && sequential[0].step_time[0].name == "step" && sequential[0].step_time[0].count == 50);
+		assert_cgp_no_msg(sequential[0].step_time[0].p50 <= sequential[0].step_time[0].p99 && sequential[0].step_time[0].p99 <= sequential[0].step_time[0].max);
+		assert_cgp_no_msg(sequential[0].hitch_count == 0 && sequential[0].hitches.empty());
+
+		// Parameters of the geometry rebuild the assets of each run (with a budget exceeded by all the steps)
+		settings.steps = 3;
+		settings.step_budget = 1e-9;
+		std::vector<batch_run> const resolution = batch_execute(scene, { {"body.cloth.resolution", {3, 6}} }, settings);
+		assert_cgp_no_msg(resolution.size() == 2 && resolution[0].particles == 2 + 9 && resolution[1].particles == 2 + 36 && resolution[0].steps == 3);
+		assert_cgp_no_msg(resolution[0].hitch_count == 3 && resolution[0].hitches.size() == 3 && resolution[0].hitches[2].frame == 2);
+		assert_cgp_no_msg(resolution[0].hitches[0].zone_count == 4 && std::string(resolution[0].hitches[0].zones[1].name) == "solve");
+
+		// Steps without heap allocation once the simulation is built (the guard aborts the test otherwise)
+		{
+			scene_description s = scene;
+			scene_load_assets(s);
+			simulation sim = simulation_build(s);
+			sim.threads = 4;
+			batch_settings guarded;
+			guarded.allocation_warmup = 0;
+			guarded.hardware_counters = true;
+			allocation_guard_enable(true);
+			batch_run const r = batch_measure(sim, 10, guarded);
+			allocation_guard_enable(false);
+			assert_cgp_no_msg(r.steps == 10 && r.step_allocations == 0 && r.step_time[0].allocations == 0);
+			assert_cgp_no_msg(sim.threads == 1); // the loops of the steps are executed by the guarded thread
+			assert_cgp_no_msg(r.counters_available == perf_counters().available());
+		}
+
+		// JSON export (diverging values are exported as null)
+		std::vector<batch_run> runs = { resolution[0] };
+		runs[0].energy_drift = std::nan("");
+		std::string const json = batch_json("test_batch.scene", settings, runs);
+		assert_cgp_no_msg(json.find("\"scene\": \"test_batch.scene\"") != std::string::npos);
+		assert_cgp_no_msg(json.find("\"parameters\": { \"body.cloth.resolution\": 3 }") != std::string::npos);
+		assert_cgp_no_msg(json.find("\"energy_drift\": null") != std::string::npos);
+		assert_cgp_no_msg(json.find("\"particles\": 11") != std::string::npos);
+		assert_cgp_no_msg(json.find("\"step_time\": {\n        \"step\": { \"count\": 3,") != std::string::npos);
+		assert_cgp_no_msg(json.find("\"step_allocations\": ") != std::string::npos && json.find("\"counters\": null") != std::string::npos);
+		runs[0].counters_available = true;
+		runs[0].step_counters.cycles = 4000;
+		runs[0].step_counters.instructions = 6000;
+		runs[0].step_counters.cache_misses = 66;
+		assert_cgp_no_msg(batch_json("a", settings, runs).find("\"ipc\": 1.5, \"cache_misses\": 66, \"branch_misses\": 0, \"cache_misses_per_particle\": 2,") != std::string::npos);
+		assert_cgp_no_msg(json.find("\"hitch_count\": 3") != std::string::npos && json.find("{ \"step\": 0, \"duration\": ") != std::string::npos);
+		assert_cgp_no_msg(batch_json("a", settings, {}).find("\"runs\": []") != std::string::npos);
+	}
+}
@@ -0,0 +1,128 @@
+#include "checkpoint.hpp"
+
+#include "cgp/core/files/files.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace cgp
+{
+	namespace
+	{
+		char const checkpoint_magic[8] = { 'C','G','P','C','H','K','\0','\0' };
+		uint32_t const checkpoint_version = 1;
+
+		struct checkpoint_header
+		{
+			binary_file_signature signature;
+			uint64_t block_count;
+		};
+
+		// Each block is stored as its description, followed by its name and its values (both padded to 8 octets)
+		struct checkpoint_block_header
+		{
+			uint32_t name_size;
+			uint32_t element_size;
+			uint64_t data_size;
+		};
+
+		uint64_t padded(uint64_t size)
+		{
+			return (size + 7) / 8 * 8;
+		}
+
+		// Write the file, or return the description of the error
+		std::string write_checkpoint(std::string const& filename, checkpoint const& c)
+		{
+			return file_write_atomic(filename, [&c](std::ostream& stream) {
+				checkpoint_header header;
+				std::memset(&header, 0, sizeof(header));
+				header.signature = binary_file_signature_create(checkpoint_magic, checkpoint_version);
+				header.block_count = c.blocks.size();
+				stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+				char const padding[8] = {};
+				for (auto const& it : c.blocks)
+				{
+					checkpoint_block_header const block_header = { uint32_t(it.first.size()), it.second.element_size, it.second.data.size() };
+					stream.write(reinterpret_cast<char const*>(&block_header), sizeof(block_header));
+					stream.write(it.first.data(), it.first.size());
+					stream.write(padding, padded(it.first.size()) - it.first.size());
+					stream.write(it.second.data.data(), it.second.data.size());
+					stream.write(padding, padded(it.second.data.size()) - it.second.data.size());
+				}
+			});
+		}
+	}
+
+	bool checkpoint::has(std::string const& name) const
+	{
+		return blocks.find(name) != blocks.end();
+	}
+
+	size_t checkpoint::memory_size() const
+	{
+		size_t size = 0;
+		for (auto const& it : blocks)
+			size += it.second.data.size();
+		return size;
+	}
+
+	void checkpoint_save_file(std::string const& filename, checkpoint const& c)
+	{
+		std::string const error = write_checkpoint(filename, c);
+		assert_cgp(error.empty(), error);
+	}
+
+	checkpoint checkpoint_load_file(std::string const& filename)
+	{
+		file_mapping const file(filename);
+		assert_cgp(file.size >= sizeof(checkpoint_header), "File " + filename + " is not a checkpoint (too small)");
+
+		checkpoint_header header;
+		std::memcpy(&header, file.data, sizeof(header));
+		std::string const error = binary_file_signature_check(header.signature, checkpoint_magic, checkpoint_version, filename, "checkpoint");
+		assert_cgp(error.empty(), error);
+
+		checkpoint c;
+		uint64_t position = sizeof(header);
+		for (uint64_t k = 0; k < header.block_count; ++k)
+		{
+			assert_cgp(position + sizeof(checkpoint_block_header) <= file.size, "File " + filename + " is truncated");
+			checkpoint_block_header block_header;
+			std::memcpy(&block_header, file.data + position, sizeof(block_header));
+			position += sizeof(block_header);
+
+			uint64_t const name_size = padded(block_header.name_size);
+			assert_cgp(block_header.data_size <= file.size && position + name_size + padded(block_header.data_size) <= file.size, "File " + filename + " is truncated");
+			std::string const name(file.data + position, block_header.name_size);
+			position += name_size;
+
+			checkpoint::block& b = c.blocks[name];
+			b.element_size = block_header.element_size;
+			b.data.assign(file.data + position, file.data + position + block_header.data_size);
+			position += padded(block_header.data_size);
+		}
+		return c;
+	}
+
+	checkpoint_writer::~checkpoint_writer()
+	{
+		wait();
+	}
+
+	void checkpoint_writer::save(std::string const& filename, checkpoint&& snapshot)
+	{
+		wait();
+		writer = std::thread([this, filename](checkpoint const& c) { writer_error = write_checkpoint(filename, c); }, std::move(snapshot));
+	}
+
+	void checkpoint_writer::wait()
+	{
+		if (writer.joinable()) {
+			writer.join();
+			last_error = std::move(writer_error);
+			writer_error.clear();
+		}
+	}
+}
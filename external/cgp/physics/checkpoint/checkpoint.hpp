@@ -0,0 +1,131 @@
+#pragma once
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+	/** Snapshot of the complete state of a simulation, used to restart a run from the middle
+	*
+	* The state is stored as a set of named arrays of raw values (particle arrays, warm start data of solvers, constraint multipliers, 
+	*   time and step size of the integrators, etc). Any trivially copyable type can be stored.
+	* The values are stored bit by bit: restoring a checkpoint in a deterministic simulation reproduces exactly the same continuation. */
+	struct checkpoint
+	{
+		/** Store a copy of the values (replace the previous values with the same name) */
+		template <typename T> void set(std::string const& name, numarray<T> const& values);
+		template <typename T> void set(std::string const& name, T const* values, size_t N);
+		template <typename T> void set_value(std::string const& name, T const& value);
+
+		/** Copy the stored values in the argument 
+		* An error is raised if the name doesn't exist, or if the stored values have a different type size (or a different number of elements for the pointer version) */
+		template <typename T> void get(std::string const& name, numarray<T>& values) const;
+		template <typename T> void get(std::string const& name, T* values, size_t N) const;
+		template <typename T> void get_value(std::string const& name, T& value) const;
+
+		bool has(std::string const& name) const;
+		/** Total size of the stored values in octets */
+		size_t memory_size() const;
+
+		struct block
+		{
+			uint32_t element_size = 0;
+			std::vector<char> data;
+		};
+		std::map<std::string, block> blocks;
+	};
+
+	/** Save the checkpoint in a binary file (written in a temporary file then renamed, such that a crash never leaves an incomplete checkpoint) */
+	void checkpoint_save_file(std::string const& filename, checkpoint const& c);
+	checkpoint checkpoint_load_file(std::string const& filename);
+
+	/** Write checkpoints in a background thread
+	* The simulation copies its state in a checkpoint (memory copy only), and hands it to the writer: save() returns immediately and the file is written in parallel of the next steps.
+	* If a previous checkpoint is still being written, save() waits for it first.
+	* A failed write does not stop the simulation: its error is given by error() once the write is finished (after wait(), or after the next save()). */
+	struct checkpoint_writer
+	{
+		checkpoint_writer() = default;
+		~checkpoint_writer();
+		checkpoint_writer(checkpoint_writer const&) = delete;
+		checkpoint_writer& operator=(checkpoint_writer const&) = delete;
+
+		void save(std::string const& filename, checkpoint&& snapshot);
+		/** Wait until the last checkpoint is written */
+		void wait();
+		/** Error of the last finished write (empty if it succeeded) */
+		std::string const& error() const { return last_error; }
+
+	private:
+		std::thread writer;
+		std::string writer_error; // written by the thread of the writer, read after it is joined
+		std::string last_error;
+	};
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+	template <typename T> void checkpoint::set(std::string const& name, numarray<T> const& values)
+	{
+		set(name, values.data.data(), values.size());
+	}
+
+	template <typename T> void checkpoint::set(std::string const& name, T const* values, size_t N)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be stored in a checkpoint");
+		block& b = blocks[name];
+		b.element_size = sizeof(T);
+		b.data.resize(N * sizeof(T));
+		if (N > 0)
+			std::memcpy(b.data.data(), values, N * sizeof(T));
+	}
+
+	template <typename T> void checkpoint::set_value(std::string const& name, T const& value)
+	{
+		set(name, &value, 1);
+	}
+
+	template <typename T> void checkpoint::get(std::string const& name, numarray<T>& values) const
+	{
+		auto const it = blocks.find(name);
+		assert_cgp(it != blocks.end(), "The checkpoint doesn't store the values " + name);
+		assert_cgp(it->second.element_size == sizeof(T), "The values " + name + " of the checkpoint have a size of " + str(it->second.element_size) + " octets while the requested type has a size of " + str(sizeof(T)) + " octets");
+		values.resize(it->second.data.size() / sizeof(T));
+		get(name, values.data.data(), values.size());
+	}
+
+	template <typename T> void checkpoint::get(std::string const& name, T* values, size_t N) const
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be stored in a checkpoint");
+		auto const it = blocks.find(name);
+		assert_cgp(it != blocks.end(), "The checkpoint doesn't store the values " + name);
+		block const& b = it->second;
+		assert_cgp(b.element_size == sizeof(T) && b.data.size() == N * sizeof(T), "The values " + name + " of the checkpoint have " + str(b.data.size() / std::max<size_t>(b.element_size, 1)) + " elements of " + str(b.element_size) + " octets while " + str(N) + " elements of " + str(sizeof(T)) + " octets are requested");
+		if (N > 0)
+			std::memcpy(values, b.data.data(), N * sizeof(T));
+	}
+
+	template <typename T> void checkpoint::get_value(std::string const& name, T& value) const
+	{
+		get(name, &value, 1);
+	}
+}
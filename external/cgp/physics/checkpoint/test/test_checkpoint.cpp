@@ -0,0 +1,92 @@
+#include "test_checkpoint.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/geometry/vec/vec.hpp"
+#include "../checkpoint.hpp"
+
+#include <cstdio>
+
+namespace cgp_test
+{
+	// Deterministic toy simulation: particles under gravity with a damping depending on the step size history
+	struct checkpoint_simulation
+	{
+		cgp::numarray<cgp::vec3> position;
+		cgp::numarray<cgp::vec3> velocity;
+		double t = 0.0;
+		float dt = 0.01f;
+
+		void step()
+		{
+			for (int k = 0; k < position.size(); ++k) {
+				velocity[k] += dt * cgp::vec3(0.0f, 0.0f, -9.81f) - 0.1f * dt * velocity[k];
+				position[k] += dt * velocity[k];
+			}
+			t += dt;
+			dt = dt * 1.01f > 0.02f ? 0.005f : dt * 1.01f;
+		}
+
+		cgp::checkpoint save() const
+		{
+			cgp::checkpoint c;
+			c.set("position", position);
+			c.set("velocity", velocity);
+			c.set_value("t", t);
+			c.set_value("dt", dt);
+			return c;
+		}
+
+		void restore(cgp::checkpoint const& c)
+		{
+			c.get("position", position);
+			c.get("velocity", velocity);
+			c.get_value("t", t);
+			c.get_value("dt", dt);
+		}
+	};
+
+	void test_checkpoint()
+	{
+		using namespace cgp;
+		std::string const filename = "test_checkpoint.cgpchk";
+
+		checkpoint_simulation simulation;
+		for (int k = 0; k < 100; ++k) {
+			simulation.position.push_back({ 0.1f * k, std::sin(float(k)), 1.0f });
+			simulation.velocity.push_back({ 0.0f, 0.0f, 0.5f * k });
+		}
+		for (int k = 0; k < 50; ++k)
+			simulation.step();
+
+		// Asynchronous save of a copy of the state, while the simulation continues
+		checkpoint_writer writer;
+		writer.save(filename, simulation.save());
+		for (int k = 0; k < 50; ++k)
+			simulation.step();
+		writer.wait();
+		assert_cgp_no_msg(writer.error().empty());
+
+		// Restart from the checkpoint: the continuation is bit-exact
+		checkpoint_simulation restarted;
+		restarted.restore(checkpoint_load_file(filename));
+		for (int k = 0; k < 50; ++k)
+			restarted.step();
+
+		assert_cgp_no_msg(restarted.t == simulation.t && restarted.dt == simulation.dt);
+		for (int k = 0; k < 100; ++k)
+			for (int i = 0; i < 3; ++i)
+				assert_cgp_no_msg(restarted.position[k][i] == simulation.position[k][i] && restarted.velocity[k][i] == simulation.velocity[k][i]);
+
+		// Content of the checkpoint
+		checkpoint const c = checkpoint_load_file(filename);
+		assert_cgp_no_msg(c.has("position") && !c.has("pressure"));
+		assert_cgp_no_msg(c.memory_size() == 2 * 100 * sizeof(vec3) + sizeof(double) + sizeof(float));
+
+		std::remove(filename.c_str());
+
+		// A failed write in background is reported without stopping the program
+		writer.save("missing_directory/checkpoint.cgpchk", simulation.save());
+		writer.wait();
+		assert_cgp_no_msg(!writer.error().empty());
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "aerodynamics/aerodynamics.hpp"
+#include "rest_state/rest_state.hpp"
+#include "recording/recording.hpp"
+#include "checkpoint/checkpoint.hpp"
+#include "point_cache/point_cache.hpp"
+#include "shared_state/shared_state.hpp"
+#include "scene_file/scene_file.hpp"
+#include "simulation/simulation.hpp"
+#include "solver_telemetry/solver_telemetry.hpp"
+#include "batch/batch.hpp"
+#include "regression/regression.hpp"
+#include "scaling/scaling.hpp"
@@ -0,0 +1,278 @@
+#include "point_cache.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/binary_file/binary_file.hpp"
+#include "third_party/src/lodepng/lodepng.h"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+namespace cgp
+{
+	namespace
+	{
+		char const point_cache_magic[8] = { 'C','G','P','P','T','C','\0','\0' };
+		char const point_cache_index_magic[8] = { 'C','G','P','P','I','D','X','\0' };
+		uint32_t const point_cache_version = 1;
+
+		// Bound on the quantized coordinates such that the residuals of the prediction 2*q1-q2 fit in 32 bits
+		int64_t const quantized_max = int64_t(1) << 28;
+
+		struct point_cache_header
+		{
+			binary_file_signature signature;
+			uint64_t vertex_count;
+			uint64_t triangle_count;
+			uint64_t keyframe_interval;
+			float precision;
+			uint32_t unused;
+			uint64_t topology_size; // size of the compressed connectivity that follows the header
+		};
+
+		// Prediction of the quantized coordinate k=3*vertex+component
+		//  order 0 (keyframe): previous vertex of the same frame, order 1: previous frame, order 2: constant velocity from the two previous frames
+		inline int64_t predict(int order, size_t k, int32_t const* q, int32_t const* q1, int32_t const* q2)
+		{
+			if (order == 0)
+				return k >= 3 ? q[k - 3] : 0;
+			if (order == 1)
+				return q1[k];
+			return 2 * int64_t(q1[k]) - q2[k];
+		}
+
+		// Residuals stored per component (all x, then all y, then all z) as zigzag varint
+		void encode_residual(int32_t const* q, int32_t const* q1, int32_t const* q2, size_t N_value, int order, std::vector<unsigned char>& out)
+		{
+			size_t const N_vertex = N_value / 3;
+			out.clear();
+			for (size_t c = 0; c < 3; ++c) {
+				for (size_t i = 0; i < N_vertex; ++i) {
+					size_t const k = 3 * i + c;
+					int32_t const r = int32_t(q[k] - predict(order, k, q, q1, q2));
+					uint32_t z = (uint32_t(r) << 1) ^ uint32_t(r >> 31);
+					while (z >= 0x80) {
+						out.push_back(uint8_t(z | 0x80));
+						z >>= 7;
+					}
+					out.push_back(uint8_t(z));
+				}
+			}
+		}
+
+		bool decode_residual(std::vector<unsigned char> const& in, int order, std::vector<int32_t>& q, std::vector<int32_t> const& q1, std::vector<int32_t> const& q2)
+		{
+			size_t const N_vertex = q.size() / 3;
+			unsigned char const* p = in.data();
+			unsigned char const* const end = p + in.size();
+			for (size_t c = 0; c < 3; ++c) {
+				for (size_t i = 0; i < N_vertex; ++i) {
+					uint32_t z = 0;
+					int shift = 0;
+					while (true) {
+						if (p == end || shift > 28)
+							return false;
+						uint8_t const b = *p++;
+						z |= uint32_t(b & 0x7f) << shift;
+						shift += 7;
+						if (b < 0x80)
+							break;
+					}
+					int32_t const r = int32_t(z >> 1) ^ -int32_t(z & 1);
+					size_t const k = 3 * i + c;
+					q[k] = int32_t(predict(order, k, q.data(), q1.data(), q2.data()) + r);
+				}
+			}
+			return p == end;
+		}
+	}
+
+	point_cache_writer::point_cache_writer(std::string const& filename_arg, numarray<uint3> const& connectivity, int vertex_count_arg, float precision_arg, int keyframe_interval_arg, int queue_capacity)
+	{
+		open(filename_arg, connectivity, vertex_count_arg, precision_arg, keyframe_interval_arg, queue_capacity);
+	}
+
+	void point_cache_writer::open(std::string const& filename, numarray<uint3> const& connectivity, int vertex_count_arg, float precision_arg, int keyframe_interval_arg, int queue_capacity)
+	{
+		close();
+		assert_cgp(vertex_count_arg >= 0, "Incorrect number of vertices (" + str(vertex_count_arg) + ")");
+		assert_cgp(precision_arg > 0, "Quantization precision must be strictly positive (" + str(precision_arg) + ")");
+		assert_cgp(keyframe_interval_arg > 0, "Keyframe interval must be strictly positive (" + str(keyframe_interval_arg) + ")");
+		for (uint3 const& f : connectivity)
+			assert_cgp(int(f.x) < vertex_count_arg && int(f.y) < vertex_count_arg && int(f.z) < vertex_count_arg, "Connectivity refers to a vertex index larger than the number of vertices (" + str(vertex_count_arg) + ")");
+
+		vertex_count = vertex_count_arg;
+		precision = precision_arg;
+		keyframe_interval = keyframe_interval_arg;
+		previous.clear();
+		previous2.clear();
+
+		std::vector<unsigned char> topology;
+		if (connectivity.size() > 0) {
+			unsigned const error = lodepng::compress(topology, reinterpret_cast<unsigned char const*>(connectivity.data.data()), connectivity.size() * sizeof(uint3));
+			assert_cgp(error == 0, "Cannot compress the connectivity: " + std::string(lodepng_error_text(error)));
+		}
+
+		// Header followed by the compressed connectivity
+		std::vector<char> header(sizeof(point_cache_header) + topology.size(), 0);
+		point_cache_header& h = *reinterpret_cast<point_cache_header*>(header.data());
+		h.signature = binary_file_signature_create(point_cache_magic, point_cache_version);
+		h.vertex_count = vertex_count;
+		h.triangle_count = connectivity.size();
+		h.keyframe_interval = keyframe_interval;
+		h.precision = precision;
+		h.topology_size = topology.size();
+		if (!topology.empty())
+			std::memcpy(header.data() + sizeof(point_cache_header), topology.data(), topology.size());
+
+		auto encoder = [this](size_t index, std::vector<uint32_t> const& values, std::vector<char>& encoded) { encode(index, values, encoded); };
+		writer.open(filename, header, point_cache_index_magic, 3 * size_t(vertex_count), encoder, queue_capacity);
+	}
+
+	void point_cache_writer::record(numarray<vec3> const& position)
+	{
+		assert_cgp(is_open(), "The point cache must be opened before recording frames");
+		assert_cgp(position.size() == vertex_count, "Frames must have " + str(vertex_count) + " vertices (size(position)=" + str(position.size()) + ")");
+
+		// Quantization (done here such that invalid positions are reported to the caller)
+		double const inverse_precision = 1.0 / double(precision);
+		float const* const x = reinterpret_cast<float const*>(position.data.data());
+		bool valid = true;
+		for (size_t k = 0; valid && k < 3 * size_t(vertex_count); ++k) {
+			double const q = std::round(double(x[k]) * inverse_precision);
+			valid = std::abs(q) < double(quantized_max); // false for NaN
+		}
+		assert_cgp(valid, "Positions of frame " + str(frame_count()) + " are not finite or too large to be quantized with precision " + str(precision));
+
+		std::vector<uint32_t>& buffer = writer.begin_frame();
+		for (size_t k = 0; k < buffer.size(); ++k)
+			buffer[k] = uint32_t(int32_t(std::round(double(x[k]) * inverse_precision)));
+		writer.end_frame();
+	}
+
+	void point_cache_writer::encode(size_t index, std::vector<uint32_t> const& values, std::vector<char>& encoded)
+	{
+		size_t const N_value = values.size();
+		int32_t const* const q = reinterpret_cast<int32_t const*>(values.data());
+		int const order = std::min(int(index % keyframe_interval), 2);
+		encode_residual(q, previous.data(), previous2.data(), N_value, order, residual);
+
+		compressed.clear();
+		if (!residual.empty()) {
+			unsigned const error = lodepng::compress(compressed, residual);
+			assert_cgp(error == 0, "Cannot compress frame " + str(index) + ": " + std::string(lodepng_error_text(error)));
+		}
+		encoded.assign(compressed.begin(), compressed.end());
+
+		// The frame becomes the previous one
+		std::swap(previous2, previous);
+		previous.assign(q, q + N_value);
+	}
+
+	void point_cache_writer::close()
+	{
+		writer.close();
+	}
+
+
+	point_cache_reader::point_cache_reader(std::string const& filename_arg)
+	{
+		open(filename_arg);
+	}
+
+	void point_cache_reader::open(std::string const& filename_arg)
+	{
+		filename = filename_arg;
+		file.open(filename);
+		current = -1;
+		assert_cgp(file.size >= sizeof(point_cache_header), "File " + filename + " is not a point cache (too small)");
+
+		point_cache_header header;
+		std::memcpy(&header, file.data, sizeof(header));
+		std::string const error = binary_file_signature_check(header.signature, point_cache_magic, point_cache_version, filename, "point cache");
+		assert_cgp(error.empty(), error);
+		assert_cgp(header.keyframe_interval > 0 && header.precision > 0, "File " + filename + " has a corrupted header");
+
+		size_t const topology_begin = sizeof(point_cache_header);
+		assert_cgp(header.topology_size <= file.size, "File " + filename + " has a corrupted connectivity block");
+		index = indexed_frame_read_index(file, point_cache_index_magic, topology_begin + header.topology_size, filename);
+		assert_cgp(index.offset[0] == topology_begin + header.topology_size, "File " + filename + " has a corrupted connectivity block");
+
+		N_vertex = int(header.vertex_count);
+		keyframe_interval = int(header.keyframe_interval);
+		quantization_step = header.precision;
+
+		triangles.resize(header.triangle_count);
+		if (header.triangle_count > 0) {
+			std::vector<unsigned char> topology;
+			unsigned const error = lodepng::decompress(topology, reinterpret_cast<unsigned char const*>(file.data + topology_begin), header.topology_size);
+			assert_cgp(error == 0 && topology.size() == header.triangle_count * sizeof(uint3), "File " + filename + " has a corrupted connectivity block");
+			std::memcpy(triangles.data.data(), topology.data(), topology.size());
+			for (uint3 const& f : triangles)
+				assert_cgp(int64_t(f.x) < N_vertex && int64_t(f.y) < N_vertex && int64_t(f.z) < N_vertex, "File " + filename + " has a connectivity with invalid vertex indices");
+		}
+
+		quantized.assign(3 * size_t(N_vertex), 0);
+		previous.assign(3 * size_t(N_vertex), 0);
+		previous2.assign(3 * size_t(N_vertex), 0);
+		position.resize(N_vertex);
+	}
+
+	int point_cache_reader::frame_count() const
+	{
+		return index.frame_count;
+	}
+
+	int point_cache_reader::vertex_count() const
+	{
+		return N_vertex;
+	}
+
+	float point_cache_reader::precision() const
+	{
+		return quantization_step;
+	}
+
+	numarray<uint3> const& point_cache_reader::connectivity() const
+	{
+		return triangles;
+	}
+
+	numarray<vec3> const& point_cache_reader::frame(int k)
+	{
+		assert_cgp(k >= 0 && k < index.frame_count, "Frame " + str(k) + " is out of range (number of frames: " + str(index.frame_count) + ")");
+		if (k == current)
+			return position;
+
+		// Restart from the keyframe, unless the requested frame follows the current one (the prediction uses the two previous frames)
+		int const keyframe = k - k % keyframe_interval;
+		int const first = (current >= keyframe && current < k) ? current + 1 : keyframe;
+		for (int i = first; i <= k; ++i)
+			decode(i);
+		current = k;
+
+		double const step = quantization_step;
+		float* const x = reinterpret_cast<float*>(position.data.data());
+		for (size_t k = 0; k < previous.size(); ++k)
+			x[k] = float(previous[k] * step);
+		return position;
+	}
+
+	void point_cache_reader::decode(int k)
+	{
+		residual.clear();
+		size_t const size = index.frame_size(k);
+		if (size > 0) {
+			unsigned const error = lodepng::decompress(residual, reinterpret_cast<unsigned char const*>(file.data + index.offset[k]), size);
+			assert_cgp(error == 0, "File " + filename + ": cannot decompress frame " + str(k) + " (" + std::string(lodepng_error_text(error)) + ")");
+		}
+
+		int const order = std::min(k % keyframe_interval, 2);
+		bool const valid = decode_residual(residual, order, quantized, previous, previous2);
+		assert_cgp(valid, "File " + filename + ": frame " + str(k) + " is corrupted");
+
+		// The decoded frame becomes the previous one
+		std::swap(previous2, previous);
+		std::swap(previous, quantized);
+	}
+}
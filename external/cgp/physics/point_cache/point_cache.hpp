@@ -0,0 +1,90 @@
+#pragma once
+
+#include "cgp/geometry/vec/vec.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+#include "cgp/core/files/file_mapping/file_mapping.hpp"
+#include "cgp/core/files/indexed_frame_file/indexed_frame_file.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace cgp
+{
+	// Compressed export of an animated triangle mesh (point cache) for offline tools
+	//
+	// The connectivity is written once at the beginning of the file. Each frame stores the positions of the vertices:
+	//  - The coordinates are quantized on a regular grid of step "precision" (the reconstruction error is at most precision/2 per coordinate).
+	//  - The quantized values are predicted from the previous frames (constant velocity extrapolation 2*p[t-1]-p[t-2]),
+	//      and only the residuals of the prediction are stored. Keyframes are predicted from the previous vertex of the same frame.
+	//  - The residuals are stored coordinate per coordinate as zigzag variable length integers (small residuals use one octet), and the block is compressed with deflate.
+	// The prediction only depends on the decoded values, therefore the error does not accumulate along the frames.
+	// The frames are written with an indexed_frame_writer (index of the position of all frames at the end of the file).
+
+	/** Write a point cache
+	* The frames are encoded and compressed by a background thread: record() only quantizes the positions in a buffer and returns without waiting,
+	*   unless queue_capacity frames are already waiting to be written. */
+	struct point_cache_writer
+	{
+		point_cache_writer() = default;
+		point_cache_writer(std::string const& filename, numarray<uint3> const& connectivity, int vertex_count, float precision = 1e-4f, int keyframe_interval = 60, int queue_capacity = 8);
+
+		/** Create the file, write the connectivity and start the writing thread.
+		* precision is the step of the quantization grid (in the units of the positions) */
+		void open(std::string const& filename, numarray<uint3> const& connectivity, int vertex_count, float precision = 1e-4f, int keyframe_interval = 60, int queue_capacity = 8);
+		/** Add a frame (position.size() must be equal to vertex_count). The positions are quantized before returning. */
+		void record(numarray<vec3> const& position);
+		/** Wait for all the frames to be written, and write the index at the end of the file (a write error is given by error()) */
+		void close();
+
+		bool is_open() const { return writer.is_open(); }
+		int frame_count() const { return writer.frame_count(); }
+		/** Description of the write error of the last closed file (empty if the cache has been written entirely) */
+		std::string const& error() const { return writer.error(); }
+
+	private:
+		void encode(size_t index, std::vector<uint32_t> const& values, std::vector<char>& encoded); // called by the background thread
+
+		int vertex_count = 0;
+		int keyframe_interval = 60;
+		float precision = 1e-4f;
+
+		// State of the background thread: quantized positions of the two previous frames, and buffers of the encoding
+		std::vector<int32_t> previous, previous2;
+		std::vector<unsigned char> residual, compressed;
+		indexed_frame_writer writer; // frames of quantized positions (int32 stored as uint32)
+	};
+
+	/** Read a file written by point_cache_writer
+	* Accessing a frame decodes its previous keyframe and the frames between them, except when the frames are accessed sequentially. */
+	struct point_cache_reader
+	{
+		point_cache_reader() = default;
+		explicit point_cache_reader(std::string const& filename);
+
+		void open(std::string const& filename);
+		int frame_count() const;
+		int vertex_count() const;
+		float precision() const;
+		numarray<uint3> const& connectivity() const;
+
+		/** Positions of the vertices at the given frame (the reference is valid until the next call) */
+		numarray<vec3> const& frame(int index);
+
+	private:
+		void decode(int index);
+
+		file_mapping file;
+		std::string filename;
+		int N_vertex = 0;
+		int keyframe_interval = 1;
+		float quantization_step = 1.0f;
+		indexed_frame_index index;
+		numarray<uint3> triangles;
+
+		int current = -1;
+		std::vector<int32_t> quantized, previous, previous2; // quantized positions of the current frame and of the two previous ones
+		std::vector<unsigned char> residual;
+		numarray<vec3> position;
+	};
+}
@@ -0,0 +1,79 @@
+#include "test_point_cache.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "../point_cache.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace cgp_test
+{
+	// Waving sheet of Nu x Nv vertices
+	static cgp::numarray<cgp::vec3> point_cache_state(int Nu, int Nv, int frame)
+	{
+		cgp::numarray<cgp::vec3> p(Nu * Nv);
+		float const t = 0.04f * frame;
+		for (int ku = 0; ku < Nu; ++ku) {
+			for (int kv = 0; kv < Nv; ++kv) {
+				float const u = ku / (Nu - 1.0f);
+				float const v = kv / (Nv - 1.0f);
+				p[ku * Nv + kv] = { u, v + 0.1f * t, 0.2f * std::sin(6.0f * u + 3.0f * t) * std::cos(4.0f * v - t) };
+			}
+		}
+		return p;
+	}
+
+	void test_point_cache()
+	{
+		using namespace cgp;
+		std::string const filename = "test_point_cache.cgppc";
+		int const Nu = 40, Nv = 30;
+		int const N = Nu * Nv;
+		int const N_frame = 53;
+		float const precision = 1e-4f;
+
+		numarray<uint3> connectivity;
+		for (int ku = 0; ku < Nu - 1; ++ku) {
+			for (int kv = 0; kv < Nv - 1; ++kv) {
+				unsigned int const k = ku * Nv + kv;
+				connectivity.push_back(uint3{ k, k + Nv, k + 1 });
+				connectivity.push_back(uint3{ k + 1, k + Nv, k + Nv + 1 });
+			}
+		}
+
+		{
+			point_cache_writer writer(filename, connectivity, N, precision, 20);
+			for (int f = 0; f < N_frame; ++f)
+				writer.record(point_cache_state(Nu, Nv, f));
+			assert_cgp_no_msg(writer.frame_count() == N_frame);
+		} // closed by the destructor
+
+		// At least an order of magnitude smaller than the raw float positions
+		assert_cgp_no_msg(file_get_size(filename) * 10 < size_t(N_frame) * N * sizeof(vec3));
+
+		point_cache_reader reader(filename);
+		assert_cgp_no_msg(reader.frame_count() == N_frame && reader.vertex_count() == N);
+		assert_cgp_no_msg(reader.connectivity().size() == connectivity.size());
+		for (size_t k = 0; k < connectivity.size(); ++k)
+			assert_cgp_no_msg(is_equal(reader.connectivity()[k], connectivity[k]));
+
+		// Random and sequential access are within the quantization error
+		for (int f : { 52, 3, 0, 1, 2, 21, 22, 23, 39, 40, 41, 19, 20 }) {
+			numarray<vec3> const& p = reader.frame(f);
+			numarray<vec3> const expected = point_cache_state(Nu, Nv, f);
+			for (int k = 0; k < N; ++k)
+				for (int c = 0; c < 3; ++c)
+					assert_cgp_no_msg(std::abs(p[k][c] - expected[k][c]) <= 0.51f * precision + 1e-6f);
+		}
+
+		// Empty cache
+		{
+			point_cache_writer writer(filename, connectivity, N);
+		}
+		point_cache_reader empty(filename);
+		assert_cgp_no_msg(empty.frame_count() == 0 && empty.connectivity().size() == connectivity.size());
+
+		std::remove(filename.c_str());
+	}
+}
@@ -0,0 +1,194 @@
+#include "recording.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/binary_file/binary_file.hpp"
+
+#include <cstring>
+
+namespace cgp
+{
+	static_assert(sizeof(vec3) == 3 * sizeof(uint32_t), "Frames are encoded as packed 32 bits values");
+
+	namespace
+	{
+		char const recording_magic[8] = { 'C','G','P','R','E','C','\0','\0' };
+		char const recording_index_magic[8] = { 'C','G','P','R','I','D','X','\0' };
+		uint32_t const recording_version = 2; // 2: frames are encoded relatively to their keyframe (previous frame in version 1)
+
+		enum frame_type : uint8_t { frame_keyframe = 0, frame_delta = 1 };
+
+		struct recording_header
+		{
+			binary_file_signature signature;
+			uint64_t element_count;
+			uint64_t keyframe_interval;
+		};
+
+		// XOR with the keyframe: one 4-bits control per value (number of low octets stored), followed by the octets
+		void encode_delta(std::vector<uint32_t> const& values, std::vector<uint32_t> const& keyframe, std::vector<char>& out)
+		{
+			size_t const N = values.size();
+			out.assign(1 + (N + 1) / 2, 0);
+			out[0] = char(frame_delta);
+			for (size_t k = 0; k < N; ++k) {
+				uint32_t x = values[k] ^ keyframe[k];
+				int bytes = 0;
+				while (x != 0) {
+					out.push_back(char(x & 0xff));
+					x >>= 8;
+					++bytes;
+				}
+				out[1 + k / 2] = char(uint8_t(out[1 + k / 2]) | uint8_t(bytes << (4 * (k % 2))));
+			}
+		}
+
+		// Apply the XOR stored in data (of the given size) to the values of the keyframe. Returns false if the data is inconsistent.
+		bool decode_delta(uint8_t const* data, size_t size, size_t N, uint32_t* values)
+		{
+			if (size < (N + 1) / 2)
+				return false;
+			uint8_t const* control = data;
+			uint8_t const* p = data + (N + 1) / 2;
+			uint8_t const* const end = data + size;
+			for (size_t k = 0; k < N; ++k) {
+				int const bytes = (control[k / 2] >> (4 * (k % 2))) & 0xf;
+				if (bytes > 4 || end - p < bytes)
+					return false;
+				uint32_t x = 0;
+				for (int b = 0; b < bytes; ++b)
+					x |= uint32_t(p[b]) << (8 * b);
+				p += bytes;
+				values[k] ^= x;
+			}
+			return p == end;
+		}
+	}
+
+	simulation_recorder::simulation_recorder(std::string const& filename_arg, int element_count_arg, int keyframe_interval_arg, int queue_capacity)
+	{
+		open(filename_arg, element_count_arg, keyframe_interval_arg, queue_capacity);
+	}
+
+	void simulation_recorder::open(std::string const& filename, int element_count_arg, int keyframe_interval_arg, int queue_capacity)
+	{
+		close();
+		assert_cgp(element_count_arg >= 0, "Incorrect number of elements per frame (" + str(element_count_arg) + ")");
+		assert_cgp(keyframe_interval_arg > 0, "Keyframe interval must be strictly positive (" + str(keyframe_interval_arg) + ")");
+
+		element_count = element_count_arg;
+		keyframe_interval = keyframe_interval_arg;
+
+		std::vector<char> header(sizeof(recording_header), 0);
+		recording_header& h = *reinterpret_cast<recording_header*>(header.data());
+		h.signature = binary_file_signature_create(recording_magic, recording_version);
+		h.element_count = element_count;
+		h.keyframe_interval = keyframe_interval;
+
+		auto encoder = [this](size_t index, std::vector<uint32_t> const& values, std::vector<char>& encoded) { encode(index, values, encoded); };
+		writer.open(filename, header, recording_index_magic, 3 * size_t(element_count), encoder, queue_capacity);
+	}
+
+	void simulation_recorder::record(numarray<vec3> const& state)
+	{
+		assert_cgp(is_open(), "The recorder must be opened before recording frames");
+		assert_cgp(state.size() == element_count, "Frames must have " + str(element_count) + " elements (size(state)=" + str(state.size()) + ")");
+
+		std::vector<uint32_t>& buffer = writer.begin_frame();
+		if (element_count > 0)
+			std::memcpy(buffer.data(), state.data.data(), buffer.size() * sizeof(uint32_t));
+		writer.end_frame();
+	}
+
+	void simulation_recorder::encode(size_t index, std::vector<uint32_t> const& values, std::vector<char>& encoded)
+	{
+		if (index % keyframe_interval == 0) {
+			keyframe.assign(values.begin(), values.end());
+			encoded.resize(1 + values.size() * sizeof(uint32_t));
+			encoded[0] = char(frame_keyframe);
+			if (!values.empty())
+				std::memcpy(encoded.data() + 1, values.data(), values.size() * sizeof(uint32_t));
+		}
+		else
+			encode_delta(values, keyframe, encoded);
+	}
+
+	void simulation_recorder::close()
+	{
+		writer.close();
+	}
+
+
+	simulation_player::simulation_player(std::string const& filename)
+	{
+		open(filename);
+	}
+
+	void simulation_player::open(std::string const& filename_arg)
+	{
+		filename = filename_arg;
+		file.open(filename);
+		current = -1;
+		current_keyframe = -1;
+		assert_cgp(file.size >= sizeof(recording_header), "File " + filename + " is not a simulation recording (too small)");
+
+		recording_header header;
+		std::memcpy(&header, file.data, sizeof(header));
+		std::string const error = binary_file_signature_check(header.signature, recording_magic, recording_version, filename, "simulation recording");
+		assert_cgp(error.empty(), error);
+		assert_cgp(header.keyframe_interval > 0 && header.keyframe_interval < (1u << 31) && header.element_count < (1u << 29), "File " + filename + " has a corrupted header");
+
+		index = indexed_frame_read_index(file, recording_index_magic, sizeof(recording_header), filename);
+		N_element = int(header.element_count);
+		keyframe_interval = int(header.keyframe_interval);
+		keyframe.assign(3 * size_t(N_element), 0);
+		state.resize(N_element);
+	}
+
+	int simulation_player::frame_count() const
+	{
+		return index.frame_count;
+	}
+
+	int simulation_player::element_count() const
+	{
+		return N_element;
+	}
+
+	numarray<vec3> const& simulation_player::frame(int k)
+	{
+		assert_cgp(k >= 0 && k < index.frame_count, "Frame " + str(k) + " is out of range (number of frames: " + str(index.frame_count) + ")");
+		if (k == current)
+			return state;
+
+		int const keyframe_index = k - k % keyframe_interval;
+		if (keyframe_index != current_keyframe) {
+			decode(keyframe_index, keyframe.data());
+			current_keyframe = keyframe_index;
+		}
+		uint32_t* const values = reinterpret_cast<uint32_t*>(state.data.data());
+		if (!keyframe.empty())
+			std::memcpy(values, keyframe.data(), keyframe.size() * sizeof(uint32_t));
+		if (k != keyframe_index)
+			decode(k, values);
+		current = k;
+		return state;
+	}
+
+	void simulation_player::decode(int k, uint32_t* values)
+	{
+		uint8_t const* const data = reinterpret_cast<uint8_t const*>(file.data + index.offset[k]);
+		size_t const size = index.frame_size(k);
+		size_t const N_value = 3 * size_t(N_element);
+		assert_cgp(size >= 1, "File " + filename + ": frame " + str(k) + " is corrupted");
+		bool const is_keyframe = k % keyframe_interval == 0;
+		if (is_keyframe) {
+			assert_cgp(data[0] == frame_keyframe && size == 1 + N_value * sizeof(uint32_t), "File " + filename + ": frame " + str(k) + " is corrupted");
+			if (N_value > 0)
+				std::memcpy(values, data + 1, N_value * sizeof(uint32_t));
+		}
+		else {
+			bool const valid = data[0] == frame_delta && decode_delta(data + 1, size - 1, N_value, values);
+			assert_cgp(valid, "File " + filename + ": frame " + str(k) + " is corrupted");
+		}
+	}
+}
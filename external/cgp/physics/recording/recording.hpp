@@ -0,0 +1,79 @@
+#pragma once
+
+#include "cgp/geometry/vec/vec.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+#include "cgp/core/files/file_mapping/file_mapping.hpp"
+#include "cgp/core/files/indexed_frame_file/indexed_frame_file.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace cgp
+{
+	// Recording of the successive states of a simulation in a binary file, and playback with random access to the frames
+	//
+	// A state is an array of vec3 of constant size (ex. positions of the particles, or positions followed by velocities).
+	// Every keyframe_interval frames, the state is stored entirely (keyframe). 
+	// The other frames store the XOR of the bits of each coordinate with their keyframe: values that change slowly keep the same sign, exponent and high bits of mantissa, 
+	//   such that only the non-zero low octets of the XOR are stored. The encoding is lossless.
+	//   As each frame only depends on its keyframe, accessing any frame decodes at most two frames.
+	// The frames are written with an indexed_frame_writer (index of the position of all frames at the end of the file).
+
+	/** Write the frames of a simulation in a file
+	* The frames are encoded and written by a background thread: record() only copies the state in a buffer and returns without waiting for the disk,
+	*   unless queue_capacity frames are already waiting to be written. */
+	struct simulation_recorder
+	{
+		simulation_recorder() = default;
+		simulation_recorder(std::string const& filename, int element_count, int keyframe_interval = 30, int queue_capacity = 8);
+
+		/** Create the file and start the writing thread. element_count is the number of vec3 per frame. */
+		void open(std::string const& filename, int element_count, int keyframe_interval = 30, int queue_capacity = 8);
+		/** Add a frame (state.size() must be equal to element_count) */
+		void record(numarray<vec3> const& state);
+		/** Wait for all the frames to be written, and write the index at the end of the file (a write error is given by error()) */
+		void close();
+
+		bool is_open() const { return writer.is_open(); }
+		int frame_count() const { return writer.frame_count(); }
+		/** Description of the write error of the last closed file (empty if the recording has been written entirely) */
+		std::string const& error() const { return writer.error(); }
+
+	private:
+		void encode(size_t index, std::vector<uint32_t> const& values, std::vector<char>& encoded); // called by the background thread
+
+		int element_count = 0;
+		int keyframe_interval = 30;
+		std::vector<uint32_t> keyframe; // last keyframe (used by the background thread)
+		indexed_frame_writer writer;
+	};
+
+	/** Read the frames of a file written by simulation_recorder
+	* The file is mapped in memory. Accessing a frame decodes its keyframe (unless it is the keyframe of the previous access) and the frame itself. */
+	struct simulation_player
+	{
+		simulation_player() = default;
+		explicit simulation_player(std::string const& filename);
+
+		void open(std::string const& filename);
+		int frame_count() const;
+		int element_count() const;
+
+		/** State of the simulation at the given frame (the reference is valid until the next call) */
+		numarray<vec3> const& frame(int index);
+
+	private:
+		void decode(int index, uint32_t* values); // decode a keyframe in values, or apply a delta frame to the values of its keyframe
+
+		file_mapping file;
+		std::string filename;
+		int N_element = 0;
+		int keyframe_interval = 1;
+		indexed_frame_index index;
+		int current = -1;
+		int current_keyframe = -1;
+		std::vector<uint32_t> keyframe; // values of the keyframe of the current frame
+		numarray<vec3> state;
+	};
+}
@@ -0,0 +1,57 @@
+#include "test_recording.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "../recording.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace cgp_test
+{
+	static cgp::numarray<cgp::vec3> recording_state(int N, int frame)
+	{
+		cgp::numarray<cgp::vec3> p(N);
+		for (int k = 0; k < N; ++k)
+			p[k] = { std::cos(0.01f * k + 0.02f * frame), std::sin(0.01f * k) + 0.001f * frame, k == 3 ? 1.0f : -0.5f * frame };
+		return p;
+	}
+
+	void test_recording()
+	{
+		using namespace cgp;
+		std::string const filename = "test_recording.cgprec";
+		int const N = 500;
+		int const N_frame = 47;
+
+		{
+			simulation_recorder recorder(filename, N, 10, 2); // at most 2 frames waiting for the writing thread
+			for (int f = 0; f < N_frame; ++f)
+				recorder.record(recording_state(N, f));
+			assert_cgp_no_msg(recorder.frame_count() == N_frame);
+		} // closed by the destructor
+
+		// Delta frames are smaller than keyframes
+		assert_cgp_no_msg(file_get_size(filename) < N_frame * N * sizeof(vec3));
+
+		simulation_player player(filename);
+		assert_cgp_no_msg(player.frame_count() == N_frame && player.element_count() == N);
+
+		// Random and sequential access give the exact recorded values
+		for (int f : { 46, 3, 0, 21, 22, 23, 39, 40, 41, 9 }) {
+			numarray<vec3> const& p = player.frame(f);
+			numarray<vec3> const expected = recording_state(N, f);
+			for (int k = 0; k < N; ++k)
+				assert_cgp_no_msg(p[k].x == expected[k].x && p[k].y == expected[k].y && p[k].z == expected[k].z);
+		}
+
+		// Empty recording
+		{
+			simulation_recorder recorder(filename, N);
+		}
+		simulation_player empty(filename);
+		assert_cgp_no_msg(empty.frame_count() == 0);
+
+		std::remove(filename.c_str());
+	}
+}
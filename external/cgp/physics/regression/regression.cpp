@@ -0,0 +1,315 @@
+#include "regression.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+namespace cgp
+{
+	namespace
+	{
+		std::string directory_of(std::string const& filename)
+		{
+			size_t const k = filename.find_last_of("/\\");
+			return k == std::string::npos ? "" : filename.substr(0, k + 1);
+		}
+
+		std::string path_relative_to(std::string const& directory, std::string const& file)
+		{
+			bool const is_absolute = !file.empty() && (file[0] == '/' || file[0] == '\\' || (file.size() > 1 && file[1] == ':'));
+			return is_absolute ? file : directory + file;
+		}
+
+		// Line of a text file without its comment, and with its trailing '\r' removed
+		std::string strip_comment(std::string line)
+		{
+			size_t const comment = line.find('#');
+			if (comment != std::string::npos)
+				line.resize(comment);
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			return line;
+		}
+
+		struct mean_variance
+		{
+			double mean = 0.0;
+			double variance = 0.0; // unbiased estimation (0 for a single value)
+			int n = 0;
+		};
+
+		mean_variance statistics(std::vector<double> const& x)
+		{
+			mean_variance s;
+			s.n = int(x.size());
+			if (s.n == 0)
+				return s;
+			for (double v : x)
+				s.mean += v;
+			s.mean /= s.n;
+			if (s.n > 1) {
+				for (double v : x)
+					s.variance += (v - s.mean) * (v - s.mean);
+				s.variance /= (s.n - 1);
+			}
+			return s;
+		}
+
+		double normal_quantile(double p)
+		{
+			// Newton iterations on the cumulative distribution function
+			double x = 0.0;
+			for (int k = 0; k < 50; ++k) {
+				double const cdf = 0.5 * std::erfc(-x / std::sqrt(2.0));
+				double const pdf = std::exp(-0.5 * x * x) / std::sqrt(2.0 * 3.14159265358979323846);
+				double const dx = (cdf - p) / pdf;
+				x -= dx;
+				if (std::abs(dx) < 1e-12)
+					break;
+			}
+			return x;
+		}
+	}
+
+	std::string str(regression_status status)
+	{
+		switch (status)
+		{
+		case regression_status::unchanged: return "unchanged";
+		case regression_status::faster: return "faster";
+		case regression_status::slower: return "slower";
+		case regression_status::no_baseline: return "no baseline";
+		}
+		return "";
+	}
+
+	double student_t_quantile(double p, double degrees_of_freedom)
+	{
+		assert_cgp(p > 0 && p < 1 && degrees_of_freedom > 0, "Invalid arguments for the quantile of the Student t distribution (p=" + str(p) + ", degrees of freedom=" + str(degrees_of_freedom) + ")");
+		double const pi = 3.14159265358979323846;
+		double const n = degrees_of_freedom;
+
+		// Exact expressions for 1 and 2 degrees of freedom
+		if (n == 1)
+			return std::tan(pi * (p - 0.5));
+		if (n == 2)
+			return (2 * p - 1) * std::sqrt(2.0 / (4 * p * (1 - p)));
+
+		// Cornish-Fisher expansion around the normal distribution (error below 1% from 3 degrees of freedom)
+		double const z = normal_quantile(p);
+		double const z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z, z9 = z7 * z * z;
+		return z + (z3 + z) / (4 * n)
+			+ (5 * z5 + 16 * z3 + 3 * z) / (96 * n * n)
+			+ (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * n * n * n)
+			+ (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) / (92160 * n * n * n * n);
+	}
+
+	std::vector<regression_benchmark> regression_load_suite(std::string const& filename)
+	{
+		std::ifstream stream(filename);
+		assert_cgp(stream.is_open(), "Cannot open the suite file " + filename);
+		std::string const directory = directory_of(filename);
+
+		std::vector<regression_benchmark> suite;
+		std::string line;
+		for (int line_number = 1; std::getline(stream, line); ++line_number)
+		{
+			std::istringstream in(strip_comment(line));
+			std::string word;
+			if (!(in >> word))
+				continue;
+
+			std::string const location = "Suite file " + filename + ", line " + str(line_number) + ": ";
+			if (word != "benchmark")
+				error_cgp(location + "unknown element [" + word + "] (expected: benchmark)");
+
+			regression_benchmark b;
+			if (!(in >> b.name >> b.scene_file))
+				error_cgp(location + "a benchmark requires a name and a scene file");
+			b.scene_file = path_relative_to(directory, b.scene_file);
+
+			std::string key;
+			while (in >> key) {
+				bool ok = true;
+				if (key == "steps") ok = bool(in >> b.steps) && b.steps > 0;
+				else if (key == "repetitions") ok = bool(in >> b.repetitions) && b.repetitions > 0;
+				else if (key == "energy_drift") ok = bool(in >> b.energy_drift_min >> b.energy_drift_max);
+				else if (key == "penetration") ok = bool(in >> b.penetration_max);
+				else if (key == "residual") ok = bool(in >> b.residual_max);
+				else error_cgp(location + "unknown key [" + key + "]");
+				if (!ok)
+					error_cgp(location + "invalid value for the key [" + key + "]");
+			}
+			for (regression_benchmark const& other : suite)
+				if (other.name == b.name)
+					error_cgp(location + "the benchmark " + b.name + " is already defined");
+			suite.push_back(b);
+		}
+		return suite;
+	}
+
+	regression_sample regression_measure(regression_benchmark const& benchmark)
+	{
+		scene_description const scene = scene_load_file(benchmark.scene_file);
+		simulation const initial = simulation_build(scene);
+
+		regression_sample sample;
+		sample.name = benchmark.name;
+		sample.steps = benchmark.steps;
+
+		// Warm-up (caches, page faults of the first allocations, start of the OpenMP threads)
+		{
+			simulation sim = initial;
+			batch_measure(sim, std::min(benchmark.steps, 10));
+		}
+
+		for (int k = 0; k < benchmark.repetitions; ++k) {
+			simulation sim = initial;
+			sample.last_run = batch_measure(sim, benchmark.steps);
+			sample.time_per_step.push_back(sample.last_run.wall_time / benchmark.steps);
+			if (k == 0)
+				sample.final_energy = sample.last_run.final_energy;
+		}
+		return sample;
+	}
+
+	std::vector<regression_sample> regression_load_baseline(std::string const& filename)
+	{
+		std::ifstream stream(filename);
+		assert_cgp(stream.is_open(), "Cannot open the baseline file " + filename);
+
+		std::vector<regression_sample> samples;
+		std::string line;
+		for (int line_number = 1; std::getline(stream, line); ++line_number)
+		{
+			std::istringstream in(strip_comment(line));
+			regression_sample s;
+			int N = 0;
+			if (!(in >> s.name))
+				continue;
+			bool ok = bool(in >> s.steps >> s.final_energy >> N) && N > 0;
+			s.time_per_step.resize(std::max(N, 0));
+			for (int k = 0; ok && k < N; ++k)
+				ok = bool(in >> s.time_per_step[k]);
+			if (!ok)
+				error_cgp("Baseline file " + filename + ", line " + str(line_number) + ": expected [name steps final_energy N time_1 ... time_N]");
+			samples.push_back(s);
+		}
+		return samples;
+	}
+
+	void regression_save_baseline(std::string const& filename, std::vector<regression_sample> const& samples)
+	{
+		std::ofstream stream(filename);
+		assert_cgp(stream.is_open(), "Cannot write the baseline file " + filename);
+		stream.precision(12);
+		stream << "# Baseline of the regression suite: name steps final_energy N time_per_step_1 ... time_per_step_N\n";
+		for (regression_sample const& s : samples) {
+			stream << s.name << " " << s.steps << " " << s.final_energy << " " << s.time_per_step.size();
+			for (double t : s.time_per_step)
+				stream << " " << t;
+			stream << "\n";
+		}
+	}
+
+	regression_comparison regression_compare(regression_sample const& baseline, regression_sample const& current, double confidence, double tolerance)
+	{
+		mean_variance const b = statistics(baseline.time_per_step);
+		mean_variance const c = statistics(current.time_per_step);
+
+		regression_comparison r;
+		r.baseline_mean = b.mean;
+		r.current_mean = c.mean;
+		if (b.n == 0 || c.n == 0 || b.mean <= 0)
+			return r;
+
+		// Welch: standard error of the difference of the means, and Welch-Satterthwaite degrees of freedom
+		double const vb = b.variance / b.n;
+		double const vc = c.variance / c.n;
+		double const standard_error = std::sqrt(vb + vc);
+		double denominator = 0.0;
+		if (b.n > 1) denominator += vb * vb / (b.n - 1);
+		if (c.n > 1) denominator += vc * vc / (c.n - 1);
+		double const degrees_of_freedom = denominator > 0 ? (vb + vc) * (vb + vc) / denominator : 1e9;
+		double const t = student_t_quantile(0.5 + 0.5 * confidence, std::max(1.0, degrees_of_freedom));
+
+		double const difference = c.mean - b.mean;
+		r.relative_change = difference / b.mean;
+		r.interval_low = (difference - t * standard_error) / b.mean;
+		r.interval_high = (difference + t * standard_error) / b.mean;
+		if (r.interval_low > tolerance)
+			r.status = regression_status::slower;
+		else if (r.interval_high < -tolerance)
+			r.status = regression_status::faster;
+		else
+			r.status = regression_status::unchanged;
+		return r;
+	}
+
+	std::vector<regression_sample> regression_merge_baseline(std::vector<regression_sample> const& baseline, std::vector<regression_sample> const& samples)
+	{
+		std::vector<regression_sample> merged = baseline;
+		for (regression_sample const& s : samples) {
+			auto it = std::find_if(merged.begin(), merged.end(), [&s](regression_sample const& b) { return b.name == s.name; });
+			if (it != merged.end())
+				*it = s;
+			else
+				merged.push_back(s);
+		}
+		return merged;
+	}
+
+	regression_result regression_check(regression_benchmark const& benchmark, regression_sample const& current, regression_sample const* baseline, double confidence, double tolerance, double energy_tolerance)
+	{
+		regression_result result;
+		result.benchmark = benchmark;
+		result.sample = current;
+		batch_run const& run = current.last_run;
+		result.timing.current_mean = statistics(current.time_per_step).mean;
+
+		if (baseline != nullptr && baseline->steps != current.steps)
+			result.failures.push_back("the baseline was measured with " + str(baseline->steps) + " steps instead of " + str(current.steps) + " (update the baseline)");
+		else if (baseline != nullptr) {
+			result.timing = regression_compare(*baseline, current, confidence, tolerance);
+			if (result.timing.status == regression_status::slower)
+				result.failures.push_back("slower than the baseline: " + str(100 * result.timing.relative_change) + "% (confidence interval [" + str(100 * result.timing.interval_low) + "%, " + str(100 * result.timing.interval_high) + "%])");
+
+			double const energy_difference = std::abs(current.final_energy - baseline->final_energy);
+			if (!(energy_difference <= energy_tolerance * std::max(std::abs(baseline->final_energy), 1e-6)))
+				result.failures.push_back("final energy " + str(current.final_energy) + " differs from the baseline " + str(baseline->final_energy));
+		}
+
+		if (!(run.energy_drift >= benchmark.energy_drift_min && run.energy_drift <= benchmark.energy_drift_max))
+			result.failures.push_back("energy drift " + str(run.energy_drift) + " outside of [" + str(benchmark.energy_drift_min) + ", " + str(benchmark.energy_drift_max) + "]");
+		if (benchmark.penetration_max >= 0 && !(run.max_penetration <= benchmark.penetration_max))
+			result.failures.push_back("penetration " + str(run.max_penetration) + " above " + str(benchmark.penetration_max));
+		if (benchmark.residual_max >= 0 && !(run.mean_residual <= benchmark.residual_max))
+			result.failures.push_back("residual " + str(run.mean_residual) + " above " + str(benchmark.residual_max));
+
+		return result;
+	}
+
+	std::string regression_report(std::vector<regression_result> const& results)
+	{
+		std::ostringstream s;
+		s.precision(3);
+		int N_fail = 0;
+		for (regression_result const& r : results) {
+			regression_comparison const& t = r.timing;
+			s << (r.failures.empty() ? "[ OK ] " : "[FAIL] ") << r.benchmark.name << ": " << 1000 * t.current_mean << " ms/step";
+			if (t.status != regression_status::no_baseline)
+				s << " (baseline " << 1000 * t.baseline_mean << " ms/step, " << std::showpos << 100 * t.relative_change << "% [" << 100 * t.interval_low << "%, " << 100 * t.interval_high << "%]" << std::noshowpos << ", " << str(t.status) << ")";
+			else
+				s << " (no baseline)";
+			s << ", drift " << r.sample.last_run.energy_drift << ", penetration " << r.sample.last_run.max_penetration << ", residual " << r.sample.last_run.mean_residual << "\n";
+			for (std::string const& f : r.failures)
+				s << "       - " << f << "\n";
+			N_fail += r.failures.empty() ? 0 : 1;
+		}
+		s << results.size() - N_fail << "/" << results.size() << " benchmarks passed\n";
+		return s.str();
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "cgp/physics/batch/batch.hpp"
+
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// Detection of performance and behavior regressions on a suite of benchmark scenes
+	//
+	// A suite file lists the benchmarks, one per line (comments start with '#', scene files are relative to the suite file):
+	//   benchmark name scene_file [key values ...]
+	//     steps N              number of steps of a run
+	//     repetitions N        number of timed runs (after one warm-up run)
+	//     energy_drift min max bounds of the relative drift of the energy
+	//     penetration max      maximal penetration depth in the colliders
+	//     residual max         maximal mean residual of the constraints
+	// The timings of the runs are compared to a baseline (file written by regression_save_baseline) with a confidence interval on the
+	//  relative difference of the mean time per step (Welch t-test). A benchmark fails if it is significantly slower than the tolerance,
+	//  if its final energy differs from the baseline (change of behavior), or if a physical invariant is outside of its bounds.
+
+	struct regression_benchmark
+	{
+		std::string name;
+		std::string scene_file;
+		int steps = 100;
+		int repetitions = 5;
+		float energy_drift_min = -1.0f;
+		float energy_drift_max = 0.1f;
+		float penetration_max = -1.0f; // negative: not checked
+		float residual_max = -1.0f;    // negative: not checked
+	};
+
+	/** Measures of a benchmark (one value per timed repetition) */
+	struct regression_sample
+	{
+		std::string name;
+		int steps = 0;
+		std::vector<double> time_per_step; // seconds
+		double final_energy = 0.0;         // of the first repetition (runs are deterministic)
+		batch_run last_run;                // complete measures of the last repetition
+	};
+
+	enum class regression_status { unchanged, faster, slower, no_baseline };
+
+	struct regression_comparison
+	{
+		double baseline_mean = 0.0;    // mean time per step (seconds)
+		double current_mean = 0.0;
+		double relative_change = 0.0;  // (current-baseline)/baseline
+		double interval_low = 0.0;     // confidence interval of the relative change
+		double interval_high = 0.0;
+		regression_status status = regression_status::no_baseline;
+	};
+
+	struct regression_result
+	{
+		regression_benchmark benchmark;
+		regression_sample sample;
+		regression_comparison timing;
+		std::vector<std::string> failures; // empty if the benchmark passes
+	};
+
+	/** Load the list of benchmarks of a suite file */
+	std::vector<regression_benchmark> regression_load_suite(std::string const& filename);
+
+	/** Run a benchmark: one warm-up run, then the timed repetitions */
+	regression_sample regression_measure(regression_benchmark const& benchmark);
+
+	/** Baseline: samples of reference (text file, one line per benchmark) */
+	std::vector<regression_sample> regression_load_baseline(std::string const& filename);
+	void regression_save_baseline(std::string const& filename, std::vector<regression_sample> const& samples);
+	/** Baseline where the samples replace the entries of the same name (the other entries are kept, new benchmarks are added at the end) */
+	std::vector<regression_sample> regression_merge_baseline(std::vector<regression_sample> const& baseline, std::vector<regression_sample> const& samples);
+
+	/** Compare the timings of two samples. The change is significant if the confidence interval of the relative change is beyond +/-tolerance. */
+	regression_comparison regression_compare(regression_sample const& baseline, regression_sample const& current, double confidence = 0.95, double tolerance = 0.05);
+
+	/** Check the timings and the final energy against the baseline sample (if given, it must have the same number of steps), and the invariants of a benchmark */
+	regression_result regression_check(regression_benchmark const& benchmark, regression_sample const& current, regression_sample const* baseline,
+		double confidence = 0.95, double tolerance = 0.05, double energy_tolerance = 0.01);
+
+	/** Readable report of the results */
+	std::string regression_report(std::vector<regression_result> const& results);
+
+	/** Quantile of the Student t distribution with the given degrees of freedom (p in ]0,1[) */
+	double student_t_quantile(double p, double degrees_of_freedom);
+
+	std::string str(regression_status status);
+}
@@ -0,0 +1,101 @@
+#include "test_regression.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../regression.hpp"
+
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+
+namespace cgp_test
+{
+	void test_regression()
+	{
+		using namespace cgp;
+
+		// Quantiles of the Student t distribution (reference values of the tables)
+		assert_cgp_no_msg(std::abs(student_t_quantile(0.975, 1) - 12.706) < 1e-3);
+		assert_cgp_no_msg(std::abs(student_t_quantile(0.975, 2) - 4.303) < 1e-3);
+		assert_cgp_no_msg(std::abs(student_t_quantile(0.975, 3) - 3.182) < 0.02);
+		assert_cgp_no_msg(std::abs(student_t_quantile(0.975, 10) - 2.228) < 1e-3);
+		assert_cgp_no_msg(std::abs(student_t_quantile(0.95, 30) - 1.697) < 1e-3);
+		assert_cgp_no_msg(std::abs(student_t_quantile(0.975, 1e9) - 1.960) < 1e-3);
+		assert_cgp_no_msg(std::abs(student_t_quantile(0.025, 10) + 2.228) < 1e-3);
+
+		// Comparison of timings
+		regression_sample baseline;
+		baseline.name = "a";
+		baseline.steps = 10;
+		baseline.final_energy = 2.0;
+		baseline.time_per_step = { 1.00, 1.02, 0.98, 1.01, 0.99 };
+
+		regression_sample same = baseline;
+		same.time_per_step = { 1.01, 0.99, 1.00, 1.02, 0.98 };
+		regression_sample slower = baseline;
+		slower.time_per_step = { 1.30, 1.32, 1.28, 1.31, 1.29 };
+		regression_sample faster = baseline;
+		faster.time_per_step = { 0.70, 0.72, 0.68, 0.71, 0.69 };
+		regression_sample noisy = baseline;
+		noisy.time_per_step = { 0.6, 1.8, 1.0, 1.5, 0.8 };
+
+		assert_cgp_no_msg(regression_compare(baseline, same).status == regression_status::unchanged);
+		regression_comparison const c = regression_compare(baseline, slower);
+		assert_cgp_no_msg(c.status == regression_status::slower && std::abs(c.relative_change - 0.3) < 1e-6 && c.interval_low < 0.3 && c.interval_high > 0.3);
+		assert_cgp_no_msg(regression_compare(baseline, faster).status == regression_status::faster);
+		assert_cgp_no_msg(regression_compare(baseline, noisy).status == regression_status::unchanged); // +14% but not significant
+		assert_cgp_no_msg(regression_compare(baseline, slower, 0.95, 0.5).status == regression_status::unchanged);
+
+		// Checks of the invariants and of the final energy
+		regression_benchmark benchmark;
+		benchmark.name = "a";
+		benchmark.penetration_max = 0.01f;
+		regression_sample current = same;
+		current.last_run.energy_drift = -0.1;
+		current.last_run.max_penetration = 0.001f;
+		assert_cgp_no_msg(regression_check(benchmark, current, &baseline).failures.empty());
+		assert_cgp_no_msg(regression_check(benchmark, current, nullptr).timing.status == regression_status::no_baseline);
+		regression_sample other_steps = baseline;
+		other_steps.steps = 2 * baseline.steps;
+		assert_cgp_no_msg(regression_check(benchmark, current, &other_steps).failures.size() == 1);
+
+		current.last_run.energy_drift = 0.5;
+		current.last_run.max_penetration = 0.1f;
+		current.final_energy = 2.5;
+		assert_cgp_no_msg(regression_check(benchmark, current, &baseline).failures.size() == 3);
+		current.last_run.energy_drift = std::nan("");
+		assert_cgp_no_msg(regression_check(benchmark, current, nullptr).failures.size() == 2);
+		assert_cgp_no_msg(regression_report({ regression_check(benchmark, current, nullptr) }).find("0/1 benchmarks passed") != std::string::npos);
+
+		// Baseline file
+		regression_save_baseline("test_regression_baseline.txt", { baseline, slower });
+		std::vector<regression_sample> const loaded = regression_load_baseline("test_regression_baseline.txt");
+		assert_cgp_no_msg(loaded.size() == 2 && loaded[0].name == "a" && loaded[0].steps == 10 && loaded[0].final_energy == 2.0);
+		assert_cgp_no_msg(loaded[1].time_per_step.size() == 5 && loaded[1].time_per_step[2] == 1.28);
+		std::remove("test_regression_baseline.txt");
+
+		// Update of a part of the baseline
+		regression_sample b = faster;
+		b.name = "b";
+		std::vector<regression_sample> const merged = regression_merge_baseline(loaded, { b });
+		assert_cgp_no_msg(merged.size() == 3 && merged[0].name == "a" && merged[2].name == "b");
+		assert_cgp_no_msg(regression_merge_baseline(merged, { slower }).size() == 3 && regression_merge_baseline(merged, { slower })[0].time_per_step[0] == 1.30);
+
+		// Suite file and measure of a benchmark
+		{
+			std::ofstream scene("test_regression.scene");
+			scene << "solver time_step 0.01\nbody p1 point position 0 0 1 fixed\nbody rope rope size 1 resolution 5 2 anchor p1\n";
+			std::ofstream suite("test_regression_suite.txt");
+			suite << "# Suite\n\nbenchmark rope test_regression.scene steps 5 repetitions 2 energy_drift -1 1 residual 0.5 # comment\r\n";
+		}
+		std::vector<regression_benchmark> const suite = regression_load_suite("test_regression_suite.txt");
+		assert_cgp_no_msg(suite.size() == 1 && suite[0].name == "rope" && suite[0].scene_file == "test_regression.scene");
+		assert_cgp_no_msg(suite[0].steps == 5 && suite[0].repetitions == 2 && suite[0].energy_drift_max == 1.0f && suite[0].residual_max == 0.5f && suite[0].penetration_max < 0);
+
+		regression_sample const measured = regression_measure(suite[0]);
+		assert_cgp_no_msg(measured.name == "rope" && measured.time_per_step.size() == 2 && measured.last_run.steps == 5 && measured.last_run.particles == 6);
+		assert_cgp_no_msg(regression_check(suite[0], measured, &measured).failures.empty());
+
+		std::remove("test_regression.scene");
+		std::remove("test_regression_suite.txt");
+	}
+}
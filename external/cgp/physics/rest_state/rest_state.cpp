@@ -0,0 +1,287 @@
+#include "rest_state.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+namespace cgp
+{
+	namespace
+	{
+		char const rest_state_magic[8] = { 'C','G','P','R','E','S','T','\0' };
+		uint32_t const rest_state_version = 1;
+
+		enum rest_state_block { block_edge, block_edge_length, block_edge_order, block_edge_color_offset, block_triangle_area, block_triangle_rest_inverse, block_mass, block_bending, block_bending_angle, block_count };
+
+		struct rest_state_header
+		{
+			binary_file_signature signature;
+			uint64_t key;
+
+			// Position in octets and number of elements of each block
+			uint64_t offset[block_count];
+			uint64_t count[block_count];
+		};
+
+		// Common access to the arrays of the rest state in the order of the blocks
+		template <typename STATE, typename F>
+		void for_each_block(STATE& state, F f)
+		{
+			f(block_edge, state.edge);
+			f(block_edge_length, state.edge_length);
+			f(block_edge_order, state.edge_order);
+			f(block_edge_color_offset, state.edge_color_offset);
+			f(block_triangle_area, state.triangle_area);
+			f(block_triangle_rest_inverse, state.triangle_rest_inverse);
+			f(block_mass, state.mass);
+			f(block_bending, state.bending);
+			f(block_bending_angle, state.bending_angle);
+		}
+
+		float dihedral_angle(vec3 const& p0, vec3 const& p1, vec3 const& p2, vec3 const& p3)
+		{
+			vec3 const e = p1 - p0;
+			vec3 const n1 = cross(e, p2 - p0);
+			vec3 const n2 = cross(p3 - p0, e);
+			float const L = norm(e);
+			if (L < 1e-12f || norm(n1) < 1e-12f || norm(n2) < 1e-12f)
+				return 0.0f;
+			return std::atan2(dot(cross(n1, n2), e) / L, dot(n1, n2));
+		}
+	}
+
+	void rest_state_color_edges(numarray<uint2> const& edge, int N_vertex, numarray<int>& edge_order, numarray<int>& edge_color_offset)
+	{
+		int const N_edge = edge.size();
+
+		// Edges adjacent to each vertex
+		std::vector<int> adjacent_offset(N_vertex + 1, 0);
+		for (uint2 const& e : edge) {
+			adjacent_offset[e[0] + 1]++;
+			adjacent_offset[e[1] + 1]++;
+		}
+		for (int k = 0; k < N_vertex; ++k)
+			adjacent_offset[k + 1] += adjacent_offset[k];
+		std::vector<int> adjacent(adjacent_offset[N_vertex]);
+		std::vector<int> fill(adjacent_offset.begin(), adjacent_offset.end() - 1);
+		for (int k = 0; k < N_edge; ++k) {
+			adjacent[fill[edge[k][0]]++] = k;
+			adjacent[fill[edge[k][1]]++] = k;
+		}
+
+		std::vector<int> color(N_edge, -1);
+		std::vector<int> forbidden; // forbidden[c]==k if the color c is used by a neighbor of the edge k
+		int N_color = 0;
+		for (int k = 0; k < N_edge; ++k) {
+			for (unsigned int v : edge[k])
+				for (int j = adjacent_offset[v]; j < adjacent_offset[v + 1]; ++j) {
+					int const c = color[adjacent[j]];
+					if (c >= 0)
+						forbidden[c] = k;
+				}
+			int c = 0;
+			while (c < N_color && forbidden[c] == k)
+				++c;
+			if (c == N_color) {
+				N_color++;
+				forbidden.push_back(-1);
+			}
+			color[k] = c;
+		}
+
+		// Sort the edges by color (stable, such that each color keeps the initial order of the edges)
+		edge_color_offset.resize(N_color + 1);
+		edge_color_offset.fill(0);
+		for (int c : color)
+			edge_color_offset[c + 1]++;
+		for (int c = 0; c < N_color; ++c)
+			edge_color_offset[c + 1] += edge_color_offset[c];
+		edge_order.resize(N_edge);
+		std::vector<int> next(edge_color_offset.begin(), edge_color_offset.end() - 1);
+		for (int k = 0; k < N_edge; ++k)
+			edge_order[next[color[k]]++] = k;
+	}
+
+	int rest_state::N_edge_color() const
+	{
+		return edge_color_offset.size() > 0 ? int(edge_color_offset.size()) - 1 : 0;
+	}
+
+	rest_state rest_state_build(numarray<vec3> const& position, numarray<uint3> const& connectivity, rest_state_parameters const& parameters)
+	{
+		int const N_vertex = position.size();
+		int const N_tri = connectivity.size();
+		rest_state state;
+
+		// Triangles: area, inverse rest shape, and lumped masses
+		state.triangle_area.resize(N_tri);
+		state.triangle_rest_inverse.resize(N_tri);
+		#pragma omp parallel for
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+		{
+			uint3 const& tri = connectivity.at_unsafe(k_tri);
+			vec3 const e1 = position.at(tri[1]) - position.at(tri[0]);
+			vec3 const e2 = position.at(tri[2]) - position.at(tri[0]);
+			vec3 const n = cross(e1, e2);
+			float const area = 0.5f * norm(n);
+			state.triangle_area.at_unsafe(k_tri) = area;
+
+			mat2 D_inv = mat2(0, 0, 0, 0);
+			if (area > 1e-12f) {
+				// Orthonormal frame (u,v) of the plane of the triangle (n is orthogonal to u and has norm 2*area)
+				vec3 const u = e1 / norm(e1);
+				vec3 const v = cross(n, u) / (2.0f * area);
+				// D = [dot(e1,u) dot(e2,u); 0 dot(e2,v)] is upper triangular with det(D) = 2*area
+				//  (inverted explicitly: inverse(mat2) rejects the small determinants of fine meshes)
+				float const a = dot(e1, u), b = dot(e2, u), d = dot(e2, v);
+				D_inv = mat2(1.0f / a, -b / (a * d), 0.0f, 1.0f / d);
+			}
+			state.triangle_rest_inverse.at_unsafe(k_tri) = D_inv;
+		}
+
+		state.mass.resize(N_vertex);
+		state.mass.fill(0.0f);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+			for (unsigned int idx : connectivity.at_unsafe(k_tri))
+				state.mass.at(idx) += parameters.density * state.triangle_area.at_unsafe(k_tri) / 3.0f;
+
+		// Edges: each triangle edge is stored as (min vertex, max vertex, triangle, opposite vertex), and sorted to group the triangles sharing an edge
+		struct half_edge { unsigned int a, b, opposite; int triangle; };
+		std::vector<half_edge> half_edges(3 * size_t(N_tri));
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri) {
+			uint3 const& tri = connectivity.at_unsafe(k_tri);
+			for (int k = 0; k < 3; ++k) {
+				unsigned int const i = tri[k], j = tri[(k + 1) % 3];
+				half_edges[3 * k_tri + k] = { std::min(i, j), std::max(i, j), tri[(k + 2) % 3], k_tri };
+			}
+		}
+		std::sort(half_edges.begin(), half_edges.end(), [](half_edge const& h1, half_edge const& h2) { return h1.a < h2.a || (h1.a == h2.a && (h1.b < h2.b || (h1.b == h2.b && h1.triangle < h2.triangle))); });
+
+		std::vector<uint2> edge;
+		std::vector<uint4> bending;
+		for (size_t k = 0; k < half_edges.size();) {
+			size_t end = k + 1;
+			while (end < half_edges.size() && half_edges[end].a == half_edges[k].a && half_edges[end].b == half_edges[k].b)
+				++end;
+			edge.push_back({ half_edges[k].a, half_edges[k].b });
+
+			// Bending is only defined for manifold edges shared by exactly two triangles
+			if (parameters.bending && end == k + 2) {
+				// Orient the edge as in the first triangle, such that the dihedral angle of a consistently oriented mesh is signed
+				uint3 const& tri = connectivity[half_edges[k].triangle];
+				unsigned int const opposite = half_edges[k].opposite;
+				unsigned int const i = tri[0] == opposite ? tri[1] : (tri[1] == opposite ? tri[2] : tri[0]);
+				unsigned int const j = half_edges[k].a == i ? half_edges[k].b : half_edges[k].a;
+				bending.push_back({ i, j, opposite, half_edges[k + 1].opposite });
+			}
+			k = end;
+		}
+
+		state.edge.data.assign(edge.begin(), edge.end());
+		state.edge_length.resize(state.edge.size());
+		for (int k = 0; k < state.edge.size(); ++k)
+			state.edge_length[k] = norm(position.at(state.edge[k][1]) - position.at(state.edge[k][0]));
+		rest_state_color_edges(state.edge, N_vertex, state.edge_order, state.edge_color_offset);
+
+		state.bending.data.assign(bending.begin(), bending.end());
+		state.bending_angle.resize(state.bending.size());
+		for (int k = 0; k < state.bending.size(); ++k) {
+			uint4 const& b = state.bending[k];
+			state.bending_angle[k] = dihedral_angle(position.at(b[0]), position.at(b[1]), position.at(b[2]), position.at(b[3]));
+		}
+
+		return state;
+	}
+
+	uint64_t rest_state_key(numarray<vec3> const& position, numarray<uint3> const& connectivity, rest_state_parameters const& parameters)
+	{
+		uint64_t key = hash_buffer(&rest_state_version, sizeof(rest_state_version));
+		key = hash_buffer(position.data.data(), position.size() * sizeof(vec3), key);
+		key = hash_buffer(connectivity.data.data(), connectivity.size() * sizeof(uint3), key);
+		key = hash_value(parameters.density, key);
+		key = hash_value(parameters.bending, key);
+		return key;
+	}
+
+	// Return an empty string on success, otherwise the description of the error
+	static std::string rest_state_write_file(std::string const& filename, rest_state const& state, uint64_t key)
+	{
+		rest_state_header header;
+		std::memset(&header, 0, sizeof(header));
+		header.signature = binary_file_signature_create(rest_state_magic, rest_state_version);
+		header.key = key;
+
+		uint64_t offset = binary_file_align(sizeof(rest_state_header));
+		for_each_block(state, [&](int block, auto const& values) {
+			using T = typename std::decay<decltype(values[0])>::type;
+			header.offset[block] = offset;
+			header.count[block] = values.size();
+			offset = binary_file_align(offset + values.size() * sizeof(T));
+		});
+
+		return file_write_atomic(filename, [&](std::ostream& stream) {
+			uint64_t position = 0;
+			binary_file_write_block(stream, position, 0, &header, sizeof(header));
+			for_each_block(state, [&](int block, auto const& values) {
+				using T = typename std::decay<decltype(values[0])>::type;
+				binary_file_write_block(stream, position, header.offset[block], values.data.data(), values.size() * sizeof(T));
+			});
+		});
+	}
+
+	void rest_state_save_file(std::string const& filename, rest_state const& state, uint64_t key)
+	{
+		std::string const error = rest_state_write_file(filename, state, key);
+		assert_cgp(error.empty(), error);
+	}
+
+	bool rest_state_load_file(std::string const& filename, uint64_t key, rest_state& state)
+	{
+		if (!check_file_exist(filename) || file_get_size(filename) < sizeof(rest_state_header))
+			return false;
+
+		file_mapping file;
+		file.open(filename);
+		rest_state_header header;
+		std::memcpy(&header, file.data, sizeof(header));
+
+		bool valid = binary_file_signature_check(header.signature, rest_state_magic, rest_state_version, filename, "rest state").empty() && header.key == key;
+		for_each_block(state, [&](int block, auto const& values) {
+			using T = typename std::decay<decltype(values[0])>::type;
+			valid = valid && header.offset[block] % binary_file_alignment == 0 && header.count[block] <= file.size / sizeof(T) && header.offset[block] + header.count[block] * sizeof(T) <= file.size;
+		});
+		if (!valid)
+			return false;
+
+		rest_state result;
+		for_each_block(result, [&](int block, auto& values) {
+			using T = typename std::decay<decltype(values[0])>::type;
+			values.resize(header.count[block]);
+			if (header.count[block] > 0)
+				std::memcpy(values.data.data(), file.data + header.offset[block], header.count[block] * sizeof(T));
+		});
+		state = std::move(result);
+		return true;
+	}
+
+	rest_state rest_state_build_cached(numarray<vec3> const& position, numarray<uint3> const& connectivity, rest_state_parameters const& parameters, std::string const& cache_directory)
+	{
+		uint64_t const key = rest_state_key(position, connectivity, parameters);
+		std::string const filename = cache_filename(cache_directory, "rest_state_", key, ".cgprest");
+
+		rest_state state;
+		if (rest_state_load_file(filename, key, state))
+			return state;
+
+		state = rest_state_build(position, connectivity, parameters);
+
+		// The cache is only an optimization: the rest state is still used if it cannot be written
+		std::string const error = rest_state_write_file(filename, state, key);
+		if (!error.empty())
+			warning_cgp("Cannot write the rest state cache", error);
+		return state;
+	}
+}
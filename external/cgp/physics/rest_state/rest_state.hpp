@@ -0,0 +1,63 @@
+#pragma once
+
+#include "cgp/geometry/vec/vec.hpp"
+#include "cgp/geometry/mat/mat.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+
+#include <cstdint>
+
+namespace cgp
+{
+	/** Parameters used to build the rest state (they are part of the cache key) */
+	struct rest_state_parameters
+	{
+		float density = 1.0f; // surface density (kg/m^2) used for the lumped masses
+		bool bending = true;  // extract the pairs of adjacent triangles used by the bending forces
+	};
+
+	/** Data of a triangle-based deformable body (cloth, shell) precomputed in its rest configuration */
+	struct rest_state
+	{
+		// Unique edges (edge[k][0] < edge[k][1]) and their rest length
+		numarray<uint2> edge;
+		numarray<float> edge_length;
+
+		// Edges grouped by color: the edges edge_order[edge_color_offset[c] ... edge_color_offset[c+1]-1] have the color c
+		//  Edges of the same color share no vertex, and can be processed in parallel (ex. Gauss-Seidel/PBD constraint projection)
+		numarray<int> edge_order;
+		numarray<int> edge_color_offset;
+
+		// Per triangle: rest area, and inverse of the rest shape matrix [p1-p0, p2-p0] expressed in the 2D frame of the triangle
+		numarray<float> triangle_area;
+		numarray<mat2> triangle_rest_inverse;
+
+		// Lumped mass per vertex
+		numarray<float> mass;
+
+		// Pairs of triangles sharing an edge: (edge vertex 0, edge vertex 1, opposite vertex in first triangle, opposite vertex in second triangle), and rest dihedral angle
+		numarray<uint4> bending;
+		numarray<float> bending_angle;
+
+		int N_edge_color() const;
+	};
+
+	/** Greedy coloring of the edges such that two edges sharing a vertex have different colors
+	* The edges edge_order[edge_color_offset[c] ... edge_color_offset[c+1]-1] have the color c (in their initial order) */
+	void rest_state_color_edges(numarray<uint2> const& edge, int N_vertex, numarray<int>& edge_order, numarray<int>& edge_color_offset);
+
+	/** Compute the rest state from the positions of the mesh in its rest configuration */
+	rest_state rest_state_build(numarray<vec3> const& position, numarray<uint3> const& connectivity, rest_state_parameters const& parameters = rest_state_parameters());
+
+	/** Key identifying a rest state: hash of the mesh, the parameters, and the version of the rest state format */
+	uint64_t rest_state_key(numarray<vec3> const& position, numarray<uint3> const& connectivity, rest_state_parameters const& parameters);
+
+	/** Save the rest state in a binary file associated to the given key */
+	void rest_state_save_file(std::string const& filename, rest_state const& state, uint64_t key);
+	/** Load the rest state from a binary file (through a memory mapping)
+	* Return false (and leave the state unchanged) if the file doesn't exist, is not valid, or has been built with another key */
+	bool rest_state_load_file(std::string const& filename, uint64_t key, rest_state& state);
+
+	/** Load the rest state from the cache directory if it has already been built for this mesh and parameters, otherwise build it and store it in the cache
+	* The cache file is named cache_directory/rest_state_[key].cgprest, the directory must exist (otherwise a warning is displayed and the rest state is only built). */
+	rest_state rest_state_build_cached(numarray<vec3> const& position, numarray<uint3> const& connectivity, rest_state_parameters const& parameters, std::string const& cache_directory);
+}
@@ -0,0 +1,98 @@
+#include "test_rest_state.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "cgp/geometry/shape/mesh/primitive/mesh_primitive.hpp"
+#include "../rest_state.hpp"
+
+#include <cstdio>
+#include <set>
+
+namespace cgp_test
+{
+	void test_rest_state()
+	{
+		using namespace cgp;
+
+		mesh const grid = mesh_primitive_grid({ 0,0,0 }, { 2,0,0 }, { 2,1,0 }, { 0,1,0 }, 5, 4);
+		int const N_vertex = grid.position.size();
+		int const N_tri = grid.connectivity.size();
+
+		rest_state_parameters parameters;
+		parameters.density = 2.0f;
+		rest_state const state = rest_state_build(grid.position, grid.connectivity, parameters);
+
+		// Euler characteristic of a disk: V - E + F = 1
+		int const N_edge = state.edge.size();
+		assert_cgp_no_msg(N_vertex - N_edge + N_tri == 1);
+		assert_cgp_no_msg(state.bending.size() == N_edge - 2 * (5 - 1) - 2 * (4 - 1)); // all edges except the boundary
+
+		float total_area = 0.0f, total_mass = 0.0f;
+		for (float a : state.triangle_area) total_area += a;
+		for (float m : state.mass) total_mass += m;
+		assert_cgp_no_msg(is_equal(total_area, 2.0f));
+		assert_cgp_no_msg(is_equal(total_mass, 4.0f));
+
+		// The rest shape inverse maps the rest edges to the identity (in the local frame of the triangle)
+		for (int k = 0; k < N_tri; ++k) {
+			uint3 const& tri = grid.connectivity[k];
+			vec3 const e1 = grid.position[tri[1]] - grid.position[tri[0]];
+			vec3 const e2 = grid.position[tri[2]] - grid.position[tri[0]];
+			float const d = std::abs(det(state.triangle_rest_inverse[k]));
+			assert_cgp_no_msg(is_equal(d, 1.0f / norm(cross(e1, e2))));
+		}
+		for (float angle : state.bending_angle)
+			assert_cgp_no_msg(std::abs(angle) < 1e-5f);
+
+		// Edges of a same color share no vertex
+		assert_cgp_no_msg(state.edge_order.size() == N_edge);
+		for (int c = 0; c < state.N_edge_color(); ++c) {
+			std::set<unsigned int> vertices;
+			for (int j = state.edge_color_offset[c]; j < state.edge_color_offset[c + 1]; ++j) {
+				uint2 const& e = state.edge[state.edge_order[j]];
+				assert_cgp_no_msg(vertices.insert(e[0]).second && vertices.insert(e[1]).second);
+			}
+		}
+
+		// Dihedral angle of a folded pair of triangles
+		{
+			numarray<vec3> const p = { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1} };
+			numarray<uint3> const t = { {0,1,2}, {0,3,1} };
+			rest_state const s = rest_state_build(p, t);
+			assert_cgp_no_msg(s.bending.size() == 1);
+			assert_cgp_no_msg(is_equal(std::abs(s.bending_angle[0]), 3.14159265f / 2.0f));
+		}
+
+		// Saving and loading with the key
+		uint64_t const key = rest_state_key(grid.position, grid.connectivity, parameters);
+		rest_state_parameters other = parameters;
+		other.bending = false;
+		assert_cgp_no_msg(rest_state_key(grid.position, grid.connectivity, other) != key);
+
+		std::string const filename = "test_rest_state.cgprest";
+		rest_state_save_file(filename, state, key);
+		rest_state loaded;
+		assert_cgp_no_msg(!rest_state_load_file(filename, key + 1, loaded));
+		assert_cgp_no_msg(rest_state_load_file(filename, key, loaded));
+		assert_cgp_no_msg(loaded.edge.size() == N_edge && loaded.bending.size() == state.bending.size() && loaded.N_edge_color() == state.N_edge_color());
+		for (int k = 0; k < N_edge; ++k)
+			assert_cgp_no_msg(is_equal(loaded.edge[k], state.edge[k]) && loaded.edge_length[k] == state.edge_length[k] && loaded.edge_order[k] == state.edge_order[k]);
+		for (int k = 0; k < N_tri; ++k)
+			assert_cgp_no_msg(is_equal(loaded.triangle_rest_inverse[k], state.triangle_rest_inverse[k]));
+		for (int k = 0; k < N_vertex; ++k)
+			assert_cgp_no_msg(loaded.mass[k] == state.mass[k]);
+		std::remove(filename.c_str());
+
+		// Cached build
+		rest_state const cached = rest_state_build_cached(grid.position, grid.connectivity, parameters, ".");
+		std::string const cached_filename = cache_filename(".", "rest_state_", key, ".cgprest");
+		assert_cgp_no_msg(check_file_exist(cached_filename));
+		rest_state const cached_again = rest_state_build_cached(grid.position, grid.connectivity, parameters, ".");
+		assert_cgp_no_msg(cached.edge.size() == N_edge && cached_again.edge.size() == N_edge);
+		std::remove(cached_filename.c_str());
+
+		// A cache that cannot be written doesn't prevent the build
+		rest_state const uncached = rest_state_build_cached(grid.position, grid.connectivity, parameters, "missing_directory");
+		assert_cgp_no_msg(uncached.edge.size() == N_edge);
+	}
+}
@@ -0,0 +1,241 @@
+#include "scaling.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/physics/simulation/simulation.hpp"
+#include "cgp/physics/batch/batch.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace cgp
+{
+	namespace
+	{
+		int const rope_particles = 100;
+
+		scaling_measure measure(simulation& sim, scaling_settings const& settings, int threads)
+		{
+			sim.threads = threads;
+
+			// Warm-up step, also used to choose the number of steps
+			simulation_step_statistics const first = simulation_step(sim);
+			int const steps = std::max(settings.min_steps, int(std::ceil(settings.min_time / std::max(first.time_total, 1e-9))));
+			batch_run const run = batch_measure(sim, steps);
+
+			scaling_measure m;
+			m.particles = run.particles;
+			m.constraints = run.constraints;
+			m.threads = threads;
+			m.steps = steps;
+			m.wall_time = run.wall_time;
+			m.throughput = run.wall_time > 0 ? double(run.particles) * steps / run.wall_time : 0.0;
+			m.memory_per_particle = run.particles > 0 ? double(run.simulation_memory) / run.particles : 0.0;
+			double const phases = run.time_integrate + run.time_solve + run.time_collide + run.time_velocity;
+			if (phases > 0) {
+				m.fraction_integrate = run.time_integrate / phases;
+				m.fraction_solve = run.time_solve / phases;
+				m.fraction_collide = run.time_collide / phases;
+				m.fraction_velocity = run.time_velocity / phases;
+			}
+			return m;
+		}
+
+		// Throughput per thread relative to the reference measure
+		void set_speedup(scaling_measure& m, scaling_measure const& reference)
+		{
+			double const reference_per_thread = reference.throughput / reference.threads;
+			m.efficiency = reference_per_thread > 0 ? (m.throughput / m.threads) / reference_per_thread : 0.0;
+			m.speedup = m.efficiency * m.threads;
+		}
+	}
+
+	std::string str(scaling_shape shape)
+	{
+		switch (shape)
+		{
+		case scaling_shape::cloth: return "cloth";
+		case scaling_shape::block: return "block";
+		case scaling_shape::ropes: return "ropes";
+		}
+		return "";
+	}
+
+	scene_description scaling_scene(scaling_shape shape, int particle_count)
+	{
+		assert_cgp(particle_count > 0, "Invalid number of particles for a scaling scene (" + str(particle_count) + ")");
+
+		scene_description scene;
+		scene.filename = "scaling_" + str(shape) + "_" + str(particle_count);
+		scene.solver.time_step = 0.016f;
+		scene.solver.substeps = 4;
+		scene.solver.iterations = 5;
+
+		scene_material material;
+		material.name = str(shape);
+		material.mass = 1.0f;
+		material.stiffness = 1000.0f;
+		material.damping = 0.05f;
+		scene.materials.push_back(material);
+
+		scene_collider ground;
+		ground.name = "ground";
+		ground.friction = 0.5f;
+		scene.colliders.push_back(ground);
+
+		if (shape == scaling_shape::cloth) {
+			scene_body cloth;
+			cloth.name = "cloth";
+			cloth.type = scene_body_type::grid;
+			cloth.position = { 0,0,0.8f };
+			cloth.size = 1.5f;
+			int const N = std::max(2, int(std::round(std::sqrt(double(particle_count)))));
+			cloth.resolution = { N, N };
+			cloth.material = 0;
+			scene.bodies.push_back(cloth);
+
+			scene_collider sphere;
+			sphere.name = "sphere";
+			sphere.type = scene_collider_type::sphere;
+			sphere.position = { 0,0,0.3f };
+			sphere.size = 0.3f;
+			scene.colliders.push_back(sphere);
+		}
+		else if (shape == scaling_shape::block) {
+			scene_body block;
+			block.name = "block";
+			block.type = scene_body_type::block;
+			block.position = { 0,0,0.6f };
+			block.size = 1.0f;
+			int const N = std::max(2, int(std::round(std::cbrt(double(particle_count)))));
+			block.resolution = { N, N };
+			block.material = 0;
+			scene.bodies.push_back(block);
+		}
+		else {
+			// Ropes laid out on a square grid of hooks, each rope going along x from its hook
+			int const N_rope = std::max(1, int(std::round(double(particle_count) / (rope_particles + 1))));
+			int const N_side = int(std::ceil(std::sqrt(double(N_rope))));
+			for (int k = 0; k < N_rope; ++k) {
+				vec3 const p = { 1.0f * (k % N_side) / N_side - 0.5f, 1.0f * (k / N_side) / N_side - 0.5f, 1.5f };
+
+				scene_body hook;
+				hook.name = "hook" + str(k);
+				hook.type = scene_body_type::point;
+				hook.position = p;
+				hook.fixed = true;
+				scene.bodies.push_back(hook);
+
+				scene_body rope;
+				rope.name = "rope" + str(k);
+				rope.type = scene_body_type::rope;
+				rope.position = p + vec3(0.01f, 0, 0);
+				rope.size = 1.0f;
+				rope.resolution = { rope_particles, 2 };
+				rope.material = 0;
+				rope.anchor = int(scene.bodies.size()) - 1;
+				scene.bodies.push_back(rope);
+			}
+		}
+
+		scene_load_assets(scene);
+		return scene;
+	}
+
+	std::vector<int> scaling_sizes(scaling_settings const& settings)
+	{
+		assert_cgp(settings.min_particles > 0 && settings.max_particles >= settings.min_particles && settings.size_factor > 1, "Invalid sizes of the scaling benchmark (min=" + str(settings.min_particles) + ", max=" + str(settings.max_particles) + ", factor=" + str(settings.size_factor) + ")");
+		std::vector<int> sizes;
+		for (double s = settings.min_particles; s <= settings.max_particles * (1 + 1e-6); s *= settings.size_factor)
+			sizes.push_back(int(std::round(s)));
+		return sizes;
+	}
+
+	std::vector<int> scaling_threads(scaling_settings const& settings)
+	{
+		if (!settings.threads.empty())
+			return settings.threads;
+
+#ifdef _OPENMP
+		int const cores = omp_get_num_procs();
+#else
+		int const cores = 1; // loops are sequential without OpenMP
+#endif
+		std::vector<int> threads;
+		for (int t = 1; t < cores; t *= 2)
+			threads.push_back(t);
+		threads.push_back(cores);
+		return threads;
+	}
+
+	std::vector<scaling_measure> scaling_run(scaling_settings const& settings, std::function<void(scaling_measure const&)> const& on_measure)
+	{
+		std::vector<int> const sizes = scaling_sizes(settings);
+		std::vector<int> const threads = scaling_threads(settings);
+
+		std::vector<scaling_measure> measures;
+		auto add = [&](scaling_measure const& m) {
+			measures.push_back(m);
+			if (on_measure)
+				on_measure(m);
+		};
+
+		for (scaling_shape const shape : settings.shapes)
+		{
+			// Strong scaling: a single scene per size, each thread count starting from its initial state
+			if (settings.strong) {
+				for (int const size : sizes) {
+					simulation const initial = simulation_build(scaling_scene(shape, size));
+					scaling_measure reference;
+					for (size_t k = 0; k < threads.size(); ++k) {
+						simulation sim = initial;
+						scaling_measure m = measure(sim, settings, threads[k]);
+						m.shape = shape;
+						if (k == 0)
+							reference = m;
+						set_speedup(m, reference);
+						add(m);
+					}
+				}
+			}
+
+			// Weak scaling: size x threads particles, as long as it stays below the maximal size
+			if (settings.weak) {
+				for (int const size : sizes) {
+					scaling_measure reference;
+					for (size_t k = 0; k < threads.size(); ++k) {
+						double const particles = double(size) * threads[k];
+						if (particles > settings.max_particles)
+							break;
+						simulation sim = simulation_build(scaling_scene(shape, int(particles)));
+						scaling_measure m = measure(sim, settings, threads[k]);
+						m.shape = shape;
+						m.weak = true;
+						if (k == 0)
+							reference = m;
+						set_speedup(m, reference);
+						add(m);
+					}
+				}
+			}
+		}
+		return measures;
+	}
+
+	std::string scaling_csv(std::vector<scaling_measure> const& measures)
+	{
+		std::ostringstream s;
+		s.precision(6);
+		s << "shape,scaling,particles,constraints,threads,steps,wall_time,throughput,speedup,efficiency,memory_per_particle,fraction_integrate,fraction_solve,fraction_collide,fraction_velocity\n";
+		for (scaling_measure const& m : measures) {
+			s << str(m.shape) << "," << (m.weak ? "weak" : "strong") << "," << m.particles << "," << m.constraints << "," << m.threads << "," << m.steps << ","
+				<< m.wall_time << "," << m.throughput << "," << m.speedup << "," << m.efficiency << "," << m.memory_per_particle << ","
+				<< m.fraction_integrate << "," << m.fraction_solve << "," << m.fraction_collide << "," << m.fraction_velocity << "\n";
+		}
+		return s.str();
+	}
+}
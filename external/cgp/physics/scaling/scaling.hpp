@@ -0,0 +1,71 @@
+#pragma once
+
+#include "cgp/physics/scene_file/scene_file.hpp"
+
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace cgp
+{
+	// Scaling benchmarks of the simulation: generated scenes of increasing size, run with an increasing number of threads
+	//
+	// Strong scaling: the size of the scene is fixed, and the number of threads increases (ideal: the time is divided by the number of threads).
+	// Weak scaling: the size of the scene is proportional to the number of threads (ideal: constant time per step).
+	// The sizes follow a geometric progression between min_particles and max_particles.
+	// Each configuration runs at least min_steps steps and at least min_time seconds, after one warm-up step.
+	// The measures of the different thread counts of a size continue the same simulation (the scene is built once per size).
+
+	enum class scaling_shape { cloth, block, ropes };
+
+	struct scaling_settings
+	{
+		std::vector<scaling_shape> shapes = { scaling_shape::cloth, scaling_shape::block, scaling_shape::ropes };
+		int min_particles = 1000;
+		int max_particles = 10000000;
+		float size_factor = 10.0f;    // ratio between two successive sizes
+		std::vector<int> threads;     // thread counts in increasing order (empty: 1, 2, 4, ... up to the number of cores)
+		bool strong = true;
+		bool weak = true;
+		double min_time = 1.0;        // seconds
+		int min_steps = 3;
+	};
+
+	struct scaling_measure
+	{
+		scaling_shape shape = scaling_shape::cloth;
+		bool weak = false;
+		int particles = 0;
+		int constraints = 0;
+		int threads = 1;
+		int steps = 0;
+		double wall_time = 0.0;           // seconds for all the steps
+		double throughput = 0.0;          // particles x steps per second
+		double speedup = 1.0;             // throughput relative to the smallest thread count (weak scaling: relative to the base size)
+		double efficiency = 1.0;          // speedup / threads
+		double memory_per_particle = 0.0; // octets of the simulation arrays per particle
+
+		// Fraction of the time of the steps spent in each phase
+		double fraction_integrate = 0.0;
+		double fraction_solve = 0.0;
+		double fraction_collide = 0.0;
+		double fraction_velocity = 0.0;
+	};
+
+	/** Scene of about particle_count particles, with its assets: cloth sheet falling on a sphere, block of tetrahedra falling on the ground,
+	* or ropes of 100 particles attached to fixed points */
+	scene_description scaling_scene(scaling_shape shape, int particle_count);
+
+	/** Sizes of the geometric progression of the settings */
+	std::vector<int> scaling_sizes(scaling_settings const& settings);
+	/** Thread counts of the settings (default: powers of 2 up to the number of cores, and the number of cores) */
+	std::vector<int> scaling_threads(scaling_settings const& settings);
+
+	/** Run all the configurations. The optional callback receives each measure as soon as it is done (ex. progress display). */
+	std::vector<scaling_measure> scaling_run(scaling_settings const& settings, std::function<void(scaling_measure const&)> const& on_measure = nullptr);
+
+	/** Table of the measures (one line per configuration, with a header line) */
+	std::string scaling_csv(std::vector<scaling_measure> const& measures);
+
+	std::string str(scaling_shape shape);
+}
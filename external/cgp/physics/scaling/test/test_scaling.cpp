@@ -0,0 +1,52 @@
+#include "test_scaling.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/physics/simulation/simulation.hpp"
+#include "../scaling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cgp_test
+{
+	void test_scaling()
+	{
+		using namespace cgp;
+
+		// Generated scenes have about the requested number of particles
+		for (scaling_shape const shape : { scaling_shape::cloth, scaling_shape::block, scaling_shape::ropes }) {
+			simulation const sim = simulation_build(scaling_scene(shape, 2000));
+			assert_cgp_no_msg(std::abs(sim.position.size() - 2000) < 200 && sim.edge.size() > 0);
+		}
+
+		scaling_settings settings;
+		settings.min_particles = 500;
+		settings.max_particles = 1000;
+		settings.size_factor = 2.0f;
+		assert_cgp_no_msg(scaling_sizes(settings) == std::vector<int>({ 500, 1000 }));
+		std::vector<int> const default_threads = scaling_threads(settings);
+		assert_cgp_no_msg(default_threads.size() >= 1 && default_threads[0] == 1);
+
+		// Strong scaling: 2 sizes x 2 thread counts. Weak scaling: 500x1, 500x2, 1000x1 (1000x2 is above the maximal size).
+		settings.shapes = { scaling_shape::ropes };
+		settings.threads = { 1, 2 };
+		settings.min_time = 0.0;
+		settings.min_steps = 2;
+		int callback_count = 0;
+		std::vector<scaling_measure> const measures = scaling_run(settings, [&](scaling_measure const&) { callback_count++; });
+		assert_cgp_no_msg(measures.size() == 7 && callback_count == 7);
+		assert_cgp_no_msg(!measures[0].weak && measures[0].threads == 1 && measures[0].speedup == 1.0 && measures[0].efficiency == 1.0);
+		assert_cgp_no_msg(measures[1].threads == 2 && measures[1].particles == measures[0].particles && measures[1].steps >= 2);
+		assert_cgp_no_msg(measures[4].weak && measures[5].weak && measures[5].threads == 2 && std::abs(measures[5].particles - 2 * measures[4].particles) < 110);
+		assert_cgp_no_msg(measures[6].weak && measures[6].threads == 1);
+		for (scaling_measure const& m : measures) {
+			assert_cgp_no_msg(m.throughput > 0 && m.memory_per_particle > 0);
+			assert_cgp_no_msg(std::abs(m.fraction_integrate + m.fraction_solve + m.fraction_collide + m.fraction_velocity - 1.0) < 1e-6);
+		}
+
+		std::string const csv = scaling_csv(measures);
+		assert_cgp_no_msg(csv.compare(0, 23, "shape,scaling,particles") == 0);
+		assert_cgp_no_msg(std::count(csv.begin(), csv.end(), '\n') == 8);
+		assert_cgp_no_msg(csv.find("\nropes,weak,") != std::string::npos);
+	}
+}
@@ -0,0 +1,432 @@
+#include "scene_file.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "cgp/core/files/parse/parse.hpp"
+#include "cgp/core/profiling/memory_accounting/memory_accounting.hpp"
+#include "cgp/geometry/shape/mesh/primitive/mesh_primitive.hpp"
+#include "cgp/geometry/shape/mesh/loader/obj/obj.hpp"
+#include "cgp/geometry/shape/tet_mesh/loader/tetgen/tetgen.hpp"
+#include "cgp/geometry/shape/tet_mesh/loader/binary/tet_binary.hpp"
+#include "cgp/geometry/shape/tet_mesh/primitive/tet_mesh_primitive.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+namespace cgp
+{
+	namespace
+	{
+		// Word of the text [begin,end) (points in the parsed buffer, no allocation)
+		struct scene_word
+		{
+			char const* begin = nullptr;
+			char const* end = nullptr;
+
+			bool operator==(char const* s) const
+			{
+				size_t const N = std::strlen(s);
+				return size_t(end - begin) == N && std::memcmp(begin, s, N) == 0;
+			}
+			std::string str() const { return std::string(begin, end); }
+		};
+
+		// Reads the words and values of one line
+		struct scene_line_parser
+		{
+			char const* p;
+			char const* end;
+			std::string const& filename;
+			int line;
+
+			[[noreturn]] void error(std::string const& message) const
+			{
+				error_cgp("Scene file " + filename + ", line " + cgp::str(line) + ": " + message);
+			}
+
+			bool at_end()
+			{
+				p = parse_skip_spaces(p, end);
+				return p == end || *p == '#';
+			}
+			scene_word word(char const* what)
+			{
+				if (at_end())
+					error(std::string("missing ") + what);
+				scene_word w;
+				w.begin = p;
+				p = parse_skip_word(p, end);
+				w.end = p;
+				return w;
+			}
+			float read_float(scene_word const& key)
+			{
+				float value = 0.0f;
+				p = parse_skip_spaces(p, end);
+				if (!parse_float(p, end, value))
+					error("expecting a number after " + key.str());
+				return value;
+			}
+			double read_double(scene_word const& key)
+			{
+				double value = 0.0;
+				p = parse_skip_spaces(p, end);
+				if (!parse_double(p, end, value))
+					error("expecting a number after " + key.str());
+				return value;
+			}
+			int read_int(scene_word const& key)
+			{
+				int value = 0;
+				p = parse_skip_spaces(p, end);
+				if (!parse_int(p, end, value))
+					error("expecting an integer after " + key.str());
+				return value;
+			}
+			vec3 read_vec3(scene_word const& key)
+			{
+				float const x = read_float(key);
+				float const y = read_float(key);
+				float const z = read_float(key);
+				return { x, y, z };
+			}
+		};
+
+		std::string directory_of(std::string const& filename)
+		{
+			size_t const k = filename.find_last_of("/\\");
+			return k == std::string::npos ? "" : filename.substr(0, k + 1);
+		}
+
+		std::string path_relative_to(std::string const& directory, std::string const& file)
+		{
+			bool const is_absolute = !file.empty() && (file[0] == '/' || file[0] == '\\' || (file.size() > 1 && file[1] == ':'));
+			return is_absolute ? file : directory + file;
+		}
+
+		// Names of materials and anchors are resolved once all the lines are read (declarations can appear in any order)
+		struct scene_reference
+		{
+			int body;
+			bool is_anchor;
+			std::string name;
+			int line;
+		};
+
+		void parse_solver(scene_line_parser& in, scene_solver& solver)
+		{
+			while (!in.at_end()) {
+				scene_word const key = in.word("key");
+				solver.ode_settings = solver.ode_settings || key == "method" || key == "initial_step" || key == "epsabs" || key == "epsrel";
+				if (key == "method") solver.method = in.word("integration method").str();
+				else if (key == "time_step") solver.time_step = in.read_float(key);
+				else if (key == "initial_step") solver.initial_step = in.read_double(key);
+				else if (key == "epsabs") solver.epsabs = in.read_double(key);
+				else if (key == "epsrel") solver.epsrel = in.read_double(key);
+				else if (key == "iterations") solver.iterations = in.read_int(key);
+				else if (key == "substeps") solver.substeps = in.read_int(key);
+				else if (key == "gravity") solver.gravity = in.read_vec3(key);
+				else in.error("unknown solver key " + key.str());
+			}
+			if (solver.time_step <= 0 || solver.iterations < 1 || solver.substeps < 1)
+				in.error("time_step, iterations and substeps must be strictly positive");
+		}
+
+		void parse_material(scene_line_parser& in, scene_material& material)
+		{
+			while (!in.at_end()) {
+				scene_word const key = in.word("key");
+				if (key == "density") material.density = in.read_float(key);
+				else if (key == "mass") material.mass = in.read_float(key);
+				else if (key == "stiffness") material.stiffness = in.read_float(key);
+				else if (key == "damping") material.damping = in.read_float(key);
+				else if (key == "bending") material.bending = in.read_float(key);
+				else in.error("unknown material key " + key.str());
+			}
+		}
+
+		void parse_body(scene_line_parser& in, scene_body& body, int body_index, std::string const& directory, std::vector<scene_reference>& references)
+		{
+			scene_word const type = in.word("body type");
+			if (type == "point") body.type = scene_body_type::point;
+			else if (type == "cube") body.type = scene_body_type::cube;
+			else if (type == "sphere") body.type = scene_body_type::sphere;
+			else if (type == "grid") body.type = scene_body_type::grid;
+			else if (type == "rope") body.type = scene_body_type::rope;
+			else if (type == "obj") body.type = scene_body_type::obj;
+			else if (type == "tetgen") body.type = scene_body_type::tetgen;
+			else if (type == "cgptet") body.type = scene_body_type::cgptet;
+			else if (type == "block") body.type = scene_body_type::block;
+			else in.error("unknown body type " + type.str());
+
+			if (body.type == scene_body_type::obj || body.type == scene_body_type::tetgen || body.type == scene_body_type::cgptet)
+				body.filename = path_relative_to(directory, in.word("file name").str());
+
+			while (!in.at_end()) {
+				scene_word const key = in.word("key");
+				if (key == "position") body.position = in.read_vec3(key);
+				else if (key == "size") body.size = in.read_float(key);
+				else if (key == "resolution") {
+					int const Nu = in.read_int(key);
+					int const Nv = in.read_int(key);
+					body.resolution = { Nu, Nv };
+				}
+				else if (key == "color") body.color = in.read_vec3(key);
+				else if (key == "material") references.push_back({ body_index, false, in.word("material name").str(), in.line });
+				else if (key == "anchor") references.push_back({ body_index, true, in.word("body name").str(), in.line });
+				else if (key == "velocity") body.velocity = in.read_vec3(key);
+				else if (key == "force") body.force = in.read_vec3(key);
+				else if (key == "fixed") body.fixed = true;
+				else if (key == "hidden") body.hidden = true;
+				else in.error("unknown body key " + key.str());
+			}
+			bool const uses_resolution_y = body.type != scene_body_type::rope && body.type != scene_body_type::block; // ropes and blocks only use the first value
+			if (body.resolution.x < 2 || (uses_resolution_y && body.resolution.y < 2))
+				in.error("the resolution must be at least 2");
+		}
+
+		void parse_collider(scene_line_parser& in, scene_collider& collider, std::string const& directory)
+		{
+			scene_word const type = in.word("collider type");
+			if (type == "plane") collider.type = scene_collider_type::plane;
+			else if (type == "sphere") collider.type = scene_collider_type::sphere;
+			else if (type == "box") collider.type = scene_collider_type::box;
+			else in.error("unknown collider type " + type.str());
+
+			while (!in.at_end()) {
+				scene_word const key = in.word("key");
+				if (key == "position") collider.position = in.read_vec3(key);
+				else if (key == "normal") collider.normal = in.read_vec3(key);
+				else if (key == "size") collider.size = in.read_float(key);
+				else if (key == "friction") collider.friction = in.read_float(key);
+				else if (key == "color") collider.color = in.read_vec3(key);
+				else if (key == "texture") collider.texture = path_relative_to(directory, in.word("texture file").str());
+				else if (key == "hidden") collider.hidden = true;
+				else in.error("unknown collider key " + key.str());
+			}
+			if (norm(collider.normal) < 1e-6f)
+				in.error("the normal of the collider must be non-zero");
+			collider.normal = normalize(collider.normal);
+		}
+
+		// Quadrangle of half size s centered at p and orthogonal to n
+		mesh plane_mesh(vec3 const& p, vec3 const& n, float s)
+		{
+			vec3 const a = std::abs(n.x) < 0.9f ? vec3{ 1,0,0 } : vec3{ 0,1,0 };
+			vec3 const u = normalize(cross(a, n)) * s;
+			vec3 const v = cross(n, u);
+			return mesh_primitive_quadrangle(p - u - v, p + u - v, p + u + v, p - u + v);
+		}
+
+		void load_body(scene_body& body)
+		{
+			vec3 const& p = body.position;
+			float const s = body.size;
+			int const Nu = body.resolution.x, Nv = body.resolution.y;
+			switch (body.type)
+			{
+			case scene_body_type::point:
+				body.shape = mesh_primitive_point(p);
+				break;
+			case scene_body_type::cube:
+				body.shape = mesh_primitive_cube(p, s);
+				break;
+			case scene_body_type::sphere:
+				body.shape = mesh_primitive_sphere(s, p, Nu, Nv);
+				break;
+			case scene_body_type::grid:
+				body.shape = mesh_primitive_grid(p + vec3(-s, -s, 0) / 2.0f, p + vec3(s, -s, 0) / 2.0f, p + vec3(s, s, 0) / 2.0f, p + vec3(-s, s, 0) / 2.0f, Nu, Nv);
+				break;
+			case scene_body_type::rope:
+				// Vertices along the x direction (no triangles)
+				body.shape = mesh();
+				for (int k = 0; k < Nu; ++k)
+					body.shape.position.push_back(p + vec3(s * k / (Nu - 1.0f), 0, 0));
+				body.shape.normal.resize(Nu);
+				body.shape.normal.fill({ 0,0,1 });
+				body.shape.uv.resize(Nu);
+				break;
+			case scene_body_type::block:
+				// Cube filled with tetrahedra, with resolution.x vertices along each edge
+				body.volume = tet_mesh_primitive_cube(p, s, Nu);
+				body.shape = tet_mesh_surface(body.volume);
+				break;
+			case scene_body_type::obj:
+				body.shape = mesh_load_file_obj(body.filename);
+				body.shape.position += p;
+				break;
+			case scene_body_type::tetgen:
+			case scene_body_type::cgptet:
+				body.volume = body.type == scene_body_type::tetgen ? tet_mesh_load_file_tetgen(body.filename) : tet_mesh_load_file_tet_binary(body.filename);
+				body.volume.position += p;
+				body.shape = tet_mesh_surface(body.volume);
+				break;
+			}
+			body.shape.color.resize(body.shape.position.size());
+			body.shape.color.fill(body.color);
+		}
+
+		void load_collider(scene_collider& collider)
+		{
+			switch (collider.type)
+			{
+			case scene_collider_type::plane:
+				collider.shape = plane_mesh(collider.position, collider.normal, collider.size);
+				break;
+			case scene_collider_type::sphere:
+				collider.shape = mesh_primitive_sphere(collider.size, collider.position);
+				break;
+			case scene_collider_type::box:
+				collider.shape = mesh_primitive_cube(collider.position, 2 * collider.size);
+				break;
+			}
+			collider.shape.color.resize(collider.shape.position.size());
+			collider.shape.color.fill(collider.color);
+			if (!collider.texture.empty())
+				collider.texture_image = image_load_file(collider.texture);
+		}
+
+		template <typename T>
+		int find_by_name(std::vector<T> const& elements, std::string const& name)
+		{
+			for (size_t k = 0; k < elements.size(); ++k)
+				if (elements[k].name == name)
+					return int(k);
+			return -1;
+		}
+	}
+
+	int scene_description::find_material(std::string const& name) const { return find_by_name(materials, name); }
+	int scene_description::find_body(std::string const& name) const { return find_by_name(bodies, name); }
+	int scene_description::find_collider(std::string const& name) const { return find_by_name(colliders, name); }
+
+	scene_description scene_parse(char const* begin, char const* end, std::string const& filename)
+	{
+		scene_description scene;
+		scene.filename = filename;
+		std::string const directory = directory_of(filename);
+		std::vector<scene_reference> references;
+
+		// Index of the elements per name (duplicate detection and resolution of the references)
+		std::unordered_map<std::string, int> material_index, body_index, collider_index;
+		auto declare = [](std::unordered_map<std::string, int>& index, std::string const& name, int k, scene_line_parser const& in, char const* what) {
+			if (!index.emplace(name, k).second)
+				in.error(std::string(what) + " " + name + " is already declared");
+		};
+
+		int line = 0;
+		for (char const* p = begin; p < end; ) {
+			char const* const line_end = parse_line_end(p, end);
+			++line;
+			scene_line_parser in{ p, line_end, filename, line };
+			p = line_end + 1;
+			if (in.at_end())
+				continue;
+
+			scene_word const keyword = in.word("keyword");
+			if (keyword == "solver") {
+				parse_solver(in, scene.solver);
+				continue;
+			}
+
+			std::string const name = in.word("name").str();
+			if (keyword == "material") {
+				declare(material_index, name, int(scene.materials.size()), in, "material");
+				scene.materials.push_back(scene_material());
+				scene.materials.back().name = name;
+				parse_material(in, scene.materials.back());
+			}
+			else if (keyword == "body") {
+				declare(body_index, name, int(scene.bodies.size()), in, "body");
+				scene.bodies.push_back(scene_body());
+				scene.bodies.back().name = name;
+				parse_body(in, scene.bodies.back(), int(scene.bodies.size()) - 1, directory, references);
+			}
+			else if (keyword == "collider") {
+				declare(collider_index, name, int(scene.colliders.size()), in, "collider");
+				scene.colliders.push_back(scene_collider());
+				scene.colliders.back().name = name;
+				parse_collider(in, scene.colliders.back(), directory);
+			}
+			else
+				in.error("unknown keyword " + keyword.str());
+		}
+
+		for (scene_reference const& r : references) {
+			std::unordered_map<std::string, int> const& index = r.is_anchor ? body_index : material_index;
+			auto const it = index.find(r.name);
+			assert_cgp(it != index.end(), "Scene file " + filename + ", line " + str(r.line) + ": unknown " + (r.is_anchor ? "body " : "material ") + r.name);
+			assert_cgp(!r.is_anchor || it->second != r.body, "Scene file " + filename + ", line " + str(r.line) + ": a body cannot be anchored to itself");
+			(r.is_anchor ? scene.bodies[r.body].anchor : scene.bodies[r.body].material) = it->second;
+		}
+		return scene;
+	}
+
+	scene_description scene_load_file(std::string const& filename, bool load_assets)
+	{
+		file_mapping file(filename);
+		scene_description scene = scene_parse(file.begin(), file.end(), filename);
+		if (load_assets)
+			scene_load_assets(scene);
+		return scene;
+	}
+
+	void scene_load_assets(scene_description& scene)
+	{
+		// One task per body and per collider, the largest files first
+		int const N_body = int(scene.bodies.size());
+		int const N_task = N_body + int(scene.colliders.size());
+		std::vector<std::pair<size_t, int> > tasks(N_task);
+		for (int k = 0; k < N_task; ++k) {
+			std::string const& file = k < N_body ? scene.bodies[k].filename : scene.colliders[k - N_body].texture;
+			tasks[k] = { check_file_exist(file) ? file_get_size(file) : 0, k };
+		}
+		std::sort(tasks.begin(), tasks.end(), [](std::pair<size_t, int> const& a, std::pair<size_t, int> const& b) { return a.first > b.first; });
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < N_task; ++k) {
+			int const task = tasks[k].second;
+			if (task < N_body)
+				load_body(scene.bodies[task]);
+			else
+				load_collider(scene.colliders[task - N_body]);
+		}
+	}
+
+	void scene_account_memory(scene_description const& scene)
+	{
+		for (scene_body const& body : scene.bodies)
+			memory_account_set_cpu("body", body.name, int64_t(body.shape.memory_size() + body.volume.memory_size()));
+		for (scene_collider const& collider : scene.colliders)
+			memory_account_set_cpu("collider", collider.name, int64_t(collider.shape.memory_size() + collider.texture_image.data.size()));
+	}
+
+	std::string str(scene_body_type type)
+	{
+		switch (type)
+		{
+		case scene_body_type::point: return "point";
+		case scene_body_type::cube: return "cube";
+		case scene_body_type::sphere: return "sphere";
+		case scene_body_type::grid: return "grid";
+		case scene_body_type::rope: return "rope";
+		case scene_body_type::obj: return "obj";
+		case scene_body_type::tetgen: return "tetgen";
+		case scene_body_type::cgptet: return "cgptet";
+		case scene_body_type::block: return "block";
+		}
+		return "";
+	}
+
+	std::string str(scene_collider_type type)
+	{
+		switch (type)
+		{
+		case scene_collider_type::plane: return "plane";
+		case scene_collider_type::sphere: return "sphere";
+		case scene_collider_type::box: return "box";
+		}
+		return "";
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "cgp/geometry/vec/vec.hpp"
+#include "cgp/geometry/shape/mesh/structure/mesh.hpp"
+#include "cgp/geometry/shape/tet_mesh/structure/tet_mesh.hpp"
+#include "cgp/core/containers/image/image.hpp"
+
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// Declarative description of a simulated scene (bodies, materials, solver settings and colliders) stored in a text file
+	//
+	// Each non-empty line declares one element, followed by a list of "key values" pairs. Comments start with '#'.
+	//   solver  [key values ...]
+	//   material name  [key values ...]
+	//   body name type [file]  [key values ...]      type: point, cube, sphere, grid, rope, block, obj, tetgen, cgptet (the three last ones are followed by a file)
+	//   collider name type  [key values ...]         type: plane, sphere, box
+	// Example:
+	//   solver method rk1imp time_step 1 epsabs 1e-6
+	//   material spring mass 20 stiffness 2 damping 0.2
+	//   body anchor point position 0 0 2 fixed
+	//   body ball point position 0 0 0.25 material spring anchor anchor force 0 0 -5
+	//   body cloth grid position 0 0 1 size 2 resolution 40 40 material cloth
+	//   collider ground plane position 0 0 -0.5 size 3 texture checkerboard.png
+	// Files (assets and textures) are relative to the directory of the scene file. See the structures below for the list of keys.
+	// The parser works in place on the mapped file (without allocation except for the final structures), and the assets are loaded in parallel.
+
+	/** Settings of the time integration */
+	struct scene_solver
+	{
+		std::string method = "rk1imp"; // key: method
+		float time_step = 1.0f;         // key: time_step
+		double initial_step = 1e-6;     // key: initial_step (adaptive integrators)
+		double epsabs = 1e-6;           // key: epsabs
+		double epsrel = 0.0;            // key: epsrel
+		int iterations = 10;            // key: iterations (iterative solvers)
+		int substeps = 1;               // key: substeps
+		vec3 gravity = { 0,0,-9.81f };  // key: gravity
+		bool ode_settings = false;      // one of method, initial_step, epsabs or epsrel is given (settings of the GSL integrator of the application, not used by the XPBD engine)
+	};
+
+	struct scene_material
+	{
+		std::string name;
+		float density = 1000.0f; // key: density
+		float mass = 1.0f;       // key: mass
+		float stiffness = 0.0f;  // key: stiffness
+		float damping = 0.0f;    // key: damping
+		float bending = 0.0f;    // key: bending
+	};
+
+	enum class scene_body_type { point, cube, sphere, grid, rope, obj, tetgen, cgptet, block };
+
+	struct scene_body
+	{
+		std::string name;
+		scene_body_type type = scene_body_type::point;
+		std::string filename;          // asset file (obj, tetgen, cgptet), with the path of the scene file
+
+		vec3 position = { 0,0,0 };     // key: position (center, or translation of the asset)
+		float size = 1.0f;             // key: size (edge length, radius, or length of the rope)
+		int2 resolution = { 10,10 };   // key: resolution (grid and sphere samples, rope and block use the first value)
+		vec3 color = { 1,1,1 };        // key: color
+		int material = -1;             // key: material (name of a material, -1 if none)
+		int anchor = -1;               // key: anchor (name of a body the body is attached to, -1 if none)
+		vec3 velocity = { 0,0,0 };     // key: velocity
+		vec3 force = { 0,0,0 };        // key: force (constant external force)
+		bool fixed = false;            // flag: fixed
+		bool hidden = false;           // flag: hidden
+
+		// Assets (filled by scene_load_assets)
+		mesh shape;                    // surface mesh (tet meshes: boundary surface)
+		tet_mesh volume;               // only for block, tetgen and cgptet bodies
+	};
+
+	enum class scene_collider_type { plane, sphere, box };
+
+	struct scene_collider
+	{
+		std::string name;
+		scene_collider_type type = scene_collider_type::plane;
+
+		vec3 position = { 0,0,0 };     // key: position
+		vec3 normal = { 0,0,1 };       // key: normal (plane)
+		float size = 1.0f;             // key: size (half extent of the plane and box, radius of the sphere)
+		float friction = 0.0f;         // key: friction
+		vec3 color = { 1,1,1 };        // key: color
+		std::string texture;           // key: texture (image file, with the path of the scene file)
+		bool hidden = false;           // flag: hidden
+
+		// Assets (filled by scene_load_assets)
+		mesh shape;
+		image_structure texture_image;
+	};
+
+	struct scene_description
+	{
+		std::string filename;
+		scene_solver solver;
+		std::vector<scene_material> materials;
+		std::vector<scene_body> bodies;
+		std::vector<scene_collider> colliders;
+
+		/** Index of the element with the given name, or -1 */
+		int find_material(std::string const& name) const;
+		int find_body(std::string const& name) const;
+		int find_collider(std::string const& name) const;
+	};
+
+	/** Load a scene file, and its assets if load_assets is true (errors are reported with the line number) */
+	scene_description scene_load_file(std::string const& filename, bool load_assets = true);
+	/** Parse the text of a scene in [begin,end). Relative files are expressed with respect to the directory of filename. */
+	scene_description scene_parse(char const* begin, char const* end, std::string const& filename);
+	/** Build the meshes of the bodies and colliders, and load their files (in parallel) */
+	void scene_load_assets(scene_description& scene);
+	/** Declare the CPU memory of the assets of each body and collider in the memory accounts ("body" and "collider", see memory_accounting) */
+	void scene_account_memory(scene_description const& scene);
+
+	std::string str(scene_body_type type);
+	std::string str(scene_collider_type type);
+}
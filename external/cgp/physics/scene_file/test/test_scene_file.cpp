@@ -0,0 +1,94 @@
+#include "test_scene_file.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/geometry/shape/tet_mesh/loader/binary/tet_binary.hpp"
+#include "cgp/core/profiling/memory_accounting/memory_accounting.hpp"
+#include "../scene_file.hpp"
+
+#include <fstream>
+#include <cstdio>
+
+namespace cgp_test
+{
+	void test_scene_file()
+	{
+		using namespace cgp;
+
+		// Assets referenced by the scene
+		{
+			std::ofstream obj("test_scene_file_triangle.obj");
+			obj << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+		}
+		tet_mesh tet;
+		tet.position = { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1} };
+		tet.connectivity = { uint4{0,1,2,3} };
+		save_file_tet_binary("test_scene_file_tet.cgptet", tet);
+
+		std::string const text =
+			"# Test scene\n"
+			"solver method rk4 time_step 0.01 iterations 20 gravity 0 0 -10 epsabs 1e-10 epsrel 0.1 initial_step 1e-7\n"
+			"\n"
+			"body p2 point position 0 0 0.25 material spring anchor p1 force 0 0 -5   # comment\r\n"
+			"body p1 point position 0 0 2 fixed hidden\n"
+			"material spring mass 20 stiffness 2 damping 0.2\n"
+			"  body cloth grid position 0 0 1 size 2 resolution 5 4 color 1 0 0\n"
+			"body rope rope size 1 resolution 11 1\n"
+			"body triangle obj test_scene_file_triangle.obj position 1 2 3\n"
+			"body tet cgptet test_scene_file_tet.cgptet\n"
+			"body block block size 0.5 resolution 3 0\n"
+			"collider ground plane position 0 0 -0.5 normal 0 0 2 size 3 friction 0.5\n"
+			"collider ball sphere size 0.5";
+		scene_description scene = scene_parse(text.data(), text.data() + text.size(), "test_scene_file.scene");
+
+		assert_cgp_no_msg(scene.solver.method == "rk4" && scene.solver.time_step == 0.01f && scene.solver.iterations == 20 && scene.solver.gravity.z == -10.0f);
+		assert_cgp_no_msg(scene.solver.substeps == 1);
+		assert_cgp_no_msg(scene.solver.epsabs == 1e-10 && scene.solver.epsrel == 0.1 && scene.solver.initial_step == 1e-7); // parsed in double precision
+		assert_cgp_no_msg(scene.solver.ode_settings);
+		std::string const engine_solver = "solver time_step 0.01 iterations 4 substeps 2\n";
+		assert_cgp_no_msg(!scene_parse(engine_solver.data(), engine_solver.data() + engine_solver.size(), "engine.scene").solver.ode_settings);
+		assert_cgp_no_msg(scene.materials.size() == 1 && scene.materials[0].mass == 20.0f && scene.materials[0].damping == 0.2f);
+		assert_cgp_no_msg(scene.bodies.size() == 7 && scene.colliders.size() == 2);
+
+		scene_body const& p2 = scene.bodies[scene.find_body("p2")];
+		assert_cgp_no_msg(p2.material == 0 && p2.anchor == scene.find_body("p1") && p2.force.z == -5.0f && !p2.fixed);
+		assert_cgp_no_msg(scene.bodies[scene.find_body("p1")].fixed && scene.bodies[scene.find_body("p1")].hidden);
+		assert_cgp_no_msg(scene.find_body("cloth") == 2 && scene.bodies[2].resolution.x == 5 && scene.bodies[2].resolution.y == 4);
+		assert_cgp_no_msg(scene.bodies[4].filename == "test_scene_file_triangle.obj" && scene.bodies[4].type == scene_body_type::obj);
+		assert_cgp_no_msg(scene.colliders[0].friction == 0.5f && scene.colliders[0].normal.z == 1.0f);
+		assert_cgp_no_msg(scene.colliders[1].type == scene_collider_type::sphere && scene.find_collider("ball") == 1);
+		assert_cgp_no_msg(scene.find_body("unknown") == -1);
+
+		// Paths are relative to the scene file
+		scene_description const in_directory = scene_parse(text.data(), text.data() + text.size(), "data/scenes/a.scene");
+		assert_cgp_no_msg(in_directory.bodies[4].filename == "data/scenes/test_scene_file_triangle.obj");
+
+		scene_load_assets(scene);
+		assert_cgp_no_msg(scene.bodies[0].shape.position.size() == 1);
+		assert_cgp_no_msg(scene.bodies[2].shape.position.size() == 20 && scene.bodies[2].shape.color[0].x == 1.0f && scene.bodies[2].shape.color[0].y == 0.0f);
+		assert_cgp_no_msg(scene.bodies[3].shape.position.size() == 11 && scene.bodies[3].shape.position[10].x == 1.0f);
+		assert_cgp_no_msg(scene.bodies[4].shape.connectivity.size() == 1 && scene.bodies[4].shape.position[0].z == 3.0f);
+		assert_cgp_no_msg(scene.bodies[5].volume.connectivity.size() == 1 && scene.bodies[5].shape.connectivity.size() == 4);
+		assert_cgp_no_msg(scene.bodies[6].type == scene_body_type::block && scene.bodies[6].volume.position.size() == 27 && scene.bodies[6].shape.position.size() == 26);
+		assert_cgp_no_msg(scene.colliders[0].shape.connectivity.size() == 2 && scene.colliders[0].shape.position[0].z == -0.5f);
+
+		// CPU memory of the assets in the accounts of the bodies and colliders
+		memory_accounts_clear();
+		scene_account_memory(scene);
+		scene_body const& block = scene.bodies[6];
+		int64_t total = 0;
+		for (scene_body const& body : scene.bodies)
+			total += int64_t(body.shape.memory_size() + body.volume.memory_size());
+		for (scene_collider const& collider : scene.colliders)
+			total += int64_t(collider.shape.memory_size() + collider.texture_image.data.size());
+		std::vector<memory_account> const accounts = memory_accounts();
+		assert_cgp_no_msg(accounts.size() == 9 && memory_account_total().cpu_bytes == total);
+		assert_cgp_no_msg(block.volume.memory_size() == 27 * sizeof(vec3) + block.volume.connectivity.size() * sizeof(uint4) + block.volume.face.size() * sizeof(uint3));
+		for (memory_account const& a : accounts)
+			if (a.category == "body" && a.name == block.name)
+				assert_cgp_no_msg(a.cpu_bytes == int64_t(block.shape.memory_size() + block.volume.memory_size()) && a.gpu_bytes == 0);
+		memory_accounts_clear();
+
+		std::remove("test_scene_file_triangle.obj");
+		std::remove("test_scene_file_tet.cgptet");
+	}
+}
@@ -0,0 +1,393 @@
+#include "shared_state.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/binary_file/binary_file.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <climits>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CGP_SHARED_STATE_POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cgp
+{
+	static_assert(sizeof(vec3) == 3 * sizeof(float), "Frames are stored as packed vec3");
+
+	namespace
+	{
+		char const shared_state_magic[8] = { 'C','G','P','S','H','M','\0','\0' };
+		uint32_t const shared_state_version = 1;
+		size_t const shared_state_alignment = 64;
+		int const shared_state_max_retry = 1000;
+
+		struct shared_state_header
+		{
+			char magic[8]; // written last, once the segment is initialized
+			uint32_t version;
+			uint32_t endian_check;
+			uint32_t body_count;
+			uint32_t slot_count;
+			uint64_t slot_size;   // size of a slot including its slot_header
+			uint64_t slot_offset; // position of the first slot in the segment
+			std::atomic<int64_t> latest; // last complete frame (-1 if none)
+			std::atomic<uint32_t> closed;
+		};
+
+		struct body_descriptor
+		{
+			char name[48];
+			uint64_t element_count;
+			uint64_t offset; // position of the values in the slot data
+		};
+
+		struct alignas(64) slot_header
+		{
+			std::atomic<uint64_t> sequence; // odd while the slot is written, 2*(frame+1) when the frame is complete
+			double time;
+		};
+
+		size_t align(size_t size)
+		{
+			return (size + shared_state_alignment - 1) / shared_state_alignment * shared_state_alignment;
+		}
+
+		// POSIX names of shared memory objects start with a single '/'
+		std::string shared_state_object_name(std::string const& name)
+		{
+			assert_cgp(!name.empty() && name.find('/', 1) == std::string::npos, "Invalid name of shared memory segment [" + name + "]");
+			return name[0] == '/' ? name : "/" + name;
+		}
+
+		shared_state_header* header_of(unsigned char* segment) { return reinterpret_cast<shared_state_header*>(segment); }
+		shared_state_header const* header_of(unsigned char const* segment) { return reinterpret_cast<shared_state_header const*>(segment); }
+		body_descriptor const* bodies_of(unsigned char const* segment) { return reinterpret_cast<body_descriptor const*>(segment + align(sizeof(shared_state_header))); }
+		slot_header* slot_of(unsigned char* segment, int slot)
+		{
+			shared_state_header const* h = header_of(segment);
+			return reinterpret_cast<slot_header*>(segment + h->slot_offset + slot * h->slot_size);
+		}
+		slot_header const* slot_of(unsigned char const* segment, int slot)
+		{
+			shared_state_header const* h = header_of(segment);
+			return reinterpret_cast<slot_header const*>(segment + h->slot_offset + slot * h->slot_size);
+		}
+
+		// Check that the slots and the values of every body described in the segment lie within its size
+		//  Return an empty string if the layout is valid, otherwise the description of the first problem
+		std::string check_layout(unsigned char const* segment, size_t size)
+		{
+			shared_state_header const* h = header_of(segment);
+			size_t const descriptor_offset = align(sizeof(shared_state_header));
+			if (size < descriptor_offset || h->body_count > (size - descriptor_offset) / sizeof(body_descriptor))
+				return "the descriptors of " + str(h->body_count) + " bodies exceed the segment";
+			if (h->slot_offset < descriptor_offset + h->body_count * sizeof(body_descriptor) || h->slot_offset > size || h->slot_offset % alignof(slot_header) != 0)
+				return "incorrect position of the slots " + str(h->slot_offset);
+			if (h->slot_size < sizeof(slot_header) || h->slot_size % alignof(slot_header) != 0)
+				return "incorrect slot size " + str(h->slot_size);
+			if (h->slot_count == 0 || h->slot_count > (size - h->slot_offset) / h->slot_size)
+				return str(h->slot_count) + " slots of " + str(h->slot_size) + " bytes exceed the segment";
+
+			body_descriptor const* bodies = bodies_of(segment);
+			for (uint32_t k = 0; k < h->body_count; ++k) {
+				body_descriptor const& body = bodies[k];
+				if (body.offset < sizeof(slot_header) || body.offset > h->slot_size || body.offset % alignof(vec3) != 0)
+					return "incorrect position " + str(body.offset) + " of the values of body " + str(k);
+				if (body.element_count > uint64_t(INT_MAX) || body.element_count > (h->slot_size - body.offset) / sizeof(vec3))
+					return "the " + str(body.element_count) + " values of body " + str(k) + " exceed the slot";
+			}
+			return "";
+		}
+	}
+
+
+	shared_state_publisher::shared_state_publisher(std::string const& name_arg, std::vector<shared_state_body> const& bodies, int slot_count)
+	{
+		open(name_arg, bodies, slot_count);
+	}
+
+	shared_state_publisher::~shared_state_publisher()
+	{
+		close();
+	}
+
+	void shared_state_publisher::open(std::string const& name_arg, std::vector<shared_state_body> const& bodies, int slot_count)
+	{
+		close();
+		assert_cgp(slot_count >= 2, "The ring of shared frames needs at least 2 slots (slot_count=" + str(slot_count) + ")");
+		assert_cgp(std::atomic<int64_t>().is_lock_free() && std::atomic<uint64_t>().is_lock_free(), "Shared memory publishing requires lock-free 64 bits atomics");
+
+		// Layout of the segment
+		size_t data_size = 0;
+		for (shared_state_body const& body : bodies) {
+			assert_cgp(body.name.size() < sizeof(body_descriptor::name), "Body name [" + body.name + "] is too long to be shared");
+			assert_cgp(body.element_count >= 0, "Incorrect number of elements of body [" + body.name + "]");
+			data_size += align(body.element_count * sizeof(vec3));
+		}
+		size_t const slot_offset = align(align(sizeof(shared_state_header)) + bodies.size() * sizeof(body_descriptor));
+		size_t const slot_size = sizeof(slot_header) + data_size;
+
+#ifdef CGP_SHARED_STATE_POSIX
+		name = shared_state_object_name(name_arg);
+		segment_size = slot_offset + slot_count * slot_size;
+
+		shm_unlink(name.c_str()); // segment left by a previous run
+		int const fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		assert_cgp(fd >= 0, "Cannot create shared memory segment " + name);
+		int const rc = ftruncate(fd, off_t(segment_size));
+		assert_cgp(rc == 0, "Cannot allocate " + str(segment_size) + " bytes of shared memory for segment " + name);
+		void* const p = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		assert_cgp(p != MAP_FAILED, "Cannot map shared memory segment " + name);
+		segment = static_cast<unsigned char*>(p);
+#else
+		(void)slot_size;
+		error_cgp("Shared memory publishing is only available on POSIX systems (segment " + name_arg + ")");
+#endif
+
+		shared_state_header* h = new (segment) shared_state_header;
+		h->version = shared_state_version;
+		h->endian_check = binary_file_endian_check;
+		h->body_count = uint32_t(bodies.size());
+		h->slot_count = uint32_t(slot_count);
+		h->slot_size = slot_size;
+		h->slot_offset = slot_offset;
+		h->latest.store(-1, std::memory_order_relaxed);
+		h->closed.store(0, std::memory_order_relaxed);
+
+		body_descriptor* descriptor = reinterpret_cast<body_descriptor*>(segment + align(sizeof(shared_state_header)));
+		size_t offset = sizeof(slot_header);
+		for (size_t k = 0; k < bodies.size(); ++k) {
+			std::memset(descriptor[k].name, 0, sizeof(descriptor[k].name));
+			std::memcpy(descriptor[k].name, bodies[k].name.data(), bodies[k].name.size());
+			descriptor[k].element_count = bodies[k].element_count;
+			descriptor[k].offset = offset;
+			offset += align(bodies[k].element_count * sizeof(vec3));
+		}
+		for (int k = 0; k < slot_count; ++k)
+			new (slot_of(segment, k)) slot_header{ {0}, 0.0 };
+
+		// The readers consider the segment valid once the magic number is visible
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(h->magic, shared_state_magic, sizeof(shared_state_magic));
+
+		frame = 0;
+		writing = false;
+	}
+
+	void shared_state_publisher::close()
+	{
+		if (!is_open())
+			return;
+#ifdef CGP_SHARED_STATE_POSIX
+		header_of(segment)->closed.store(1, std::memory_order_release);
+		munmap(segment, segment_size);
+		shm_unlink(name.c_str()); // readers that mapped the segment keep access to it
+#endif
+		segment = nullptr;
+		segment_size = 0;
+	}
+
+	void shared_state_publisher::begin_frame(double time)
+	{
+		assert_cgp(is_open(), "The shared state publisher must be opened before publishing frames");
+		assert_cgp(!writing, "begin_frame() called twice without end_frame()");
+		shared_state_header const* h = header_of(segment);
+		slot_header* slot = slot_of(segment, int(frame % h->slot_count));
+
+		slot->sequence.store(2 * uint64_t(frame) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot->time = time;
+		writing = true;
+	}
+
+	void shared_state_publisher::write(int body, numarray<vec3> const& values)
+	{
+		assert_cgp(writing, "write() must be called between begin_frame() and end_frame()");
+		shared_state_header const* h = header_of(segment);
+		assert_cgp(body >= 0 && body < int(h->body_count), "Incorrect body index " + str(body) + " (number of bodies: " + str(h->body_count) + ")");
+		body_descriptor const& descriptor = bodies_of(segment)[body];
+		assert_cgp(values.size() == descriptor.element_count, "Body [" + std::string(descriptor.name) + "] has " + str(descriptor.element_count) + " elements (size(values)=" + str(values.size()) + ")");
+
+		unsigned char* slot = reinterpret_cast<unsigned char*>(slot_of(segment, int(frame % h->slot_count)));
+		if (values.size() > 0)
+			std::memcpy(slot + descriptor.offset, values.data.data(), values.size() * sizeof(vec3));
+	}
+
+	void shared_state_publisher::end_frame()
+	{
+		assert_cgp(writing, "end_frame() called without begin_frame()");
+		shared_state_header* h = header_of(segment);
+		slot_header* slot = slot_of(segment, int(frame % h->slot_count));
+
+		slot->sequence.store(2 * uint64_t(frame) + 2, std::memory_order_release);
+		h->latest.store(frame, std::memory_order_release);
+		frame++;
+		writing = false;
+	}
+
+	void shared_state_publisher::publish(double time, numarray<vec3> const& values)
+	{
+		begin_frame(time);
+		write(0, values);
+		end_frame();
+	}
+
+
+	shared_state_reader::~shared_state_reader()
+	{
+		close();
+	}
+
+	bool shared_state_reader::open(std::string const& name_arg)
+	{
+		close();
+#ifdef CGP_SHARED_STATE_POSIX
+		std::string const name = shared_state_object_name(name_arg);
+		int const fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+			return false;
+
+		struct stat stat_buf;
+		int const rc = fstat(fd, &stat_buf);
+		size_t const size = rc == 0 ? size_t(stat_buf.st_size) : 0;
+		void* const p = size >= sizeof(shared_state_header) ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+		::close(fd);
+		if (p == MAP_FAILED)
+			return false; // segment not yet allocated by the publisher
+
+		unsigned char* const data = static_cast<unsigned char*>(p);
+		shared_state_header const* h = header_of(data);
+		if (std::memcmp(h->magic, shared_state_magic, sizeof(shared_state_magic)) != 0) {
+			munmap(p, size); // segment not yet initialized by the publisher
+			return false;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		assert_cgp(h->version == shared_state_version, "Shared memory segment " + name + " has version " + str(h->version) + " while the supported version is " + str(shared_state_version));
+		assert_cgp(h->endian_check == binary_file_endian_check, "Shared memory segment " + name + " has an unexpected endianness");
+		std::string const layout_error = check_layout(data, size);
+		assert_cgp(layout_error.empty(), "Shared memory segment " + name + " is corrupted: " + layout_error);
+
+		segment = data;
+		segment_size = size;
+		return true;
+#else
+		error_cgp("Shared memory publishing is only available on POSIX systems (segment " + name_arg + ")");
+		return false;
+#endif
+	}
+
+	void shared_state_reader::close()
+	{
+		if (!is_open())
+			return;
+#ifdef CGP_SHARED_STATE_POSIX
+		munmap(segment, segment_size);
+#endif
+		segment = nullptr;
+		segment_size = 0;
+	}
+
+	bool shared_state_reader::publisher_closed() const
+	{
+		assert_cgp_no_msg(is_open());
+		return header_of(static_cast<unsigned char const*>(segment))->closed.load(std::memory_order_acquire) != 0;
+	}
+
+	int shared_state_reader::body_count() const
+	{
+		assert_cgp_no_msg(is_open());
+		return int(header_of(static_cast<unsigned char const*>(segment))->body_count);
+	}
+
+	std::string shared_state_reader::body_name(int body) const
+	{
+		assert_cgp(body >= 0 && body < body_count(), "Incorrect body index " + str(body));
+		body_descriptor const& descriptor = bodies_of(segment)[body];
+		return std::string(descriptor.name, strnlen(descriptor.name, sizeof(descriptor.name)));
+	}
+
+	int shared_state_reader::body_element_count(int body) const
+	{
+		assert_cgp(body >= 0 && body < body_count(), "Incorrect body index " + str(body));
+		return int(bodies_of(segment)[body].element_count);
+	}
+
+	int shared_state_reader::find_body(std::string const& name) const
+	{
+		for (int k = 0; k < body_count(); ++k)
+			if (body_name(k) == name)
+				return k;
+		return -1;
+	}
+
+	int64_t shared_state_reader::latest_frame() const
+	{
+		assert_cgp_no_msg(is_open());
+		return header_of(static_cast<unsigned char const*>(segment))->latest.load(std::memory_order_acquire);
+	}
+
+	bool shared_state_reader::acquire(shared_state_frame& f) const
+	{
+		assert_cgp_no_msg(is_open());
+		unsigned char const* const data = segment;
+		shared_state_header const* h = header_of(data);
+		for (int attempt = 0; attempt < shared_state_max_retry; ++attempt) {
+			int64_t const latest = h->latest.load(std::memory_order_acquire);
+			if (latest < 0)
+				return false;
+
+			int const slot = int(latest % h->slot_count);
+			slot_header const* s = slot_of(data, slot);
+			uint64_t const sequence = s->sequence.load(std::memory_order_acquire);
+			if (sequence != 2 * uint64_t(latest) + 2)
+				continue; // the slot is already reused for a newer frame
+
+			f.frame = latest;
+			f.time = s->time;
+			f.slot = slot;
+			f.sequence = sequence;
+			f.data = reinterpret_cast<unsigned char const*>(s);
+			if (is_valid(f))
+				return true;
+		}
+		return false;
+	}
+
+	vec3 const* shared_state_reader::values(shared_state_frame const& f, int body) const
+	{
+		assert_cgp(f.data != nullptr, "Frame has not been acquired");
+		assert_cgp(body >= 0 && body < body_count(), "Incorrect body index " + str(body));
+		return reinterpret_cast<vec3 const*>(f.data + bodies_of(segment)[body].offset);
+	}
+
+	bool shared_state_reader::is_valid(shared_state_frame const& f) const
+	{
+		if (f.data == nullptr)
+			return false;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return slot_of(static_cast<unsigned char const*>(segment), f.slot)->sequence.load(std::memory_order_relaxed) == f.sequence;
+	}
+
+	int64_t shared_state_reader::copy_latest(int body, numarray<vec3>& values_out) const
+	{
+		int const N = body_element_count(body);
+		values_out.resize(N);
+		for (int attempt = 0; attempt < shared_state_max_retry; ++attempt) {
+			shared_state_frame f;
+			if (!acquire(f))
+				return -1;
+			if (N > 0)
+				std::memcpy(values_out.data.data(), values(f, body), N * sizeof(vec3));
+			if (is_valid(f))
+				return f.frame;
+		}
+		return -1;
+	}
+}
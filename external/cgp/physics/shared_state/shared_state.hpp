@@ -0,0 +1,113 @@
+#pragma once
+
+#include "cgp/geometry/vec/vec.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace cgp
+{
+	// Publication of the state of a simulation in shared memory, such that other local processes (viewers, analysis tools) can read it without copy nor socket
+	//
+	// The shared memory segment (POSIX shm_open) contains a header, one descriptor per body (name, number of vec3), and a ring of slots.
+	// Each slot stores a complete frame (all the bodies one after the other) and is protected by a sequence number (seqlock):
+	//   the sequence is odd while the publisher writes the slot, and is equal to 2*(frame+1) once the frame is complete.
+	// The publisher never waits for the readers. A reader checks that the sequence of the slot did not change after accessing the data,
+	//   and simply retries with the newest frame if the slot has been overwritten in the meantime.
+	// Only available on POSIX systems (Linux, macOS).
+
+	/** Description of a body published in shared memory */
+	struct shared_state_body
+	{
+		std::string name;      // at most 47 characters
+		int element_count = 0; // number of vec3 published per frame
+	};
+
+	/** Write the frames of a simulation in a shared memory segment */
+	struct shared_state_publisher
+	{
+		shared_state_publisher() = default;
+		shared_state_publisher(std::string const& name, std::vector<shared_state_body> const& bodies, int slot_count = 4);
+		~shared_state_publisher();
+
+		shared_state_publisher(shared_state_publisher const&) = delete;
+		shared_state_publisher& operator=(shared_state_publisher const&) = delete;
+
+		/** Create the shared memory segment (a previous segment with the same name is replaced)
+		* The readers access the frames as long as they are at most slot_count-1 frames late. */
+		void open(std::string const& name, std::vector<shared_state_body> const& bodies, int slot_count = 4);
+		/** Mark the segment as closed for the readers and remove its name */
+		void close();
+		bool is_open() const { return segment != nullptr; }
+
+		/** Write a frame: begin_frame(), then write() of each body, then end_frame() to make the frame visible */
+		void begin_frame(double time);
+		void write(int body, numarray<vec3> const& values);
+		void end_frame();
+
+		/** Publish a frame of a single body */
+		void publish(double time, numarray<vec3> const& values);
+
+		int64_t frame_count() const { return frame; }
+
+	private:
+		std::string name;
+		unsigned char* segment = nullptr;
+		size_t segment_size = 0;
+		int64_t frame = 0;
+		bool writing = false;
+	};
+
+	/** Consistent access to a frame published in shared memory (pointers are valid as long as is_valid() returns true) */
+	struct shared_state_frame
+	{
+		int64_t frame = -1;
+		double time = 0.0;
+		int slot = -1;
+		uint64_t sequence = 0;
+		unsigned char const* data = nullptr;
+	};
+
+	/** Read the frames published by a shared_state_publisher (in the same or in another process) */
+	struct shared_state_reader
+	{
+		shared_state_reader() = default;
+		~shared_state_reader();
+
+		shared_state_reader(shared_state_reader const&) = delete;
+		shared_state_reader& operator=(shared_state_reader const&) = delete;
+
+		/** Map the segment with the given name. Returns false if no publisher has created it (yet). */
+		bool open(std::string const& name);
+		void close();
+		bool is_open() const { return segment != nullptr; }
+		/** True when the publisher has closed the segment (the last frames remain readable) */
+		bool publisher_closed() const;
+
+		int body_count() const;
+		std::string body_name(int body) const;
+		int body_element_count(int body) const;
+		/** Index of the body with the given name, or -1 */
+		int find_body(std::string const& name) const;
+
+		/** Last complete frame (-1 if no frame has been published) */
+		int64_t latest_frame() const;
+
+		/** Zero-copy access to the last complete frame. Returns false if no frame is available.
+		* The values returned by values() must only be trusted if is_valid(f) is true after they have been read. */
+		bool acquire(shared_state_frame& f) const;
+		vec3 const* values(shared_state_frame const& f, int body) const;
+		bool is_valid(shared_state_frame const& f) const;
+
+		/** Copy the values of a body in the last complete frame (retries if the frame is overwritten during the copy)
+		* Returns the index of the copied frame, or -1 if no frame is available. */
+		int64_t copy_latest(int body, numarray<vec3>& values) const;
+
+	private:
+		unsigned char* segment = nullptr;
+		size_t segment_size = 0;
+	};
+}
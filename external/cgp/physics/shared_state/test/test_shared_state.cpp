@@ -0,0 +1,79 @@
+#include "test_shared_state.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "../shared_state.hpp"
+
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace cgp_test
+{
+	void test_shared_state()
+	{
+		using namespace cgp;
+		std::string const name = "cgp_test_shared_state_" + str(int(getpid()));
+
+		shared_state_reader reader;
+		assert_cgp_no_msg(reader.open(name) == false);
+
+		shared_state_publisher publisher(name, { {"cloth", 100}, {"ball", 1} }, 3);
+		assert_cgp_no_msg(reader.open(name));
+		assert_cgp_no_msg(reader.body_count() == 2 && reader.body_name(0) == "cloth" && reader.body_element_count(1) == 1);
+		assert_cgp_no_msg(reader.find_body("ball") == 1 && reader.find_body("rope") == -1);
+		assert_cgp_no_msg(reader.latest_frame() == -1);
+
+		numarray<vec3> cloth(100), ball(1), values;
+		for (int f = 0; f < 5; ++f) {
+			cloth.fill(vec3(float(f), 1.0f, 2.0f));
+			ball[0] = vec3(0.0f, 0.0f, float(-f));
+			publisher.begin_frame(0.1 * f);
+			publisher.write(0, cloth);
+			publisher.write(1, ball);
+			publisher.end_frame();
+		}
+
+		// Zero-copy access to the last frame
+		shared_state_frame f;
+		assert_cgp_no_msg(reader.acquire(f));
+		assert_cgp_no_msg(f.frame == 4 && f.time == 0.4);
+		assert_cgp_no_msg(reader.values(f, 0)[99].x == 4.0f && reader.values(f, 1)[0].z == -4.0f);
+		assert_cgp_no_msg(reader.is_valid(f));
+
+		// The slot of the frame is invalidated once the publisher reuses it
+		auto publish = [&](int frame) {
+			cloth.fill(vec3(float(frame), float(frame), float(frame)));
+			ball[0] = vec3(float(frame), 0.0f, 0.0f);
+			publisher.begin_frame(0.1 * frame);
+			publisher.write(0, cloth);
+			publisher.write(1, ball);
+			publisher.end_frame();
+		};
+		for (int frame = 5; frame < 8; ++frame)
+			publish(frame);
+		assert_cgp_no_msg(!reader.is_valid(f));
+		assert_cgp_no_msg(reader.copy_latest(0, values) == 7 && values.size() == 100 && values[0].x == 7.0f);
+
+		// Concurrent publication: the copied frames are never torn
+		std::thread writer([&]() {
+			for (int frame = 8; frame < 20000; ++frame)
+				publish(frame);
+		});
+		int64_t last = 7;
+		while (last < 19999) {
+			int64_t const frame = reader.copy_latest(0, values);
+			assert_cgp_no_msg(frame >= last);
+			for (vec3 const& v : values)
+				assert_cgp_no_msg(v.x == float(frame) && v.z == float(frame));
+			last = frame;
+		}
+		writer.join();
+
+		// The last frames remain readable after the publisher is closed
+		publisher.close();
+		assert_cgp_no_msg(reader.publisher_closed());
+		assert_cgp_no_msg(reader.copy_latest(1, values) == 19999 && values[0].x == 19999.0f);
+		reader.close();
+		assert_cgp_no_msg(reader.open(name) == false);
+	}
+}
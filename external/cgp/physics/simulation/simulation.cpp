@@ -0,0 +1,440 @@
+#include "simulation.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/physics/rest_state/rest_state.hpp"
+
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace cgp
+{
+	namespace
+	{
+		// Below this number of elements, a loop is run sequentially (the start of the threads costs more than the loop)
+		int const parallel_threshold = 4096;
+
+		double elapsed(std::chrono::steady_clock::time_point const& t0)
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		}
+
+		int thread_count(simulation const& sim)
+		{
+#ifdef _OPENMP
+			return sim.threads > 0 ? sim.threads : omp_get_max_threads();
+#else
+			(void)sim;
+			return 1;
+#endif
+		}
+
+		// Merge the vertices of a mesh at the same position (ex. duplicated vertices of the faces of a cube, seams of the texture coordinates)
+		numarray<int> weld_vertices(numarray<vec3> const& position, numarray<vec3>& particle)
+		{
+			struct key_hash {
+				size_t operator()(vec3 const& p) const {
+					size_t h = 0;
+					for (float x : p) {
+						uint32_t bits;
+						std::memcpy(&bits, &x, sizeof(bits));
+						h = h * 1000003u ^ bits;
+					}
+					return h;
+				}
+			};
+			struct key_equal {
+				bool operator()(vec3 const& a, vec3 const& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+			};
+
+			std::unordered_map<vec3, int, key_hash, key_equal> index;
+			index.reserve(position.size());
+			numarray<int> vertex_to_particle(position.size());
+			particle.clear();
+			for (int k = 0; k < position.size(); ++k) {
+				auto it = index.find(position[k]);
+				if (it == index.end()) {
+					it = index.insert({ position[k], int(particle.size()) }).first;
+					particle.push_back(position[k]);
+				}
+				vertex_to_particle[k] = it->second;
+			}
+			return vertex_to_particle;
+		}
+
+		// Unique edges (i<j) of a list of elements, given the local pairs of vertices of an element
+		template <typename ELEMENT, size_t N_PAIR>
+		void add_element_edges(numarray<ELEMENT> const& element, int const (&pairs)[N_PAIR][2], numarray<int> const& to_particle, std::vector<uint2>& edge)
+		{
+			size_t const first = edge.size();
+			for (ELEMENT const& e : element) {
+				for (auto const& p : pairs) {
+					unsigned int a = to_particle[e[p[0]]];
+					unsigned int b = to_particle[e[p[1]]];
+					if (a == b)
+						continue;
+					if (a > b)
+						std::swap(a, b);
+					edge.push_back({ a, b });
+				}
+			}
+			auto lexicographic = [](uint2 const& a, uint2 const& b) { return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]); };
+			std::sort(edge.begin() + first, edge.end(), lexicographic);
+			auto same = [](uint2 const& a, uint2 const& b) { return a[0] == b[0] && a[1] == b[1]; };
+			edge.erase(std::unique(edge.begin() + first, edge.end(), same), edge.end());
+		}
+
+		struct residual_measure
+		{
+			float rms = 0.0f;
+			float max = 0.0f;
+		};
+
+		// Violation of the distance constraints relative to their rest length
+		residual_measure constraint_residual(simulation const& sim)
+		{
+			int const N_edge = sim.edge.size();
+			if (N_edge == 0)
+				return residual_measure();
+
+			double sum = 0.0;
+			float max = 0.0f;
+			#pragma omp parallel for reduction(+:sum) reduction(max:max) if(N_edge > parallel_threshold) num_threads(thread_count(sim))
+			for (int k = 0; k < N_edge; ++k) {
+				uint2 const& e = sim.edge[k];
+				float const L0 = sim.edge_length[k];
+				float const r = std::abs(norm(sim.position[e[1]] - sim.position[e[0]]) - L0) / L0;
+				sum += double(r) * r;
+				max = std::max(max, r);
+			}
+
+			residual_measure m;
+			m.rms = float(std::sqrt(sum / N_edge));
+			m.max = max;
+			return m;
+		}
+
+		// Project a particle outside of a collider. Returns the penetration depth before the projection.
+		float collide(simulation_collider const& c, vec3& p, vec3 const& previous)
+		{
+			vec3 normal;
+			float depth = 0.0f;
+			if (c.type == scene_collider_type::plane) {
+				normal = c.normal;
+				depth = -dot(p - c.position, normal);
+			}
+			else if (c.type == scene_collider_type::sphere) {
+				vec3 const r = p - c.position;
+				float const L = norm(r);
+				normal = L > 1e-12f ? r / L : vec3(0, 0, 1);
+				depth = c.size - L;
+			}
+			else if (c.type == scene_collider_type::box) {
+				// Exit through the closest face
+				vec3 const r = p - c.position;
+				depth = std::numeric_limits<float>::max();
+				for (int k = 0; k < 3; ++k) {
+					float const d = c.size - std::abs(r[k]);
+					if (d < depth) {
+						depth = d;
+						normal = { 0,0,0 };
+						normal[k] = r[k] < 0 ? -1.0f : 1.0f;
+					}
+				}
+			}
+			if (depth <= 0)
+				return 0.0f;
+
+			p += depth * normal;
+
+			// Friction: remove a part of the tangential displacement of the substep
+			vec3 const d = p - previous;
+			vec3 const tangent = d - dot(d, normal) * normal;
+			p -= std::min(std::max(c.friction, 0.0f), 1.0f) * tangent;
+
+			return depth;
+		}
+	}
+
+	int simulation::find_body(std::string const& name) const
+	{
+		for (int k = 0; k < int(bodies.size()); ++k)
+			if (bodies[k].name == name)
+				return k;
+		return -1;
+	}
+
+	size_t simulation::memory_size() const
+	{
+		size_t s = 0;
+		s += (position.size() + velocity.size() + previous.size() + acceleration.size()) * sizeof(vec3);
+		s += (inverse_mass.size() + damping.size()) * sizeof(float);
+		s += edge.size() * sizeof(uint2);
+		s += (edge_length.size() + edge_compliance.size() + edge_lambda.size()) * sizeof(float);
+		s += (edge_order.size() + edge_color_offset.size()) * sizeof(int);
+		for (simulation_body const& b : bodies)
+			s += b.shape_to_particle.size() * sizeof(int);
+		return s;
+	}
+
+	simulation simulation_build(scene_description const& scene)
+	{
+		simulation sim;
+		sim.solver = scene.solver;
+		assert_cgp(sim.solver.substeps > 0 && sim.solver.iterations >= 0, "Invalid solver settings for the simulation (substeps=" + str(sim.solver.substeps) + ", iterations=" + str(sim.solver.iterations) + ")");
+
+		std::vector<vec3> position, velocity, acceleration;
+		std::vector<float> inverse_mass, damping;
+		std::vector<uint2> edge;
+		std::vector<float> edge_compliance;
+
+		int const triangle_pairs[3][2] = { {0,1},{1,2},{2,0} };
+		int const tetrahedron_pairs[6][2] = { {0,1},{0,2},{0,3},{1,2},{1,3},{2,3} };
+
+		for (scene_body const& body : scene.bodies)
+		{
+			simulation_body b;
+			b.name = body.name;
+			b.offset = int(position.size());
+
+			bool const is_volume = body.type == scene_body_type::block || body.type == scene_body_type::tetgen || body.type == scene_body_type::cgptet;
+			numarray<vec3> const& vertices = is_volume ? body.volume.position : body.shape.position;
+			assert_cgp(vertices.size() > 0, "The body " + body.name + " has no vertex (the assets of the scene must be loaded before building the simulation)");
+
+			numarray<vec3> particle;
+			numarray<int> vertex_to_particle = weld_vertices(vertices, particle);
+			b.size = particle.size();
+
+			// Edges and mass of each particle (proportional to the area or the volume of the adjacent elements)
+			size_t const first_edge = edge.size();
+			std::vector<double> weight(b.size, 0.0);
+			if (is_volume) {
+				add_element_edges(body.volume.connectivity, tetrahedron_pairs, vertex_to_particle, edge);
+				for (uint4 const& t : body.volume.connectivity) {
+					vec3 const& p0 = vertices[t[0]];
+					double const v = std::abs(dot(vertices[t[1]] - p0, cross(vertices[t[2]] - p0, vertices[t[3]] - p0))) / 6.0;
+					for (unsigned int i : t)
+						weight[vertex_to_particle[i]] += v / 4.0;
+				}
+			}
+			else if (body.type == scene_body_type::rope) {
+				for (int k = 0; k + 1 < b.size; ++k)
+					edge.push_back({ unsigned(k), unsigned(k + 1) });
+			}
+			else {
+				add_element_edges(body.shape.connectivity, triangle_pairs, vertex_to_particle, edge);
+				for (uint3 const& t : body.shape.connectivity) {
+					vec3 const& p0 = vertices[t[0]];
+					double const a = 0.5 * norm(cross(vertices[t[1]] - p0, vertices[t[2]] - p0));
+					for (unsigned int i : t)
+						weight[vertex_to_particle[i]] += a / 3.0;
+				}
+			}
+			double weight_sum = 0.0;
+			for (double w : weight)
+				weight_sum += w;
+			if (weight_sum <= 0.0) { // points, ropes, or degenerated elements
+				std::fill(weight.begin(), weight.end(), 1.0);
+				weight_sum = b.size;
+			}
+
+			scene_material const* material = body.material >= 0 ? &scene.materials[body.material] : nullptr;
+			float const mass = material != nullptr ? material->mass : 1.0f;
+			float const compliance = (material != nullptr && material->stiffness > 0) ? 1.0f / material->stiffness : 0.0f;
+			assert_cgp(mass > 0, "The mass of the body " + body.name + " must be positive (mass=" + str(mass) + ")");
+
+			// A vertex in no element of a mesh has no mass, and no constraint moves it: it is kept fixed
+			for (int k = 0; k < b.size; ++k) {
+				position.push_back(particle[k]);
+				velocity.push_back(body.velocity);
+				acceleration.push_back(scene.solver.gravity + body.force / mass);
+				inverse_mass.push_back(body.fixed || weight[k] <= 0.0 ? 0.0f : float(weight_sum / (mass * weight[k])));
+				damping.push_back(material != nullptr ? material->damping : 0.0f);
+			}
+
+			for (size_t k = first_edge; k < edge.size(); ++k) {
+				edge[k] = { edge[k][0] + b.offset, edge[k][1] + b.offset };
+				edge_compliance.push_back(compliance);
+			}
+			for (int& i : vertex_to_particle)
+				i += b.offset;
+			b.shape_to_particle = is_volume ? numarray<int>() : vertex_to_particle;
+
+			sim.bodies.push_back(b);
+		}
+
+		// Springs between the bodies and their anchors
+		for (int k = 0; k < int(scene.bodies.size()); ++k) {
+			scene_body const& body = scene.bodies[k];
+			if (body.anchor < 0)
+				continue;
+			unsigned int const a = sim.bodies[k].offset;
+			unsigned int const b = sim.bodies[body.anchor].offset;
+			scene_material const* material = body.material >= 0 ? &scene.materials[body.material] : nullptr;
+			edge.push_back({ a, b });
+			edge_compliance.push_back((material != nullptr && material->stiffness > 0) ? 1.0f / material->stiffness : 0.0f);
+		}
+
+		int const N = int(position.size());
+		sim.position = position;
+		sim.velocity = velocity;
+		sim.previous = position;
+		sim.acceleration = acceleration;
+		sim.inverse_mass = inverse_mass;
+		sim.damping = damping;
+
+		// Rest lengths (constraints of zero length cannot be projected and are removed)
+		numarray<uint2> kept_edge;
+		for (size_t k = 0; k < edge.size(); ++k) {
+			float const L = norm(position[edge[k][1]] - position[edge[k][0]]);
+			if (L < 1e-8f)
+				continue;
+			kept_edge.push_back(edge[k]);
+			sim.edge_length.push_back(L);
+			sim.edge_compliance.push_back(edge_compliance[k]);
+		}
+		sim.edge = kept_edge;
+		sim.edge_lambda.resize(sim.edge.size());
+		sim.edge_lambda.fill(0.0f);
+		rest_state_color_edges(sim.edge, N, sim.edge_order, sim.edge_color_offset);
+
+		for (scene_collider const& c : scene.colliders) {
+			simulation_collider s;
+			s.type = c.type;
+			s.position = c.position;
+			s.normal = normalize(c.normal);
+			s.size = c.size;
+			s.friction = c.friction;
+			sim.colliders.push_back(s);
+		}
+
+		return sim;
+	}
+
+	simulation_step_statistics simulation_step(simulation& sim)
+	{
+		using clock = std::chrono::steady_clock;
+		clock::time_point const t_start = clock::now();
+
+		simulation_step_statistics stats;
+		int const N = sim.position.size();
+		int const N_color = sim.edge_color_offset.size() > 0 ? int(sim.edge_color_offset.size()) - 1 : 0;
+		int const substeps = sim.solver.substeps;
+		float const h = sim.solver.time_step / substeps;
+		int const threads = thread_count(sim);
+
+		for (int s = 0; s < substeps; ++s)
+		{
+			// Prediction of the positions
+			clock::time_point t0 = clock::now();
+			#pragma omp parallel for if(N > parallel_threshold) num_threads(threads)
+			for (int k = 0; k < N; ++k) {
+				sim.previous[k] = sim.position[k];
+				if (sim.inverse_mass[k] == 0)
+					continue;
+				sim.velocity[k] += h * sim.acceleration[k];
+				sim.velocity[k] *= std::max(0.0f, 1.0f - sim.damping[k] * h);
+				sim.position[k] += h * sim.velocity[k];
+			}
+			stats.time_integrate += elapsed(t0);
+
+			// The residual that the iterations reduce is the one of the predicted positions
+			if (s == 0)
+				stats.initial_residual = constraint_residual(sim).rms;
+
+			// Projection of the distance constraints, color by color
+			t0 = clock::now();
+			sim.edge_lambda.fill(0.0f);
+			float const h2 = h * h;
+			for (int it = 0; it < sim.solver.iterations; ++it) {
+				for (int c = 0; c < N_color; ++c) {
+					int const start = sim.edge_color_offset[c];
+					int const end = sim.edge_color_offset[c + 1];
+					#pragma omp parallel for if(end - start > parallel_threshold) num_threads(threads)
+					for (int j = start; j < end; ++j) {
+						int const k = sim.edge_order[j];
+						unsigned int const a = sim.edge[k][0];
+						unsigned int const b = sim.edge[k][1];
+						float const wa = sim.inverse_mass[a];
+						float const wb = sim.inverse_mass[b];
+						float const alpha = sim.edge_compliance[k] / h2;
+						if (wa + wb + alpha == 0)
+							continue;
+
+						vec3 const d = sim.position[b] - sim.position[a];
+						float const L = norm(d);
+						if (L < 1e-12f)
+							continue;
+						float const C = L - sim.edge_length[k];
+						float const dlambda = (-C - alpha * sim.edge_lambda[k]) / (wa + wb + alpha);
+						sim.edge_lambda[k] += dlambda;
+
+						vec3 const n = d / L;
+						sim.position[a] -= wa * dlambda * n;
+						sim.position[b] += wb * dlambda * n;
+					}
+				}
+				stats.iterations++;
+			}
+			stats.time_solve += elapsed(t0);
+
+			// Colliders
+			t0 = clock::now();
+			int const N_collider = int(sim.colliders.size());
+			if (N_collider > 0) {
+				float max_penetration = stats.max_penetration;
+				#pragma omp parallel for reduction(max:max_penetration) if(N > parallel_threshold) num_threads(threads)
+				for (int k = 0; k < N; ++k) {
+					if (sim.inverse_mass[k] == 0)
+						continue;
+					for (int c = 0; c < N_collider; ++c)
+						max_penetration = std::max(max_penetration, collide(sim.colliders[c], sim.position[k], sim.previous[k]));
+				}
+				stats.max_penetration = max_penetration;
+			}
+			stats.time_collide += elapsed(t0);
+
+			// Velocities from the displacement of the substep
+			t0 = clock::now();
+			#pragma omp parallel for if(N > parallel_threshold) num_threads(threads)
+			for (int k = 0; k < N; ++k)
+				if (sim.inverse_mass[k] != 0)
+					sim.velocity[k] = (sim.position[k] - sim.previous[k]) / h;
+			stats.time_velocity += elapsed(t0);
+		}
+
+		residual_measure const final_residual = constraint_residual(sim);
+		stats.final_residual = final_residual.rms;
+		stats.max_violation = final_residual.max;
+
+		sim.time += sim.solver.time_step;
+		sim.step_count++;
+		stats.time_total = elapsed(t_start);
+		return stats;
+	}
+
+	double simulation_energy(simulation const& sim)
+	{
+		double energy = 0.0;
+		for (int k = 0; k < sim.position.size(); ++k) {
+			if (sim.inverse_mass[k] == 0)
+				continue;
+			double const m = 1.0 / sim.inverse_mass[k];
+			energy += 0.5 * m * dot(sim.velocity[k], sim.velocity[k]) - m * dot(sim.acceleration[k], sim.position[k]);
+		}
+		for (int k = 0; k < sim.edge.size(); ++k) {
+			if (sim.edge_compliance[k] == 0)
+				continue;
+			float const C = norm(sim.position[sim.edge[k][1]] - sim.position[sim.edge[k][0]]) - sim.edge_length[k];
+			energy += 0.5 * C * C / sim.edge_compliance[k];
+		}
+		return energy;
+	}
+}
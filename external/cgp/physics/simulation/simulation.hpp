@@ -0,0 +1,97 @@
+#pragma once
+
+#include "cgp/geometry/vec/vec.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+#include "cgp/physics/scene_file/scene_file.hpp"
+
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// Simulation of the bodies of a scene description with a mass-spring model solved by XPBD (Extended Position Based Dynamics)
+	//
+	// All the bodies are merged in a single set of particles. Each edge of a body (edges of the triangles, of the tetrahedra, or successive vertices of a rope)
+	//  is a distance constraint with the compliance 1/stiffness of the material (stiffness 0 gives inextensible edges).
+	//  A body with an anchor is attached by a spring between its first vertex and the first vertex of the anchor body.
+	// The mass of the material is the total mass of the body, distributed on the vertices (weighted by the area of the triangles or the volume of the tetrahedra).
+	// Fixed bodies have an infinite mass. Colliders are handled by projecting the particles outside of them at each substep.
+	//
+	// A time step is divided in solver.substeps substeps, each of them running solver.iterations Gauss-Seidel iterations over the constraints.
+	//  The constraints are sorted by colors (no shared vertex in a color) such that each color is projected in parallel (OpenMP).
+
+	struct simulation_body
+	{
+		std::string name;
+		int offset = 0;                  // first particle of the body
+		int size = 0;                    // number of particles
+		numarray<int> shape_to_particle; // particle of each vertex of the surface mesh (vertices at the same position share a particle). Empty for tet meshes: the particles are the vertices of the volume.
+	};
+
+	struct simulation_collider
+	{
+		scene_collider_type type = scene_collider_type::plane;
+		vec3 position;
+		vec3 normal = { 0,0,1 };
+		float size = 1.0f;
+		float friction = 0.0f;
+	};
+
+	/** Measures of one simulation step */
+	struct simulation_step_statistics
+	{
+		int iterations = 0;            // total number of constraint iterations (substeps x iterations)
+		float initial_residual = 0.0f; // RMS of the constraint violations (relative to the rest length) before the first iteration (predicted positions of the first substep)
+		float final_residual = 0.0f;   // RMS after the last iteration of the last substep
+		float max_violation = 0.0f;    // maximal relative violation at the end of the step
+		float max_penetration = 0.0f;  // maximal depth of a particle inside a collider before its projection
+
+		// Time spent in each phase (seconds)
+		double time_integrate = 0.0;
+		double time_solve = 0.0;
+		double time_collide = 0.0;
+		double time_velocity = 0.0;
+		double time_total = 0.0;
+	};
+
+	struct simulation
+	{
+		// Particles of all the bodies
+		numarray<vec3> position;
+		numarray<vec3> velocity;
+		numarray<vec3> previous;       // position at the beginning of the substep
+		numarray<vec3> acceleration;   // gravity and external forces divided by the mass
+		numarray<float> inverse_mass;
+		numarray<float> damping;
+
+		// Distance constraints
+		numarray<uint2> edge;
+		numarray<float> edge_length;
+		numarray<float> edge_compliance;
+		numarray<float> edge_lambda;
+		numarray<int> edge_order;         // constraints sorted by color
+		numarray<int> edge_color_offset;
+
+		std::vector<simulation_body> bodies;
+		std::vector<simulation_collider> colliders;
+		scene_solver solver;
+
+		double time = 0.0;
+		int step_count = 0;
+		int threads = 0; // number of OpenMP threads used by the step (0: default of OpenMP)
+
+		/** Index of the body with the given name, or -1 */
+		int find_body(std::string const& name) const;
+		/** Memory used by the arrays of the simulation (octets) */
+		size_t memory_size() const;
+	};
+
+	/** Build the particles and constraints of the bodies of a scene (the assets of the scene must be loaded) */
+	simulation simulation_build(scene_description const& scene);
+
+	/** Advance the simulation by solver.time_step */
+	simulation_step_statistics simulation_step(simulation& sim);
+
+	/** Total mechanical energy: kinetic, potential of the gravity and external forces, and elastic energy of the compliant constraints (fixed particles are ignored) */
+	double simulation_energy(simulation const& sim);
+}
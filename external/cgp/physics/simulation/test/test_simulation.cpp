@@ -0,0 +1,126 @@
+#include "test_simulation.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/geometry/shape/tet_mesh/loader/binary/tet_binary.hpp"
+#include "../simulation.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+namespace cgp_test
+{
+	namespace
+	{
+		cgp::scene_description test_scene(std::string const& text)
+		{
+			cgp::scene_description scene = cgp::scene_parse(text.data(), text.data() + text.size(), "test_simulation.scene");
+			cgp::scene_load_assets(scene);
+			return scene;
+		}
+	}
+
+	void test_simulation()
+	{
+		using namespace cgp;
+
+		// The duplicated vertices of the faces of the cube are merged: 8 particles, 12 edges and 6 diagonals
+		{
+			simulation sim = simulation_build(test_scene("material m mass 3\nbody cube cube material m\nbody anchor point position 0 0 2 fixed\n"));
+			assert_cgp_no_msg(sim.bodies.size() == 2 && sim.bodies[0].size == 8 && sim.bodies[1].offset == 8);
+			assert_cgp_no_msg(sim.position.size() == 9 && sim.edge.size() == 18);
+			assert_cgp_no_msg(sim.bodies[0].shape_to_particle.size() == 24);
+			assert_cgp_no_msg(sim.inverse_mass[8] == 0.0f);
+
+			double mass = 0.0;
+			for (int k = 0; k < 8; ++k)
+				mass += 1.0 / sim.inverse_mass[k];
+			assert_cgp_no_msg(std::abs(mass - 3.0) < 1e-4);
+
+			// Each color contains edges without common vertex
+			for (int c = 0; c + 1 < sim.edge_color_offset.size(); ++c) {
+				std::vector<int> used(sim.position.size(), 0);
+				for (int j = sim.edge_color_offset[c]; j < sim.edge_color_offset[c + 1]; ++j)
+					for (unsigned int v : sim.edge[sim.edge_order[j]])
+						assert_cgp_no_msg(used[v]++ == 0);
+			}
+			assert_cgp_no_msg(sim.find_body("anchor") == 1 && sim.find_body("unknown") == -1);
+			assert_cgp_no_msg(sim.memory_size() > 0);
+		}
+
+		// A vertex in no tetrahedron is kept fixed instead of getting an infinite inverse mass
+		{
+			tet_mesh volume;
+			volume.position = { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}, {5,5,5} };
+			volume.connectivity = { {0,1,2,3} };
+			save_file_tet_binary("test_simulation_isolated.cgptet", volume);
+			simulation sim = simulation_build(test_scene("body block cgptet test_simulation_isolated.cgptet\n"));
+			std::remove("test_simulation_isolated.cgptet");
+			assert_cgp_no_msg(sim.position.size() == 5);
+			for (int k = 0; k < 4; ++k)
+				assert_cgp_no_msg(sim.inverse_mass[k] > 0.0f && std::isfinite(sim.inverse_mass[k]));
+			assert_cgp_no_msg(sim.inverse_mass[4] == 0.0f);
+			simulation_step(sim);
+			assert_cgp_no_msg(std::isfinite(sim.position[0].z) && sim.position[4].z == 5.0f);
+		}
+
+		// An inextensible rope attached to a fixed point falls and keeps its length
+		{
+			simulation sim = simulation_build(test_scene(
+				"solver time_step 0.01 substeps 10 iterations 5\n"
+				"body top point position 0 0 0.1 fixed\n"
+				"body rope rope size 1 resolution 11 2 anchor top\n"));
+			assert_cgp_no_msg(sim.position.size() == 12 && sim.edge.size() == 11);
+
+			simulation_step_statistics stats;
+			for (int k = 0; k < 50; ++k)
+				stats = simulation_step(sim);
+			assert_cgp_no_msg(sim.step_count == 50 && std::abs(sim.time - 0.5) < 1e-4);
+			assert_cgp_no_msg(stats.iterations == 50 && stats.max_violation < 0.01f && stats.final_residual <= stats.max_violation);
+			assert_cgp_no_msg(sim.position[0].z == 0.1f);
+			assert_cgp_no_msg(sim.position[11].z < -0.5f);
+			assert_cgp_no_msg(stats.time_total >= stats.time_solve && stats.time_solve > 0);
+		}
+
+		// A damped spring loses energy
+		{
+			simulation sim = simulation_build(test_scene(
+				"solver time_step 0.01 substeps 4 iterations 2\n"
+				"material spring mass 2 stiffness 50 damping 0.5\n"
+				"body p1 point position 0 0 1 fixed\n"
+				"body p2 point position 0 0 0 material spring anchor p1 velocity 1 0 0\n"));
+			assert_cgp_no_msg(sim.edge.size() == 1 && std::abs(sim.edge_compliance[0] - 0.02f) < 1e-6f);
+			double const E0 = simulation_energy(sim);
+			double E = E0;
+			for (int k = 0; k < 500; ++k)
+				simulation_step(sim);
+			E = simulation_energy(sim);
+			assert_cgp_no_msg(E < E0);
+		}
+
+		// A cloth falling on a plane stays above it, with the same result for any number of threads (the colors are independent)
+		{
+			std::string const text =
+				"solver time_step 0.02 substeps 2 iterations 4\n"
+				"material cloth mass 1 stiffness 1000\n"
+				"body cloth grid position 0 0 0.2 size 2 resolution 70 70 material cloth\n"
+				"collider ground plane position 0 0 0 friction 0.5\n"
+				"collider ball sphere position 0 0 0 size 0.3\n";
+			simulation a = simulation_build(test_scene(text));
+			simulation b = a;
+			a.threads = 1;
+			b.threads = 2;
+
+			float max_penetration = 0.0f;
+			for (int k = 0; k < 30; ++k) {
+				max_penetration = std::max(max_penetration, simulation_step(a).max_penetration);
+				simulation_step(b);
+			}
+			assert_cgp_no_msg(max_penetration > 0.0f);
+			for (int k = 0; k < a.position.size(); ++k) {
+				assert_cgp_no_msg(a.position[k].z >= -1e-5f);
+				assert_cgp_no_msg(norm(a.position[k]) >= 0.3f - 1e-4f);
+				assert_cgp_no_msg(norm(a.position[k] - b.position[k]) == 0.0f);
+			}
+		}
+	}
+}
@@ -0,0 +1,173 @@
+#include "solver_telemetry.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace cgp
+{
+	namespace
+	{
+		std::string json_number(double x)
+		{
+			if (!std::isfinite(x))
+				return "null";
+			std::ostringstream s;
+			s.precision(9);
+			s << x;
+			return s.str();
+		}
+	}
+
+	double solver_step_record::time_per_iteration() const
+	{
+		return iterations > 0 ? solve_time / iterations : 0.0;
+	}
+
+	float solver_step_record::convergence_rate() const
+	{
+		if (iterations <= 0 || initial_residual <= 0.0f)
+			return 0.0f;
+		return float(std::pow(double(final_residual) / initial_residual, 1.0 / iterations));
+	}
+
+	solver_telemetry::solver_telemetry(int capacity)
+		:ring(std::max(capacity, 0))
+	{}
+
+	void solver_telemetry::add(solver_step_record const& record)
+	{
+		if (ring.empty())
+			return;
+		ring[N_record % int64_t(ring.size())] = record;
+		N_record++;
+	}
+
+	void solver_telemetry::add(simulation const& sim, simulation_step_statistics const& stats)
+	{
+		solver_step_record r;
+		r.step = sim.step_count;
+		r.time = sim.time;
+		r.iterations = stats.iterations;
+		r.initial_residual = stats.initial_residual;
+		r.final_residual = stats.final_residual;
+		r.max_violation = stats.max_violation;
+		r.solve_time = stats.time_solve;
+		add(r);
+	}
+
+	void solver_telemetry::clear()
+	{
+		N_record = 0;
+	}
+
+	int solver_telemetry::size() const
+	{
+		return int(std::min(N_record, int64_t(ring.size())));
+	}
+
+	solver_step_record const& solver_telemetry::operator[](int k) const
+	{
+		assert_cgp(k >= 0 && k < size(), "Record " + str(k) + " is not kept by the solver telemetry (size " + str(size()) + ")");
+		int64_t const capacity = int64_t(ring.size());
+		return ring[(N_record - size() + k) % capacity];
+	}
+
+	solver_step_record const& solver_telemetry::last() const
+	{
+		return (*this)[size() - 1];
+	}
+
+	void solver_telemetry::series(solver_record_field field, numarray<float>& values) const
+	{
+		int const N = size();
+		values.resize(N);
+		for (int k = 0; k < N; ++k) {
+			solver_step_record const& r = (*this)[k];
+			switch (field) {
+			case solver_record_field::iterations: values[k] = float(r.iterations); break;
+			case solver_record_field::initial_residual: values[k] = r.initial_residual; break;
+			case solver_record_field::final_residual: values[k] = r.final_residual; break;
+			case solver_record_field::max_violation: values[k] = r.max_violation; break;
+			case solver_record_field::time_per_iteration: values[k] = float(r.time_per_iteration()); break;
+			case solver_record_field::convergence_rate: values[k] = r.convergence_rate(); break;
+			}
+		}
+	}
+
+	solver_telemetry_summary solver_telemetry_summarize(solver_telemetry const& telemetry)
+	{
+		solver_telemetry_summary s;
+		s.steps = telemetry.size();
+		if (s.steps == 0)
+			return s;
+
+		long long iterations = 0;
+		double residual_sum = 0.0;
+		double solve_time = 0.0;
+		double rate_sum = 0.0;
+		int N_rate = 0;
+		for (int k = 0; k < s.steps; ++k) {
+			solver_step_record const& r = telemetry[k];
+			iterations += r.iterations;
+			s.max_iterations = std::max(s.max_iterations, r.iterations);
+			residual_sum += r.final_residual;
+			s.max_final_residual = std::max(s.max_final_residual, r.final_residual);
+			s.max_violation = std::max(s.max_violation, r.max_violation);
+			solve_time += r.solve_time;
+			if (r.iterations > 0 && r.initial_residual > 0) {
+				rate_sum += r.convergence_rate();
+				N_rate++;
+			}
+		}
+		s.mean_iterations = double(iterations) / s.steps;
+		s.mean_final_residual = float(residual_sum / s.steps);
+		s.mean_time_per_iteration = iterations > 0 ? solve_time / iterations : 0.0;
+		s.mean_convergence_rate = N_rate > 0 ? float(rate_sum / N_rate) : 0.0f;
+		return s;
+	}
+
+	std::string solver_telemetry_csv(solver_telemetry const& telemetry)
+	{
+		std::ostringstream s;
+		s << "step,time,iterations,initial_residual,final_residual,max_violation,solve_time,time_per_iteration,convergence_rate\n";
+		for (int k = 0; k < telemetry.size(); ++k) {
+			solver_step_record const& r = telemetry[k];
+			s << r.step << "," << json_number(r.time) << "," << r.iterations << "," << json_number(r.initial_residual) << "," << json_number(r.final_residual)
+				<< "," << json_number(r.max_violation) << "," << json_number(r.solve_time) << "," << json_number(r.time_per_iteration()) << "," << json_number(r.convergence_rate()) << "\n";
+		}
+		return s.str();
+	}
+
+	std::string solver_telemetry_json(solver_telemetry const& telemetry)
+	{
+		solver_telemetry_summary const summary = solver_telemetry_summarize(telemetry);
+		std::ostringstream s;
+		s << "{\n";
+		s << "  \"recorded_steps\": " << telemetry.count() << ",\n";
+		s << "  \"summary\": { \"steps\": " << summary.steps << ", \"mean_iterations\": " << json_number(summary.mean_iterations) << ", \"max_iterations\": " << summary.max_iterations
+			<< ", \"mean_final_residual\": " << json_number(summary.mean_final_residual) << ", \"max_final_residual\": " << json_number(summary.max_final_residual)
+			<< ", \"max_violation\": " << json_number(summary.max_violation) << ", \"mean_time_per_iteration\": " << json_number(summary.mean_time_per_iteration)
+			<< ", \"mean_convergence_rate\": " << json_number(summary.mean_convergence_rate) << " },\n";
+		s << "  \"steps\": [";
+		for (int k = 0; k < telemetry.size(); ++k) {
+			solver_step_record const& r = telemetry[k];
+			s << (k == 0 ? "\n" : ",\n") << "    { \"step\": " << r.step << ", \"time\": " << json_number(r.time) << ", \"iterations\": " << r.iterations
+				<< ", \"initial_residual\": " << json_number(r.initial_residual) << ", \"final_residual\": " << json_number(r.final_residual)
+				<< ", \"max_violation\": " << json_number(r.max_violation) << ", \"solve_time\": " << json_number(r.solve_time) << " }";
+		}
+		s << (telemetry.size() == 0 ? "]\n" : "\n  ]\n");
+		s << "}\n";
+		return s.str();
+	}
+
+	std::string solver_telemetry_save(std::string const& filename, solver_telemetry const& telemetry)
+	{
+		bool const json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+		std::string const text = json ? solver_telemetry_json(telemetry) : solver_telemetry_csv(telemetry);
+		return file_write_atomic(filename, [&text](std::ostream& stream) { stream << text; });
+	}
+}
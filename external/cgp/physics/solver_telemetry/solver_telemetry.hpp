@@ -0,0 +1,96 @@
+#pragma once
+
+#include "cgp/physics/simulation/simulation.hpp"
+#include "cgp/core/array/numarray/numarray.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace cgp
+{
+	// Convergence of an iterative solver, step after step
+	//
+	// Each step of a solver is summarized by a record: number of iterations, residual before and after the iterations, violation of the constraints
+	//  and time of the iterations. The last records are kept in a ring of fixed capacity: adding a record copies a few numbers and never allocates,
+	//  such that the telemetry can stay enabled in every step (including under allocation_forbidden_scope).
+	// The history is used to choose the iteration budget from measures: a final residual that does not decrease anymore when iterations are added,
+	//  or a convergence rate close to 1, shows iterations that are not worth their time.
+	// A solver that does not measure a value (ex. no constraint for an ODE integrator) leaves it to 0.
+	//
+	// Example:
+	//   solver_telemetry telemetry(600);
+	//   while(...) {
+	//     simulation_step_statistics const stats = simulation_step(sim);
+	//     telemetry.add(sim, stats);
+	//   }
+	//   solver_telemetry_save("telemetry.csv", telemetry);
+
+	/** Measures of a step of a solver */
+	struct solver_step_record
+	{
+		int64_t step = 0;
+		double time = 0.0;             // simulated time at the end of the step
+		int iterations = 0;
+		float initial_residual = 0.0f; // residual before the first iteration
+		float final_residual = 0.0f;   // residual after the last iteration
+		float max_violation = 0.0f;    // maximal violation of a constraint at the end of the step
+		double solve_time = 0.0;       // seconds spent in the iterations
+
+		/** Seconds per iteration (0 without iteration) */
+		double time_per_iteration() const;
+		/** Mean reduction of the residual per iteration: (final/initial)^(1/iterations). 0 if the residuals are not measured. */
+		float convergence_rate() const;
+	};
+
+	enum class solver_record_field { iterations, initial_residual, final_residual, max_violation, time_per_iteration, convergence_rate };
+
+	/** Last records of a solver */
+	struct solver_telemetry
+	{
+		explicit solver_telemetry(int capacity = 600);
+
+		void add(solver_step_record const& record);
+		/** Add the step just done by simulation_step() */
+		void add(simulation const& sim, simulation_step_statistics const& stats);
+		void clear();
+
+		int capacity() const { return int(ring.size()); }
+		/** Number of records kept (at most the capacity) */
+		int size() const;
+		/** Number of records added since the construction or the last clear() */
+		int64_t count() const { return N_record; }
+		/** k-th kept record, the oldest first */
+		solver_step_record const& operator[](int k) const;
+		/** Last record added (the telemetry must not be empty) */
+		solver_step_record const& last() const;
+
+		/** Values of a field for the kept records, the oldest first (ex. for ImGui::PlotLines). values is resized to size(). */
+		void series(solver_record_field field, numarray<float>& values) const;
+
+	private:
+		std::vector<solver_step_record> ring;
+		int64_t N_record = 0;
+	};
+
+	/** Means and maxima over the records kept by a telemetry */
+	struct solver_telemetry_summary
+	{
+		int steps = 0;
+		double mean_iterations = 0.0;
+		int max_iterations = 0;
+		float mean_final_residual = 0.0f;
+		float max_final_residual = 0.0f;
+		float max_violation = 0.0f;
+		double mean_time_per_iteration = 0.0; // total solve time divided by the total number of iterations
+		float mean_convergence_rate = 0.0f;   // over the steps where it is defined
+	};
+	solver_telemetry_summary solver_telemetry_summarize(solver_telemetry const& telemetry);
+
+	/** Export of the kept records: one line (or object) per step, the oldest first */
+	std::string solver_telemetry_csv(solver_telemetry const& telemetry);
+	std::string solver_telemetry_json(solver_telemetry const& telemetry);
+	/** Save in JSON if the filename ends with ".json", in CSV otherwise
+	* Return an empty string on success, otherwise the description of the error (the telemetry is an observation: a failed save doesn't stop the program) */
+	std::string solver_telemetry_save(std::string const& filename, solver_telemetry const& telemetry);
+}
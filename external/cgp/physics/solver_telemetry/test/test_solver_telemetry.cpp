@@ -0,0 +1,86 @@
+#include "test_solver_telemetry.hpp"
+
+#include "cgp/core/base/base.hpp"
+#include "cgp/core/files/files.hpp"
+#include "cgp/core/profiling/allocation_tracker/allocation_tracker.hpp"
+#include "../solver_telemetry.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+namespace cgp_test
+{
+	void test_solver_telemetry()
+	{
+		using namespace cgp;
+
+		// The ring keeps the last records, the oldest first
+		{
+			solver_telemetry telemetry(3);
+			for (int k = 0; k < 5; ++k) {
+				solver_step_record r;
+				r.step = k;
+				r.iterations = 4;
+				r.initial_residual = 1.0f;
+				r.final_residual = 0.0625f;
+				r.solve_time = 0.002 * (k + 1);
+				telemetry.add(r);
+			}
+			assert_cgp_no_msg(telemetry.capacity() == 3 && telemetry.size() == 3 && telemetry.count() == 5);
+			assert_cgp_no_msg(telemetry[0].step == 2 && telemetry[2].step == 4 && telemetry.last().step == 4);
+			assert_cgp_no_msg(std::abs(telemetry[0].time_per_iteration() - 0.0015) < 1e-9);
+			assert_cgp_no_msg(std::abs(telemetry[0].convergence_rate() - 0.5f) < 1e-5f);
+
+			numarray<float> values;
+			telemetry.series(solver_record_field::time_per_iteration, values);
+			assert_cgp_no_msg(values.size() == 3 && std::abs(values[2] - 0.0025f) < 1e-7f);
+
+			solver_telemetry_summary const s = solver_telemetry_summarize(telemetry);
+			assert_cgp_no_msg(s.steps == 3 && s.mean_iterations == 4 && s.max_iterations == 4);
+			assert_cgp_no_msg(std::abs(s.mean_time_per_iteration - 0.002) < 1e-9 && std::abs(s.mean_convergence_rate - 0.5f) < 1e-5f);
+
+			// One line per record after the header
+			std::string const csv = solver_telemetry_csv(telemetry);
+			assert_cgp_no_msg(std::count(csv.begin(), csv.end(), '\n') == 4 && csv.find("\n2,") != std::string::npos);
+			assert_cgp_no_msg(solver_telemetry_json(telemetry).find("\"recorded_steps\": 5") != std::string::npos);
+
+			// A failed save is reported instead of stopping the program
+			assert_cgp_no_msg(solver_telemetry_save("test_solver_telemetry.csv", telemetry).empty());
+			assert_cgp_no_msg(file_get_size("test_solver_telemetry.csv") == csv.size());
+			std::remove("test_solver_telemetry.csv");
+			assert_cgp_no_msg(!solver_telemetry_save("missing_directory/test_solver_telemetry.json", telemetry).empty());
+
+			telemetry.clear();
+			assert_cgp_no_msg(telemetry.size() == 0 && telemetry.count() == 0);
+			assert_cgp_no_msg(solver_telemetry_summarize(telemetry).steps == 0);
+		}
+
+		// Steps of a simulation: the iterations reduce the residual of the predicted positions, and recording does not allocate
+		{
+			std::string const text =
+				"solver time_step 0.01 substeps 1 iterations 20\n"
+				"body top point position 0 0 0.1 fixed\n"
+				"body rope rope size 1 resolution 11 2 anchor top\n";
+			scene_description scene = scene_parse(text.data(), text.data() + text.size(), "test_solver_telemetry.scene");
+			scene_load_assets(scene);
+			simulation sim = simulation_build(scene);
+
+			solver_telemetry telemetry(8);
+			int64_t allocations = 0;
+			for (int k = 0; k < 10; ++k) {
+				simulation_step_statistics const stats = simulation_step(sim);
+				allocation_counters const before = allocation_thread_count();
+				telemetry.add(sim, stats);
+				allocations += (allocation_thread_count() - before).allocations;
+			}
+			assert_cgp_no_msg(allocations == 0);
+			assert_cgp_no_msg(telemetry.size() == 8 && telemetry.last().step == 10 && std::abs(telemetry.last().time - 0.1) < 1e-6);
+			for (int k = 0; k < telemetry.size(); ++k) {
+				solver_step_record const& r = telemetry[k];
+				assert_cgp_no_msg(r.iterations == 20 && r.initial_residual > 0 && r.final_residual < r.initial_residual);
+				assert_cgp_no_msg(r.convergence_rate() > 0 && r.convergence_rate() < 1 && r.solve_time > 0);
+			}
+		}
+	}
+}
@@ -211,8 +211,8 @@ double snoise2(double x, double y) {
     double y2 = y0 - 1.0f + 2.0f * G2;
 
     // Wrap the integer indices at 256, to avoid indexing perm[] out of bounds
-    int ii = i % 256;
-    int jj = j % 256;
+    int ii = i & 0xff;
+    int jj = j & 0xff;
 
     // Calculate the contribution from the three corners
     double t0 = 0.5f - x0*x0-y0*y0;
@@ -301,9 +301,9 @@ double snoise3(double x, double y, double z) {
     double z3 = z0 - 1.0f + 3.0f*G3;
 
     // Wrap the integer indices at 256, to avoid indexing perm[] out of bounds
-    int ii = i % 256;
-    int jj = j % 256;
-    int kk = k % 256;
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    int kk = k & 0xff;
 
     // Calculate the contribution from the four corners
     double t0 = 0.6f - x0*x0 - y0*y0 - z0*z0;
@@ -430,10 +430,10 @@ double snoise4(double x, double y, double z, double w) {
     double w4 = w0 - 1.0f + 4.0f*G4;
 
     // Wrap the integer indices at 256, to avoid indexing perm[] out of bounds
-    int ii = i % 256;
-    int jj = j % 256;
-    int kk = k % 256;
-    int ll = l % 256;
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    int kk = k & 0xff;
+    int ll = l & 0xff;
 
     // Calculate the contribution from the five corners
     double t0 = 0.6f - x0*x0 - y0*y0 - z0*z0 - w0*w0;
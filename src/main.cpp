@@ -3,13 +3,10 @@
 #include "cgp/cgp.hpp" // Give access to the complete CGP library
 #include <iostream>
 
-// Library for ODE solving
-#include <gsl/gsl_errno.h>
-#include <gsl/gsl_matrix.h>
-#include <gsl/gsl_odeiv2.h>
-
 // Custom scene of this code
 #include "scene.hpp"
+// Spring model integrated by GSL
+#include "spring_ode.hpp"
 
 
 // *************************** //
@@ -24,23 +21,33 @@ scene_structure scene;
 // Start of the program
 // *************************** //
 
-struct parameters {
-
-    double c;
-    double k;
-    double M;
-    double F;
-};
-
 window_structure standard_window_initialization(int width=0, int height=0);
 void initialize_default_shaders();
-int eqdiff(double t, const double y[], double f[], void* params);
-int jacobian(double t, const double y[], double* dfdy, double dfdt[], void* params);
 
-int main(int, char* argv[])
+int main(int argc, char* argv[])
 {
 	std::cout << "Run " << argv[0] << std::endl;
 
+	// Command line options: --scene scene_file, --restart checkpoint_file, --publish shared_memory_name, --forbid-allocations warmup_frames
+	std::string scene_filename = "../scenes/spring.scene";
+	std::string restart_filename, publish_name;
+	int allocation_warmup = -1;
+	for (int k = 1; k < argc; k += 2) {
+		std::string const option = argv[k];
+		if (k + 1 == argc)
+			std::cout << "Missing value of option " << option << std::endl;
+		else if (option == "--scene")
+			scene_filename = argv[k + 1];
+		else if (option == "--restart")
+			restart_filename = argv[k + 1];
+		else if (option == "--publish")
+			publish_name = argv[k + 1];
+		else if (option == "--forbid-allocations")
+			allocation_warmup = std::atoi(argv[k + 1]);
+		else
+			std::cout << "Unknown option " << option << std::endl;
+	}
+
 	// ************************ //
 	//     INITIALISATION
 	// ************************ //
@@ -53,19 +60,20 @@ int main(int, char* argv[])
 	// Initialize default shaders
 	initialize_default_shaders();
 	
-	// Custom scene initialization
-	std::cout << "Initialize data of the scene ..." << std::endl;
-	scene.initialize();                                              
+	// Custom scene initialization (bodies, materials and solver settings are read from the scene file, the assets are loaded in parallel)
+	std::cout << "Initialize data of the scene " << scene_filename << " ..." << std::endl;
+	scene_description const description = scene_load_file(scene_filename);
+	scene.initialize(description);
 	std::cout << "Initialization finished\n" << std::endl;
+	assert_cgp(scene.spring_body >= 0, "The scene " + scene_filename + " must contain a body with a material and an anchor (simulated by the spring model)");
+	mesh_drawable& p2 = scene.bodies[scene.spring_body];
+	vec3 const anchor_position = description.bodies[scene.spring_anchor].position;
 
-	// Initialize ODE solver
-	struct parameters parameters;
-    parameters.c = 0.2;
-    parameters.k = 2;
-    parameters.M = 20;
-    parameters.F = 5;
+	// Initialize ODE solver (the spring model is one-dimensional along -z)
+	spring_parameters parameters = spring_parameters_from_scene(description, scene.spring_body);
+    scene_solver const& solver = description.solver;
     gsl_odeiv2_system sys = {eqdiff, jacobian, 2, &parameters};
-    gsl_odeiv2_driver* d = gsl_odeiv2_driver_alloc_y_new (&sys, gsl_odeiv2_step_rk1imp, 1e-6, 1e-6, 0.0);
+    gsl_odeiv2_driver* d = gsl_odeiv2_driver_alloc_y_new (&sys, gsl_step_type(solver.method), solver.initial_step, solver.epsabs, solver.epsrel);
     int ti;
     double t = 0.0;
     double y[2] = { 0.5, 0.0 }; // définir y[0] : position initiale, y[1] : vitesse initiale
@@ -76,9 +84,45 @@ int main(int, char* argv[])
 	std::cout<<"Start animation loop ..."<<std::endl;
 	timer_fps fps_record;
 	fps_record.start();
+
+	// Distribution of the frame times (frames above the budget are listed with the time of their zones in the GUI)
+	scene.profiler.budget = 1 / 30.0;
+
+	// With --forbid-allocations, a heap allocation in the physics or the display after the warmup frames aborts with its backtrace
+	if (allocation_warmup >= 0)
+		allocation_guard_enable(true);
+	numarray<vec3> line_position = { anchor_position, p2.model.translation };
 	ti = 1;
+
+	// Checkpoints of the simulation are saved periodically, run "pgm --restart simulation.cgpchk" to continue from the last one
+	//  Saving only observes the state. With a single-step method, the restart continues the run bit for bit (checked by tools/restart_check).
+	//  The multistep methods (msadams, msbdf) keep a history of steps inside GSL: their checkpoints are not saved and --restart refuses them.
+	std::string const checkpoint_filename = "simulation.cgpchk";
+	int const checkpoint_interval = 600;
+	bool const checkpoint_enabled = !gsl_step_is_multistep(solver.method);
+	checkpoint_writer checkpoint_writing;
+
+	// The state of the bodies is published in shared memory for external viewers (see tools/shared_state_consumer)
+	shared_state_publisher publisher;
+	numarray<vec3> published_state(1);
+	if (!publish_name.empty()) {
+		publisher.open(publish_name, { {description.bodies[scene.spring_body].name, 1} });
+		std::cout << "Publish the simulation state in shared memory [" << publish_name << "]" << std::endl;
+	}
+
+	if (!restart_filename.empty()) {
+		if (!checkpoint_enabled)
+			error_cgp("Cannot restart from " + restart_filename + " with the multistep method " + solver.method + " of the scene " + scene_filename + ": its history of steps is not saved by the checkpoints (use a single-step method, ex. rkf45)");
+		checkpoint const c = checkpoint_load_file(restart_filename);
+		spring_checkpoint_load(c, t, y, d);
+		c.get_value("ti", ti);
+		c.get_value("p2_translation", p2.model.translation);
+		std::cout << "Restart from " << restart_filename << " (t=" << t << ")" << std::endl;
+	}
 	while (!glfwWindowShouldClose(scene.window.glfw_window))
 	{
+		scene.profiler.begin_frame();
+		bool const forbid_allocations = allocation_warmup >= 0 && scene.profiler.frame_count() >= allocation_warmup;
 		scene.camera_projection.aspect_ratio = scene.window.aspect_ratio();
 		scene.environment.camera_projection = scene.camera_projection.matrix();
 		glViewport(0, 0, scene.window.width, scene.window.height);
@@ -101,33 +145,80 @@ int main(int, char* argv[])
 		scene.inputs.mouse.on_gui = ImGui::GetIO().WantCaptureMouse;
 		scene.inputs.time_interval = time_interval;
 
+		// Checkpoint of the simulation state (copied, then written in background)
+		if (checkpoint_enabled && ti % checkpoint_interval == 0) {
+			frame_profiler_zone zone(scene.profiler, "checkpoint");
+			checkpoint c;
+			spring_checkpoint_save(c, t, y, d);
+			c.set_value("ti", ti);
+			c.set_value("p2_translation", p2.model.translation);
+			checkpoint_writing.save(checkpoint_filename, std::move(c));
+			if (!checkpoint_writing.error().empty())
+				std::cerr << "Checkpoint not saved: " << checkpoint_writing.error() << std::endl;
+		}
+
 		// Physics
-		gsl_odeiv2_driver_apply(d, &t, (double)ti, y);
-		vec3 p2dir = vec3(0,0,y[0]) - vec3(0,0,3);
-		p2dir /= norm(p2dir);
-		// std::cout << y[1] << std::endl;
-		scene.p2.model.translation += vec3(p2dir * y[1]);
-		scene.line.initialize_data_on_gpu(mesh_primitive_line(vec3(0,0,2),scene.p2.model.translation));
-		// scene.line.initialize_data_on_gpu(mesh_primitive_line(vec3(0,0,2),vec3(2,0,0.25) + scene.p2.model.translation));
+		scene.profiler.begin_zone("physics");
+		{
+			allocation_forbidden_scope allocation_guard(forbid_allocations ? "physics" : nullptr);
+			unsigned long const internal_steps = d->e->count;
+			auto const solve_start = std::chrono::steady_clock::now();
+			gsl_odeiv2_driver_apply(d, &t, ti * double(solver.time_step), y);
+
+			// Convergence of the adaptive integrator: internal steps of the frame and error estimate of the last one (relative to the tolerance)
+			solver_step_record record;
+			record.step = ti;
+			record.time = t;
+			record.iterations = int(d->e->count - internal_steps);
+			record.final_residual = gsl_error_ratio(d, y, solver);
+			record.solve_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start).count();
+			scene.solver_history.add(record);
+
+			vec3 p2dir = vec3(0,0,y[0]) - vec3(0,0,3);
+			p2dir /= norm(p2dir);
+			// std::cout << y[1] << std::endl;
+			p2.model.translation += vec3(p2dir * y[1]);
+			line_position[1] = p2.model.translation;
+			scene.line.vbo_position.update(line_position);
+			if (publisher.is_open()) {
+				published_state[0] = p2.model.translation;
+				publisher.publish(t, published_state);
+			}
+		}
+		scene.profiler.end_zone();
+		// scene.line.initialize_data_on_gpu(mesh_primitive_line(vec3(0,0,2),vec3(2,0,0.25) + p2.model.translation));
 
 		// Display the ImGUI interface (button, sliders, etc)
+		scene.profiler.begin_zone("gui");
 		scene.display_gui();
+		scene.profiler.end_zone();
 
 		// Handle camera behavior in standard frame
 		scene.idle_frame();
 
 		// Call the display of the scene
-		scene.display_frame();
+		scene.profiler.begin_zone("display");
+		{
+			allocation_forbidden_scope allocation_guard(forbid_allocations ? "display" : nullptr);
+			scene.display_frame();
+		}
+		scene.profiler.end_zone();
 
-		// End of ImGui display and handle GLFW events
+		// End of ImGui display and handle GLFW events (the swap waits for the vertical synchronization)
+		scene.profiler.begin_zone("swap");
 		ImGui::End();
 		imgui_render_frame(scene.window.glfw_window); 
 		glfwSwapBuffers(scene.window.glfw_window);
 		glfwPollEvents();
+		scene.profiler.end_zone();
+		scene.profiler.end_frame();
 
 		ti++;
 	}
 	std::cout << "\nAnimation loop stopped" << std::endl;
+	checkpoint_writing.wait();
+	if (!checkpoint_writing.error().empty())
+		std::cerr << "Checkpoint not saved: " << checkpoint_writing.error() << std::endl;
 	
 	// Cleanup
 	cgp::imgui_cleanup();
@@ -208,48 +299,6 @@ window_structure standard_window_initialization(int width_target, int height_tar
 	return window;
 }
 
-int eqdiff(double t, const double y[], double f[], void* params) {
-
-	(void)(t);
-
-    struct parameters parameters = *(struct parameters*)params;
-
-    double c = parameters.c;
-    double k = parameters.k;
-    double M = parameters.M;
-    double F = parameters.F;
-
-    f[0] = y[1];
-    f[1] = (F - c * y[1] - k * y[0]) / M;
-
-    return GSL_SUCCESS;
-}
-
-int jacobian(double t, const double y[], double* dfdy, double dfdt[], void* params) {
-
-	(void)(t);
-	(void)(y);
-
-    struct parameters parameters = *(struct parameters*)params;
-
-    double c = parameters.c;
-    double k = parameters.k;
-    double M = parameters.M;
-
-    gsl_matrix_view dfdy_mat = gsl_matrix_view_array (dfdy, 2, 2);
-    
-    gsl_matrix* m = &dfdy_mat.matrix;
-    gsl_matrix_set(m, 0, 0, 0.0);
-    gsl_matrix_set(m, 0, 1, 1.0);
-    gsl_matrix_set(m, 1, 0, -k / M);
-    gsl_matrix_set(m, 1, 1, -c / M);
-
-    dfdt[0] = 0.0;
-    dfdt[1] = 0.0;
-    
-    return GSL_SUCCESS;
-}
-
 // This function is called everytime the window is resized
 void window_size_callback(GLFWwindow* , int width, int height)
 {
@@ -1,9 +1,10 @@
 #include "scene.hpp"
+#include "spring_ode.hpp"
 
 
 using namespace cgp;
 
-void scene_structure::initialize()
+void scene_structure::initialize(scene_description const& description)
 {
 	
 
@@ -11,42 +12,51 @@ void scene_structure::initialize()
 	// ***************************************** //
 	camera_control.initialize(inputs, window); // Give access to the inputs and window global state to the camera controler
 	camera_control.set_rotation_axis_z();
-	global_frame.initialize_data_on_gpu(mesh_primitive_frame());
+	{
+		memory_scope scope("scene", "global frame");
+		global_frame.initialize_data_on_gpu(mesh_primitive_frame());
+	}
 
 	// Initialize the shapes of the scene
 	// ***************************************** //
 
-	// Create a mesh structure (here a cube)
-	mesh cube_mesh = mesh_primitive_cube(/*center*/{ 0,0,0 }, /*edge length*/ 1.0f);
-	// a mesh is simply a container of vertex data (position,normal,color,uv) and triangle index
-	// the mesh data are stored on the CPU memory - they will need to be sent to the GPU memory before being drawn
-
-
-	// Initialize a "mesh_drawable" from a mesh structure
+	// One drawable per body and collider, initialized from the meshes of the scene file
 	//   - mesh : store buffer of data (vertices, indices, etc) on the CPU. The mesh structure is convenient to manipulate in the C++ code but cannot be displayed directly (data is not on GPU).
 	//   - mesh_drawable : store VBO associated to elements on the GPU + associated uniform parameters. A mesh_drawable can be displayed using the function draw(mesh_drawable, environment). It only stores the indices of the buffers on the GPU - the buffer of data cannot be directly accessed in the C++ code through a mesh_drawable.
-	//   Note: A mesh_drawable can be initialized from a mesh structure using the syntax
-	//    [meshDrawableName].initalize_data_on_gpu( [meshName] );
-	cube.initialize_data_on_gpu(cube_mesh);
-	cube.material.color = { 1,0,1 };  // set the color of the cube using (R,G,B) \in [0,1] - this color information is send as uniform parameter to the shader when display is called.
-
-
-	// Same process for the ground which is a plane
-	float z_floor = -0.51f;
-	float L = 3;
-	mesh ground_mesh = mesh_primitive_quadrangle({ -L,-L,z_floor }, { L,-L,z_floor }, { L,L,z_floor }, { -L,L,z_floor });
-	ground.initialize_data_on_gpu(ground_mesh);
-	ground.material.color = {1,1,1};
-	ground.texture.load_and_initialize_texture_2d_on_gpu("../assets/checkerboard.png");
-
-	mesh p1_mesh = mesh_primitive_point(vec3(0,0,2));
-	mesh p2_mesh = mesh_primitive_point(vec3(0,0,0.25));
-	// mesh p2_mesh = mesh_primitive_point(vec3(2,0,0.25));
-	mesh line_mesh = mesh_primitive_line(p1_mesh.position[0],p2_mesh.position[0]);
-
-	p1.initialize_data_on_gpu(p1_mesh); p1.isPoint = true; p1.material.color = {1,0,0};
-	p2.initialize_data_on_gpu(p2_mesh); p2.isPoint = true; p2.material.color = {1,0,0};
-	line.initialize_data_on_gpu(line_mesh); line.isLine = true; line.material.color = {1,0,0};
+	bodies.resize(description.bodies.size());
+	body_visible.resize(description.bodies.size());
+	for (size_t k = 0; k < description.bodies.size(); ++k) {
+		scene_body const& body = description.bodies[k];
+		memory_scope scope("body", body.name);
+		bodies[k].initialize_data_on_gpu(body.shape);
+		bodies[k].material.color = body.color;
+		bodies[k].isPoint = body.type == scene_body_type::point || body.type == scene_body_type::rope;
+		body_visible[k] = !body.hidden;
+	}
+	spring_body = spring_body_index(description);
+	if (spring_body >= 0)
+		spring_anchor = description.bodies[spring_body].anchor;
+
+	colliders.resize(description.colliders.size());
+	collider_visible.resize(description.colliders.size());
+	for (size_t k = 0; k < description.colliders.size(); ++k) {
+		scene_collider const& collider = description.colliders[k];
+		memory_scope scope("collider", collider.name);
+		colliders[k].initialize_data_on_gpu(collider.shape);
+		colliders[k].material.color = collider.color;
+		if (!collider.texture.empty())
+			colliders[k].texture.initialize_texture_2d_on_gpu(collider.texture_image);
+		collider_visible[k] = !collider.hidden;
+	}
+
+	if (spring_body >= 0) {
+		memory_scope scope("scene", "spring line");
+		mesh const line_mesh = mesh_primitive_line(description.bodies[spring_anchor].position, description.bodies[spring_body].position);
+		line.initialize_data_on_gpu(line_mesh); line.isLine = true; line.material.color = description.bodies[spring_body].color;
+	}
+
+	// CPU memory of the meshes of the scene (the GPU memory is counted by the scopes above)
+	scene_account_memory(description);
 }
 
 
@@ -60,19 +70,19 @@ void scene_structure::display_frame()
 	// the general syntax to display a mesh is:
 	//   draw(mesh_drawableName, environment);
 	//     Note: scene is used to set the uniform parameters associated to the camera, light, etc. to the shader
-	// draw(ground, environment);
-	// draw(cube, environment);
-	draw(p1,environment);
-	draw(p2,environment);
-	draw(line,environment);
+	for (size_t k = 0; k < bodies.size(); ++k)
+		if (body_visible[k]) draw(bodies[k], environment);
+	for (size_t k = 0; k < colliders.size(); ++k)
+		if (collider_visible[k]) draw(colliders[k], environment);
+	if (spring_body >= 0) draw(line, environment);
 
 	// conditional display of the global frame (set via the GUI)
 	if(gui.display_frame) draw(global_frame, environment);
 	
 	if(gui.draw_wireframe) {
 
-		draw_wireframe(ground, environment);
-		// draw_wireframe(cube, environment);
+		for (mesh_drawable const& collider : colliders)
+			draw_wireframe(collider, environment);
 	}
 }
 
@@ -81,6 +91,99 @@ void scene_structure::display_gui()
 {
 	ImGui::Checkbox("Frame", &gui.display_frame);
 	ImGui::Checkbox("Wireframe", &gui.draw_wireframe);
+	display_gui_frame_times();
+	display_gui_memory();
+	display_gui_solver();
+}
+
+void scene_structure::display_gui_frame_times()
+{
+	if (!ImGui::CollapsingHeader("Frame times"))
+		return;
+
+	float budget_ms = float(1000 * profiler.budget);
+	if (ImGui::SliderFloat("Budget (ms)", &budget_ms, 1.0f, 100.0f))
+		profiler.budget = budget_ms / 1000.0;
+
+	std::vector<time_distribution> const distributions = profiler.distributions();
+	ImGui::Text("%-12s %8s %8s %8s %8s %8s", "ms", "p50", "p95", "p99", "max", "allocs");
+	for (time_distribution const& d : distributions)
+		ImGui::Text("%-12s %8.2f %8.2f %8.2f %8.2f %8.1f", d.name.c_str(), 1000 * d.p50, 1000 * d.p95, 1000 * d.p99, 1000 * d.max, d.allocations);
+	ImGui::Text("Last frame: %lld allocations (%lld octets)", (long long)profiler.last_frame_allocations().allocations, (long long)profiler.last_frame_allocations().bytes);
+
+	// Hardware counters of the main thread (mean per frame or per zone)
+	bool counters_enabled = profiler.hardware_counters() != nullptr;
+	if (ImGui::Checkbox("Hardware counters", &counters_enabled))
+		profiler.enable_hardware_counters(counters_enabled);
+	if (perf_counters const* counters = profiler.hardware_counters()) {
+		if (!counters->available())
+			ImGui::Text("%s", counters->error().c_str());
+		else {
+			ImGui::Text("%-12s %8s %12s %12s", "", "ipc", "cache miss", "branch miss");
+			for (time_distribution const& d : distributions)
+				ImGui::Text("%-12s %8.2f %12.0f %12.0f", d.name.c_str(), d.ipc, d.cache_misses, d.branch_misses);
+		}
+	}
+
+	ImGui::Text("%lld frames above the budget", (long long)profiler.hitch_count());
+	std::vector<frame_hitch> const hitches = profiler.hitches();
+	for (int k = int(hitches.size()) - 1; k >= 0 && k >= int(hitches.size()) - 5; --k) {
+		frame_hitch const& h = hitches[k];
+		std::string zones;
+		for (int i = 0; i < h.zone_count; ++i)
+			zones += std::string(" ") + h.zones[i].name + (h.zones[i].duration < 0 ? "(active)" : "=" + str(int(1000 * h.zones[i].duration)) + "ms");
+		ImGui::Text("frame %lld: %.1f ms, %lld allocs%s", (long long)h.frame, 1000 * h.duration, (long long)h.allocations, zones.c_str());
+	}
+	if (ImGui::Button("Reset"))
+		profiler.clear();
+}
+
+void scene_structure::display_gui_memory()
+{
+	if (!ImGui::CollapsingHeader("Memory"))
+		return;
+
+	std::vector<memory_account> accounts = memory_accounts();
+	accounts.push_back(memory_account_total());
+	ImGui::Text("%-24s %10s %10s %10s %10s %7s", "kB", "CPU", "CPU peak", "GPU", "GPU peak", "objects");
+	for (memory_account const& a : accounts) {
+		std::string const name = a.name.empty() ? a.category : a.category + " " + a.name;
+		ImGui::Text("%-24s %10.1f %10.1f %10.1f %10.1f %7lld", name.c_str(), a.cpu_bytes / 1024.0, a.cpu_peak / 1024.0, a.gpu_bytes / 1024.0, a.gpu_peak / 1024.0, (long long)a.gpu_objects);
+	}
+}
+
+void scene_structure::display_gui_solver()
+{
+	if (!ImGui::CollapsingHeader("Solver"))
+		return;
+	if (solver_history.size() == 0) {
+		ImGui::Text("No step recorded");
+		return;
+	}
+
+	solver_telemetry_summary const s = solver_telemetry_summarize(solver_history);
+	ImGui::Text("Last %d frames: %.1f internal steps per frame (max %d), %.3f us per internal step", s.steps, s.mean_iterations, s.max_iterations, 1e6 * s.mean_time_per_iteration);
+
+	char overlay[64];
+	solver_step_record const& last = solver_history.last();
+	ImVec2 const size = ImVec2(400, 60);
+	solver_history.series(solver_record_field::iterations, solver_plot);
+	std::snprintf(overlay, sizeof(overlay), "%d", last.iterations);
+	ImGui::PlotLines("Internal steps", solver_plot.data.data(), int(solver_plot.size()), 0, overlay, 0.0f, FLT_MAX, size);
+	solver_history.series(solver_record_field::final_residual, solver_plot);
+	std::snprintf(overlay, sizeof(overlay), "%.3g", last.final_residual);
+	ImGui::PlotLines("Error / tolerance", solver_plot.data.data(), int(solver_plot.size()), 0, overlay, 0.0f, FLT_MAX, size);
+	solver_history.series(solver_record_field::time_per_iteration, solver_plot);
+	std::snprintf(overlay, sizeof(overlay), "%.3f us", 1e6 * last.time_per_iteration());
+	ImGui::PlotLines("Time per step", solver_plot.data.data(), int(solver_plot.size()), 0, overlay, 0.0f, FLT_MAX, size);
+
+	if (ImGui::Button("Save CSV"))
+		solver_save_error = solver_telemetry_save("solver_telemetry.csv", solver_history);
+	ImGui::SameLine();
+	if (ImGui::Button("Save JSON"))
+		solver_save_error = solver_telemetry_save("solver_telemetry.json", solver_history);
+	if (!solver_save_error.empty())
+		ImGui::Text("Not saved: %s", solver_save_error.c_str());
 }
 
 void scene_structure::mouse_move_event()
@@ -33,21 +33,32 @@ struct scene_structure {
 	gui_parameters gui;                       // Standard GUI element storage
 	
 	cgp::timer_basic timer;
-
-	mesh_drawable ground;	
-	mesh_drawable cube;
-
-	mesh_drawable p1;
-	mesh_drawable p2;
+	cgp::frame_profiler profiler; // Distribution of the time of the frames and of their phases (displayed in the GUI)
+	cgp::solver_telemetry solver_history; // Convergence of the ODE solver in the last frames (plotted in the GUI)
+	cgp::numarray<float> solver_plot;     // Values of the plotted field
+	std::string solver_save_error;        // Error of the last save of the telemetry (displayed in the GUI)
+
+	// Bodies and colliders declared in the scene file (one drawable per element)
+	std::vector<mesh_drawable> bodies;
+	std::vector<mesh_drawable> colliders;
+	std::vector<bool> body_visible;
+	std::vector<bool> collider_visible;
+
+	// Body attached to its anchor by a spring (simulated in main.cpp), and segment displaying the spring
+	int spring_body = -1;
+	int spring_anchor = -1;
 	mesh_drawable line;
 
 	// ****************************** //
 	// Functions
 	// ****************************** //
 
-	void initialize();  // Standard initialization to be called before the animation loop
+	void initialize(cgp::scene_description const& description);  // Standard initialization to be called before the animation loop (the assets of the description must be loaded)
 	void display_frame();     // The frame display to be called within the animation loop
 	void display_gui(); // The display of the GUI, also called within the animation loop
+	void display_gui_frame_times(); // Percentiles of the frame times and last frames above the budget
+	void display_gui_memory(); // CPU and GPU memory of the bodies, colliders and other elements of the scene
+	void display_gui_solver(); // Iterations, error and time per iteration of the solver in the last frames, and export of the history
 
 	void mouse_move_event();
 	void mouse_click_event();
@@ -0,0 +1,117 @@
+#include "spring_ode.hpp"
+
+#include "cgp/core/base/base.hpp"
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_matrix.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace cgp;
+
+int spring_body_index(scene_description const& description)
+{
+	for (size_t k = 0; k < description.bodies.size(); ++k)
+		if (description.bodies[k].anchor >= 0 && description.bodies[k].material >= 0)
+			return int(k);
+	return -1;
+}
+
+spring_parameters spring_parameters_from_scene(scene_description const& description, int body)
+{
+	scene_material const& spring = description.materials[description.bodies[body].material];
+	spring_parameters parameters;
+	parameters.c = spring.damping;
+	parameters.k = spring.stiffness;
+	parameters.M = spring.mass;
+	parameters.F = -description.bodies[body].force.z;
+	return parameters;
+}
+
+gsl_odeiv2_step_type const* gsl_step_type(std::string const& method)
+{
+	if (method == "rk2") return gsl_odeiv2_step_rk2;
+	if (method == "rk4") return gsl_odeiv2_step_rk4;
+	if (method == "rkf45") return gsl_odeiv2_step_rkf45;
+	if (method == "rkck") return gsl_odeiv2_step_rkck;
+	if (method == "rk8pd") return gsl_odeiv2_step_rk8pd;
+	if (method == "rk1imp") return gsl_odeiv2_step_rk1imp;
+	if (method == "rk2imp") return gsl_odeiv2_step_rk2imp;
+	if (method == "rk4imp") return gsl_odeiv2_step_rk4imp;
+	if (method == "bsimp") return gsl_odeiv2_step_bsimp;
+	if (method == "msadams") return gsl_odeiv2_step_msadams;
+	if (method == "msbdf") return gsl_odeiv2_step_msbdf;
+	error_cgp("Unknown integration method " + method);
+}
+
+bool gsl_step_is_multistep(std::string const& method)
+{
+	return method == "msadams" || method == "msbdf";
+}
+
+float gsl_error_ratio(gsl_odeiv2_driver const* d, double const y[], scene_solver const& solver)
+{
+	double ratio = 0.0;
+	for (size_t k = 0; k < d->e->dimension; ++k)
+		ratio = std::max(ratio, std::abs(d->e->yerr[k]) / (solver.epsabs + solver.epsrel * std::abs(y[k])));
+	return float(ratio);
+}
+
+void spring_checkpoint_save(checkpoint& c, double t, double const y[2], gsl_odeiv2_driver const* d)
+{
+	c.set_value("t", t);
+	c.set("y", y, 2);
+	c.set_value("h", d->h);
+}
+
+void spring_checkpoint_load(checkpoint const& c, double& t, double y[2], gsl_odeiv2_driver* d)
+{
+	double h = 0.0;
+	c.get_value("t", t);
+	c.get("y", y, 2);
+	c.get_value("h", h);
+	gsl_odeiv2_driver_reset_hstart(d, h);
+}
+
+int eqdiff(double t, const double y[], double f[], void* params) {
+
+	(void)(t);
+
+    spring_parameters parameters = *(spring_parameters*)params;
+
+    double c = parameters.c;
+    double k = parameters.k;
+    double M = parameters.M;
+    double F = parameters.F;
+
+    f[0] = y[1];
+    f[1] = (F - c * y[1] - k * y[0]) / M;
+
+    return GSL_SUCCESS;
+}
+
+int jacobian(double t, const double y[], double* dfdy, double dfdt[], void* params) {
+
+	(void)(t);
+	(void)(y);
+
+    spring_parameters parameters = *(spring_parameters*)params;
+
+    double c = parameters.c;
+    double k = parameters.k;
+    double M = parameters.M;
+
+    gsl_matrix_view dfdy_mat = gsl_matrix_view_array (dfdy, 2, 2);
+
+    gsl_matrix* m = &dfdy_mat.matrix;
+    gsl_matrix_set(m, 0, 0, 0.0);
+    gsl_matrix_set(m, 0, 1, 1.0);
+    gsl_matrix_set(m, 1, 0, -k / M);
+    gsl_matrix_set(m, 1, 1, -c / M);
+
+    dfdt[0] = 0.0;
+    dfdt[1] = 0.0;
+
+    return GSL_SUCCESS;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "cgp/physics/scene_file/scene_file.hpp"
+#include "cgp/physics/checkpoint/checkpoint.hpp"
+
+#include <gsl/gsl_odeiv2.h>
+
+#include <string>
+
+// Spring model of the application: the body attached to its anchor moves along -z, y[0] is its position and y[1] its velocity
+//  The integration by GSL is separated from the display, such that tools/restart_check runs it without window.
+
+struct spring_parameters {
+	double c; // damping
+	double k; // stiffness
+	double M; // mass
+	double F; // force along -z
+};
+
+// Body simulated by the spring model: the first body with a material and an anchor (-1 if the scene has none)
+int spring_body_index(cgp::scene_description const& description);
+// Parameters of the spring from the material and the force of the body
+spring_parameters spring_parameters_from_scene(cgp::scene_description const& description, int body);
+
+// Right-hand side and jacobian of the ODE (params is a spring_parameters)
+int eqdiff(double t, const double y[], double f[], void* params);
+int jacobian(double t, const double y[], double* dfdy, double dfdt[], void* params);
+
+// Integration method of GSL from its name in the scene file
+gsl_odeiv2_step_type const* gsl_step_type(std::string const& method);
+// Methods keeping a history of the previous steps inside GSL (msadams, msbdf)
+bool gsl_step_is_multistep(std::string const& method);
+// Error estimate of the last internal step of the driver divided by the tolerance (the step is accepted below 1)
+float gsl_error_ratio(gsl_odeiv2_driver const* d, double const y[], cgp::scene_solver const& solver);
+
+// State of the integration in a checkpoint: t, y and the next step size of the driver
+//  Between two calls to gsl_odeiv2_driver_apply, a single-step method carries no other state (the counters of the evolve are only statistics),
+//  so the restart continues bit for bit. The multistep methods cannot be restarted: their history of steps is not accessible.
+void spring_checkpoint_save(cgp::checkpoint& c, double t, double const y[2], gsl_odeiv2_driver const* d);
+void spring_checkpoint_load(cgp::checkpoint const& c, double& t, double y[2], gsl_odeiv2_driver* d);
@@ -0,0 +1,143 @@
+// Headless execution of a scene, as fast as possible, for performance measures and regression tests
+//   batch_runner scene_file [--steps N | --duration T] [--sweep key=v1,v2,...]... [--threads N] [--simulation-threads N] [--budget ms] [--forbid-allocations W] [--counters] [--telemetry file.csv] [--output results.json]
+//   Each --sweep adds a parameter to the grid of runs (ex. --sweep solver.iterations=5,10,20 --sweep material.cloth.stiffness=100,1000).
+//   The runs are distributed on --threads threads. The results are written in JSON (in the terminal without --output).
+//   The JSON gives the p50/p95/p99/max time of the steps and of their phases; steps longer than --budget are listed with the time of their phases.
+//   With --forbid-allocations W, a heap allocation in a step after the first W steps aborts with its backtrace (allocation-free steps in CI).
+//   The guarded runs use a single OpenMP thread (--simulation-threads is ignored), such that all the loops of the steps are checked.
+//   With --counters, the hardware counters of the steps (IPC, cache and branch misses per particle) are added to the JSON when the system provides them.
+//   With --telemetry, the convergence of the solver in each step (iterations, residuals, time per iteration) is saved in CSV, or in JSON if the file
+//   ends with .json. With several runs, the index of the run is added before the extension (telemetry_0.csv, telemetry_1.csv, ...).
+//   The scenes are simulated by the XPBD engine of cgp/physics/simulation, not by the GSL spring of the interactive application (src/).
+//   A warning is printed for the scenes setting the GSL integrator (solver method, initial_step, epsabs or epsrel), which the engine ignores.
+//   peak_memory is the peak of the heap memory allocated by the thread of each run (not by its OpenMP workers), from its start to its results.
+
+#include "cgp/core/core.hpp"
+#include "cgp/physics/batch/batch.hpp"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace cgp;
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "Usage: batch_runner scene_file [--steps N | --duration T] [--sweep key=v1,v2,...]... [--threads N] [--simulation-threads N] [--budget ms] [--forbid-allocations W] [--counters] [--telemetry file.csv] [--output file.json]" << std::endl;
+		std::exit(1);
+	}
+
+	batch_parameter parse_sweep(std::string const& text)
+	{
+		size_t const equal = text.find('=');
+		if (equal == std::string::npos || equal == 0)
+			usage();
+
+		batch_parameter p;
+		p.key = text.substr(0, equal);
+		size_t start = equal + 1;
+		while (start <= text.size()) {
+			size_t end = text.find(',', start);
+			if (end == std::string::npos)
+				end = text.size();
+			std::string const value = text.substr(start, end - start);
+			char* value_end = nullptr;
+			float const x = std::strtof(value.c_str(), &value_end);
+			if (value.empty() || *value_end != '\0') {
+				std::cerr << "Invalid value [" << value << "] for the parameter " << p.key << std::endl;
+				std::exit(1);
+			}
+			p.values.push_back(x);
+			start = end + 1;
+		}
+		return p;
+	}
+
+	// Name of the telemetry file of a run: index inserted before the extension when there are several runs
+	std::string telemetry_filename(std::string const& filename, int run, int N_run)
+	{
+		if (N_run == 1)
+			return filename;
+		size_t const dot = filename.find_last_of('.');
+		size_t const slash = filename.find_last_of("/\\");
+		if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+			return filename + "_" + str(run);
+		return filename.substr(0, dot) + "_" + str(run) + filename.substr(dot);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+		usage();
+
+	std::string const scene_filename = argv[1];
+	std::string output;
+	std::string telemetry;
+	batch_settings settings;
+	std::vector<batch_parameter> sweep;
+	for (int k = 2; k < argc; ++k) {
+		std::string const option = argv[k];
+		if (option == "--counters") {
+			settings.hardware_counters = true;
+			continue;
+		}
+		if (k + 1 >= argc)
+			usage();
+		std::string const value = argv[++k];
+		if (option == "--steps") settings.steps = std::atoi(value.c_str());
+		else if (option == "--duration") settings.duration = float(std::atof(value.c_str()));
+		else if (option == "--sweep") sweep.push_back(parse_sweep(value));
+		else if (option == "--threads") settings.threads = std::atoi(value.c_str());
+		else if (option == "--simulation-threads") settings.simulation_threads = std::atoi(value.c_str());
+		else if (option == "--budget") settings.step_budget = std::atof(value.c_str()) / 1000.0;
+		else if (option == "--forbid-allocations") settings.allocation_warmup = std::atoi(value.c_str());
+		else if (option == "--telemetry") telemetry = value;
+		else if (option == "--output") output = value;
+		else usage();
+	}
+	if (settings.steps <= 0 && settings.duration <= 0)
+		settings.steps = 100;
+
+	if (settings.allocation_warmup >= 0)
+		allocation_guard_enable(true);
+	if (!telemetry.empty())
+		settings.telemetry_capacity = settings.steps > 0 ? settings.steps : 10000; // last 10000 steps of the runs given by a duration
+
+	scene_description const scene = scene_load_file(scene_filename, false);
+	if (scene.solver.ode_settings)
+		std::fprintf(stderr, "Warning: %s sets the GSL integrator of the application (solver method %s, initial_step, epsabs, epsrel). The XPBD engine ignores these settings: the runs do not measure the integration of the application.\n",
+			scene_filename.c_str(), scene.solver.method.c_str());
+	std::vector<batch_run> const runs = batch_execute(scene, sweep, settings);
+
+	// Summary in the terminal, complete results in JSON
+	for (batch_run const& r : runs) {
+		std::string parameters;
+		for (auto const& p : r.parameters)
+			parameters += p.first + "=" + str(p.second) + " ";
+		std::fprintf(stderr, "%s%d particles, %d steps: %.1f steps/s, drift %.3g, residual %.3g\n", parameters.c_str(), r.particles, r.steps, r.steps_per_second, r.energy_drift, r.mean_residual);
+		if (!r.step_time.empty())
+			std::fprintf(stderr, "  step time p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms, %lld steps above the budget, %lld allocations\n",
+				1000 * r.step_time[0].p50, 1000 * r.step_time[0].p95, 1000 * r.step_time[0].p99, 1000 * r.step_time[0].max, (long long)r.hitch_count, (long long)r.step_allocations);
+		if (r.counters_available)
+			std::fprintf(stderr, "  ipc %.2f, %.3g cache misses and %.3g branch misses per particle and step\n", r.step_counters.ipc(),
+				double(r.step_counters.cache_misses) / (double(r.steps) * r.particles), double(r.step_counters.branch_misses) / (double(r.steps) * r.particles));
+	}
+	if (settings.hardware_counters && (runs.empty() || !runs[0].counters_available)) {
+		perf_counters const counters;
+		std::fprintf(stderr, "Hardware counters not available: %s\n", counters.error().c_str());
+	}
+	for (size_t k = 0; !telemetry.empty() && k < runs.size(); ++k) {
+		std::string const error = solver_telemetry_save(telemetry_filename(telemetry, int(k), int(runs.size())), runs[k].telemetry);
+		if (!error.empty())
+			std::fprintf(stderr, "Solver telemetry not saved: %s\n", error.c_str());
+	}
+	if (output.empty())
+		std::cout << batch_json(scene_filename, settings, runs);
+	else
+		batch_save_json(output, scene_filename, settings, runs);
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+// Performance regression check on a suite of benchmark scenes (see cgp/physics/regression/regression.hpp for the format of the suite)
+//   regression_runner suite_file [--baseline file] [--update-baseline] [--confidence 0.95] [--tolerance 0.05] [--only name] [--report file]
+//   Without --update-baseline, the timings are compared to the baseline file (if given) and the program returns 1 if a benchmark fails.
+//   With a baseline, a benchmark without entry in the baseline (or measured with another number of steps) fails, and a missing baseline file is an error (2).
+//   With --update-baseline, the measures replace the entries of the measured benchmarks in the baseline (to be done on the machine used for the comparisons).
+//   The benchmarks run the XPBD engine of cgp/physics/simulation, not the GSL spring of the interactive application (src/).
+// Example: regression_runner scenes/benchmark/suite.txt --baseline baseline.txt
+
+#include "cgp/core/core.hpp"
+#include "cgp/physics/regression/regression.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+using namespace cgp;
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "Usage: regression_runner suite_file [--baseline file] [--update-baseline] [--confidence 0.95] [--tolerance 0.05] [--only name] [--report file]" << std::endl;
+		std::exit(2);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+		usage();
+
+	std::string const suite_file = argv[1];
+	std::string baseline_file, report_file, only;
+	bool update_baseline = false;
+	double confidence = 0.95;
+	double tolerance = 0.05;
+	for (int k = 2; k < argc; ++k) {
+		std::string const option = argv[k];
+		if (option == "--update-baseline") {
+			update_baseline = true;
+			continue;
+		}
+		if (k + 1 >= argc)
+			usage();
+		std::string const value = argv[++k];
+		if (option == "--baseline") baseline_file = value;
+		else if (option == "--confidence") confidence = std::atof(value.c_str());
+		else if (option == "--tolerance") tolerance = std::atof(value.c_str());
+		else if (option == "--only") only = value;
+		else if (option == "--report") report_file = value;
+		else usage();
+	}
+	if (update_baseline && baseline_file.empty())
+		usage();
+
+	std::vector<regression_sample> baseline;
+	if (!baseline_file.empty() && check_file_exist(baseline_file))
+		baseline = regression_load_baseline(baseline_file);
+	else if (!baseline_file.empty() && !update_baseline) {
+		std::cerr << "The baseline file " << baseline_file << " does not exist (create it with --update-baseline)" << std::endl;
+		return 2;
+	}
+	bool const compare = !baseline_file.empty() && !update_baseline;
+
+	std::vector<regression_sample> samples;
+	std::vector<regression_result> results;
+	for (regression_benchmark const& benchmark : regression_load_suite(suite_file)) {
+		if (!only.empty() && benchmark.name != only)
+			continue;
+		std::cerr << "Run " << benchmark.name << " (" << benchmark.repetitions << " x " << benchmark.steps << " steps) ..." << std::endl;
+		samples.push_back(regression_measure(benchmark));
+
+		regression_sample const* reference = nullptr;
+		for (regression_sample const& s : baseline)
+			if (compare && s.name == benchmark.name)
+				reference = &s;
+		results.push_back(regression_check(benchmark, samples.back(), reference, confidence, tolerance));
+		if (compare && reference == nullptr)
+			results.back().failures.push_back("no entry in the baseline " + baseline_file + " (update the baseline)");
+	}
+
+	if (results.empty()) {
+		std::cerr << "No benchmark " << (only.empty() ? "in the suite " + suite_file : only) << std::endl;
+		return 2;
+	}
+
+	std::string const report = regression_report(results);
+	std::cout << report;
+	if (!report_file.empty())
+		std::ofstream(report_file) << report;
+
+	if (update_baseline) {
+		regression_save_baseline(baseline_file, regression_merge_baseline(baseline, samples));
+		std::cout << "Baseline written in " << baseline_file << std::endl;
+	}
+
+	for (regression_result const& r : results)
+		if (!r.failures.empty())
+			return 1;
+	return 0;
+}
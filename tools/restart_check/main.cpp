@@ -0,0 +1,110 @@
+// Checks that a restart from a checkpoint continues the spring of the application bit for bit
+//   restart_check scene_file [--frames N]
+//   For each single-step method of GSL, the spring of the scene is integrated N frames in one run, then N/2 frames, saved in a checkpoint file,
+//   and restarted from this file with a new driver for the N/2 last frames. The final t and y of both runs must be identical to the bit.
+//   The frames and the checkpoint follow the animation loop of src/main.cpp. Returns 1 if a method differs (and 0 if all are identical).
+
+#include "cgp/core/core.hpp"
+#include "spring_ode.hpp"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace cgp;
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "Usage: restart_check scene_file [--frames N]" << std::endl;
+		std::exit(1);
+	}
+
+	struct spring_state
+	{
+		double t = 0.0;
+		double y[2] = { 0.5, 0.0 };
+	};
+
+	// Frames first_frame to last_frame of the animation loop (frame ti integrates up to ti * time_step)
+	void integrate_frames(gsl_odeiv2_driver* d, spring_state& state, int first_frame, int last_frame, scene_solver const& solver)
+	{
+		for (int ti = first_frame; ti <= last_frame; ++ti)
+			gsl_odeiv2_driver_apply(d, &state.t, ti * double(solver.time_step), state.y);
+	}
+
+	bool identical(spring_state const& a, spring_state const& b)
+	{
+		return std::memcmp(&a.t, &b.t, sizeof(double)) == 0 && std::memcmp(a.y, b.y, sizeof(a.y)) == 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+		usage();
+	std::string const scene_filename = argv[1];
+	int frames = 1200;
+	for (int k = 2; k < argc; k += 2) {
+		std::string const option = argv[k];
+		if (k + 1 == argc)
+			usage();
+		if (option == "--frames")
+			frames = std::atoi(argv[k + 1]);
+		else
+			usage();
+	}
+	if (frames < 2)
+		usage();
+
+	scene_description const description = scene_load_file(scene_filename);
+	int const body = spring_body_index(description);
+	assert_cgp(body >= 0, "The scene " + scene_filename + " must contain a body with a material and an anchor (simulated by the spring model)");
+	spring_parameters parameters = spring_parameters_from_scene(description, body);
+	scene_solver const& solver = description.solver;
+	gsl_odeiv2_system sys = { eqdiff, jacobian, 2, &parameters };
+
+	std::string const checkpoint_filename = "restart_check.cgpchk";
+	int const checkpoint_frame = frames / 2;
+	char const* methods[] = { "rk2", "rk4", "rkf45", "rkck", "rk8pd", "rk1imp", "rk2imp", "rk4imp", "bsimp" };
+
+	int different = 0;
+	for (char const* method : methods) {
+		// Run of all the frames
+		spring_state straight;
+		gsl_odeiv2_driver* d = gsl_odeiv2_driver_alloc_y_new(&sys, gsl_step_type(method), solver.initial_step, solver.epsabs, solver.epsrel);
+		integrate_frames(d, straight, 1, frames, solver);
+		gsl_odeiv2_driver_free(d);
+
+		// Run stopped after the checkpoint, then restarted from its file by a new driver
+		spring_state first_half;
+		d = gsl_odeiv2_driver_alloc_y_new(&sys, gsl_step_type(method), solver.initial_step, solver.epsabs, solver.epsrel);
+		integrate_frames(d, first_half, 1, checkpoint_frame, solver);
+		checkpoint c;
+		spring_checkpoint_save(c, first_half.t, first_half.y, d);
+		checkpoint_save_file(checkpoint_filename, c);
+		gsl_odeiv2_driver_free(d);
+
+		spring_state restarted;
+		d = gsl_odeiv2_driver_alloc_y_new(&sys, gsl_step_type(method), solver.initial_step, solver.epsabs, solver.epsrel);
+		spring_checkpoint_load(checkpoint_load_file(checkpoint_filename), restarted.t, restarted.y, d);
+		integrate_frames(d, restarted, checkpoint_frame + 1, frames, solver);
+		gsl_odeiv2_driver_free(d);
+
+		bool const same = identical(straight, restarted);
+		std::printf("%-8s %s (y = %.17g %.17g, restarted y = %.17g %.17g)\n", method, same ? "identical" : "DIFFERENT",
+			straight.y[0], straight.y[1], restarted.y[0], restarted.y[1]);
+		if (!same)
+			different++;
+	}
+	std::remove(checkpoint_filename.c_str());
+
+	if (different > 0) {
+		std::printf("%d method(s) do not restart bit for bit after %d frames\n", different, frames);
+		return 1;
+	}
+	std::printf("All single-step methods restart bit for bit after %d frames (checkpoint at frame %d)\n", frames, checkpoint_frame);
+	return 0;
+}
@@ -0,0 +1,89 @@
+// Strong and weak scaling of the simulation on generated scenes (cloth sheets, tetrahedral blocks, bundles of ropes)
+//   scaling_benchmark [--shapes cloth,block,ropes] [--min 1000] [--max 10000000] [--factor 10] [--threads 1,2,4,...] [--mode strong|weak|both] [--time 1] [--output file.csv]
+//   The table (CSV) gives the throughput, the parallel efficiency, the memory per particle and the fraction of time of each phase of each configuration.
+//   Without --threads, the thread counts are the powers of 2 up to the number of cores.
+
+#include "cgp/core/core.hpp"
+#include "cgp/physics/scaling/scaling.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace cgp;
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "Usage: scaling_benchmark [--shapes cloth,block,ropes] [--min N] [--max N] [--factor F] [--threads t1,t2,...] [--mode strong|weak|both] [--time seconds] [--output file.csv]" << std::endl;
+		std::exit(1);
+	}
+
+	std::vector<std::string> split(std::string const& text)
+	{
+		std::vector<std::string> words;
+		std::istringstream in(text);
+		std::string word;
+		while (std::getline(in, word, ','))
+			if (!word.empty())
+				words.push_back(word);
+		return words;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	scaling_settings settings;
+	std::string output;
+	for (int k = 1; k < argc; ++k) {
+		std::string const option = argv[k];
+		if (k + 1 >= argc)
+			usage();
+		std::string const value = argv[++k];
+		if (option == "--shapes") {
+			settings.shapes.clear();
+			for (std::string const& s : split(value)) {
+				if (s == "cloth") settings.shapes.push_back(scaling_shape::cloth);
+				else if (s == "block") settings.shapes.push_back(scaling_shape::block);
+				else if (s == "ropes") settings.shapes.push_back(scaling_shape::ropes);
+				else usage();
+			}
+		}
+		else if (option == "--min") settings.min_particles = std::atoi(value.c_str());
+		else if (option == "--max") settings.max_particles = std::atoi(value.c_str());
+		else if (option == "--factor") settings.size_factor = float(std::atof(value.c_str()));
+		else if (option == "--threads") {
+			for (std::string const& t : split(value))
+				settings.threads.push_back(std::atoi(t.c_str()));
+		}
+		else if (option == "--mode") {
+			if (value != "strong" && value != "weak" && value != "both")
+				usage();
+			settings.strong = value != "weak";
+			settings.weak = value != "strong";
+		}
+		else if (option == "--time") settings.min_time = std::atof(value.c_str());
+		else if (option == "--output") output = value;
+		else usage();
+	}
+
+	std::vector<scaling_measure> const measures = scaling_run(settings, [](scaling_measure const& m) {
+		std::fprintf(stderr, "%s %s %d particles, %d threads: %.3g particle-steps/s, efficiency %.2f, %.0f octets/particle\n",
+			str(m.shape).c_str(), m.weak ? "weak" : "strong", m.particles, m.threads, m.throughput, m.efficiency, m.memory_per_particle);
+	});
+
+	if (output.empty())
+		std::cout << scaling_csv(measures);
+	else {
+		std::ofstream stream(output);
+		if (!stream.is_open()) {
+			std::cerr << "Cannot write the file " << output << std::endl;
+			return 1;
+		}
+		stream << scaling_csv(measures);
+	}
+	return 0;
+}
@@ -0,0 +1,57 @@
+// Headless consumer of the simulation state published in shared memory
+//   Run the simulation with "pgm --publish name", then "shared_state_consumer name" in another terminal.
+//   The consumer displays the frames it receives (frame rate, and bounding box of each body) until the simulation stops.
+
+#include "cgp/core/core.hpp"
+#include "cgp/geometry/geometry.hpp"
+#include "cgp/physics/shared_state/shared_state.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+using namespace cgp;
+
+int main(int argc, char* argv[])
+{
+	std::string const name = argc > 1 ? argv[1] : "cgp_simulation";
+	std::cout << "Wait for shared memory segment [" << name << "] ..." << std::endl;
+
+	shared_state_reader reader;
+	while (!reader.open(name))
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	std::cout << "Connected: " << reader.body_count() << " bodies" << std::endl;
+	for (int k = 0; k < reader.body_count(); ++k)
+		std::cout << "  - " << reader.body_name(k) << " (" << reader.body_element_count(k) << " elements)" << std::endl;
+
+	auto const period = std::chrono::milliseconds(500);
+	int64_t previous_frame = reader.latest_frame();
+	while (!reader.publisher_closed())
+	{
+		std::this_thread::sleep_for(period);
+
+		// Read the newest frame in place, and check that it has not been overwritten while reading it
+		shared_state_frame f;
+		if (!reader.acquire(f))
+			continue;
+		std::string line = "frame " + str(f.frame) + " t=" + str(f.time) + " (" + str(double(f.frame - previous_frame) / 0.5) + " frames/s)";
+		for (int k = 0; k < reader.body_count(); ++k) {
+			vec3 const* p = reader.values(f, k);
+			int const N = reader.body_element_count(k);
+			vec3 p_min = N > 0 ? p[0] : vec3(), p_max = p_min;
+			for (int i = 1; i < N; ++i) {
+				p_min = { std::min(p_min.x, p[i].x), std::min(p_min.y, p[i].y), std::min(p_min.z, p[i].z) };
+				p_max = { std::max(p_max.x, p[i].x), std::max(p_max.y, p[i].y), std::max(p_max.z, p[i].z) };
+			}
+			line += " | " + reader.body_name(k) + " [" + str(p_min) + "] - [" + str(p_max) + "]";
+		}
+		if (!reader.is_valid(f))
+			continue; // overwritten during the reading: wait for the next one
+		std::cout << line << std::endl;
+		previous_frame = f.frame;
+	}
+
+	std::cout << "The simulation has closed the segment after " << reader.latest_frame() + 1 << " frames" << std::endl;
+	return 0;
+}